@@ -0,0 +1,1131 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "graph/node.h"
+
+#include "render/attribute.h"
+#include "render/background.h"
+#include "render/camera.h"
+#include "render/film.h"
+#include "render/graph.h"
+#include "render/hair.h"
+#include "render/integrator.h"
+#include "render/light.h"
+#include "render/mesh.h"
+#include "render/nodes.h"
+#include "render/object.h"
+#include "render/particles.h"
+#include "render/scene.h"
+#include "render/shader.h"
+#include "render/volume.h"
+
+#include "util/util_foreach.h"
+#include "util/util_map.h"
+#include "util/util_path.h"
+#include "util/util_vector.h"
+
+#include "app/cycles_binary.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* File Layout
+ *
+ * A 16 byte header followed by a sequence of chunks, each starting with a
+ * 16 byte chunk header (kind, reserved, payload size) at an aligned offset.
+ * Raw data blocks inside chunks are aligned as well, matching the alignment
+ * of the array storage they are read into. Nodes are numbered in the order they are written,
+ * node sockets and chunks refer to other nodes by that index. */
+
+#define BINARY_VERSION 1
+#define BINARY_ALIGNMENT 16
+#define BINARY_STRING_MAX (1 << 24)
+
+static const char BINARY_MAGIC[8] = {'C', 'Y', 'C', 'L', 'E', 'S', 'B', '\0'};
+static const uint32_t BINARY_ENDIAN = 0x01020304;
+
+enum BinaryChunk {
+  BINARY_CHUNK_END = 0,
+  BINARY_CHUNK_NODE = 1,
+  BINARY_CHUNK_SHADER_GRAPH = 2,
+  BINARY_CHUNK_ATTRIBUTES = 3,
+  BINARY_CHUNK_PARTICLES = 4,
+};
+
+/* Nodes that every scene already has, which are filled in instead of created. */
+enum BinaryBuiltin {
+  BINARY_BUILTIN_NONE = 0,
+  BINARY_BUILTIN_CAMERA,
+  BINARY_BUILTIN_FILM,
+  BINARY_BUILTIN_INTEGRATOR,
+  BINARY_BUILTIN_BACKGROUND,
+  BINARY_BUILTIN_DEFAULT_SURFACE,
+  BINARY_BUILTIN_DEFAULT_VOLUME,
+  BINARY_BUILTIN_DEFAULT_LIGHT,
+  BINARY_BUILTIN_DEFAULT_BACKGROUND,
+  BINARY_BUILTIN_DEFAULT_EMPTY,
+};
+
+static Node *binary_builtin_node(Scene *scene, int builtin)
+{
+  switch (builtin) {
+    case BINARY_BUILTIN_CAMERA:
+      return scene->camera;
+    case BINARY_BUILTIN_FILM:
+      return scene->film;
+    case BINARY_BUILTIN_INTEGRATOR:
+      return scene->integrator;
+    case BINARY_BUILTIN_BACKGROUND:
+      return scene->background;
+    case BINARY_BUILTIN_DEFAULT_SURFACE:
+      return scene->default_surface;
+    case BINARY_BUILTIN_DEFAULT_VOLUME:
+      return scene->default_volume;
+    case BINARY_BUILTIN_DEFAULT_LIGHT:
+      return scene->default_light;
+    case BINARY_BUILTIN_DEFAULT_BACKGROUND:
+      return scene->default_background;
+    case BINARY_BUILTIN_DEFAULT_EMPTY:
+      return scene->default_empty;
+  }
+
+  return NULL;
+}
+
+static int binary_builtin_index(Scene *scene, const Node *node)
+{
+  for (int builtin = BINARY_BUILTIN_CAMERA; builtin <= BINARY_BUILTIN_DEFAULT_EMPTY; builtin++) {
+    if (binary_builtin_node(scene, builtin) == node) {
+      return builtin;
+    }
+  }
+
+  return BINARY_BUILTIN_NONE;
+}
+
+static bool binary_socket_skip(const SocketType &socket)
+{
+  return (socket.type == SocketType::CLOSURE || socket.type == SocketType::UNDEFINED ||
+          (socket.flags & SocketType::INTERNAL));
+}
+
+/* Writer */
+
+class BinaryWriter {
+ public:
+  explicit BinaryWriter(FILE *f) : f(f), ok(true), chunk_begin(0)
+  {
+  }
+
+  void write(const void *data, size_t size)
+  {
+    if (size && fwrite(data, 1, size, f) != size) {
+      ok = false;
+    }
+  }
+
+  template<typename T> void write_value(const T &value)
+  {
+    write(&value, sizeof(T));
+  }
+
+  void write_string(const string &str)
+  {
+    write_value<uint32_t>(str.size());
+    write(str.data(), str.size());
+  }
+
+  void write_float3(const float3 &value)
+  {
+    write_value(value.x);
+    write_value(value.y);
+    write_value(value.z);
+  }
+
+  template<typename T> void write_array(const array<T> &data)
+  {
+    write_value<uint64_t>(data.size());
+    write_value<uint32_t>(sizeof(T));
+    align();
+    write(data.data(), data.size() * sizeof(T));
+  }
+
+  void align()
+  {
+    static const char zeros[BINARY_ALIGNMENT] = {0};
+    const int64_t offset = path_ftell(f);
+    write(zeros, (BINARY_ALIGNMENT - offset % BINARY_ALIGNMENT) % BINARY_ALIGNMENT);
+  }
+
+  /* Sized blocks get a placeholder size that is filled in once the contents
+   * are written, so readers can skip data they do not understand. */
+  int64_t begin_block()
+  {
+    write_value<uint64_t>(0);
+    return path_ftell(f);
+  }
+
+  void end_block(int64_t begin)
+  {
+    const int64_t end = path_ftell(f);
+    if (!path_fseek(f, begin - sizeof(uint64_t), SEEK_SET)) {
+      ok = false;
+      return;
+    }
+    write_value<uint64_t>(end - begin);
+    if (!path_fseek(f, end, SEEK_SET)) {
+      ok = false;
+    }
+  }
+
+  void begin_chunk(BinaryChunk kind)
+  {
+    align();
+    write_value<uint32_t>(kind);
+    write_value<uint32_t>(0);
+    chunk_begin = begin_block();
+  }
+
+  void end_chunk()
+  {
+    end_block(chunk_begin);
+  }
+
+  int add_node(const Node *node)
+  {
+    const int index = node_index.size();
+    node_index[node] = index;
+    return index;
+  }
+
+  int find_node(const Node *node) const
+  {
+    map<const Node *, int>::const_iterator it = node_index.find(node);
+    return (it != node_index.end()) ? it->second : -1;
+  }
+
+  FILE *f;
+  bool ok;
+
+ protected:
+  int64_t chunk_begin;
+  map<const Node *, int> node_index;
+};
+
+static void binary_write_socket(BinaryWriter &writer, const Node *node, const SocketType &socket)
+{
+  switch (socket.type) {
+    case SocketType::BOOLEAN:
+      writer.write_value<uint8_t>(node->get_bool(socket));
+      break;
+    case SocketType::INT:
+    case SocketType::ENUM:
+      writer.write_value<int32_t>(node->get_int(socket));
+      break;
+    case SocketType::UINT:
+      writer.write_value<uint32_t>(node->get_uint(socket));
+      break;
+    case SocketType::FLOAT:
+      writer.write_value(node->get_float(socket));
+      break;
+    case SocketType::COLOR:
+    case SocketType::VECTOR:
+    case SocketType::POINT:
+    case SocketType::NORMAL:
+      writer.write_float3(node->get_float3(socket));
+      break;
+    case SocketType::POINT2:
+      writer.write_value(node->get_float2(socket));
+      break;
+    case SocketType::STRING:
+      writer.write_string(node->get_string(socket).string());
+      break;
+    case SocketType::TRANSFORM:
+      writer.write_value(node->get_transform(socket));
+      break;
+    case SocketType::NODE:
+      writer.write_value<int32_t>(writer.find_node(node->get_node(socket)));
+      break;
+    case SocketType::BOOLEAN_ARRAY:
+      writer.write_array(node->get_bool_array(socket));
+      break;
+    case SocketType::FLOAT_ARRAY:
+      writer.write_array(node->get_float_array(socket));
+      break;
+    case SocketType::INT_ARRAY:
+      writer.write_array(node->get_int_array(socket));
+      break;
+    case SocketType::COLOR_ARRAY:
+    case SocketType::VECTOR_ARRAY:
+    case SocketType::POINT_ARRAY:
+    case SocketType::NORMAL_ARRAY:
+      writer.write_array(node->get_float3_array(socket));
+      break;
+    case SocketType::POINT2_ARRAY:
+      writer.write_array(node->get_float2_array(socket));
+      break;
+    case SocketType::TRANSFORM_ARRAY:
+      writer.write_array(node->get_transform_array(socket));
+      break;
+    case SocketType::STRING_ARRAY: {
+      const array<ustring> &value = node->get_string_array(socket);
+      writer.write_value<uint64_t>(value.size());
+      for (size_t i = 0; i < value.size(); i++) {
+        writer.write_string(value[i].string());
+      }
+      break;
+    }
+    case SocketType::NODE_ARRAY: {
+      const array<Node *> &value = node->get_node_array(socket);
+      writer.write_value<uint64_t>(value.size());
+      for (size_t i = 0; i < value.size(); i++) {
+        writer.write_value<int32_t>(writer.find_node(value[i]));
+      }
+      break;
+    }
+    case SocketType::CLOSURE:
+    case SocketType::UNDEFINED:
+      break;
+  }
+}
+
+static void binary_write_sockets(BinaryWriter &writer, const Node *node)
+{
+  uint32_t num_sockets = 0;
+  foreach (const SocketType &socket, node->type->inputs) {
+    if (!binary_socket_skip(socket)) {
+      num_sockets++;
+    }
+  }
+
+  writer.write_value(num_sockets);
+
+  foreach (const SocketType &socket, node->type->inputs) {
+    if (binary_socket_skip(socket)) {
+      continue;
+    }
+
+    writer.write_string(socket.name.string());
+    writer.write_value<uint32_t>(socket.type);
+    const int64_t begin = writer.begin_block();
+    binary_write_socket(writer, node, socket);
+    writer.end_block(begin);
+  }
+}
+
+static void binary_write_node(BinaryWriter &writer, Scene *scene, const Node *node)
+{
+  writer.begin_chunk(BINARY_CHUNK_NODE);
+  writer.write_value<uint32_t>(binary_builtin_index(scene, node));
+  writer.write_string(node->type->name.string());
+  writer.write_string(node->name.string());
+  binary_write_sockets(writer, node);
+  writer.end_chunk();
+
+  writer.add_node(node);
+}
+
+static void binary_write_shader_graph(BinaryWriter &writer, Shader *shader)
+{
+  ShaderGraph *graph = shader->graph;
+  if (graph == NULL) {
+    return;
+  }
+
+  map<ShaderNode *, int> node_index;
+  vector<ShaderNode *> nodes;
+
+  foreach (ShaderNode *node, graph->nodes) {
+    /* Script nodes build their sockets from the compiled shader at runtime,
+     * they can't be recreated from the node type alone. */
+    if (node->special_type == SHADER_SPECIAL_TYPE_OSL) {
+      fprintf(stderr,
+              "Skipping OSL script node \"%s\" in shader \"%s\".\n",
+              node->name.c_str(),
+              shader->name.c_str());
+      continue;
+    }
+
+    node_index[node] = nodes.size();
+    nodes.push_back(node);
+  }
+
+  writer.begin_chunk(BINARY_CHUNK_SHADER_GRAPH);
+  writer.write_value<int32_t>(writer.find_node(shader));
+
+  writer.write_value<uint32_t>(nodes.size());
+  foreach (ShaderNode *node, nodes) {
+    writer.write_string(node->type->name.string());
+    writer.write_string(node->name.string());
+    binary_write_sockets(writer, node);
+  }
+
+  uint32_t num_links = 0;
+  foreach (ShaderNode *node, nodes) {
+    foreach (ShaderInput *input, node->inputs) {
+      if (input->link && node_index.count(input->link->parent)) {
+        num_links++;
+      }
+    }
+  }
+
+  writer.write_value(num_links);
+  foreach (ShaderNode *node, nodes) {
+    foreach (ShaderInput *input, node->inputs) {
+      if (input->link && node_index.count(input->link->parent)) {
+        writer.write_value<uint32_t>(node_index[input->link->parent]);
+        writer.write_string(input->link->socket_type.name.string());
+        writer.write_value<uint32_t>(node_index[node]);
+        writer.write_string(input->socket_type.name.string());
+      }
+    }
+  }
+
+  writer.end_chunk();
+}
+
+static void binary_write_attribute_set(BinaryWriter &writer, const AttributeSet &attributes)
+{
+  uint32_t num_attributes = 0;
+  foreach (const Attribute &attr, attributes.attributes) {
+    /* Voxel attributes reference images, which are not part of the file. */
+    if (attr.element != ATTR_ELEMENT_VOXEL) {
+      num_attributes++;
+    }
+  }
+
+  writer.write_value(num_attributes);
+
+  foreach (const Attribute &attr, attributes.attributes) {
+    if (attr.element == ATTR_ELEMENT_VOXEL) {
+      continue;
+    }
+
+    writer.write_value<int32_t>(attr.std);
+    writer.write_string(attr.name.string());
+    writer.write_value<int32_t>(attr.type.basetype);
+    writer.write_value<int32_t>(attr.type.aggregate);
+    writer.write_value<int32_t>(attr.type.vecsemantics);
+    writer.write_value<int32_t>(attr.type.arraylen);
+    writer.write_value<int32_t>(attr.element);
+    writer.write_value<uint32_t>(attr.flags);
+    writer.write_value<uint64_t>(attr.buffer.size());
+    writer.align();
+    writer.write(attr.data(), attr.buffer.size());
+  }
+}
+
+static void binary_write_attributes(BinaryWriter &writer, Geometry *geom)
+{
+  writer.begin_chunk(BINARY_CHUNK_ATTRIBUTES);
+  writer.write_value<int32_t>(writer.find_node(geom));
+  binary_write_attribute_set(writer, geom->attributes);
+
+  if (geom->is_mesh()) {
+    binary_write_attribute_set(writer, static_cast<Mesh *>(geom)->subd_attributes);
+  }
+  else {
+    writer.write_value<uint32_t>(0);
+  }
+
+  writer.end_chunk();
+}
+
+static void binary_write_particles(BinaryWriter &writer, ParticleSystem *psys)
+{
+  writer.begin_chunk(BINARY_CHUNK_PARTICLES);
+  writer.write_value<int32_t>(writer.find_node(psys));
+  writer.write_array(psys->particles);
+  writer.end_chunk();
+}
+
+bool binary_write_file(Scene *scene, const char *filepath)
+{
+  FILE *f = path_fopen(filepath, "wb");
+  if (!f) {
+    fprintf(stderr, "Failed to open \"%s\" for writing.\n", filepath);
+    return false;
+  }
+
+  BinaryWriter writer(f);
+  writer.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+  writer.write_value<uint32_t>(BINARY_VERSION);
+  writer.write_value(BINARY_ENDIAN);
+
+  /* Nodes are written before anything that references them: shaders first,
+   * then geometry and particles, then the objects and lights using those. */
+  foreach (Shader *shader, scene->shaders) {
+    binary_write_node(writer, scene, shader);
+  }
+  foreach (Shader *shader, scene->shaders) {
+    binary_write_shader_graph(writer, shader);
+  }
+
+  foreach (ParticleSystem *psys, scene->particle_systems) {
+    binary_write_node(writer, scene, psys);
+    binary_write_particles(writer, psys);
+  }
+
+  foreach (Geometry *geom, scene->geometry) {
+    binary_write_node(writer, scene, geom);
+    binary_write_attributes(writer, geom);
+  }
+
+  foreach (Object *object, scene->objects) {
+    binary_write_node(writer, scene, object);
+  }
+
+  foreach (Light *light, scene->lights) {
+    binary_write_node(writer, scene, light);
+  }
+
+  binary_write_node(writer, scene, scene->camera);
+  binary_write_node(writer, scene, scene->film);
+  binary_write_node(writer, scene, scene->integrator);
+  binary_write_node(writer, scene, scene->background);
+
+  writer.begin_chunk(BINARY_CHUNK_END);
+  writer.end_chunk();
+
+  const bool ok = writer.ok;
+  if (fclose(f) != 0 || !ok) {
+    fprintf(stderr, "Failed to write \"%s\".\n", filepath);
+    return false;
+  }
+
+  return true;
+}
+
+/* Reader */
+
+class BinaryReader {
+ public:
+  BinaryReader(FILE *f, Scene *scene) : f(f), scene(scene), ok(true), file_size(0)
+  {
+    ok = path_fseek(f, 0, SEEK_END);
+    if (ok) {
+      file_size = path_ftell(f);
+      ok = (file_size >= 0) && path_fseek(f, 0, SEEK_SET);
+    }
+  }
+
+  bool read(void *data, size_t size)
+  {
+    if (ok && size && fread(data, 1, size, f) != size) {
+      ok = false;
+    }
+    return ok;
+  }
+
+  template<typename T> T read_value()
+  {
+    T value = T();
+    read(&value, sizeof(T));
+    return value;
+  }
+
+  ustring read_string()
+  {
+    const uint32_t size = read_value<uint32_t>();
+    if (!ok || size == 0) {
+      return ustring();
+    }
+    if (size > BINARY_STRING_MAX || !check_size(size, 1)) {
+      ok = false;
+      return ustring();
+    }
+
+    string str(size, '\0');
+    read(&str[0], size);
+    return ustring(str);
+  }
+
+  float3 read_float3()
+  {
+    const float x = read_value<float>();
+    const float y = read_value<float>();
+    const float z = read_value<float>();
+    return make_float3(x, y, z);
+  }
+
+  /* Raw arrays are read straight into the array storage, which is handed over
+   * to the node without any further copies. */
+  template<typename T> bool read_array(array<T> &data)
+  {
+    const uint64_t size = read_value<uint64_t>();
+    const uint32_t element_size = read_value<uint32_t>();
+    if (!ok) {
+      return false;
+    }
+    if (element_size != sizeof(T)) {
+      fprintf(stderr, "Binary scene was written by a build with a different data layout.\n");
+      ok = false;
+      return false;
+    }
+
+    align();
+
+    if (!check_size(size, sizeof(T))) {
+      return false;
+    }
+
+    T *mem = data.resize(size);
+    if (size && mem == NULL) {
+      fprintf(stderr, "Out of memory reading binary scene.\n");
+      ok = false;
+      return false;
+    }
+
+    return read(mem, size * sizeof(T));
+  }
+
+  /* Sizes are checked against the rest of the file before allocating, so a
+   * corrupt file fails to load instead of exhausting memory. */
+  bool check_size(uint64_t num_elements, size_t element_size)
+  {
+    const int64_t remaining = file_size - tell();
+    if (ok && (remaining < 0 || num_elements > (uint64_t)remaining / element_size)) {
+      ok = false;
+    }
+    return ok;
+  }
+
+  void align()
+  {
+    const int64_t offset = tell();
+    seek(offset + (BINARY_ALIGNMENT - offset % BINARY_ALIGNMENT) % BINARY_ALIGNMENT);
+  }
+
+  int64_t tell()
+  {
+    return path_ftell(f);
+  }
+
+  void seek(int64_t offset)
+  {
+    if (ok && (offset < 0 || offset > file_size || !path_fseek(f, offset, SEEK_SET))) {
+      ok = false;
+    }
+  }
+
+  Node *node(int index) const
+  {
+    return (index >= 0 && index < (int)nodes.size()) ? nodes[index] : NULL;
+  }
+
+  FILE *f;
+  Scene *scene;
+  bool ok;
+  int64_t file_size;
+
+  /* Nodes by index in the file, NULL for nodes that could not be created. */
+  vector<Node *> nodes;
+};
+
+static void binary_read_socket(BinaryReader &reader, Node *node, const SocketType &socket)
+{
+  switch (socket.type) {
+    case SocketType::BOOLEAN:
+      node->set(socket, reader.read_value<uint8_t>() != 0);
+      break;
+    case SocketType::INT:
+    case SocketType::ENUM:
+      node->set(socket, (int)reader.read_value<int32_t>());
+      break;
+    case SocketType::UINT:
+      node->set(socket, (uint)reader.read_value<uint32_t>());
+      break;
+    case SocketType::FLOAT:
+      node->set(socket, reader.read_value<float>());
+      break;
+    case SocketType::COLOR:
+    case SocketType::VECTOR:
+    case SocketType::POINT:
+    case SocketType::NORMAL:
+      node->set(socket, reader.read_float3());
+      break;
+    case SocketType::POINT2:
+      node->set(socket, reader.read_value<float2>());
+      break;
+    case SocketType::STRING:
+      node->set(socket, reader.read_string());
+      break;
+    case SocketType::TRANSFORM:
+      node->set(socket, reader.read_value<Transform>());
+      break;
+    case SocketType::NODE: {
+      Node *value = reader.node(reader.read_value<int32_t>());
+      if (value && !value->is_a(*socket.node_type)) {
+        value = NULL;
+      }
+      node->set(socket, value);
+      break;
+    }
+    case SocketType::BOOLEAN_ARRAY: {
+      array<bool> value;
+      if (reader.read_array(value)) {
+        node->set(socket, value);
+      }
+      break;
+    }
+    case SocketType::FLOAT_ARRAY: {
+      array<float> value;
+      if (reader.read_array(value)) {
+        node->set(socket, value);
+      }
+      break;
+    }
+    case SocketType::INT_ARRAY: {
+      array<int> value;
+      if (reader.read_array(value)) {
+        node->set(socket, value);
+      }
+      break;
+    }
+    case SocketType::COLOR_ARRAY:
+    case SocketType::VECTOR_ARRAY:
+    case SocketType::POINT_ARRAY:
+    case SocketType::NORMAL_ARRAY: {
+      array<float3> value;
+      if (reader.read_array(value)) {
+        node->set(socket, value);
+      }
+      break;
+    }
+    case SocketType::POINT2_ARRAY: {
+      array<float2> value;
+      if (reader.read_array(value)) {
+        node->set(socket, value);
+      }
+      break;
+    }
+    case SocketType::TRANSFORM_ARRAY: {
+      array<Transform> value;
+      if (reader.read_array(value)) {
+        node->set(socket, value);
+      }
+      break;
+    }
+    case SocketType::STRING_ARRAY: {
+      array<ustring> value;
+      const uint64_t size = reader.read_value<uint64_t>();
+      if (!reader.check_size(size, sizeof(uint32_t))) {
+        break;
+      }
+      value.resize(size);
+      for (size_t i = 0; i < value.size(); i++) {
+        value[i] = reader.read_string();
+      }
+      node->set(socket, value);
+      break;
+    }
+    case SocketType::NODE_ARRAY: {
+      array<Node *> value;
+      const uint64_t size = reader.read_value<uint64_t>();
+      if (!reader.check_size(size, sizeof(int32_t))) {
+        break;
+      }
+      value.resize(size);
+      for (size_t i = 0; i < value.size(); i++) {
+        value[i] = reader.node(reader.read_value<int32_t>());
+        if (value[i] && !value[i]->is_a(*socket.node_type)) {
+          value[i] = NULL;
+        }
+      }
+      node->set(socket, value);
+      break;
+    }
+    case SocketType::CLOSURE:
+    case SocketType::UNDEFINED:
+      break;
+  }
+}
+
+/* Read sockets into the node, or skip them when node is NULL. */
+static void binary_read_sockets(BinaryReader &reader, Node *node)
+{
+  const uint32_t num_sockets = reader.read_value<uint32_t>();
+
+  for (uint32_t i = 0; i < num_sockets && reader.ok; i++) {
+    const ustring name = reader.read_string();
+    const uint32_t type = reader.read_value<uint32_t>();
+    const uint64_t size = reader.read_value<uint64_t>();
+    if (!reader.check_size(size, 1)) {
+      break;
+    }
+    const int64_t end = reader.tell() + size;
+
+    /* Sockets that were removed or changed type since the file was written
+     * are skipped, leaving the default value. */
+    const SocketType *socket = (node) ? node->type->find_input(name) : NULL;
+    if (socket && socket->type == type && !binary_socket_skip(*socket)) {
+      binary_read_socket(reader, node, *socket);
+    }
+
+    reader.seek(end);
+  }
+}
+
+static Node *binary_create_node(Scene *scene, const NodeType *type)
+{
+  if (type == Mesh::node_type) {
+    return scene->create_node<Mesh>();
+  }
+  else if (type == Hair::node_type) {
+    return scene->create_node<Hair>();
+  }
+  else if (type == Volume::node_type) {
+    return scene->create_node<Volume>();
+  }
+  else if (type == Object::node_type) {
+    return scene->create_node<Object>();
+  }
+  else if (type == Light::node_type) {
+    return scene->create_node<Light>();
+  }
+  else if (type == Shader::node_type) {
+    return scene->create_node<Shader>();
+  }
+  else if (type == ParticleSystem::node_type) {
+    return scene->create_node<ParticleSystem>();
+  }
+
+  return NULL;
+}
+
+static void binary_read_node(BinaryReader &reader)
+{
+  const uint32_t builtin = reader.read_value<uint32_t>();
+  const ustring type_name = reader.read_string();
+  const ustring name = reader.read_string();
+  if (!reader.ok) {
+    return;
+  }
+
+  const NodeType *type = NodeType::find(type_name);
+  Node *node = NULL;
+
+  if (builtin != BINARY_BUILTIN_NONE) {
+    node = binary_builtin_node(reader.scene, builtin);
+    if (node && node->type != type) {
+      node = NULL;
+    }
+  }
+  else if (type) {
+    node = binary_create_node(reader.scene, type);
+  }
+
+  if (node) {
+    node->name = name;
+  }
+  else {
+    fprintf(stderr,
+            "Skipping node \"%s\" of unknown type \"%s\".\n",
+            name.c_str(),
+            type_name.c_str());
+  }
+
+  binary_read_sockets(reader, node);
+
+  /* Keep indices in sync with the writer, also for skipped nodes. */
+  reader.nodes.push_back(node);
+}
+
+static void binary_read_shader_graph(BinaryReader &reader)
+{
+  Node *node = reader.node(reader.read_value<int32_t>());
+  Shader *shader = (node && node->type == Shader::node_type) ? static_cast<Shader *>(node) :
+                                                                NULL;
+  if (shader == NULL) {
+    return;
+  }
+
+  ShaderGraph *graph = new ShaderGraph();
+  vector<ShaderNode *> nodes;
+
+  const uint32_t num_nodes = reader.read_value<uint32_t>();
+  for (uint32_t i = 0; i < num_nodes && reader.ok; i++) {
+    const ustring type_name = reader.read_string();
+    const ustring name = reader.read_string();
+    const NodeType *node_type = NodeType::find(type_name);
+
+    ShaderNode *snode = NULL;
+
+    if (node_type == OutputNode::node_type) {
+      snode = graph->output();
+    }
+    else if (node_type && node_type->type == NodeType::SHADER && node_type->create) {
+      snode = graph->add((ShaderNode *)node_type->create(node_type));
+    }
+    else {
+      fprintf(stderr,
+              "Skipping unknown shader node \"%s\" in shader \"%s\".\n",
+              type_name.c_str(),
+              shader->name.c_str());
+    }
+
+    if (snode) {
+      snode->name = name;
+    }
+
+    binary_read_sockets(reader, snode);
+    nodes.push_back(snode);
+  }
+
+  const uint32_t num_links = reader.read_value<uint32_t>();
+  for (uint32_t i = 0; i < num_links && reader.ok; i++) {
+    const uint32_t from_index = reader.read_value<uint32_t>();
+    const ustring from_name = reader.read_string();
+    const uint32_t to_index = reader.read_value<uint32_t>();
+    const ustring to_name = reader.read_string();
+
+    ShaderNode *from = (from_index < nodes.size()) ? nodes[from_index] : NULL;
+    ShaderNode *to = (to_index < nodes.size()) ? nodes[to_index] : NULL;
+    ShaderOutput *output = (from) ? from->output(from_name) : NULL;
+    ShaderInput *input = (to) ? to->input(to_name) : NULL;
+
+    if (output && input) {
+      graph->connect(output, input);
+    }
+  }
+
+  shader->set_graph(graph);
+  shader->tag_update(reader.scene);
+}
+
+/* Attribute types and elements as they are created by Cycles, anything else in a file is
+ * corrupt. Voxel attributes are never written, their buffer holds an image handle. */
+static bool binary_attribute_valid(int basetype, int aggregate, int vecsemantics, int element)
+{
+  if (basetype < 0 || basetype >= TypeDesc::LASTBASE) {
+    return false;
+  }
+  if (aggregate != TypeDesc::SCALAR && aggregate != TypeDesc::VEC2 &&
+      aggregate != TypeDesc::VEC3 && aggregate != TypeDesc::VEC4 &&
+      aggregate != TypeDesc::MATRIX33 && aggregate != TypeDesc::MATRIX44) {
+    return false;
+  }
+  if (vecsemantics < TypeDesc::NOXFORM || vecsemantics > TypeDesc::NORMAL) {
+    return false;
+  }
+
+  switch (element) {
+    case ATTR_ELEMENT_OBJECT:
+    case ATTR_ELEMENT_MESH:
+    case ATTR_ELEMENT_FACE:
+    case ATTR_ELEMENT_VERTEX:
+    case ATTR_ELEMENT_VERTEX_MOTION:
+    case ATTR_ELEMENT_CORNER:
+    case ATTR_ELEMENT_CORNER_BYTE:
+    case ATTR_ELEMENT_CURVE:
+    case ATTR_ELEMENT_CURVE_KEY:
+    case ATTR_ELEMENT_CURVE_KEY_MOTION:
+      break;
+    default:
+      return false;
+  }
+
+  const TypeDesc type((TypeDesc::BASETYPE)basetype,
+                      (TypeDesc::AGGREGATE)aggregate,
+                      (TypeDesc::VECSEMANTICS)vecsemantics);
+  return (type == TypeDesc::TypeFloat || type == TypeDesc::TypeColor ||
+          type == TypeDesc::TypePoint || type == TypeDesc::TypeVector ||
+          type == TypeDesc::TypeNormal || type == TypeDesc::TypeMatrix || type == TypeFloat2 ||
+          type == TypeFloat4 || type == TypeRGBA);
+}
+
+static void binary_read_attribute_set(BinaryReader &reader, AttributeSet *attributes)
+{
+  const uint32_t num_attributes = reader.read_value<uint32_t>();
+
+  for (uint32_t i = 0; i < num_attributes && reader.ok; i++) {
+    const AttributeStandard std = (AttributeStandard)reader.read_value<int32_t>();
+    const ustring name = reader.read_string();
+    const int basetype = reader.read_value<int32_t>();
+    const int aggregate = reader.read_value<int32_t>();
+    const int vecsemantics = reader.read_value<int32_t>();
+    const int arraylen = reader.read_value<int32_t>();
+    const AttributeElement element = (AttributeElement)reader.read_value<int32_t>();
+    const uint flags = reader.read_value<uint32_t>();
+    const uint64_t size = reader.read_value<uint64_t>();
+    if (!reader.ok) {
+      return;
+    }
+
+    reader.align();
+    if (!reader.check_size(size, 1)) {
+      return;
+    }
+
+    if (attributes == NULL) {
+      reader.seek(reader.tell() + size);
+      continue;
+    }
+
+    if (arraylen != 0 || !binary_attribute_valid(basetype, aggregate, vecsemantics, element)) {
+      reader.ok = false;
+      return;
+    }
+
+    const TypeDesc type((TypeDesc::BASETYPE)basetype,
+                        (TypeDesc::AGGREGATE)aggregate,
+                        (TypeDesc::VECSEMANTICS)vecsemantics);
+
+    /* Read straight into the attribute buffer, sized from the geometry sockets which are read
+     * already. A different size means the file is inconsistent, packing would read past the
+     * end of the buffer. */
+    Attribute *attr = attributes->add(name, type, element);
+    if (size != attr->buffer.size()) {
+      attributes->remove(name);
+      reader.ok = false;
+      return;
+    }
+
+    attr->std = std;
+    attr->flags = flags;
+    reader.read(attr->data(), size);
+  }
+}
+
+static void binary_read_attributes(BinaryReader &reader)
+{
+  Node *node = reader.node(reader.read_value<int32_t>());
+  Geometry *geom = (node && node->is_a(Geometry::node_base_type)) ? static_cast<Geometry *>(node) :
+                                                                    NULL;
+
+  binary_read_attribute_set(reader, (geom) ? &geom->attributes : NULL);
+  binary_read_attribute_set(
+      reader, (geom && geom->is_mesh()) ? &static_cast<Mesh *>(geom)->subd_attributes : NULL);
+}
+
+static void binary_read_particles(BinaryReader &reader)
+{
+  Node *node = reader.node(reader.read_value<int32_t>());
+  if (node == NULL || node->type != ParticleSystem::node_type) {
+    return;
+  }
+
+  ParticleSystem *psys = static_cast<ParticleSystem *>(node);
+  if (reader.read_array(psys->particles)) {
+    psys->tag_update(reader.scene);
+  }
+}
+
+static bool binary_read_header(BinaryReader &reader)
+{
+  char magic[sizeof(BINARY_MAGIC)];
+  if (!reader.read(magic, sizeof(magic)) || memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0) {
+    return false;
+  }
+
+  const uint32_t version = reader.read_value<uint32_t>();
+  const uint32_t endian = reader.read_value<uint32_t>();
+  if (!reader.ok) {
+    return false;
+  }
+  if (version != BINARY_VERSION) {
+    fprintf(stderr, "Unsupported binary scene version %u.\n", version);
+    return false;
+  }
+  if (endian != BINARY_ENDIAN) {
+    fprintf(stderr, "Binary scene was written on a machine with different endianness.\n");
+    return false;
+  }
+
+  return true;
+}
+
+bool binary_is_file(const char *filepath)
+{
+  FILE *f = path_fopen(filepath, "rb");
+  if (!f) {
+    return false;
+  }
+
+  char magic[sizeof(BINARY_MAGIC)];
+  const bool is_binary = (fread(magic, 1, sizeof(magic), f) == sizeof(magic) &&
+                          memcmp(magic, BINARY_MAGIC, sizeof(magic)) == 0);
+  fclose(f);
+
+  return is_binary;
+}
+
+bool binary_read_file(Scene *scene, const char *filepath)
+{
+  FILE *f = path_fopen(filepath, "rb");
+  if (!f) {
+    fprintf(stderr, "Failed to open \"%s\".\n", filepath);
+    return false;
+  }
+
+  BinaryReader reader(f, scene);
+  if (!binary_read_header(reader)) {
+    fprintf(stderr, "\"%s\" is not a binary Cycles scene.\n", filepath);
+    fclose(f);
+    return false;
+  }
+
+  bool done = false;
+
+  while (reader.ok && !done) {
+    reader.align();
+    const uint32_t kind = reader.read_value<uint32_t>();
+    reader.read_value<uint32_t>();
+    const uint64_t size = reader.read_value<uint64_t>();
+    if (!reader.check_size(size, 1)) {
+      break;
+    }
+    const int64_t end = reader.tell() + size;
+
+    /* Unknown chunks are skipped, so files can be extended without breaking
+     * older readers. */
+    switch (kind) {
+      case BINARY_CHUNK_END:
+        done = true;
+        break;
+      case BINARY_CHUNK_NODE:
+        binary_read_node(reader);
+        break;
+      case BINARY_CHUNK_SHADER_GRAPH:
+        binary_read_shader_graph(reader);
+        break;
+      case BINARY_CHUNK_ATTRIBUTES:
+        binary_read_attributes(reader);
+        break;
+      case BINARY_CHUNK_PARTICLES:
+        binary_read_particles(reader);
+        break;
+    }
+
+    reader.seek(end);
+  }
+
+  fclose(f);
+
+  if (!done) {
+    fprintf(stderr, "Failed to read \"%s\", file is truncated or corrupt.\n", filepath);
+    return false;
+  }
+
+  /* Same as the XML loader, scenes are rendered once. */
+  scene->params.bvh_type = SceneParams::BVH_STATIC;
+
+  return true;
+}
+
+CCL_NAMESPACE_END
@@ -40,6 +40,7 @@
 #  include "util/util_view.h"
 #endif
 
+#include "app/cycles_binary.h"
 #include "app/cycles_xml.h"
 
 CCL_NAMESPACE_BEGIN
@@ -54,6 +55,7 @@ struct Options {
   bool quiet;
   bool show_help, interactive, pause;
   string output_path;
+  string export_path;
 } options;
 
 static void session_print(const string &str)
@@ -128,8 +130,15 @@ static void scene_init()
 {
   options.scene = new Scene(options.scene_params, options.session->device);
 
-  /* Read XML */
-  xml_read_file(options.scene, options.filepath.c_str());
+  /* Read binary scene or XML */
+  if (binary_is_file(options.filepath.c_str())) {
+    if (!binary_read_file(options.scene, options.filepath.c_str())) {
+      exit(EXIT_FAILURE);
+    }
+  }
+  else {
+    xml_read_file(options.scene, options.filepath.c_str());
+  }
 
   /* Camera width/height override? */
   if (!(options.width == 0 || options.height == 0)) {
@@ -165,6 +174,21 @@ static void session_init()
   options.session->start();
 }
 
+static void scene_export()
+{
+  options.session = new Session(options.session_params);
+
+  scene_init();
+  options.session->scene = options.scene;
+
+  if (!binary_write_file(options.scene, options.export_path.c_str())) {
+    exit(EXIT_FAILURE);
+  }
+
+  delete options.session;
+  options.session = NULL;
+}
+
 static void session_exit()
 {
   if (options.session) {
@@ -393,7 +417,7 @@ static void options_parse(int argc, const char **argv)
   bool help = false, debug = false, version = false;
   int verbosity = 1;
 
-  ap.options("Usage: cycles [options] file.xml",
+  ap.options("Usage: cycles [options] file.xml|file.cyb",
              "%*",
              files_parse,
              "",
@@ -417,6 +441,12 @@ static void options_parse(int argc, const char **argv)
              "--output %s",
              &options.output_path,
              "File path to write output image",
+             "--checkpoint %s",
+             &options.session_params.checkpoint_path,
+             "Save render progress to this file, and continue from it if it exists",
+             "--export %s",
+             &options.export_path,
+             "Write the scene to a binary .cyb file for faster loading, without rendering",
              "--threads %d",
              &options.session_params.threads,
              "CPU Rendering Threads",
@@ -545,6 +575,11 @@ int main(int argc, const char **argv)
   path_init();
   options_parse(argc, argv);
 
+  if (!options.export_path.empty()) {
+    scene_export();
+    return 0;
+  }
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
   if (options.session_params.background) {
 #endif
@@ -59,6 +59,7 @@ class CyclesRender(bpy.types.RenderEngine):
     bl_use_exclude_layers = True
     bl_use_save_buffers = True
     bl_use_spherical_stereo = True
+    bl_use_bake_multi_object = True
 
     def __init__(self):
         self.session = None
@@ -70,6 +70,13 @@ def _configure_argument_parser():
     parser.add_argument("--cycles-print-stats",
                         help="Print rendering statistics to stderr",
                         action='store_true')
+    parser.add_argument("--cycles-stats-json",
+                        help="Write rendering statistics as JSON next to every rendered frame",
+                        action='store_true')
+    parser.add_argument("--cycles-checkpoint",
+                        help="Periodically save render progress next to every rendered frame, "
+                        "and continue from it when rendering the frame again after an interruption",
+                        action='store_true')
     parser.add_argument("--cycles-device",
                         help="Set the device to use for Cycles, overriding user preferences and the scene setting."
                              "Valid options are 'CPU', 'CUDA', 'OPTIX' or 'OPENCL'."
@@ -107,6 +114,14 @@ def _parse_command_line():
         import _cycles
         _cycles.enable_print_stats()
 
+    if args.cycles_stats_json:
+        import _cycles
+        _cycles.enable_stats_json()
+
+    if args.cycles_checkpoint:
+        import _cycles
+        _cycles.enable_checkpoints()
+
     if args.cycles_device:
         import _cycles
         _cycles.set_device_override(args.cycles_device)
@@ -266,6 +281,7 @@ def list_render_passes(scene, srl):
     if crl.pass_debug_bvh_intersections:       yield ("Debug BVH Intersections",       "X",   'VALUE')
     if crl.pass_debug_ray_bounces:             yield ("Debug Ray Bounces",             "X",   'VALUE')
     if crl.pass_debug_sample_count:            yield ("Debug Sample Count",            "X",   'VALUE')
+    if crl.pass_debug_adaptive_error:          yield ("Debug Adaptive Error",          "X",   'VALUE')
     if crl.use_pass_volume_direct:             yield ("VolumeDir",                     "RGB", 'COLOR')
     if crl.use_pass_volume_indirect:           yield ("VolumeInd",                     "RGB", 'COLOR')
 
@@ -397,6 +397,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         min=0.0, max=1.0,
         default=0.01,
     )
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Pick lights by their estimated contribution at the shading point, using a tree of all lights and emissive triangles. "
+        "Reduces noise in scenes with many lights (path tracing only)",
+        default=False,
+    )
 
     use_adaptive_sampling: BoolProperty(
         name="Use Adaptive Sampling",
@@ -677,6 +683,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_bvh_types,
         default='DYNAMIC_BVH',
     )
+    use_dynamic_bvh: BoolProperty(
+        name="Dynamic BVH",
+        description="Keep a separate BVH for every object, so that object transform changes between frames "
+        "only rebuild the top level BVH. Only used with persistent data, renders slower",
+        default=False,
+    )
     debug_use_spatial_splits: BoolProperty(
         name="Use Spatial Splits",
         description="Use BVH spatial splits: longer builder time, faster render",
@@ -800,6 +812,46 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_texture_limit
     )
 
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Load image files on demand while rendering on the CPU, instead of loading "
+        "them completely up front. Works best with tiled and mipmapped files (.tx)",
+        default=False,
+    )
+
+    texture_cache_size: IntProperty(
+        name="Cache Size",
+        description="Maximum memory used by the texture cache, in megabytes",
+        default=4096,
+        min=64, max=1048576,
+        subtype='UNSIGNED',
+    )
+
+    use_out_of_core_geometry: BoolProperty(
+        name="Out-of-Core Geometry",
+        description="Move large packed geometry arrays to memory mapped files while rendering on "
+        "the CPU, more slowly. The original mesh data stays in memory, and so do the BVH and "
+        "vertex copies of Embree, so with Embree only part of the geometry memory is saved",
+        default=False,
+    )
+
+    out_of_core_geometry_threshold: IntProperty(
+        name="Threshold",
+        description="Minimum size of geometry data to move to files, in megabytes",
+        default=64,
+        min=0, max=1048576,
+        subtype='UNSIGNED',
+    )
+
+    out_of_core_geometry_path: StringProperty(
+        name="Directory",
+        description="Directory for the memory mapped files, the temporary directory of the "
+        "system if empty. A fast local disk works best. A directory kept in memory, like a "
+        "tmpfs temporary directory, saves no memory",
+        default="",
+        subtype='DIR_PATH',
+    )
+
     ao_bounces: IntProperty(
         name="AO Bounces",
         default=0,
@@ -1297,6 +1349,14 @@ class CyclesCurveRenderSettings(bpy.types.PropertyGroup):
         min=0, max=24,
         default=2,
     )
+    use_compression: BoolProperty(
+        name="Compression",
+        description="Store curve keys quantized to 16 bits, halving their memory usage "
+        "at a small loss of precision and render speed. Embree on the CPU and OptiX keep "
+        "their own full precision copy of the keys for intersection, so less memory is saved "
+        "with them",
+        default=False,
+    )
 
     @classmethod
     def register(cls):
@@ -1370,6 +1430,14 @@ class CyclesRenderLayerSettings(bpy.types.PropertyGroup):
         default=False,
         update=update_render_passes,
     )
+    pass_debug_adaptive_error: BoolProperty(
+        name="Debug Adaptive Error",
+        description="Adaptive sampling error per pixel at the last convergence check, comparable "
+        "to the noise threshold. Only filled when using adaptive sampling. Per tile summaries "
+        "are added to the render statistics",
+        default=False,
+        update=update_render_passes,
+    )
     use_pass_volume_direct: BoolProperty(
         name="Volume Direct",
         description="Deliver direct volumetric scattering pass",
@@ -315,6 +315,9 @@ class CYCLES_RENDER_PT_sampling_advanced(CyclesButtonsPanel, Panel):
         col.prop(cscene, "min_transparent_bounces")
         col.prop(cscene, "light_sampling_threshold", text="Light Threshold")
 
+        if not use_branched_path(context):
+            layout.prop(cscene, "use_light_tree")
+
         if cscene.progressive != 'PATH' and use_branched_path(context):
             col = layout.column(align=True)
             col.prop(cscene, "sample_all_lights_direct")
@@ -428,6 +431,7 @@ class CYCLES_RENDER_PT_hair(CyclesButtonsPanel, Panel):
         col.prop(ccscene, "shape", text="Shape")
         if ccscene.shape == 'RIBBONS':
             col.prop(ccscene, "subdivisions", text="Curve Subdivisions")
+        col.prop(ccscene, "use_compression", text="Compression")
 
 
 class CYCLES_RENDER_PT_volumes(CyclesButtonsPanel, Panel):
@@ -734,12 +738,44 @@ class CYCLES_RENDER_PT_performance_final_render(CyclesButtonsPanel, Panel):
         layout.use_property_decorate = False
 
         scene = context.scene
+        cscene = scene.cycles
         rd = scene.render
 
         col = layout.column()
 
         col.prop(rd, "use_save_buffers")
-        col.prop(rd, "use_persistent_data", text="Persistent Images")
+        col.prop(rd, "use_persistent_data", text="Persistent Data")
+        sub = col.column()
+        sub.active = rd.use_persistent_data
+        sub.prop(cscene, "use_dynamic_bvh")
+
+
+class CYCLES_RENDER_PT_performance_memory(CyclesButtonsPanel, Panel):
+    bl_label = "Memory"
+    bl_parent_id = "CYCLES_RENDER_PT_performance"
+
+    def draw(self, context):
+        layout = self.layout
+        layout.use_property_split = True
+        layout.use_property_decorate = False
+
+        scene = context.scene
+        cscene = scene.cycles
+
+        col = layout.column()
+        col.active = use_cpu(context) and not cscene.shading_system
+        col.prop(cscene, "use_texture_cache")
+        sub = col.column()
+        sub.active = cscene.use_texture_cache
+        sub.prop(cscene, "texture_cache_size")
+
+        col = layout.column()
+        col.active = use_cpu(context)
+        col.prop(cscene, "use_out_of_core_geometry")
+        sub = col.column()
+        sub.active = cscene.use_out_of_core_geometry
+        sub.prop(cscene, "out_of_core_geometry_threshold")
+        sub.prop(cscene, "out_of_core_geometry_path")
 
 
 class CYCLES_RENDER_PT_performance_viewport(CyclesButtonsPanel, Panel):
@@ -842,6 +878,7 @@ class CYCLES_RENDER_PT_passes_data(CyclesButtonsPanel, Panel):
         col = layout.column(heading="Debug", align=True)
         col.prop(cycles_view_layer, "pass_debug_render_time", text="Render Time")
         col.prop(cycles_view_layer, "pass_debug_sample_count", text="Sample Count")
+        col.prop(cycles_view_layer, "pass_debug_adaptive_error", text="Adaptive Error")
 
         layout.prop(view_layer, "pass_alpha_threshold")
 
@@ -2312,6 +2349,7 @@ classes = (
     CYCLES_RENDER_PT_performance_tiles,
     CYCLES_RENDER_PT_performance_acceleration_structure,
     CYCLES_RENDER_PT_performance_final_render,
+    CYCLES_RENDER_PT_performance_memory,
     CYCLES_RENDER_PT_performance_viewport,
     CYCLES_RENDER_PT_passes,
     CYCLES_RENDER_PT_passes_data,
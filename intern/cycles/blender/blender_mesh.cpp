@@ -33,11 +33,58 @@
 #include "util/util_hash.h"
 #include "util/util_logging.h"
 #include "util/util_math.h"
+#include "util/util_tbb.h"
 
 #include "mikktspace.h"
 
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
 CCL_NAMESPACE_BEGIN
 
+/* Direct Data Access
+ *
+ * The RNA collections of a mesh wrap plain arrays, so the data pointer of the first element is
+ * the start of the array. Reading those directly avoids several calls through RNA for every
+ * element, which dominates sync time of large meshes. */
+
+template<typename T, typename Collection> static const T *mesh_array(Collection &collection)
+{
+  return (collection.length() > 0) ? static_cast<const T *>(collection[0].ptr.data) : NULL;
+}
+
+/* Same as CustomData_get_layer(). */
+static const void *mesh_custom_data_layer(BL::Mesh &b_mesh, const bool loop_data, const int type)
+{
+  const ::Mesh *me = static_cast<const ::Mesh *>(b_mesh.ptr.data);
+  const CustomData &data = (loop_data) ? me->ldata : me->vdata;
+  const int index = data.typemap[type];
+  return (index != -1) ? data.layers[index].data : NULL;
+}
+
+static inline float3 mesh_vertex_co(const MVert &mvert)
+{
+  return make_float3(mvert.co[0], mvert.co[1], mvert.co[2]);
+}
+
+static inline float3 mesh_vertex_normal(const MVert &mvert)
+{
+  return make_float3(mvert.no[0], mvert.no[1], mvert.no[2]) * (1.0f / 32767.0f);
+}
+
+/* Elements copied per task, small meshes are copied in a single task. */
+#define MESH_SYNC_GRAIN_SIZE 16384
+
+template<typename Func> static void mesh_parallel_for(const size_t num, const Func &func)
+{
+  parallel_for(blocked_range<size_t>(0, num, MESH_SYNC_GRAIN_SIZE),
+               [&](const blocked_range<size_t> &range) {
+                 for (size_t i = range.begin(); i != range.end(); i++) {
+                   func(i);
+                 }
+               });
+}
+
 /* Tangent Space */
 
 struct MikkUserData {
@@ -304,11 +351,13 @@ static void attr_create_sculpt_vertex_color(Scene *scene,
     vcol_attr->std = vcol_std;
 
     float4 *cdata = vcol_attr->data_float4();
-    int numverts = b_mesh.vertices.length();
+    const MPropCol *colors = mesh_array<MPropCol>(l->data);
+    const int numverts = (colors) ? b_mesh.vertices.length() : 0;
 
-    for (int i = 0; i < numverts; i++) {
-      *(cdata++) = get_float4(l->data[i].color());
-    }
+    mesh_parallel_for(numverts, [&](const size_t i) {
+      cdata[i] = make_float4(
+          colors[i].color[0], colors[i].color[1], colors[i].color[2], colors[i].color[3]);
+    });
   }
 }
 
@@ -317,6 +366,15 @@ static void attr_create_vertex_color(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh,
 {
   BL::Mesh::vertex_colors_iterator l;
 
+  /* Compress/encode vertex color using the sRGB curve, tabulated since colors are bytes. */
+  uchar byte_table[256];
+  for (int i = 0; i < 256; i++) {
+    byte_table[i] = float_to_byte(i / 255.0f);
+  }
+  auto encode = [&](const MLoopCol &c) {
+    return make_uchar4(byte_table[c.r], byte_table[c.g], byte_table[c.b], byte_table[c.a]);
+  };
+
   for (b_mesh.vertex_colors.begin(l); l != b_mesh.vertex_colors.end(); ++l) {
     const bool active_render = l->active_render();
     AttributeStandard vcol_std = (active_render) ? ATTR_STD_VERTEX_COLOR : ATTR_STD_NONE;
@@ -330,6 +388,7 @@ static void attr_create_vertex_color(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh,
     }
 
     Attribute *vcol_attr = NULL;
+    const MLoopCol *colors = mesh_array<MLoopCol>(l->data);
 
     if (subdivision) {
       if (active_render) {
@@ -339,15 +398,14 @@ static void attr_create_vertex_color(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh,
         vcol_attr = mesh->subd_attributes.add(vcol_name, TypeRGBA, ATTR_ELEMENT_CORNER_BYTE);
       }
 
-      BL::Mesh::polygons_iterator p;
+      const MPoly *polys = mesh_array<MPoly>(b_mesh.polygons);
+      const int numpolys = (colors) ? b_mesh.polygons.length() : 0;
       uchar4 *cdata = vcol_attr->data_uchar4();
 
-      for (b_mesh.polygons.begin(p); p != b_mesh.polygons.end(); ++p) {
-        int n = p->loop_total();
+      for (int p = 0; p < numpolys; p++) {
+        const int n = polys[p].totloop;
         for (int i = 0; i < n; i++) {
-          float4 color = get_float4(l->data[p->loop_start() + i].color());
-          /* Compress/encode vertex color using the sRGB curve. */
-          *(cdata++) = color_float4_to_uchar4(color);
+          *(cdata++) = encode(colors[polys[p].loopstart + i]);
         }
       }
     }
@@ -359,22 +417,16 @@ static void attr_create_vertex_color(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh,
         vcol_attr = mesh->attributes.add(vcol_name, TypeRGBA, ATTR_ELEMENT_CORNER_BYTE);
       }
 
-      BL::Mesh::loop_triangles_iterator t;
+      const MLoopTri *looptris = mesh_array<MLoopTri>(b_mesh.loop_triangles);
+      const int numtris = (colors) ? b_mesh.loop_triangles.length() : 0;
       uchar4 *cdata = vcol_attr->data_uchar4();
 
-      for (b_mesh.loop_triangles.begin(t); t != b_mesh.loop_triangles.end(); ++t) {
-        int3 li = get_int3(t->loops());
-        float4 c1 = get_float4(l->data[li[0]].color());
-        float4 c2 = get_float4(l->data[li[1]].color());
-        float4 c3 = get_float4(l->data[li[2]].color());
-
-        /* Compress/encode vertex color using the sRGB curve. */
-        cdata[0] = color_float4_to_uchar4(c1);
-        cdata[1] = color_float4_to_uchar4(c2);
-        cdata[2] = color_float4_to_uchar4(c3);
-
-        cdata += 3;
-      }
+      mesh_parallel_for(numtris, [&](const size_t i) {
+        const MLoopTri &lt = looptris[i];
+        cdata[i * 3 + 0] = encode(colors[lt.tri[0]]);
+        cdata[i * 3 + 1] = encode(colors[lt.tri[1]]);
+        cdata[i * 3 + 2] = encode(colors[lt.tri[2]]);
+      });
     }
   }
 }
@@ -412,16 +464,17 @@ static void attr_create_uv_map(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh)
           uv_attr = mesh->attributes.add(uv_name, TypeFloat2, ATTR_ELEMENT_CORNER);
         }
 
-        BL::Mesh::loop_triangles_iterator t;
+        const MLoopTri *looptris = mesh_array<MLoopTri>(b_mesh.loop_triangles);
+        const MLoopUV *uvs = mesh_array<MLoopUV>(l->data);
+        const int numtris = (uvs) ? b_mesh.loop_triangles.length() : 0;
         float2 *fdata = uv_attr->data_float2();
 
-        for (b_mesh.loop_triangles.begin(t); t != b_mesh.loop_triangles.end(); ++t) {
-          int3 li = get_int3(t->loops());
-          fdata[0] = get_float2(l->data[li[0]].uv());
-          fdata[1] = get_float2(l->data[li[1]].uv());
-          fdata[2] = get_float2(l->data[li[2]].uv());
-          fdata += 3;
-        }
+        mesh_parallel_for(numtris, [&](const size_t i) {
+          const MLoopTri &lt = looptris[i];
+          for (int j = 0; j < 3; j++) {
+            fdata[i * 3 + j] = make_float2(uvs[lt.tri[j]].uv[0], uvs[lt.tri[j]].uv[1]);
+          }
+        });
       }
 
       /* UV tangent */
@@ -480,13 +533,16 @@ static void attr_create_subd_uv_map(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh,
           uv_attr->flags |= ATTR_SUBDIVIDED;
         }
 
-        BL::Mesh::polygons_iterator p;
+        const MPoly *polys = mesh_array<MPoly>(b_mesh.polygons);
+        const MLoopUV *uvs = mesh_array<MLoopUV>(l->data);
+        const int numpolys = (uvs) ? b_mesh.polygons.length() : 0;
         float2 *fdata = uv_attr->data_float2();
 
-        for (b_mesh.polygons.begin(p); p != b_mesh.polygons.end(); ++p) {
-          int n = p->loop_total();
+        for (int p = 0; p < numpolys; p++) {
+          const int n = polys[p].totloop;
           for (int j = 0; j < n; j++) {
-            *(fdata++) = get_float2(l->data[p->loop_start() + j].uv());
+            const MLoopUV &uv = uvs[polys[p].loopstart + j];
+            *(fdata++) = make_float2(uv.uv[0], uv.uv[1]);
           }
         }
       }
@@ -599,10 +655,13 @@ static void attr_create_pointiness(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh, b
   /* STEP 2: Calculate vertex normals taking into account their possible
    *         duplicates which gets "welded" together.
    */
+  const MVert *mverts = mesh_array<MVert>(b_mesh.vertices);
+  const MEdge *medges = mesh_array<MEdge>(b_mesh.edges);
+  const int num_edges = b_mesh.edges.length();
   vector<float3> vert_normal(num_verts, make_float3(0.0f, 0.0f, 0.0f));
   /* First we accumulate all vertex normals in the original index. */
   for (int vert_index = 0; vert_index < num_verts; ++vert_index) {
-    const float3 normal = get_float3(b_mesh.vertices[vert_index].normal());
+    const float3 normal = mesh_vertex_normal(mverts[vert_index]);
     const int orig_index = vert_orig_index[vert_index];
     vert_normal[orig_index] += normal;
   }
@@ -617,18 +676,16 @@ static void attr_create_pointiness(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh, b
   vector<int> counter(num_verts, 0);
   vector<float> raw_data(num_verts, 0.0f);
   vector<float3> edge_accum(num_verts, make_float3(0.0f, 0.0f, 0.0f));
-  BL::Mesh::edges_iterator e;
   EdgeMap visited_edges;
-  int edge_index = 0;
   memset(&counter[0], 0, sizeof(int) * counter.size());
-  for (b_mesh.edges.begin(e); e != b_mesh.edges.end(); ++e, ++edge_index) {
-    const int v0 = vert_orig_index[b_mesh.edges[edge_index].vertices()[0]],
-              v1 = vert_orig_index[b_mesh.edges[edge_index].vertices()[1]];
+  for (int edge_index = 0; edge_index < num_edges; ++edge_index) {
+    const int v0 = vert_orig_index[medges[edge_index].v1],
+              v1 = vert_orig_index[medges[edge_index].v2];
     if (visited_edges.exists(v0, v1)) {
       continue;
     }
     visited_edges.insert(v0, v1);
-    float3 co0 = get_float3(b_mesh.vertices[v0].co()), co1 = get_float3(b_mesh.vertices[v1].co());
+    float3 co0 = mesh_vertex_co(mverts[v0]), co1 = mesh_vertex_co(mverts[v1]);
     float3 edge = normalize(co1 - co0);
     edge_accum[v0] += edge;
     edge_accum[v1] += -edge;
@@ -656,11 +713,10 @@ static void attr_create_pointiness(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh, b
   float *data = attr->data_float();
   memcpy(data, &raw_data[0], sizeof(float) * raw_data.size());
   memset(&counter[0], 0, sizeof(int) * counter.size());
-  edge_index = 0;
   visited_edges.clear();
-  for (b_mesh.edges.begin(e); e != b_mesh.edges.end(); ++e, ++edge_index) {
-    const int v0 = vert_orig_index[b_mesh.edges[edge_index].vertices()[0]],
-              v1 = vert_orig_index[b_mesh.edges[edge_index].vertices()[1]];
+  for (int edge_index = 0; edge_index < num_edges; ++edge_index) {
+    const int v0 = vert_orig_index[medges[edge_index].v1],
+              v1 = vert_orig_index[medges[edge_index].v2];
     if (visited_edges.exists(v0, v1)) {
       continue;
     }
@@ -706,25 +762,30 @@ static void attr_create_random_per_island(Scene *scene,
 
   DisjointSet vertices_sets(number_of_vertices);
 
-  BL::Mesh::edges_iterator e;
-  for (b_mesh.edges.begin(e); e != b_mesh.edges.end(); ++e) {
-    vertices_sets.join(e->vertices()[0], e->vertices()[1]);
+  const MEdge *medges = mesh_array<MEdge>(b_mesh.edges);
+  const int num_edges = b_mesh.edges.length();
+  for (int i = 0; i < num_edges; i++) {
+    vertices_sets.join(medges[i].v1, medges[i].v2);
   }
 
   AttributeSet &attributes = (subdivision) ? mesh->subd_attributes : mesh->attributes;
   Attribute *attribute = attributes.add(ATTR_STD_RANDOM_PER_ISLAND);
   float *data = attribute->data_float();
 
+  const MLoop *mloops = mesh_array<MLoop>(b_mesh.loops);
+
   if (!subdivision) {
-    BL::Mesh::loop_triangles_iterator t;
-    for (b_mesh.loop_triangles.begin(t); t != b_mesh.loop_triangles.end(); ++t) {
-      data[t->index()] = hash_uint_to_float(vertices_sets.find(t->vertices()[0]));
+    const MLoopTri *looptris = mesh_array<MLoopTri>(b_mesh.loop_triangles);
+    const int num_tris = b_mesh.loop_triangles.length();
+    for (int i = 0; i < num_tris; i++) {
+      data[i] = hash_uint_to_float(vertices_sets.find(mloops[looptris[i].tri[0]].v));
     }
   }
   else {
-    BL::Mesh::polygons_iterator p;
-    for (b_mesh.polygons.begin(p); p != b_mesh.polygons.end(); ++p) {
-      data[p->index()] = hash_uint_to_float(vertices_sets.find(p->vertices()[0]));
+    const MPoly *polys = mesh_array<MPoly>(b_mesh.polygons);
+    const int num_polys = b_mesh.polygons.length();
+    for (int i = 0; i < num_polys; i++) {
+      data[i] = hash_uint_to_float(vertices_sets.find(mloops[polys[i].loopstart].v));
     }
   }
 }
@@ -752,14 +813,17 @@ static void create_mesh(Scene *scene,
     return;
   }
 
+  const MVert *mverts = mesh_array<MVert>(b_mesh.vertices);
+  const MPoly *mpolys = mesh_array<MPoly>(b_mesh.polygons);
+  const MLoop *mloops = mesh_array<MLoop>(b_mesh.loops);
+
   if (!subdivision) {
     numtris = numfaces;
   }
   else {
-    BL::Mesh::polygons_iterator p;
-    for (b_mesh.polygons.begin(p); p != b_mesh.polygons.end(); ++p) {
-      numngons += (p->loop_total() == 4) ? 0 : 1;
-      numcorners += p->loop_total();
+    for (int i = 0; i < numfaces; i++) {
+      numngons += (mpolys[i].totloop == 4) ? 0 : 1;
+      numcorners += mpolys[i].totloop;
     }
   }
 
@@ -768,20 +832,27 @@ static void create_mesh(Scene *scene,
     mesh->reserve_subd_faces(numfaces, numngons, numcorners);
   }
 
-  mesh->reserve_mesh(numverts, numtris);
+  mesh->resize_mesh(numverts, numtris);
 
   /* create vertex coordinates and normals */
-  BL::Mesh::vertices_iterator v;
-  for (b_mesh.vertices.begin(v); v != b_mesh.vertices.end(); ++v)
-    mesh->add_vertex(get_float3(v->co()));
-
   AttributeSet &attributes = (subdivision) ? mesh->subd_attributes : mesh->attributes;
   Attribute *attr_N = attributes.add(ATTR_STD_VERTEX_NORMAL);
   float3 *N = attr_N->data_float3();
+  float3 *verts = mesh->get_verts().data();
+
+  mesh_parallel_for(numverts, [&](const size_t i) {
+    verts[i] = mesh_vertex_co(mverts[i]);
+    N[i] = mesh_vertex_normal(mverts[i]);
+  });
+  mesh->tag_verts_modified();
 
-  for (b_mesh.vertices.begin(v); v != b_mesh.vertices.end(); ++v, ++N)
-    *N = get_float3(v->normal());
-  N = attr_N->data_float3();
+  if (subdivision) {
+    float2 *vert_patch_uv = mesh->get_vert_patch_uv().data();
+    for (int i = 0; i < numverts; i++) {
+      vert_patch_uv[i] = make_float2(0.0f, 0.0f);
+    }
+    mesh->tag_vert_patch_uv_modified();
+  }
 
   /* create generated coordinates from undeformed coordinates */
   const bool need_default_tangent = (subdivision == false) && (b_mesh.uv_layers.length() == 0) &&
@@ -794,52 +865,80 @@ static void create_mesh(Scene *scene,
     mesh_texture_space(b_mesh, loc, size);
 
     float3 *generated = attr->data_float3();
-    size_t i = 0;
 
-    for (b_mesh.vertices.begin(v); v != b_mesh.vertices.end(); ++v) {
-      generated[i++] = get_float3(v->undeformed_co()) * size - loc;
+    if (mesh_custom_data_layer(b_mesh, false, CD_ORCO) == NULL) {
+      /* Undeformed coordinates are the vertex coordinates. */
+      mesh_parallel_for(numverts, [&](const size_t i) {
+        generated[i] = mesh_vertex_co(mverts[i]) * size - loc;
+      });
+    }
+    else {
+      BL::Mesh::vertices_iterator v;
+      size_t i = 0;
+
+      for (b_mesh.vertices.begin(v); v != b_mesh.vertices.end(); ++v) {
+        generated[i++] = get_float3(v->undeformed_co()) * size - loc;
+      }
     }
   }
 
   /* create faces */
   if (!subdivision) {
-    BL::Mesh::loop_triangles_iterator t;
-
-    for (b_mesh.loop_triangles.begin(t); t != b_mesh.loop_triangles.end(); ++t) {
-      BL::MeshPolygon p = b_mesh.polygons[t->polygon_index()];
-      int3 vi = get_int3(t->vertices());
-
-      int shader = clamp(p.material_index(), 0, used_shaders.size() - 1);
-      bool smooth = p.use_smooth() || use_loop_normals;
-
-      if (use_loop_normals) {
-        BL::Array<float, 9> loop_normals = t->split_normals();
-        for (int i = 0; i < 3; i++) {
-          N[vi[i]] = make_float3(
-              loop_normals[i * 3], loop_normals[i * 3 + 1], loop_normals[i * 3 + 2]);
+    const MLoopTri *looptris = mesh_array<MLoopTri>(b_mesh.loop_triangles);
+    const int max_shader = used_shaders.size() - 1;
+    int *triangles = mesh->get_triangles().data();
+    int *shader = mesh->get_shader().data();
+    bool *smooth = mesh->get_smooth().data();
+
+    /* Create triangles.
+     *
+     * NOTE: Autosmooth is already taken care about.
+     */
+    mesh_parallel_for(numtris, [&](const size_t i) {
+      const MLoopTri &lt = looptris[i];
+      const MPoly &p = mpolys[lt.poly];
+
+      triangles[i * 3 + 0] = mloops[lt.tri[0]].v;
+      triangles[i * 3 + 1] = mloops[lt.tri[1]].v;
+      triangles[i * 3 + 2] = mloops[lt.tri[2]].v;
+      shader[i] = clamp((int)p.mat_nr, 0, max_shader);
+      smooth[i] = (p.flag & ME_SMOOTH) || use_loop_normals;
+    });
+
+    mesh->tag_triangles_modified();
+    mesh->tag_shader_modified();
+    mesh->tag_smooth_modified();
+
+    if (use_loop_normals) {
+      /* Vertices shared by triangles get the split normal of the last one, so
+       * this is done in order. */
+      const float(*loop_normals)[3] = static_cast<const float(*)[3]>(
+          mesh_custom_data_layer(b_mesh, true, CD_NORMAL));
+
+      for (int i = 0; i < numtris; i++) {
+        for (int j = 0; j < 3; j++) {
+          const int loop = looptris[i].tri[j];
+          N[mloops[loop].v] = (loop_normals) ? make_float3(loop_normals[loop][0],
+                                                           loop_normals[loop][1],
+                                                           loop_normals[loop][2]) :
+                                               make_float3(0.0f, 0.0f, 0.0f);
         }
       }
-
-      /* Create triangles.
-       *
-       * NOTE: Autosmooth is already taken care about.
-       */
-      mesh->add_triangle(vi[0], vi[1], vi[2], shader, smooth);
     }
   }
   else {
-    BL::Mesh::polygons_iterator p;
     vector<int> vi;
 
-    for (b_mesh.polygons.begin(p); p != b_mesh.polygons.end(); ++p) {
-      int n = p->loop_total();
-      int shader = clamp(p->material_index(), 0, used_shaders.size() - 1);
-      bool smooth = p->use_smooth() || use_loop_normals;
+    for (int p = 0; p < numfaces; p++) {
+      const MPoly &mpoly = mpolys[p];
+      int n = mpoly.totloop;
+      int shader = clamp((int)mpoly.mat_nr, 0, used_shaders.size() - 1);
+      bool smooth = (mpoly.flag & ME_SMOOTH) || use_loop_normals;
 
       vi.resize(n);
       for (int i = 0; i < n; i++) {
         /* NOTE: Autosmooth is already taken care about. */
-        vi[i] = b_mesh.loops[p->loop_start() + i].vertex_index();
+        vi[i] = mloops[mpoly.loopstart + i].v;
       }
 
       /* create subd faces */
@@ -890,20 +989,21 @@ static void create_subd_mesh(Scene *scene,
   create_mesh(scene, mesh, b_mesh, used_shaders, true, subdivide_uvs);
 
   /* export creases */
+  const MEdge *medges = mesh_array<MEdge>(b_mesh.edges);
+  const int num_edges = b_mesh.edges.length();
   size_t num_creases = 0;
-  BL::Mesh::edges_iterator e;
 
-  for (b_mesh.edges.begin(e); e != b_mesh.edges.end(); ++e) {
-    if (e->crease() != 0.0f) {
+  for (int i = 0; i < num_edges; i++) {
+    if (medges[i].crease != 0) {
       num_creases++;
     }
   }
 
   mesh->reserve_subd_creases(num_creases);
 
-  for (b_mesh.edges.begin(e); e != b_mesh.edges.end(); ++e) {
-    if (e->crease() != 0.0f) {
-      mesh->add_crease(e->vertices()[0], e->vertices()[1], e->crease());
+  for (int i = 0; i < num_edges; i++) {
+    if (medges[i].crease != 0) {
+      mesh->add_crease(medges[i].v1, medges[i].v2, medges[i].crease / 255.0f);
     }
   }
 
@@ -1148,13 +1248,12 @@ void BlenderSync::sync_mesh_motion(BL::Depsgraph b_depsgraph,
     /* NOTE: We don't copy more that existing amount of vertices to prevent
      * possible memory corruption.
      */
-    BL::Mesh::vertices_iterator v;
-    int i = 0;
-    for (b_mesh.vertices.begin(v); v != b_mesh.vertices.end() && i < numverts; ++v, ++i) {
-      mP[i] = get_float3(v->co());
+    const MVert *mverts = mesh_array<MVert>(b_mesh.vertices);
+    mesh_parallel_for(min((size_t)b_mesh.vertices.length(), numverts), [&](const size_t i) {
+      mP[i] = mesh_vertex_co(mverts[i]);
       if (mN)
-        mN[i] = get_float3(v->normal());
-    }
+        mN[i] = mesh_vertex_normal(mverts[i]);
+    });
     if (new_attribute) {
       /* In case of new attribute, we verify if there really was any motion. */
       if (b_mesh.vertices.length() != numverts ||
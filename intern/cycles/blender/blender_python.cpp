@@ -804,11 +804,12 @@ static PyObject *denoise_func(PyObject * /*self*/, PyObject *args, PyObject *key
 
 static PyObject *merge_func(PyObject * /*self*/, PyObject *args, PyObject *keywords)
 {
-  static const char *keyword_list[] = {"input", "output", NULL};
+  static const char *keyword_list[] = {"input", "output", "band_height", NULL};
   PyObject *pyinput, *pyoutput = NULL;
+  int band_height = -1;
 
   if (!PyArg_ParseTupleAndKeywords(
-          args, keywords, "OO", (char **)keyword_list, &pyinput, &pyoutput)) {
+          args, keywords, "OO|i", (char **)keyword_list, &pyinput, &pyoutput, &band_height)) {
     return NULL;
   }
 
@@ -830,6 +831,10 @@ static PyObject *merge_func(PyObject * /*self*/, PyObject *args, PyObject *keywo
   merger.input = input;
   merger.output = output;
 
+  if (band_height >= 0) {
+    merger.band_height = band_height;
+  }
+
   if (!merger.run()) {
     PyErr_SetString(PyExc_ValueError, merger.error.c_str());
     return NULL;
@@ -958,6 +963,18 @@ static PyObject *enable_print_stats_func(PyObject * /*self*/, PyObject * /*args*
   Py_RETURN_NONE;
 }
 
+static PyObject *enable_stats_json_func(PyObject * /*self*/, PyObject * /*args*/)
+{
+  BlenderSession::write_render_stats_json = true;
+  Py_RETURN_NONE;
+}
+
+static PyObject *enable_checkpoints_func(PyObject * /*self*/, PyObject * /*args*/)
+{
+  BlenderSession::use_render_checkpoints = true;
+  Py_RETURN_NONE;
+}
+
 static PyObject *get_device_types_func(PyObject * /*self*/, PyObject * /*args*/)
 {
   vector<DeviceType> device_types = Device::available_types();
@@ -1043,6 +1060,8 @@ static PyMethodDef methods[] = {
 
     /* Statistics. */
     {"enable_print_stats", enable_print_stats_func, METH_NOARGS, ""},
+    {"enable_stats_json", enable_stats_json_func, METH_NOARGS, ""},
+    {"enable_checkpoints", enable_checkpoints_func, METH_NOARGS, ""},
 
     /* Resumable render */
     {"set_resumable_chunk", set_resumable_chunk_func, METH_VARARGS, ""},
@@ -38,7 +38,9 @@
 #include "util/util_hash.h"
 #include "util/util_logging.h"
 #include "util/util_murmurhash.h"
+#include "util/util_path.h"
 #include "util/util_progress.h"
+#include "util/util_set.h"
 #include "util/util_time.h"
 
 #include "blender/blender_session.h"
@@ -54,6 +56,8 @@ int BlenderSession::current_resumable_chunk = 0;
 int BlenderSession::start_resumable_chunk = 0;
 int BlenderSession::end_resumable_chunk = 0;
 bool BlenderSession::print_render_stats = false;
+bool BlenderSession::write_render_stats_json = false;
+bool BlenderSession::use_render_checkpoints = false;
 
 BlenderSession::BlenderSession(BL::RenderEngine &b_engine,
                                BL::Preferences &b_userpref,
@@ -171,6 +175,10 @@ void BlenderSession::create_session()
 
 void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsgraph)
 {
+  /* With persistent data the render engine keeps its depsgraph between frames, only when it is
+   * the same can the synced data be updated from its recalc flags. */
+  const bool is_same_depsgraph = (this->b_depsgraph.ptr.data == b_depsgraph.ptr.data);
+
   /* Update data, scene and depsgraph pointers. These can change after undo. */
   this->b_data = b_data;
   this->b_depsgraph = b_depsgraph;
@@ -234,12 +242,19 @@ void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsg
    */
   session->stats.mem_peak = session->stats.mem_used;
 
-  /* There is no single depsgraph to use for the entire render.
-   * See note on create_session().
-   */
-  /* sync object should be re-created */
-  delete sync;
-  sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
+  if (is_same_depsgraph) {
+    /* Sync recalculations to only update what changed since the previous frame, keeping
+     * geometry, BVH and images of unchanged data. */
+    sync->sync_recalc(b_depsgraph, b_v3d);
+  }
+  else {
+    /* There is no single depsgraph to use for the entire render.
+     * See note on create_session().
+     */
+    /* sync object should be re-created */
+    delete sync;
+    sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
+  }
 
   BL::SpaceView3D b_null_space_view3d(PointerRNA_NULL);
   BL::RegionView3D b_null_region_view3d(PointerRNA_NULL);
@@ -471,6 +486,29 @@ void BlenderSession::stamp_view_layer_metadata(Scene *scene, const string &view_
                             time_human_readable_from_seconds(total_time - render_time).c_str());
 }
 
+/* Output path of the current frame with the frame number substituted the same
+ * way as for rendered images, suffixed with the view layer name. */
+string BlenderSession::render_frame_filepath(const string &suffix)
+{
+  string filepath = blender_absolute_path(b_data, b_scene, b_render.filepath());
+  const int frame = b_scene.frame_current();
+
+  const size_t hash_end = filepath.find_last_of('#');
+  if (hash_end == string::npos || hash_end < filepath.find_last_of("/\\") + 1) {
+    filepath += string_printf("%04d", frame);
+  }
+  else {
+    size_t hash_start = hash_end;
+    while (hash_start > 0 && filepath[hash_start - 1] == '#') {
+      hash_start--;
+    }
+    const int num_digits = (int)(hash_end - hash_start + 1);
+    filepath.replace(hash_start, num_digits, string_printf("%0*d", num_digits, frame));
+  }
+
+  return filepath + "_" + b_rlay_name + suffix;
+}
+
 void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
 {
   b_depsgraph = b_depsgraph_;
@@ -521,6 +559,10 @@ void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
     num_views++;
   }
 
+  const bool write_stats_json = !b_engine.is_preview() && background &&
+                                write_render_stats_json;
+  string stats_json = "";
+
   int view_index = 0;
   for (b_rr.views.begin(b_view_iter); b_view_iter != b_rr.views.end();
        ++b_view_iter, ++view_index) {
@@ -568,11 +610,18 @@ void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
     /* Update tile manager if we're doing resumable render. */
     update_resumable_tile_manager(effective_layer_samples);
 
+    /* Checkpoints are per view layer and view, so they can't be confused when restarting. */
+    if (!b_engine.is_preview() && background && use_render_checkpoints) {
+      const string suffix = (num_views > 1) ? "_" + b_rview_name : "";
+      session->params.checkpoint_path = render_frame_filepath(suffix + ".checkpoint");
+      path_create_directories(session->params.checkpoint_path);
+    }
+
     /* Update session itself. */
     session->reset(buffer_params, effective_layer_samples);
 
     /* render */
-    if (!b_engine.is_preview() && background && print_render_stats) {
+    if ((!b_engine.is_preview() && background && print_render_stats) || write_stats_json) {
       scene->enable_update_stats();
     }
 
@@ -585,10 +634,35 @@ void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
       printf("Render statistics:\n%s\n", stats.full_report().c_str());
     }
 
+    if (write_stats_json) {
+      RenderStats stats;
+      session->collect_statistics(&stats);
+      stats_json += string_printf("%s{\"name\": %s, \"stats\": %s",
+                                  stats_json.empty() ? "" : ", ",
+                                  string_json_quote(b_rview_name).c_str(),
+                                  stats.json_report().c_str());
+      if (scene->update_stats) {
+        stats_json += ", \"update\": " + scene->update_stats->json_report();
+      }
+      stats_json += "}";
+    }
+
     if (session->progress.get_cancel())
       break;
   }
 
+  if (write_stats_json && !stats_json.empty()) {
+    const string filepath = render_frame_filepath(".json");
+    string text = string_printf("{\"frame\": %d, \"view_layer\": %s, \"views\": [%s]}\n",
+                                b_scene.frame_current(),
+                                string_json_quote(b_rlay_name).c_str(),
+                                stats_json.c_str());
+    path_create_directories(filepath);
+    if (!path_write_text(filepath, text)) {
+      fprintf(stderr, "Cycles: failed to write render statistics to %s\n", filepath.c_str());
+    }
+  }
+
   /* add metadata */
   stamp_view_layer_metadata(scene, b_rlay_name);
 
@@ -655,8 +729,19 @@ void BlenderSession::bake(BL::Depsgraph &b_depsgraph_,
   ShaderEvalType shader_type = get_shader_type(pass_type);
   int bake_pass_filter = bake_pass_filter_get(pass_filter);
 
+  /* Objects baked together in a single pass, or only the given object. */
+  vector<string> object_names;
+  BL::RenderEngine::bake_objects_iterator b_bake_object;
+  for (b_engine.bake_objects.begin(b_bake_object); b_bake_object != b_engine.bake_objects.end();
+       ++b_bake_object) {
+    object_names.push_back(b_bake_object->name());
+  }
+  if (object_names.empty()) {
+    object_names.push_back(b_object.name());
+  }
+
   /* Initialize bake manager, before we load the baking kernels. */
-  scene->bake_manager->set(scene, b_object.name(), shader_type, bake_pass_filter);
+  scene->bake_manager->set(scene, object_names, shader_type, bake_pass_filter);
 
   /* Passes are identified by name, so in order to return the combined pass we need to set the
    * name. */
@@ -675,14 +760,16 @@ void BlenderSession::bake(BL::Depsgraph &b_depsgraph_,
   }
 
   /* Object might have been disabled for rendering or excluded in some
-   * other way, in that case Blender will report a warning afterwards. */
-  bool object_found = false;
+   * other way, in that case Blender will report a warning afterwards.
+   * When baking multiple objects, all of them must be found. */
+  set<string> objects_missing(object_names.begin(), object_names.end());
   foreach (Object *ob, scene->objects) {
-    if (ob->name == b_object.name()) {
-      object_found = true;
+    objects_missing.erase(ob->name.string());
+    if (objects_missing.empty()) {
       break;
     }
   }
+  const bool object_found = objects_missing.empty();
 
   if (object_found && !session->progress.get_cancel()) {
     /* Get session and buffer parameters. */
@@ -148,9 +148,17 @@ class BlenderSession {
 
   static bool print_render_stats;
 
+  /* Write statistics of every rendered frame to a JSON file next to it. */
+  static bool write_render_stats_json;
+
+  /* Save render checkpoints next to every rendered frame, to resume interrupted renders. */
+  static bool use_render_checkpoints;
+
  protected:
   void stamp_view_layer_metadata(Scene *scene, const string &view_layer_name);
 
+  string render_frame_filepath(const string &suffix);
+
   void do_write_update_render_result(BL::RenderLayer &b_rlay,
                                      RenderTile &rtile,
                                      bool do_update_only);
@@ -316,6 +316,7 @@ void BlenderSync::sync_integrator()
   integrator->set_sample_all_lights_direct(get_boolean(cscene, "sample_all_lights_direct"));
   integrator->set_sample_all_lights_indirect(get_boolean(cscene, "sample_all_lights_indirect"));
   integrator->set_light_sampling_threshold(get_float(cscene, "light_sampling_threshold"));
+  integrator->set_use_light_tree(get_boolean(cscene, "use_light_tree"));
 
   SamplingPattern sampling_pattern = (SamplingPattern)get_enum(
       cscene, "sampling_pattern", SAMPLING_NUM_PATTERNS, SAMPLING_PATTERN_SOBOL);
@@ -536,6 +537,7 @@ PassType BlenderSync::get_pass_type(BL::RenderPass &b_pass)
   MAP_PASS("Debug Render Time", PASS_RENDER_TIME);
   MAP_PASS("AdaptiveAuxBuffer", PASS_ADAPTIVE_AUX_BUFFER);
   MAP_PASS("Debug Sample Count", PASS_SAMPLE_COUNT);
+  MAP_PASS("Debug Adaptive Error", PASS_ADAPTIVE_ERROR);
   if (string_startswith(name, cryptomatte_prefix)) {
     return PASS_CRYPTOMATTE;
   }
@@ -656,6 +658,12 @@ vector<Pass> BlenderSync::sync_render_passes(BL::RenderLayer &b_rlay,
     b_engine.add_pass("Debug Sample Count", 1, "X", b_view_layer.name().c_str());
     Pass::add(PASS_SAMPLE_COUNT, passes, "Debug Sample Count");
   }
+  if (get_boolean(crl, "pass_debug_adaptive_error")) {
+    b_engine.add_pass("Debug Adaptive Error", 1, "X", b_view_layer.name().c_str());
+    Pass::add(PASS_ADAPTIVE_ERROR, passes, "Debug Adaptive Error");
+    /* Per tile statistics need the sample count, add it even without its own debug pass. */
+    Pass::add(PASS_SAMPLE_COUNT, passes);
+  }
   if (get_boolean(crl, "use_pass_volume_direct")) {
     b_engine.add_pass("VolumeDir", 3, "RGB", b_view_layer.name().c_str());
     Pass::add(PASS_VOLUME_DIRECT, passes, "VolumeDir");
@@ -741,11 +749,15 @@ void BlenderSync::free_data_after_sync(BL::Depsgraph &b_depsgraph)
    * footprint during synchronization process.
    */
   const bool is_interface_locked = b_engine.render() && b_engine.render().use_lock_interface();
+  const bool is_persistent_data = b_engine.render() && b_engine.render().use_persistent_data();
   const bool can_free_caches = (BlenderSession::headless || is_interface_locked) &&
                                /* Baking re-uses the depsgraph multiple times, clearing crashes
                                 * reading un-evaluated mesh data which isn't aligned with the
                                 * geometry we're baking, see T71012. */
-                               !scene->bake_manager->get_baking();
+                               !scene->bake_manager->get_baking() &&
+                               /* Persistent data keeps the depsgraph and its evaluated data
+                                * for the next frame. */
+                               !is_persistent_data;
   if (!can_free_caches) {
     return;
   }
@@ -772,7 +784,11 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
   else if (shadingsystem == 1)
     params.shadingsystem = SHADINGSYSTEM_OSL;
 
-  if (background || DebugFlags().viewport_static_bvh)
+  /* Dynamic BVH for final renders only helps when the scene is kept between frames. */
+  const bool use_dynamic_bvh = r.use_persistent_data() &&
+                               RNA_boolean_get(&cscene, "use_dynamic_bvh");
+
+  if ((background && !use_dynamic_bvh) || DebugFlags().viewport_static_bvh)
     params.bvh_type = SceneParams::BVH_STATIC;
   else
     params.bvh_type = SceneParams::BVH_DYNAMIC;
@@ -785,6 +801,7 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
   params.hair_subdivisions = get_int(csscene, "subdivisions");
   params.hair_shape = (CurveShapeType)get_enum(
       csscene, "shape", CURVE_NUM_SHAPE_TYPES, CURVE_THICK);
+  params.hair_compression = get_boolean(csscene, "use_compression");
 
   if (background && params.shadingsystem != SHADINGSYSTEM_OSL)
     params.persistent_data = r.use_persistent_data();
@@ -805,6 +822,13 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
     params.texture_limit = 0;
   }
 
+  params.use_texture_cache = RNA_boolean_get(&cscene, "use_texture_cache");
+  params.texture_cache_size = RNA_int_get(&cscene, "texture_cache_size");
+
+  params.use_out_of_core_geometry = RNA_boolean_get(&cscene, "use_out_of_core_geometry");
+  params.out_of_core_geometry_threshold = RNA_int_get(&cscene, "out_of_core_geometry_threshold");
+  params.out_of_core_geometry_path = get_string(cscene, "out_of_core_geometry_path");
+
   params.bvh_layout = DebugFlags().cpu.bvh_layout;
 
   params.background = background;
@@ -963,7 +987,8 @@ SessionParams BlenderSync::get_session_params(BL::RenderEngine &b_engine,
   }
 
   params.use_profiling = params.device.has_profiling && !b_engine.is_preview() && background &&
-                         BlenderSession::print_render_stats;
+                         (BlenderSession::print_render_stats ||
+                          BlenderSession::write_render_stats_json);
 
   params.adaptive_sampling = RNA_boolean_get(&cscene, "use_adaptive_sampling");
 
@@ -29,7 +29,9 @@
 
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
+#include "util/util_map.h"
 #include "util/util_progress.h"
+#include "util/util_set.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -92,7 +94,7 @@ int BVHStackEntry::encodeIdx() const
 BVH::BVH(const BVHParams &params_,
          const vector<Geometry *> &geometry_,
          const vector<Object *> &objects_)
-    : params(params_), geometry(geometry_), objects(objects_)
+    : params(params_), geometry(geometry_), objects(objects_), instances_in_place(false)
 {
 }
 
@@ -179,6 +181,13 @@ void BVH::build(Progress &progress, Stats *)
   root->deleteSubtree();
 }
 
+void BVH::use_packed_instances(const PackedBVHInstances &packed_instances)
+{
+  assert(params.top_level);
+  instances = packed_instances;
+  instances_in_place = true;
+}
+
 /* Refitting */
 
 void BVH::refit(Progress &progress)
@@ -214,7 +223,9 @@ void BVH::refit_primitives(int start, int end, BoundBox &bbox, uint &visibility)
         Hair::Curve curve = hair->get_curve(pidx - prim_offset);
         int k = PRIMITIVE_UNPACK_SEGMENT(pack.prim_type[prim]);
 
-        curve.bounds_grow(k, &hair->get_curve_keys()[0], &hair->get_curve_radius()[0], bbox);
+        BoundBox curve_bounds = BoundBox::empty;
+        curve.bounds_grow(
+            k, &hair->get_curve_keys()[0], &hair->get_curve_radius()[0], curve_bounds);
 
         /* Motion curves. */
         if (hair->get_use_motion_blur()) {
@@ -226,9 +237,13 @@ void BVH::refit_primitives(int start, int end, BoundBox &bbox, uint &visibility)
             float3 *key_steps = attr->data_float3();
 
             for (size_t i = 0; i < steps; i++)
-              curve.bounds_grow(k, key_steps + i * hair_size, &hair->get_curve_radius()[0], bbox);
+              curve.bounds_grow(
+                  k, key_steps + i * hair_size, &hair->get_curve_radius()[0], curve_bounds);
           }
         }
+
+        hair->pad_curve_bounds(curve_bounds);
+        bbox.grow(curve_bounds);
       }
       else {
         /* Triangles. */
@@ -322,6 +337,16 @@ void BVH::pack_primitives()
 
 /* Pack Instances */
 
+/* Move the top level data to the end of the array, after the merged instances. */
+template<typename T> static void pack_move_after_instances(array<T> &data, size_t offset)
+{
+  const size_t size = data.size();
+  data.resize(offset + size);
+  if (size && offset) {
+    memmove(data.data() + offset, data.data(), sizeof(T) * size);
+  }
+}
+
 void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
 {
   /* Adjust primitive index to point to the triangle in the global array, for
@@ -333,190 +358,193 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
     }
   }
 
-  /* track offsets of instanced BVH data in global array */
-  size_t prim_offset = pack.prim_index.size();
-  size_t nodes_offset = nodes_size;
-  size_t nodes_leaf_offset = leaf_nodes_size;
+  /* Gather geometry with its own BVH, each one is merged only once even if it is used by
+   * multiple objects. */
+  if (!instances_in_place) {
+    instances.clear();
 
-  /* clear array that gives the node indexes for instanced objects */
-  pack.object_node.clear();
+    set<Geometry *> merged_geometry;
+
+    foreach (Object *ob, objects) {
+      Geometry *geom = ob->get_geometry();
 
-  /* reserve */
-  size_t prim_index_size = pack.prim_index.size();
-  size_t prim_tri_verts_size = pack.prim_tri_verts.size();
+      /* We assume that if mesh doesn't need own BVH it was already included
+       * into a top-level BVH and no packing here is needed.
+       */
+      if (!geom->need_build_bvh(params.bvh_layout) || !merged_geometry.insert(geom).second) {
+        continue;
+      }
 
-  size_t pack_prim_index_offset = prim_index_size;
-  size_t pack_prim_tri_verts_offset = prim_tri_verts_size;
-  size_t pack_nodes_offset = nodes_size;
-  size_t pack_leaf_nodes_offset = leaf_nodes_size;
-  size_t object_offset = 0;
+      BVH *bvh = geom->bvh;
 
-  foreach (Geometry *geom, geometry) {
-    BVH *bvh = geom->bvh;
+      instances.geometry.push_back(geom);
+      instances.prim_index_size += bvh->pack.prim_index.size();
+      instances.prim_tri_verts_size += bvh->pack.prim_tri_verts.size();
+      instances.nodes_size += bvh->pack.nodes.size();
+      instances.leaf_nodes_size += bvh->pack.leaf_nodes.size();
+    }
+  }
 
-    if (geom->need_build_bvh(params.bvh_layout)) {
-      prim_index_size += bvh->pack.prim_index.size();
-      prim_tri_verts_size += bvh->pack.prim_tri_verts.size();
-      nodes_size += bvh->pack.nodes.size();
-      leaf_nodes_size += bvh->pack.leaf_nodes.size();
+  /* Top level primitives go after the instances, adjust their triangle index for that. */
+  for (size_t i = 0; i < pack.prim_tri_index.size(); i++) {
+    if (pack.prim_tri_index[i] != (uint)-1) {
+      pack.prim_tri_index[i] += instances.prim_tri_verts_size;
     }
   }
 
-  pack.prim_index.resize(prim_index_size);
-  pack.prim_type.resize(prim_index_size);
-  pack.prim_object.resize(prim_index_size);
-  pack.prim_visibility.resize(prim_index_size);
-  pack.prim_tri_verts.resize(prim_tri_verts_size);
-  pack.prim_tri_index.resize(prim_index_size);
-  pack.nodes.resize(nodes_size);
-  pack.leaf_nodes.resize(leaf_nodes_size);
-  pack.object_node.resize(objects.size());
+  const size_t prim_offset = instances.prim_index_size;
+  pack_move_after_instances(pack.prim_index, prim_offset);
+  pack_move_after_instances(pack.prim_type, prim_offset);
+  pack_move_after_instances(pack.prim_object, prim_offset);
+  pack_move_after_instances(pack.prim_visibility, prim_offset);
+  pack_move_after_instances(pack.prim_tri_index, prim_offset);
+  pack_move_after_instances(pack.prim_tri_verts, instances.prim_tri_verts_size);
 
   if (params.num_motion_curve_steps > 0 || params.num_motion_triangle_steps > 0) {
-    pack.prim_time.resize(prim_index_size);
+    pack_move_after_instances(pack.prim_time, prim_offset);
   }
 
-  int *pack_prim_index = (pack.prim_index.size()) ? &pack.prim_index[0] : NULL;
-  int *pack_prim_type = (pack.prim_type.size()) ? &pack.prim_type[0] : NULL;
-  int *pack_prim_object = (pack.prim_object.size()) ? &pack.prim_object[0] : NULL;
-  uint *pack_prim_visibility = (pack.prim_visibility.size()) ? &pack.prim_visibility[0] : NULL;
-  float4 *pack_prim_tri_verts = (pack.prim_tri_verts.size()) ? &pack.prim_tri_verts[0] : NULL;
-  uint *pack_prim_tri_index = (pack.prim_tri_index.size()) ? &pack.prim_tri_index[0] : NULL;
-  int4 *pack_nodes = (pack.nodes.size()) ? &pack.nodes[0] : NULL;
-  int4 *pack_leaf_nodes = (pack.leaf_nodes.size()) ? &pack.leaf_nodes[0] : NULL;
-  float2 *pack_prim_time = (pack.prim_time.size()) ? &pack.prim_time[0] : NULL;
-
-  map<Geometry *, int> geometry_map;
-
-  /* merge */
-  foreach (Object *ob, objects) {
-    Geometry *geom = ob->get_geometry();
-
-    /* We assume that if mesh doesn't need own BVH it was already included
-     * into a top-level BVH and no packing here is needed.
-     */
-    if (!geom->need_build_bvh(params.bvh_layout)) {
-      pack.object_node[object_offset++] = 0;
-      continue;
-    }
-
-    /* if mesh already added once, don't add it again, but used set
-     * node offset for this object */
-    map<Geometry *, int>::iterator it = geometry_map.find(geom);
-
-    if (geometry_map.find(geom) != geometry_map.end()) {
-      int noffset = it->second;
-      pack.object_node[object_offset++] = noffset;
-      continue;
-    }
-
-    BVH *bvh = geom->bvh;
-
-    int noffset = nodes_offset;
-    int noffset_leaf = nodes_leaf_offset;
-    int geom_prim_offset = geom->prim_offset;
-
-    /* fill in node indexes for instances */
-    if (bvh->pack.root_index == -1)
-      pack.object_node[object_offset++] = -noffset_leaf - 1;
-    else
-      pack.object_node[object_offset++] = noffset;
-
-    geometry_map[geom] = pack.object_node[object_offset - 1];
-
-    /* merge primitive, object and triangle indexes */
-    if (bvh->pack.prim_index.size()) {
-      size_t bvh_prim_index_size = bvh->pack.prim_index.size();
-      int *bvh_prim_index = &bvh->pack.prim_index[0];
-      int *bvh_prim_type = &bvh->pack.prim_type[0];
-      uint *bvh_prim_visibility = &bvh->pack.prim_visibility[0];
-      uint *bvh_prim_tri_index = &bvh->pack.prim_tri_index[0];
-      float2 *bvh_prim_time = bvh->pack.prim_time.size() ? &bvh->pack.prim_time[0] : NULL;
-
-      for (size_t i = 0; i < bvh_prim_index_size; i++) {
-        if (bvh->pack.prim_type[i] & PRIMITIVE_ALL_CURVE) {
-          pack_prim_index[pack_prim_index_offset] = bvh_prim_index[i] + geom_prim_offset;
-          pack_prim_tri_index[pack_prim_index_offset] = -1;
-        }
-        else {
-          pack_prim_index[pack_prim_index_offset] = bvh_prim_index[i] + geom_prim_offset;
-          pack_prim_tri_index[pack_prim_index_offset] = bvh_prim_tri_index[i] +
-                                                        pack_prim_tri_verts_offset;
-        }
+  pack.nodes.resize(instances.nodes_size + nodes_size);
+  pack.leaf_nodes.resize(instances.leaf_nodes_size + leaf_nodes_size);
+
+  /* Merge instance BVHs, unless they are still in place from a previous build. */
+  if (!instances_in_place) {
+    int *pack_prim_index = (pack.prim_index.size()) ? &pack.prim_index[0] : NULL;
+    int *pack_prim_type = (pack.prim_type.size()) ? &pack.prim_type[0] : NULL;
+    int *pack_prim_object = (pack.prim_object.size()) ? &pack.prim_object[0] : NULL;
+    uint *pack_prim_visibility = (pack.prim_visibility.size()) ? &pack.prim_visibility[0] :
+                                                                 NULL;
+    float4 *pack_prim_tri_verts = (pack.prim_tri_verts.size()) ? &pack.prim_tri_verts[0] :
+                                                                  NULL;
+    uint *pack_prim_tri_index = (pack.prim_tri_index.size()) ? &pack.prim_tri_index[0] : NULL;
+    int4 *pack_nodes = (pack.nodes.size()) ? &pack.nodes[0] : NULL;
+    int4 *pack_leaf_nodes = (pack.leaf_nodes.size()) ? &pack.leaf_nodes[0] : NULL;
+    float2 *pack_prim_time = (pack.prim_time.size()) ? &pack.prim_time[0] : NULL;
+
+    /* track offsets of instanced BVH data in global array */
+    size_t pack_prim_index_offset = 0;
+    size_t pack_prim_tri_verts_offset = 0;
+    size_t pack_nodes_offset = 0;
+    size_t pack_leaf_nodes_offset = 0;
+
+    foreach (Geometry *geom, instances.geometry) {
+      BVH *bvh = geom->bvh;
+
+      int noffset = pack_nodes_offset;
+      int noffset_leaf = pack_leaf_nodes_offset;
+      int geom_prim_offset = geom->prim_offset;
+      int instance_prim_offset = pack_prim_index_offset;
+
+      /* fill in node indexes for instances */
+      if (bvh->pack.root_index == -1)
+        instances.geometry_node.push_back(-noffset_leaf - 1);
+      else
+        instances.geometry_node.push_back(noffset);
+
+      /* merge primitive, object and triangle indexes */
+      if (bvh->pack.prim_index.size()) {
+        size_t bvh_prim_index_size = bvh->pack.prim_index.size();
+        int *bvh_prim_index = &bvh->pack.prim_index[0];
+        int *bvh_prim_type = &bvh->pack.prim_type[0];
+        uint *bvh_prim_visibility = &bvh->pack.prim_visibility[0];
+        uint *bvh_prim_tri_index = &bvh->pack.prim_tri_index[0];
+        float2 *bvh_prim_time = bvh->pack.prim_time.size() ? &bvh->pack.prim_time[0] : NULL;
+
+        for (size_t i = 0; i < bvh_prim_index_size; i++) {
+          if (bvh->pack.prim_type[i] & PRIMITIVE_ALL_CURVE) {
+            pack_prim_index[pack_prim_index_offset] = bvh_prim_index[i] + geom_prim_offset;
+            pack_prim_tri_index[pack_prim_index_offset] = -1;
+          }
+          else {
+            pack_prim_index[pack_prim_index_offset] = bvh_prim_index[i] + geom_prim_offset;
+            pack_prim_tri_index[pack_prim_index_offset] = bvh_prim_tri_index[i] +
+                                                          pack_prim_tri_verts_offset;
+          }
 
-        pack_prim_type[pack_prim_index_offset] = bvh_prim_type[i];
-        pack_prim_visibility[pack_prim_index_offset] = bvh_prim_visibility[i];
-        pack_prim_object[pack_prim_index_offset] = 0;  // unused for instances
-        if (bvh_prim_time != NULL) {
-          pack_prim_time[pack_prim_index_offset] = bvh_prim_time[i];
+          pack_prim_type[pack_prim_index_offset] = bvh_prim_type[i];
+          pack_prim_visibility[pack_prim_index_offset] = bvh_prim_visibility[i];
+          pack_prim_object[pack_prim_index_offset] = 0;  // unused for instances
+          if (bvh_prim_time != NULL) {
+            pack_prim_time[pack_prim_index_offset] = bvh_prim_time[i];
+          }
+          pack_prim_index_offset++;
         }
-        pack_prim_index_offset++;
       }
-    }
 
-    /* Merge triangle vertices data. */
-    if (bvh->pack.prim_tri_verts.size()) {
-      const size_t prim_tri_size = bvh->pack.prim_tri_verts.size();
-      memcpy(pack_prim_tri_verts + pack_prim_tri_verts_offset,
-             &bvh->pack.prim_tri_verts[0],
-             prim_tri_size * sizeof(float4));
-      pack_prim_tri_verts_offset += prim_tri_size;
-    }
+      /* Merge triangle vertices data. */
+      if (bvh->pack.prim_tri_verts.size()) {
+        const size_t prim_tri_size = bvh->pack.prim_tri_verts.size();
+        memcpy(pack_prim_tri_verts + pack_prim_tri_verts_offset,
+               &bvh->pack.prim_tri_verts[0],
+               prim_tri_size * sizeof(float4));
+        pack_prim_tri_verts_offset += prim_tri_size;
+      }
 
-    /* merge nodes */
-    if (bvh->pack.leaf_nodes.size()) {
-      int4 *leaf_nodes_offset = &bvh->pack.leaf_nodes[0];
-      size_t leaf_nodes_offset_size = bvh->pack.leaf_nodes.size();
-      for (size_t i = 0, j = 0; i < leaf_nodes_offset_size; i += BVH_NODE_LEAF_SIZE, j++) {
-        int4 data = leaf_nodes_offset[i];
-        data.x += prim_offset;
-        data.y += prim_offset;
-        pack_leaf_nodes[pack_leaf_nodes_offset] = data;
-        for (int j = 1; j < BVH_NODE_LEAF_SIZE; ++j) {
-          pack_leaf_nodes[pack_leaf_nodes_offset + j] = leaf_nodes_offset[i + j];
+      /* merge nodes */
+      if (bvh->pack.leaf_nodes.size()) {
+        int4 *leaf_nodes_offset = &bvh->pack.leaf_nodes[0];
+        size_t leaf_nodes_offset_size = bvh->pack.leaf_nodes.size();
+        for (size_t i = 0, j = 0; i < leaf_nodes_offset_size; i += BVH_NODE_LEAF_SIZE, j++) {
+          int4 data = leaf_nodes_offset[i];
+          data.x += instance_prim_offset;
+          data.y += instance_prim_offset;
+          pack_leaf_nodes[pack_leaf_nodes_offset] = data;
+          for (int j = 1; j < BVH_NODE_LEAF_SIZE; ++j) {
+            pack_leaf_nodes[pack_leaf_nodes_offset + j] = leaf_nodes_offset[i + j];
+          }
+          pack_leaf_nodes_offset += BVH_NODE_LEAF_SIZE;
         }
-        pack_leaf_nodes_offset += BVH_NODE_LEAF_SIZE;
       }
-    }
 
-    if (bvh->pack.nodes.size()) {
-      int4 *bvh_nodes = &bvh->pack.nodes[0];
-      size_t bvh_nodes_size = bvh->pack.nodes.size();
+      if (bvh->pack.nodes.size()) {
+        int4 *bvh_nodes = &bvh->pack.nodes[0];
+        size_t bvh_nodes_size = bvh->pack.nodes.size();
 
-      for (size_t i = 0, j = 0; i < bvh_nodes_size; j++) {
-        size_t nsize, nsize_bbox;
-        if (bvh_nodes[i].x & PATH_RAY_NODE_UNALIGNED) {
-          nsize = BVH_UNALIGNED_NODE_SIZE;
-          nsize_bbox = 0;
-        }
-        else {
-          nsize = BVH_NODE_SIZE;
-          nsize_bbox = 0;
-        }
+        for (size_t i = 0, j = 0; i < bvh_nodes_size; j++) {
+          size_t nsize, nsize_bbox;
+          if (bvh_nodes[i].x & PATH_RAY_NODE_UNALIGNED) {
+            nsize = BVH_UNALIGNED_NODE_SIZE;
+            nsize_bbox = 0;
+          }
+          else {
+            nsize = BVH_NODE_SIZE;
+            nsize_bbox = 0;
+          }
 
-        memcpy(pack_nodes + pack_nodes_offset, bvh_nodes + i, nsize_bbox * sizeof(int4));
+          memcpy(pack_nodes + pack_nodes_offset, bvh_nodes + i, nsize_bbox * sizeof(int4));
 
-        /* Modify offsets into arrays */
-        int4 data = bvh_nodes[i + nsize_bbox];
-        data.z += (data.z < 0) ? -noffset_leaf : noffset;
-        data.w += (data.w < 0) ? -noffset_leaf : noffset;
-        pack_nodes[pack_nodes_offset + nsize_bbox] = data;
+          /* Modify offsets into arrays */
+          int4 data = bvh_nodes[i + nsize_bbox];
+          data.z += (data.z < 0) ? -noffset_leaf : noffset;
+          data.w += (data.w < 0) ? -noffset_leaf : noffset;
+          pack_nodes[pack_nodes_offset + nsize_bbox] = data;
 
-        /* Usually this copies nothing, but we better
-         * be prepared for possible node size extension.
-         */
-        memcpy(&pack_nodes[pack_nodes_offset + nsize_bbox + 1],
-               &bvh_nodes[i + nsize_bbox + 1],
-               sizeof(int4) * (nsize - (nsize_bbox + 1)));
+          /* Usually this copies nothing, but we better
+           * be prepared for possible node size extension.
+           */
+          memcpy(&pack_nodes[pack_nodes_offset + nsize_bbox + 1],
+                 &bvh_nodes[i + nsize_bbox + 1],
+                 sizeof(int4) * (nsize - (nsize_bbox + 1)));
 
-        pack_nodes_offset += nsize;
-        i += nsize;
+          pack_nodes_offset += nsize;
+          i += nsize;
+        }
       }
     }
+  }
+
+  /* Fill in node indexes for objects, 0 for objects already in the top level BVH. */
+  map<Geometry *, int> geometry_node;
+  for (size_t i = 0; i < instances.geometry.size(); i++) {
+    geometry_node[instances.geometry[i]] = instances.geometry_node[i];
+  }
+
+  pack.object_node.clear();
+  pack.object_node.resize(objects.size());
 
-    nodes_offset += bvh->pack.nodes.size();
-    nodes_leaf_offset += bvh->pack.leaf_nodes.size();
-    prim_offset += bvh->pack.prim_index.size();
+  for (size_t i = 0; i < objects.size(); i++) {
+    map<Geometry *, int>::const_iterator it = geometry_node.find(objects[i]->get_geometry());
+    pack.object_node[i] = (it != geometry_node.end()) ? it->second : 0;
   }
 }
 
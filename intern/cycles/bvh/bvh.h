@@ -76,6 +76,40 @@ struct PackedBVH {
   }
 };
 
+/* Packed Instances
+ *
+ * Object BVHs merged into the packed arrays of a top level BVH. They are stored before the
+ * top level nodes and primitives, so that they can stay in place when only the top level
+ * BVH is rebuilt, for example when only object transforms changed. */
+
+struct PackedBVHInstances {
+  /* Geometry with its own BVH, in the order they are merged. */
+  vector<Geometry *> geometry;
+  /* Node index of the BVH of each geometry, as stored in object_node. */
+  vector<int> geometry_node;
+
+  /* Size of the merged data at the start of the packed arrays. */
+  size_t prim_index_size;
+  size_t prim_tri_verts_size;
+  size_t nodes_size;
+  size_t leaf_nodes_size;
+
+  PackedBVHInstances()
+  {
+    clear();
+  }
+
+  void clear()
+  {
+    geometry.clear();
+    geometry_node.clear();
+    prim_index_size = 0;
+    prim_tri_verts_size = 0;
+    nodes_size = 0;
+    leaf_nodes_size = 0;
+  }
+};
+
 enum BVH_TYPE { bvh2 };
 
 /* BVH */
@@ -83,6 +117,7 @@ enum BVH_TYPE { bvh2 };
 class BVH {
  public:
   PackedBVH pack;
+  PackedBVHInstances instances;
   BVHParams params;
   vector<Geometry *> geometry;
   vector<Object *> objects;
@@ -102,11 +137,18 @@ class BVH {
 
   void refit(Progress &progress);
 
+  /* Skip merging object BVHs into a top level BVH, because the caller still has them in
+   * place from a previous build with the same instances. Only the top level part of the
+   * packed arrays is filled in then, after the given instance data. */
+  void use_packed_instances(const PackedBVHInstances &packed_instances);
+
  protected:
   BVH(const BVHParams &params,
       const vector<Geometry *> &geometry,
       const vector<Object *> &objects);
 
+  bool instances_in_place;
+
   /* Refit range of primitives. */
   void refit_primitives(int start, int end, BoundBox &bbox, uint &visibility);
 
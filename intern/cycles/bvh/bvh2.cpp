@@ -42,19 +42,22 @@ void BVH2::pack_leaf(const BVHStackEntry &e, const LeafNode *leaf)
   assert(e.idx + BVH_NODE_LEAF_SIZE <= pack.leaf_nodes.size());
   float4 data[BVH_NODE_LEAF_SIZE];
   memset(data, 0, sizeof(data));
-  if (leaf->num_triangles() == 1 && pack.prim_index[leaf->lo] == -1) {
+  /* Top level primitives are stored after the merged instances. */
+  const int lo = leaf->lo + instances.prim_index_size;
+  const int hi = leaf->hi + instances.prim_index_size;
+  if (leaf->num_triangles() == 1 && pack.prim_index[lo] == -1) {
     /* object */
-    data[0].x = __int_as_float(~(leaf->lo));
+    data[0].x = __int_as_float(~lo);
     data[0].y = __int_as_float(0);
   }
   else {
     /* triangle */
-    data[0].x = __int_as_float(leaf->lo);
-    data[0].y = __int_as_float(leaf->hi);
+    data[0].x = __int_as_float(lo);
+    data[0].y = __int_as_float(hi);
   }
   data[0].z = __uint_as_float(leaf->visibility);
   if (leaf->num_triangles() != 0) {
-    data[0].w = __uint_as_float(pack.prim_type[leaf->lo]);
+    data[0].w = __uint_as_float(pack.prim_type[lo]);
   }
 
   memcpy(&pack.leaf_nodes[e.idx], data, sizeof(float4) * BVH_NODE_LEAF_SIZE);
@@ -189,7 +192,8 @@ void BVH2::pack_nodes(const BVHNode *root)
     pack.leaf_nodes.resize(num_leaf_nodes * BVH_NODE_LEAF_SIZE);
   }
 
-  int nextNodeIdx = 0, nextLeafNodeIdx = 0;
+  /* Top level nodes are stored after the merged instances. */
+  int nextNodeIdx = instances.nodes_size, nextLeafNodeIdx = instances.leaf_nodes_size;
 
   vector<BVHStackEntry> stack;
   stack.reserve(BVHParams::MAX_DEPTH * 2);
@@ -230,9 +234,10 @@ void BVH2::pack_nodes(const BVHNode *root)
       pack_inner(e, stack[stack.size() - 2], stack[stack.size() - 1]);
     }
   }
-  assert(node_size == nextNodeIdx);
+  assert(node_size == nextNodeIdx - instances.nodes_size);
   /* root index to start traversal at, to handle case of single leaf node */
-  pack.root_index = (root->is_leaf()) ? -1 : 0;
+  pack.root_index = (root->is_leaf()) ? -(int)instances.leaf_nodes_size - 1 :
+                                        (int)instances.nodes_size;
 }
 
 void BVH2::refit_nodes()
@@ -23,6 +23,7 @@
 
 #include "util/util_algorithm.h"
 #include "util/util_boundbox.h"
+#include "util/util_task.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -96,75 +97,36 @@ BVHObjectBinning::BVHObjectBinning(const BVHRange &job,
   num_bins = min(size_t(MAX_BINS), size_t(4.0f + 0.05f * size()));
   scale = rcp(cent_bounds_.size()) * make_float3((float)num_bins);
 
-  /* initialize binning counter and bounds */
-  BoundBox bin_bounds[MAX_BINS][4]; /* bounds for every bin in every dimension */
-  int4 bin_count[MAX_BINS];         /* number of primitives mapped to bin */
+  /* map geometry to bins */
+  Bins bins;
+  bins.reset(num_bins);
 
-  for (size_t i = 0; i < num_bins; i++) {
-    bin_count[i] = make_int4(0);
-    bin_bounds[i][0] = bin_bounds[i][1] = bin_bounds[i][2] = BoundBox::empty;
+  if (size() < BVHParams::PARALLEL_BINNING_SIZE) {
+    bin_references(prims, 0, size(), bins);
   }
-
-  /* map geometry to bins, unrolled once */
-  {
-    ssize_t i;
-
-    for (i = 0; i < ssize_t(size()) - 1; i += 2) {
-      prefetch_L2(&prims[start() + i + 8]);
-
-      /* map even and odd primitive to bin */
-      const BVHReference &prim0 = prims[start() + i + 0];
-      const BVHReference &prim1 = prims[start() + i + 1];
-
-      BoundBox bounds0 = get_prim_bounds(prim0);
-      BoundBox bounds1 = get_prim_bounds(prim1);
-
-      int4 bin0 = get_bin(bounds0);
-      int4 bin1 = get_bin(bounds1);
-
-      /* increase bounds for bins for even primitive */
-      int b00 = (int)extract<0>(bin0);
-      bin_count[b00][0]++;
-      bin_bounds[b00][0].grow(bounds0);
-      int b01 = (int)extract<1>(bin0);
-      bin_count[b01][1]++;
-      bin_bounds[b01][1].grow(bounds0);
-      int b02 = (int)extract<2>(bin0);
-      bin_count[b02][2]++;
-      bin_bounds[b02][2].grow(bounds0);
-
-      /* increase bounds of bins for odd primitive */
-      int b10 = (int)extract<0>(bin1);
-      bin_count[b10][0]++;
-      bin_bounds[b10][0].grow(bounds1);
-      int b11 = (int)extract<1>(bin1);
-      bin_count[b11][1]++;
-      bin_bounds[b11][1].grow(bounds1);
-      int b12 = (int)extract<2>(bin1);
-      bin_count[b12][2]++;
-      bin_bounds[b12][2].grow(bounds1);
-    }
-
-    /* for uneven number of primitives */
-    if (i < ssize_t(size())) {
-      /* map primitive to bin */
-      const BVHReference &prim0 = prims[start() + i];
-      BoundBox bounds0 = get_prim_bounds(prim0);
-      int4 bin0 = get_bin(bounds0);
-
-      /* increase bounds of bins */
-      int b00 = (int)extract<0>(bin0);
-      bin_count[b00][0]++;
-      bin_bounds[b00][0].grow(bounds0);
-      int b01 = (int)extract<1>(bin0);
-      bin_count[b01][1]++;
-      bin_bounds[b01][1].grow(bounds0);
-      int b02 = (int)extract<2>(bin0);
-      bin_count[b02][2]++;
-      bin_bounds[b02][2].grow(bounds0);
+  else {
+    /* Bin blocks of references in parallel and merge the results. Blocks are
+     * merged in order, so the result does not depend on thread scheduling. */
+    const size_t num_blocks = divide_up(size(), BVHParams::PARALLEL_BLOCK_SIZE);
+    vector<Bins> block_bins(num_blocks);
+
+    parallel_for(blocked_range<size_t>(0, num_blocks, 1), [&](const blocked_range<size_t> &r) {
+      for (size_t block = r.begin(); block != r.end(); block++) {
+        const size_t begin = block * BVHParams::PARALLEL_BLOCK_SIZE;
+        const size_t end = min(begin + BVHParams::PARALLEL_BLOCK_SIZE, size());
+        block_bins[block].reset(num_bins);
+        bin_references(prims, begin, end, block_bins[block]);
+      }
+    });
+
+    for (size_t block = 0; block < num_blocks; block++) {
+      bins.merge(block_bins[block], num_bins);
     }
   }
 
+  BoundBox(*bin_bounds)[4] = bins.bounds;
+  const int4 *bin_count = bins.count;
+
   /* sweep from right to left and compute parallel prefix of merged bounds */
   float4 r_area[MAX_BINS];  /* area of bounds of primitives on the right */
   float4 r_count[MAX_BINS]; /* number of primitives on the right */
@@ -226,6 +188,181 @@ BVHObjectBinning::BVHObjectBinning(const BVHRange &job,
   leafSAH = bounds_.half_area() * blocks(size());
 }
 
+void BVHObjectBinning::Bins::reset(size_t num_bins)
+{
+  for (size_t i = 0; i < num_bins; i++) {
+    count[i] = make_int4(0);
+    bounds[i][0] = bounds[i][1] = bounds[i][2] = BoundBox::empty;
+  }
+}
+
+void BVHObjectBinning::Bins::merge(const Bins &other, size_t num_bins)
+{
+  for (size_t i = 0; i < num_bins; i++) {
+    count[i] = count[i] + other.count[i];
+    bounds[i][0].grow(other.bounds[i][0]);
+    bounds[i][1].grow(other.bounds[i][1]);
+    bounds[i][2].grow(other.bounds[i][2]);
+  }
+}
+
+void BVHObjectBinning::bin_references(const BVHReference *prims,
+                                      size_t begin,
+                                      size_t end,
+                                      Bins &bins) const
+{
+  BoundBox(*bin_bounds)[4] = bins.bounds;
+  int4 *bin_count = bins.count;
+
+  /* map geometry to bins, unrolled once */
+  ssize_t i;
+
+  for (i = begin; i < ssize_t(end) - 1; i += 2) {
+    prefetch_L2(&prims[start() + i + 8]);
+
+    /* map even and odd primitive to bin */
+    const BVHReference &prim0 = prims[start() + i + 0];
+    const BVHReference &prim1 = prims[start() + i + 1];
+
+    BoundBox bounds0 = get_prim_bounds(prim0);
+    BoundBox bounds1 = get_prim_bounds(prim1);
+
+    int4 bin0 = get_bin(bounds0);
+    int4 bin1 = get_bin(bounds1);
+
+    /* increase bounds for bins for even primitive */
+    int b00 = (int)extract<0>(bin0);
+    bin_count[b00][0]++;
+    bin_bounds[b00][0].grow(bounds0);
+    int b01 = (int)extract<1>(bin0);
+    bin_count[b01][1]++;
+    bin_bounds[b01][1].grow(bounds0);
+    int b02 = (int)extract<2>(bin0);
+    bin_count[b02][2]++;
+    bin_bounds[b02][2].grow(bounds0);
+
+    /* increase bounds of bins for odd primitive */
+    int b10 = (int)extract<0>(bin1);
+    bin_count[b10][0]++;
+    bin_bounds[b10][0].grow(bounds1);
+    int b11 = (int)extract<1>(bin1);
+    bin_count[b11][1]++;
+    bin_bounds[b11][1].grow(bounds1);
+    int b12 = (int)extract<2>(bin1);
+    bin_count[b12][2]++;
+    bin_bounds[b12][2].grow(bounds1);
+  }
+
+  /* for uneven number of primitives */
+  if (i < ssize_t(end)) {
+    /* map primitive to bin */
+    const BVHReference &prim0 = prims[start() + i];
+    BoundBox bounds0 = get_prim_bounds(prim0);
+    int4 bin0 = get_bin(bounds0);
+
+    /* increase bounds of bins */
+    int b00 = (int)extract<0>(bin0);
+    bin_count[b00][0]++;
+    bin_bounds[b00][0].grow(bounds0);
+    int b01 = (int)extract<1>(bin0);
+    bin_count[b01][1]++;
+    bin_bounds[b01][1].grow(bounds0);
+    int b02 = (int)extract<2>(bin0);
+    bin_count[b02][2]++;
+    bin_bounds[b02][2].grow(bounds0);
+  }
+}
+
+size_t BVHObjectBinning::parallel_partition(BVHReference *prims,
+                                            BoundBox &lgeom_bounds,
+                                            BoundBox &rgeom_bounds,
+                                            BoundBox &lcent_bounds,
+                                            BoundBox &rcent_bounds) const
+{
+  /* Stable partition in three passes over blocks of references: count and
+   * bound the left-hand references of every block, scatter every block to
+   * its offsets in a temporary array and copy the result back. */
+  struct BlockInfo {
+    size_t num_left;
+    BoundBox lgeom_bounds, rgeom_bounds;
+    BoundBox lcent_bounds, rcent_bounds;
+  };
+
+  const size_t N = size();
+  const size_t block_size = BVHParams::PARALLEL_BLOCK_SIZE;
+  const size_t num_blocks = divide_up(N, block_size);
+  vector<BlockInfo> blocks(num_blocks);
+  BVHReference *range_prims = prims + start();
+
+  parallel_for(blocked_range<size_t>(0, num_blocks, 1), [&](const blocked_range<size_t> &r) {
+    for (size_t block = r.begin(); block != r.end(); block++) {
+      BlockInfo &info = blocks[block];
+      info.num_left = 0;
+      info.lgeom_bounds = info.rgeom_bounds = BoundBox::empty;
+      info.lcent_bounds = info.rcent_bounds = BoundBox::empty;
+
+      const size_t end = min((block + 1) * block_size, N);
+      for (size_t i = block * block_size; i < end; i++) {
+        const BVHReference &prim = range_prims[i];
+        if (goes_left(prim)) {
+          info.lgeom_bounds.grow(prim.bounds());
+          info.lcent_bounds.grow(prim.bounds().center2());
+          info.num_left++;
+        }
+        else {
+          info.rgeom_bounds.grow(prim.bounds());
+          info.rcent_bounds.grow(prim.bounds().center2());
+        }
+      }
+    }
+  });
+
+  /* Prefix sum of left-hand references gives the output offsets. */
+  vector<size_t> left_offset(num_blocks);
+  size_t num_left = 0;
+  for (size_t block = 0; block < num_blocks; block++) {
+    const BlockInfo &info = blocks[block];
+    left_offset[block] = num_left;
+    num_left += info.num_left;
+
+    lgeom_bounds.grow(info.lgeom_bounds);
+    rgeom_bounds.grow(info.rgeom_bounds);
+    lcent_bounds.grow(info.lcent_bounds);
+    rcent_bounds.grow(info.rcent_bounds);
+  }
+
+  if (num_left == 0 || num_left == N) {
+    /* Nothing to move, caller falls back to a median split. */
+    return num_left;
+  }
+
+  vector<BVHReference> sorted(N);
+
+  parallel_for(blocked_range<size_t>(0, num_blocks, 1), [&](const blocked_range<size_t> &r) {
+    for (size_t block = r.begin(); block != r.end(); block++) {
+      const size_t begin = block * block_size;
+      const size_t end = min(begin + block_size, N);
+      size_t left = left_offset[block];
+      size_t right = num_left + (begin - left_offset[block]);
+      for (size_t i = begin; i < end; i++) {
+        const BVHReference &prim = range_prims[i];
+        if (goes_left(prim)) {
+          sorted[left++] = prim;
+        }
+        else {
+          sorted[right++] = prim;
+        }
+      }
+    }
+  });
+
+  parallel_for(blocked_range<size_t>(0, N, block_size), [&](const blocked_range<size_t> &r) {
+    std::copy(sorted.begin() + r.begin(), sorted.begin() + r.end(), range_prims + r.begin());
+  });
+
+  return num_left;
+}
+
 void BVHObjectBinning::split(BVHReference *prims,
                              BVHObjectBinning &left_o,
                              BVHObjectBinning &right_o) const
@@ -237,34 +374,43 @@ void BVHObjectBinning::split(BVHReference *prims,
   BoundBox lcent_bounds = BoundBox::empty;
   BoundBox rcent_bounds = BoundBox::empty;
 
-  ssize_t l = 0, r = N - 1;
-
-  while (l <= r) {
-    prefetch_L2(&prims[start() + l + 8]);
-    prefetch_L2(&prims[start() + r - 8]);
-
-    BVHReference prim = prims[start() + l];
-    BoundBox unaligned_bounds = get_prim_bounds(prim);
-    float3 unaligned_center = unaligned_bounds.center2();
-    float3 center = prim.bounds().center2();
-
-    if (get_bin(unaligned_center)[dim] < pos) {
-      lgeom_bounds.grow(prim.bounds());
-      lcent_bounds.grow(center);
-      l++;
-    }
-    else {
-      rgeom_bounds.grow(prim.bounds());
-      rcent_bounds.grow(center);
-      swap(prims[start() + l], prims[start() + r]);
-      r--;
+  size_t num_left;
+
+  if (N < BVHParams::PARALLEL_BINNING_SIZE) {
+    ssize_t l = 0, r = N - 1;
+
+    while (l <= r) {
+      prefetch_L2(&prims[start() + l + 8]);
+      prefetch_L2(&prims[start() + r - 8]);
+
+      BVHReference prim = prims[start() + l];
+      float3 center = prim.bounds().center2();
+
+      if (goes_left(prim)) {
+        lgeom_bounds.grow(prim.bounds());
+        lcent_bounds.grow(center);
+        l++;
+      }
+      else {
+        rgeom_bounds.grow(prim.bounds());
+        rcent_bounds.grow(center);
+        swap(prims[start() + l], prims[start() + r]);
+        r--;
+      }
     }
+
+    num_left = l;
   }
+  else {
+    num_left = parallel_partition(
+        prims, lgeom_bounds, rgeom_bounds, lcent_bounds, rcent_bounds);
+  }
+
   /* finish */
-  if (l != 0 && N - 1 - r != 0) {
-    right_o = BVHObjectBinning(BVHRange(rgeom_bounds, rcent_bounds, start() + l, N - 1 - r),
-                               prims);
-    left_o = BVHObjectBinning(BVHRange(lgeom_bounds, lcent_bounds, start(), l), prims);
+  if (num_left != 0 && num_left != N) {
+    right_o = BVHObjectBinning(
+        BVHRange(rgeom_bounds, rcent_bounds, start() + num_left, N - num_left), prims);
+    left_o = BVHObjectBinning(BVHRange(lgeom_bounds, lcent_bounds, start(), num_left), prims);
     return;
   }
 
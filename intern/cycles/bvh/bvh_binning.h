@@ -27,12 +27,15 @@ CCL_NAMESPACE_BEGIN
 
 class BVHBuild;
 
-/* Single threaded object binner. Finds the split with the best SAH heuristic
+/* Object binner. Finds the split with the best SAH heuristic
  * by testing for each dimension multiple partitionings for regular spaced
  * partition locations. A partitioning for a partition location is computed,
  * by putting primitives whose centroid is on the left and right of the split
  * location to different sets. The SAH is evaluated by computing the number of
- * blocks occupied by the primitives in the partitions. */
+ * blocks occupied by the primitives in the partitions.
+ *
+ * Large ranges are binned and partitioned by multiple threads, so the top
+ * levels of the tree do not become a serial bottleneck. */
 
 class BVHObjectBinning : public BVHRange {
  public:
@@ -71,6 +74,32 @@ class BVHObjectBinning : public BVHRange {
   enum { MAX_BINS = 32 };
   enum { LOG_BLOCK_SIZE = 2 };
 
+  /* Bounds and number of primitives for every bin in every dimension. */
+  struct Bins {
+    BoundBox bounds[MAX_BINS][4];
+    int4 count[MAX_BINS];
+
+    void reset(size_t num_bins);
+    void merge(const Bins &other, size_t num_bins);
+  };
+
+  /* Map references [begin, end[ of this range to bins. */
+  void bin_references(const BVHReference *prims, size_t begin, size_t end, Bins &bins) const;
+
+  /* Multi-threaded partition of the references for split(), returns number of
+   * references on the left-hand side. */
+  size_t parallel_partition(BVHReference *prims,
+                            BoundBox &lgeom_bounds,
+                            BoundBox &rgeom_bounds,
+                            BoundBox &lcent_bounds,
+                            BoundBox &rcent_bounds) const;
+
+  /* Test whether reference goes to the left child of the chosen split. */
+  __forceinline bool goes_left(const BVHReference &prim) const
+  {
+    return get_bin(get_prim_bounds(prim).center2())[dim] < pos;
+  }
+
   /* computes the bin numbers for each dimension for a box. */
   __forceinline int4 get_bin(const BoundBox &box) const
   {
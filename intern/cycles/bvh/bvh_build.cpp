@@ -175,6 +175,7 @@ void BVHBuild::add_reference_curves(BoundBox &root, BoundBox &center, Hair *hair
         /* Really simple logic for static hair. */
         BoundBox bounds = BoundBox::empty;
         curve.bounds_grow(k, &hair->get_curve_keys()[0], curve_radius, bounds);
+        hair->pad_curve_bounds(bounds);
         if (bounds.valid()) {
           int packed_type = PRIMITIVE_PACK_SEGMENT(primitive_type, k);
           references.push_back(BVHReference(bounds, j, i, packed_type));
@@ -196,6 +197,7 @@ void BVHBuild::add_reference_curves(BoundBox &root, BoundBox &center, Hair *hair
         for (size_t step = 0; step < num_steps - 1; step++) {
           curve.bounds_grow(k, key_steps + step * num_keys, curve_radius, bounds);
         }
+        hair->pad_curve_bounds(bounds);
         if (bounds.valid()) {
           int packed_type = PRIMITIVE_PACK_SEGMENT(primitive_type, k);
           references.push_back(BVHReference(bounds, j, i, packed_type));
@@ -232,6 +234,7 @@ void BVHBuild::add_reference_curves(BoundBox &root, BoundBox &center, Hair *hair
                                    prev_keys);
         BoundBox prev_bounds = BoundBox::empty;
         curve.bounds_grow(prev_keys, prev_bounds);
+        hair->pad_curve_bounds(prev_bounds);
         /* Create all primitive time steps, */
         for (int bvh_step = 1; bvh_step < num_bvh_steps; ++bvh_step) {
           const float curr_time = (float)(bvh_step)*num_bvh_steps_inv_1;
@@ -249,6 +252,7 @@ void BVHBuild::add_reference_curves(BoundBox &root, BoundBox &center, Hair *hair
                                      curr_keys);
           BoundBox curr_bounds = BoundBox::empty;
           curve.bounds_grow(curr_keys, curr_bounds);
+          hair->pad_curve_bounds(curr_bounds);
           BoundBox bounds = prev_bounds;
           bounds.grow(curr_bounds);
           if (bounds.valid()) {
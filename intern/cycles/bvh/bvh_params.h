@@ -94,6 +94,11 @@ class BVHParams {
   /* fixed parameters */
   enum { MAX_DEPTH = 64, MAX_SPATIAL_DEPTH = 48, NUM_SPATIAL_BINS = 32 };
 
+  /* Ranges with at least this many references are binned and partitioned by
+   * multiple threads, in blocks of PARALLEL_BLOCK_SIZE references. Below that
+   * the per-block bookkeeping costs more than it gains. */
+  enum { PARALLEL_BINNING_SIZE = 32768, PARALLEL_BLOCK_SIZE = 8192 };
+
   BVHParams()
   {
     use_spatial_split = true;
@@ -289,6 +294,13 @@ struct BVHSpatialBin {
   }
 };
 
+/* Spatial bins of all dimensions, accumulated per block of references when
+ * a large range is binned by multiple threads. */
+
+struct BVHSpatialBins {
+  BVHSpatialBin bins[3][BVHParams::NUM_SPATIAL_BINS];
+};
+
 /* BVH Spatial Storage
  *
  * The idea of this storage is have thread-specific storage for the spatial
@@ -25,6 +25,7 @@
 #include "render/object.h"
 
 #include "util/util_algorithm.h"
+#include "util/util_task.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -159,44 +160,88 @@ BVHSpatialSplit::BVHSpatialSplit(const BVHBuild &builder,
   float3 binSize = (range_bounds.max - origin) * (1.0f / (float)BVHParams::NUM_SPATIAL_BINS);
   float3 invBinSize = 1.0f / binSize;
 
-  for (int dim = 0; dim < 3; dim++) {
-    for (int i = 0; i < BVHParams::NUM_SPATIAL_BINS; i++) {
-      BVHSpatialBin &bin = storage_->bins[dim][i];
+  /* chop references [begin, end[ into bins. */
+  auto chop_references = [&](int begin,
+                             int end,
+                             BVHSpatialBin (*bins)[BVHParams::NUM_SPATIAL_BINS]) {
+    for (int dim = 0; dim < 3; dim++) {
+      for (int i = 0; i < BVHParams::NUM_SPATIAL_BINS; i++) {
+        BVHSpatialBin &bin = bins[dim][i];
 
-      bin.bounds = BoundBox::empty;
-      bin.enter = 0;
-      bin.exit = 0;
+        bin.bounds = BoundBox::empty;
+        bin.enter = 0;
+        bin.exit = 0;
+      }
     }
-  }
 
-  /* chop references into bins. */
-  for (unsigned int refIdx = range.start(); refIdx < range.end(); refIdx++) {
-    const BVHReference &ref = references_->at(refIdx);
-    BoundBox prim_bounds = get_prim_bounds(ref);
-    float3 firstBinf = (prim_bounds.min - origin) * invBinSize;
-    float3 lastBinf = (prim_bounds.max - origin) * invBinSize;
-    int3 firstBin = make_int3((int)firstBinf.x, (int)firstBinf.y, (int)firstBinf.z);
-    int3 lastBin = make_int3((int)lastBinf.x, (int)lastBinf.y, (int)lastBinf.z);
+    for (int refIdx = begin; refIdx < end; refIdx++) {
+      const BVHReference &ref = references_->at(refIdx);
+      BoundBox prim_bounds = get_prim_bounds(ref);
+      float3 firstBinf = (prim_bounds.min - origin) * invBinSize;
+      float3 lastBinf = (prim_bounds.max - origin) * invBinSize;
+      int3 firstBin = make_int3((int)firstBinf.x, (int)firstBinf.y, (int)firstBinf.z);
+      int3 lastBin = make_int3((int)lastBinf.x, (int)lastBinf.y, (int)lastBinf.z);
+
+      firstBin = clamp(firstBin, 0, BVHParams::NUM_SPATIAL_BINS - 1);
+      lastBin = clamp(lastBin, firstBin, BVHParams::NUM_SPATIAL_BINS - 1);
+
+      for (int dim = 0; dim < 3; dim++) {
+        BVHReference currRef(prim_bounds, ref.prim_index(), ref.prim_object(), ref.prim_type());
+
+        for (int i = firstBin[dim]; i < lastBin[dim]; i++) {
+          BVHReference leftRef, rightRef;
+
+          split_reference(builder,
+                          leftRef,
+                          rightRef,
+                          currRef,
+                          dim,
+                          origin[dim] + binSize[dim] * (float)(i + 1));
+          bins[dim][i].bounds.grow(leftRef.bounds());
+          currRef = rightRef;
+        }
+
+        bins[dim][lastBin[dim]].bounds.grow(currRef.bounds());
+        bins[dim][firstBin[dim]].enter++;
+        bins[dim][lastBin[dim]].exit++;
+      }
+    }
+  };
 
-    firstBin = clamp(firstBin, 0, BVHParams::NUM_SPATIAL_BINS - 1);
-    lastBin = clamp(lastBin, firstBin, BVHParams::NUM_SPATIAL_BINS - 1);
+  if (range.size() < BVHParams::PARALLEL_BINNING_SIZE) {
+    chop_references(range.start(), range.end(), storage_->bins);
+  }
+  else {
+    /* Chop blocks of references in parallel, then merge the bins in block
+     * order so the result does not depend on thread scheduling.
+     *
+     * The block bins can not live in the thread's spatial storage: while
+     * waiting for the loop this thread may pick up another node's build task,
+     * which uses the same storage. */
+    const int block_size = BVHParams::PARALLEL_BLOCK_SIZE;
+    const int num_blocks = divide_up(range.size(), block_size);
+    vector<BVHSpatialBins> block_bins(num_blocks);
+
+    parallel_for(blocked_range<int>(0, num_blocks, 1), [&](const blocked_range<int> &r) {
+      for (int block = r.begin(); block != r.end(); block++) {
+        const int begin = range.start() + block * block_size;
+        const int end = min(begin + block_size, range.end());
+        chop_references(begin, end, block_bins[block].bins);
+      }
+    });
 
     for (int dim = 0; dim < 3; dim++) {
-      BVHReference currRef(
-          get_prim_bounds(ref), ref.prim_index(), ref.prim_object(), ref.prim_type());
-
-      for (int i = firstBin[dim]; i < lastBin[dim]; i++) {
-        BVHReference leftRef, rightRef;
-
-        split_reference(
-            builder, leftRef, rightRef, currRef, dim, origin[dim] + binSize[dim] * (float)(i + 1));
-        storage_->bins[dim][i].bounds.grow(leftRef.bounds());
-        currRef = rightRef;
+      for (int i = 0; i < BVHParams::NUM_SPATIAL_BINS; i++) {
+        BVHSpatialBin &bin = storage_->bins[dim][i];
+
+        bin = block_bins[0].bins[dim][i];
+        for (int block = 1; block < num_blocks; block++) {
+          const BVHSpatialBin &block_bin = block_bins[block].bins[dim][i];
+          bin.bounds.grow(block_bin.bounds);
+          bin.enter += block_bin.enter;
+          bin.exit += block_bin.exit;
+        }
       }
-
-      storage_->bins[dim][lastBin[dim]].bounds.grow(currRef.bounds());
-      storage_->bins[dim][firstBin[dim]].enter++;
-      storage_->bins[dim][lastBin[dim]].exit++;
     }
   }
 
@@ -405,24 +450,26 @@ void BVHSpatialSplit::split_curve_primitive(const Hair *hair,
   float v0p = v0[dim];
   float v1p = v1[dim];
 
-  /* insert vertex to the boxes it belongs to. */
+  /* insert vertex to the boxes it belongs to, padded like the reference bounds. */
+  const float padding = hair->curve_keys_padding;
+
   if (v0p <= pos)
-    left_bounds.grow(v0);
+    left_bounds.grow(v0, padding);
 
   if (v0p >= pos)
-    right_bounds.grow(v0);
+    right_bounds.grow(v0, padding);
 
   if (v1p <= pos)
-    left_bounds.grow(v1);
+    left_bounds.grow(v1, padding);
 
   if (v1p >= pos)
-    right_bounds.grow(v1);
+    right_bounds.grow(v1, padding);
 
   /* edge intersects the plane => insert intersection to both boxes. */
   if ((v0p < pos && v1p > pos) || (v0p > pos && v1p < pos)) {
     float3 t = lerp(v0, v1, clamp((pos - v0p) / (v1p - v0p), 0.0f, 1.0f));
-    left_bounds.grow(t);
-    right_bounds.grow(t);
+    left_bounds.grow(t, padding);
+    right_bounds.grow(t, padding);
   }
 }
 
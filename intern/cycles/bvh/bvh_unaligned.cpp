@@ -102,6 +102,8 @@ BoundBox BVHUnaligned::compute_aligned_prim_boundbox(const BVHReference &prim,
     const Hair::Curve &curve = hair->get_curve(curve_index);
     curve.bounds_grow(
         segment, &hair->get_curve_keys()[0], &hair->get_curve_radius()[0], aligned_space, bounds);
+    /* The aligned space is orthonormal, so the padding applies unchanged. */
+    hair->pad_curve_bounds(bounds);
   }
   else {
     bounds = prim.bounds().transformed(&aligned_space);
@@ -37,6 +37,7 @@ CCL_NAMESPACE_BEGIN
 class BVH;
 class Progress;
 class RenderTile;
+class TextureCache;
 
 /* Device Types */
 
@@ -373,6 +374,12 @@ class Device {
     return NULL;
   }
 
+  /* Images loaded on demand during rendering, only for CPU device */
+  virtual TextureCache *texture_cache()
+  {
+    return NULL;
+  }
+
   /* Device specific pointer for BVH creation. Currently only used by Embree. */
   virtual void *bvh_device() const
   {
@@ -60,8 +60,10 @@
 #include "util/util_optimization.h"
 #include "util/util_progress.h"
 #include "util/util_system.h"
+#include "util/util_texture_cache.h"
 #include "util/util_task.h"
 #include "util/util_thread.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -182,6 +184,7 @@ class CPUDevice : public Device {
 #ifdef WITH_OSL
   OSLGlobals osl_globals;
 #endif
+  TextureCache tex_cache;
 #ifdef WITH_OPENIMAGEDENOISE
   oidn::DeviceRef oidn_device;
   oidn::FilterRef oidn_filter;
@@ -200,7 +203,7 @@ class CPUDevice : public Device {
       convert_to_half_float_kernel;
   KernelFunctions<void (*)(KernelGlobals *, uchar4 *, float *, float, int, int, int, int)>
       convert_to_byte_kernel;
-  KernelFunctions<void (*)(KernelGlobals *, uint4 *, float4 *, int, int, int, int, int)>
+  KernelFunctions<void (*)(KernelGlobals *, uint4 *, float4 *, int, int, int, int, int, int)>
       shader_kernel;
   KernelFunctions<void (*)(KernelGlobals *, float *, int, int, int, int, int)> bake_kernel;
 
@@ -309,6 +312,7 @@ class CPUDevice : public Device {
 #ifdef WITH_OSL
     kernel_globals.osl = &osl_globals;
 #endif
+    kernel_globals.texture_cache = &tex_cache;
 #ifdef WITH_EMBREE
     embree_device = rtcNewDevice("verbose=0");
 #endif
@@ -537,6 +541,11 @@ class CPUDevice : public Device {
 #endif
   }
 
+  virtual TextureCache *texture_cache() override
+  {
+    return &tex_cache;
+  }
+
   void *bvh_device() const override
   {
 #ifdef WITH_EMBREE
@@ -911,6 +920,7 @@ class CPUDevice : public Device {
   void render(DeviceTask &task, RenderTile &tile, KernelGlobals *kg)
   {
     const bool use_coverage = kernel_data.film.cryptomatte_passes & CRYPT_ACCURATE;
+    const int pass_render_time = kernel_data.film.pass_render_time;
 
     scoped_timer timer(&tile.buffers->render_time);
 
@@ -943,7 +953,17 @@ class CPUDevice : public Device {
             if (use_coverage) {
               coverage.init_pixel(x, y);
             }
-            path_trace_kernel()(kg, render_buffer, sample, x, y, tile.offset, tile.stride);
+            if (pass_render_time) {
+              /* Accumulate seconds spent on each pixel for the render time pass. */
+              const double time_start = time_dt();
+              path_trace_kernel()(kg, render_buffer, sample, x, y, tile.offset, tile.stride);
+              const int index = tile.offset + x + y * tile.stride;
+              render_buffer[index * kernel_data.film.pass_stride + pass_render_time] += (float)(
+                  time_dt() - time_start);
+            }
+            else {
+              path_trace_kernel()(kg, render_buffer, sample, x, y, tile.offset, tile.stride);
+            }
           }
         }
       }
@@ -1382,15 +1402,15 @@ class CPUDevice : public Device {
     KernelGlobals *kg = new KernelGlobals(thread_kernel_globals_init());
 
     for (int sample = 0; sample < task.num_samples; sample++) {
-      for (int x = task.shader_x; x < task.shader_x + task.shader_w; x++)
-        shader_kernel()(kg,
-                        (uint4 *)task.shader_input,
-                        (float4 *)task.shader_output,
-                        task.shader_eval_type,
-                        task.shader_filter,
-                        x,
-                        task.offset,
-                        sample);
+      shader_kernel()(kg,
+                      (uint4 *)task.shader_input,
+                      (float4 *)task.shader_output,
+                      task.shader_eval_type,
+                      task.shader_filter,
+                      task.shader_x,
+                      task.shader_w,
+                      task.offset,
+                      sample);
 
       if (task.get_cancel() || task_pool.canceled())
         break;
@@ -1460,6 +1480,10 @@ class CPUDevice : public Device {
     }
     kg.decoupled_volume_steps_index = 0;
     kg.coverage_asset = kg.coverage_object = kg.coverage_material = NULL;
+    kg.texture_cache_tdata = tex_cache.thread_info();
+#ifdef WITH_NANOVDB
+    kg.nanovdb_accessors = NULL;
+#endif
 #ifdef WITH_OSL
     OSLShader::thread_init(&kg, &kernel_globals, &osl_globals);
 #endif
@@ -1482,6 +1506,11 @@ class CPUDevice : public Device {
         free(kg->decoupled_volume_steps[i]);
       }
     }
+#ifdef WITH_NANOVDB
+    if (kg->nanovdb_accessors != NULL) {
+      free(kg->nanovdb_accessors);
+    }
+#endif
 #ifdef WITH_OSL
     OSLShader::thread_free(kg);
 #endif
@@ -17,6 +17,8 @@
 #include "device/device_memory.h"
 #include "device/device.h"
 
+#include "util/util_mmap.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* Device Memory */
@@ -35,7 +37,10 @@ device_memory::device_memory(Device *device, const char *name, MemoryType type)
       device_pointer(0),
       host_pointer(0),
       shared_pointer(0),
-      shared_counter(0)
+      shared_counter(0),
+      host_mapped(false),
+      use_host_map(false),
+      host_map_min_size(0)
 {
 }
 
@@ -45,12 +50,24 @@ device_memory::~device_memory()
   assert(shared_counter == 0);
 }
 
-void *device_memory::host_alloc(size_t size)
+void *device_memory::host_alloc(size_t size, bool *mapped)
 {
+  if (mapped) {
+    *mapped = false;
+  }
+
   if (!size) {
     return 0;
   }
 
+  if (mapped && use_host_map && size >= host_map_min_size) {
+    void *ptr = util_mmap_temp_file(host_map_dirpath, size);
+    if (ptr) {
+      *mapped = true;
+      return ptr;
+    }
+  }
+
   void *ptr = util_aligned_malloc(size, MIN_ALIGNMENT_CPU_DATA_TYPES);
 
   if (ptr) {
@@ -66,12 +83,52 @@ void *device_memory::host_alloc(size_t size)
 void device_memory::host_free()
 {
   if (host_pointer) {
-    util_guarded_mem_free(memory_size());
-    util_aligned_free((void *)host_pointer);
+    if (host_mapped) {
+      util_munmap(host_pointer, memory_size());
+      host_mapped = false;
+    }
+    else {
+      util_guarded_mem_free(memory_size());
+      util_aligned_free((void *)host_pointer);
+    }
     host_pointer = 0;
   }
 }
 
+bool device_memory::host_map_to_file(const string &dirpath)
+{
+  if (!host_pointer || host_mapped) {
+    return false;
+  }
+
+  const size_t size = memory_size();
+  void *ptr = util_mmap_temp_file(dirpath, size);
+  if (!ptr) {
+    return false;
+  }
+
+  memcpy(ptr, host_pointer, size);
+
+  util_guarded_mem_free(size);
+  util_aligned_free((void *)host_pointer);
+  host_pointer = ptr;
+  host_mapped = true;
+
+  /* Devices rendering from host memory point to the new memory. */
+  if (device_pointer) {
+    device_copy_to();
+  }
+
+  return true;
+}
+
+void device_memory::host_map_allocations(bool use, const string &dirpath, size_t min_size)
+{
+  use_host_map = use;
+  host_map_dirpath = dirpath;
+  host_map_min_size = min_size;
+}
+
 void device_memory::device_alloc()
 {
   assert(!device_pointer && type != MEM_TEXTURE && type != MEM_GLOBAL);
@@ -232,6 +232,22 @@ class device_memory {
 
   bool is_resident(Device *sub_device) const;
 
+  /* Move host memory into a temporary memory mapped file in the given directory,
+   * so the operating system can page it out when running low on memory and read
+   * it back in on demand. Only useful for devices that use host memory directly.
+   * Returns false and leaves the memory as is if the file could not be mapped. */
+  bool host_map_to_file(const string &dirpath);
+
+  /* Allocate host memory of at least min_size bytes directly in such a file from now on,
+   * instead of moving it there after it was filled in. Falls back to regular memory if
+   * the file could not be mapped. */
+  void host_map_allocations(bool use, const string &dirpath, size_t min_size);
+
+  bool is_host_mapped() const
+  {
+    return host_mapped;
+  }
+
  protected:
   friend class CUDADevice;
   friend class OptiXDevice;
@@ -245,8 +261,9 @@ class device_memory {
 
   /* Host allocation on the device. All host_pointer memory should be
    * allocated with these functions, for devices that support using
-   * the same pointer for host and device. */
-  void *host_alloc(size_t size);
+   * the same pointer for host and device. If mapped is given, the memory may be
+   * mapped from a file as set up by host_map_allocations. */
+  void *host_alloc(size_t size, bool *mapped = NULL);
   void host_free();
 
   /* Device memory allocation and copying. */
@@ -259,6 +276,14 @@ class device_memory {
   device_ptr original_device_ptr;
   size_t original_device_size;
   Device *original_device;
+
+  /* Host memory is mapped from a file by host_map_to_file or host_alloc. */
+  bool host_mapped;
+
+  /* Settings of host_map_allocations. */
+  bool use_host_map;
+  string host_map_dirpath;
+  size_t host_map_min_size;
 };
 
 /* Device Only Memory
@@ -346,7 +371,7 @@ template<typename T> class device_vector : public device_memory {
     if (new_size != data_size) {
       device_free();
       host_free();
-      host_pointer = host_alloc(sizeof(T) * new_size);
+      host_pointer = host_alloc(sizeof(T) * new_size, &host_mapped);
       assert(device_pointer == 0);
     }
 
@@ -365,7 +390,8 @@ template<typename T> class device_vector : public device_memory {
     size_t new_size = size(width, height, depth);
 
     if (new_size != data_size) {
-      void *new_ptr = host_alloc(sizeof(T) * new_size);
+      bool new_mapped;
+      void *new_ptr = host_alloc(sizeof(T) * new_size, &new_mapped);
 
       if (new_size && data_size) {
         size_t min_size = ((new_size < data_size) ? new_size : data_size);
@@ -375,6 +401,7 @@ template<typename T> class device_vector : public device_memory {
       device_free();
       host_free();
       host_pointer = new_ptr;
+      host_mapped = new_mapped;
       assert(device_pointer == 0);
     }
 
@@ -1312,6 +1312,7 @@ class OptiXDevice : public CUDADevice {
               {
                 BoundBox bounds = BoundBox::empty;
                 curve.bounds_grow(segment, keys, hair->get_curve_radius().data(), bounds);
+                hair->pad_curve_bounds(bounds);
 
                 const size_t index = step * num_segments + i;
                 aabb_data[index].minX = bounds.min.x;
@@ -26,6 +26,7 @@
 #include "kernel/geom/geom_motion_triangle.h"
 #include "kernel/geom/geom_motion_triangle_intersect.h"
 #include "kernel/geom/geom_motion_triangle_shader.h"
+#include "kernel/geom/geom_curve_keys.h"
 #include "kernel/geom/geom_motion_curve.h"
 #include "kernel/geom/geom_curve.h"
 #include "kernel/geom/geom_curve_intersect.h"
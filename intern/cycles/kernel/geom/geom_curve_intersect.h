@@ -651,10 +651,10 @@ ccl_device_forceinline bool curve_intersect(KernelGlobals *kg,
 
   float4 curve[4];
   if (!is_motion) {
-    curve[0] = kernel_tex_fetch(__curve_keys, ka);
-    curve[1] = kernel_tex_fetch(__curve_keys, k0);
-    curve[2] = kernel_tex_fetch(__curve_keys, k1);
-    curve[3] = kernel_tex_fetch(__curve_keys, kb);
+    curve[0] = curve_key_fetch(kg, prim, ka);
+    curve[1] = curve_key_fetch(kg, prim, k0);
+    curve[2] = curve_key_fetch(kg, prim, k1);
+    curve[3] = curve_key_fetch(kg, prim, kb);
   }
   else {
     int fobject = (object == OBJECT_NONE) ? kernel_tex_fetch(__prim_object, curveAddr) : object;
@@ -724,10 +724,10 @@ ccl_device_inline void curve_shader_setup(KernelGlobals *kg,
   float4 P_curve[4];
 
   if (!(sd->type & PRIMITIVE_ALL_MOTION)) {
-    P_curve[0] = kernel_tex_fetch(__curve_keys, ka);
-    P_curve[1] = kernel_tex_fetch(__curve_keys, k0);
-    P_curve[2] = kernel_tex_fetch(__curve_keys, k1);
-    P_curve[3] = kernel_tex_fetch(__curve_keys, kb);
+    P_curve[0] = curve_key_fetch(kg, prim, ka);
+    P_curve[1] = curve_key_fetch(kg, prim, k0);
+    P_curve[2] = curve_key_fetch(kg, prim, k1);
+    P_curve[3] = curve_key_fetch(kg, prim, kb);
   }
   else {
     motion_curve_keys(kg, sd->object, sd->prim, sd->time, ka, k0, k1, kb, P_curve);
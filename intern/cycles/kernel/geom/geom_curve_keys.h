@@ -0,0 +1,49 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Curve Keys
+ *
+ * Curve keys are stored either as full precision float4 with the radius in
+ * the w component, or quantized to 16 bit integers to save memory. Quantized
+ * positions are offsets from the minimum of the curve bounds, in steps of the
+ * bounds size divided by 65535. Quantized radii are steps of the largest
+ * radius of the curve divided by 65535, stored in the w component of the
+ * curve data. */
+
+CCL_NAMESPACE_BEGIN
+
+#ifdef __HAIR__
+
+/* Position and radius of curve key k, belonging to curve prim. */
+ccl_device_inline float4 curve_key_fetch(KernelGlobals *kg, int prim, int k)
+{
+  if (!kernel_data.bvh.curve_keys_quantized) {
+    return kernel_tex_fetch(__curve_keys, k);
+  }
+
+  const ushort4 key = kernel_tex_fetch(__curve_keys_quantized, k);
+  const float4 bounds = kernel_tex_fetch(__curve_bounds, prim);
+  const float radius_step = kernel_tex_fetch(__curves, prim).w;
+
+  return make_float4(bounds.x + (float)key.x * bounds.w,
+                     bounds.y + (float)key.y * bounds.w,
+                     bounds.z + (float)key.z * bounds.w,
+                     (float)key.w * radius_step);
+}
+
+#endif /* __HAIR__ */
+
+CCL_NAMESPACE_END
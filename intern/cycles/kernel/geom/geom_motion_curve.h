@@ -51,6 +51,7 @@ ccl_device_inline int find_attribute_curve_motion(KernelGlobals *kg,
 }
 
 ccl_device_inline void motion_curve_keys_for_step_linear(KernelGlobals *kg,
+                                                         int prim,
                                                          int offset,
                                                          int numkeys,
                                                          int numsteps,
@@ -61,8 +62,8 @@ ccl_device_inline void motion_curve_keys_for_step_linear(KernelGlobals *kg,
 {
   if (step == numsteps) {
     /* center step: regular key location */
-    keys[0] = kernel_tex_fetch(__curve_keys, k0);
-    keys[1] = kernel_tex_fetch(__curve_keys, k1);
+    keys[0] = curve_key_fetch(kg, prim, k0);
+    keys[1] = curve_key_fetch(kg, prim, k1);
   }
   else {
     /* center step is not stored in this array */
@@ -97,8 +98,9 @@ ccl_device_inline void motion_curve_keys_linear(
   /* fetch key coordinates */
   float4 next_keys[2];
 
-  motion_curve_keys_for_step_linear(kg, offset, numkeys, numsteps, step, k0, k1, keys);
-  motion_curve_keys_for_step_linear(kg, offset, numkeys, numsteps, step + 1, k0, k1, next_keys);
+  motion_curve_keys_for_step_linear(kg, prim, offset, numkeys, numsteps, step, k0, k1, keys);
+  motion_curve_keys_for_step_linear(
+      kg, prim, offset, numkeys, numsteps, step + 1, k0, k1, next_keys);
 
   /* interpolate between steps */
   keys[0] = (1.0f - t) * keys[0] + t * next_keys[0];
@@ -106,6 +108,7 @@ ccl_device_inline void motion_curve_keys_linear(
 }
 
 ccl_device_inline void motion_curve_keys_for_step(KernelGlobals *kg,
+                                                  int prim,
                                                   int offset,
                                                   int numkeys,
                                                   int numsteps,
@@ -118,10 +121,10 @@ ccl_device_inline void motion_curve_keys_for_step(KernelGlobals *kg,
 {
   if (step == numsteps) {
     /* center step: regular key location */
-    keys[0] = kernel_tex_fetch(__curve_keys, k0);
-    keys[1] = kernel_tex_fetch(__curve_keys, k1);
-    keys[2] = kernel_tex_fetch(__curve_keys, k2);
-    keys[3] = kernel_tex_fetch(__curve_keys, k3);
+    keys[0] = curve_key_fetch(kg, prim, k0);
+    keys[1] = curve_key_fetch(kg, prim, k1);
+    keys[2] = curve_key_fetch(kg, prim, k2);
+    keys[3] = curve_key_fetch(kg, prim, k3);
   }
   else {
     /* center step is not stored in this array */
@@ -165,8 +168,9 @@ ccl_device_inline void motion_curve_keys(KernelGlobals *kg,
   /* fetch key coordinates */
   float4 next_keys[4];
 
-  motion_curve_keys_for_step(kg, offset, numkeys, numsteps, step, k0, k1, k2, k3, keys);
-  motion_curve_keys_for_step(kg, offset, numkeys, numsteps, step + 1, k0, k1, k2, k3, next_keys);
+  motion_curve_keys_for_step(kg, prim, offset, numkeys, numsteps, step, k0, k1, k2, k3, keys);
+  motion_curve_keys_for_step(
+      kg, prim, offset, numkeys, numsteps, step + 1, k0, k1, k2, k3, next_keys);
 
   /* interpolate between steps */
   keys[0] = (1.0f - t) * keys[0] + t * next_keys[0];
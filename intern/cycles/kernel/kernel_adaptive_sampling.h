@@ -33,6 +33,10 @@ ccl_device void kernel_do_adaptive_stopping(KernelGlobals *kg,
    * A small epsilon is added to the divisor to prevent division by zero. */
   float error = (fabsf(I.x - A.x) + fabsf(I.y - A.y) + fabsf(I.z - A.z)) /
                 (sample * 0.0001f + sqrtf(I.x + I.y + I.z));
+  if (kernel_data.film.pass_adaptive_error) {
+    /* Debug pass with the error of the last check, comparable to the adaptive threshold. */
+    buffer[kernel_data.film.pass_adaptive_error] = error / (float)sample;
+  }
   if (error < kernel_data.integrator.adaptive_threshold * (float)sample) {
     /* Set the fourth component to non-zero value to indicate that this pixel has converged. */
     buffer[kernel_data.film.pass_adaptive_aux_buffer + 3] += 1.0f;
@@ -237,7 +237,17 @@ ccl_device void kernel_bake_evaluate(
   if (prim == -1)
     return;
 
-  prim += kernel_data.bake.tri_offset;
+  int object = kernel_data.bake.object_index;
+
+  if (kernel_data.bake.use_targets) {
+    const KernelBakeTarget target = kernel_tex_fetch(__bake_targets,
+                                                     __float_as_uint(primitive[0]));
+    object = target.object_index;
+    prim += target.tri_offset;
+  }
+  else {
+    prim += kernel_data.bake.tri_offset;
+  }
 
   /* Random number generator. */
   uint rng_hash = hash_uint2(x, y) ^ kernel_data.integrator.seed;
@@ -267,7 +277,6 @@ ccl_device void kernel_bake_evaluate(
   }
 
   /* Shader data setup. */
-  int object = kernel_data.bake.object_index;
   int shader;
   float3 P, Ng;
 
@@ -471,6 +480,101 @@ ccl_device void kernel_displace_evaluate(KernelGlobals *kg,
   output[i] += make_float4(D.x, D.y, D.z, 0.0f);
 }
 
+#if defined(__KERNEL_CPU__) && defined(__KERNEL_SSE2__) && defined(__SVM__)
+
+/* Number of points searched for others with the same shader. */
+#  define DISPLACE_BATCH_WINDOW 32
+
+/* Same as kernel_displace_evaluate() for points start to start + num, running
+ * the displacement shader for SVM_BATCH_SIZE points at once where possible.
+ * Points with a shader that can't be batched are evaluated one at a time. */
+ccl_device void kernel_displace_evaluate_batch(
+    KernelGlobals *kg, ccl_global uint4 *input, ccl_global float4 *output, int start, int num)
+{
+#  ifdef __OSL__
+  if (kg->osl) {
+    for (int i = start; i < start + num; i++) {
+      kernel_displace_evaluate(kg, input, output, i);
+    }
+    return;
+  }
+#  endif
+
+  ShaderData sd[SVM_BATCH_SIZE];
+  float3 P[SVM_BATCH_SIZE];
+  SVMBatch batch;
+  int shader[DISPLACE_BATCH_WINDOW];
+  bool done[DISPLACE_BATCH_WINDOW];
+
+  for (int lane = 0; lane < SVM_BATCH_SIZE; lane++) {
+    batch.sd[lane] = &sd[lane];
+  }
+
+  for (int window = start; window < start + num; window += DISPLACE_BATCH_WINDOW) {
+    const int window_size = min(DISPLACE_BATCH_WINDOW, start + num - window);
+
+    for (int j = 0; j < window_size; j++) {
+      shader[j] = kernel_tex_fetch(__tri_shader, input[window + j].y) & SHADER_MASK;
+      done[j] = false;
+    }
+
+    for (int j = 0; j < window_size; j++) {
+      if (done[j]) {
+        continue;
+      }
+
+      /* Gather points with the same shader, repeating the first point to fill
+       * a partial batch. */
+      int index[SVM_BATCH_SIZE];
+      int count = 0;
+
+      for (int k = j; k < window_size && count < SVM_BATCH_SIZE; k++) {
+        if (!done[k] && shader[k] == shader[j]) {
+          index[count++] = window + k;
+          done[k] = true;
+        }
+      }
+      for (int lane = count; lane < SVM_BATCH_SIZE; lane++) {
+        index[lane] = index[0];
+      }
+
+      /* setup shader data */
+      for (int lane = 0; lane < SVM_BATCH_SIZE; lane++) {
+        uint4 in = input[index[lane]];
+        shader_setup_from_displace(
+            kg, &sd[lane], in.x, in.y, __uint_as_float(in.z), __uint_as_float(in.w));
+        sd[lane].num_closure = 0;
+        sd[lane].num_closure_left = 0;
+        P[lane] = sd[lane].P;
+      }
+
+      /* evaluate */
+      if (svm_eval_displacement_batch(kg, &batch)) {
+        for (int lane = 0; lane < count; lane++) {
+          float3 D = sd[lane].P - P[lane];
+          object_inverse_dir_transform(kg, &sd[lane], &D);
+          output[index[lane]] += make_float4(D.x, D.y, D.z, 0.0f);
+        }
+      }
+      else {
+        /* Unsupported nodes, evaluate this shader one point at a time for the
+         * rest of the window. */
+        for (int lane = 0; lane < count; lane++) {
+          kernel_displace_evaluate(kg, input, output, index[lane]);
+        }
+        for (int k = j + 1; k < window_size; k++) {
+          if (!done[k] && shader[k] == shader[j]) {
+            kernel_displace_evaluate(kg, input, output, window + k);
+            done[k] = true;
+          }
+        }
+      }
+    }
+  }
+}
+
+#endif
+
 ccl_device void kernel_background_evaluate(KernelGlobals *kg,
                                            ccl_global uint4 *input,
                                            ccl_global float4 *output,
@@ -47,7 +47,11 @@ struct OSLShadingSystem;
 
 typedef unordered_map<float, float> CoverageMap;
 
+class TextureCache;
 struct Intersection;
+#  ifdef WITH_NANOVDB
+struct NanoVDBAccessorCache;
+#  endif
 struct VolumeStep;
 
 typedef struct KernelGlobals {
@@ -64,6 +68,15 @@ typedef struct KernelGlobals {
   OSLThreadData *osl_tdata;
 #  endif
 
+  /* Images loaded on demand, see TextureInfo.cache_handle. */
+  TextureCache *texture_cache;
+  void *texture_cache_tdata;
+
+#  ifdef WITH_NANOVDB
+  /* Tree accessors of recently sampled volume grids, allocated on first use. */
+  NanoVDBAccessorCache *nanovdb_accessors;
+#  endif
+
   /* **** Run-time data ****  */
 
   /* Heap-allocated storage for transparent shadows intersections. */
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+CCL_NAMESPACE_BEGIN
+
+/* Light Tree
+ *
+ * Selects an emitter with probability proportional to an estimate of its
+ * contribution at point P, by descending the tree built in render/light_tree.cpp.
+ * The estimate only depends on P and not on the surface normal, so the pdf of an
+ * emitter can be computed again when a ray hits it, for multiple importance
+ * sampling.
+ *
+ * Distant and background lights are not part of the tree, they are selected
+ * uniformly with probability 1 - light_tree_local_pdf. */
+
+/* Estimated contribution of the emitters below a node at P. */
+ccl_device float light_tree_node_importance(KernelGlobals *kg, const float3 P, int index)
+{
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, index);
+
+  if (knode->energy == 0.0f) {
+    return 0.0f;
+  }
+
+  const float3 bbox_min = make_float3(knode->bbox_min[0], knode->bbox_min[1], knode->bbox_min[2]);
+  const float3 bbox_max = make_float3(knode->bbox_max[0], knode->bbox_max[1], knode->bbox_max[2]);
+  const float3 centroid = 0.5f * (bbox_min + bbox_max);
+  const float radius_sq = 0.25f * len_squared(bbox_max - bbox_min);
+
+  float distance;
+  const float3 D = normalize_len(P - centroid, &distance);
+  const float distance_sq = distance * distance;
+
+  if (distance_sq <= radius_sq) {
+    /* Inside the bounds, emitters can face P from any direction. */
+    return knode->energy / max(radius_sq, 1e-8f);
+  }
+
+  /* Angle between the cone axis and the direction to P, reduced by the spread
+   * of the emitter normals and the angle the bounds cover as seen from P. */
+  const float3 axis = make_float3(knode->axis[0], knode->axis[1], knode->axis[2]);
+  const float cos_theta = knode->two_sided ? fabsf(dot(axis, D)) : dot(axis, D);
+  const float theta = fast_acosf(clamp(cos_theta, -1.0f, 1.0f));
+  const float theta_u = fast_asinf(min(sqrtf(radius_sq) / distance, 1.0f));
+  const float theta_prime = max(theta - knode->theta_o - theta_u, 0.0f);
+
+  if (theta_prime >= knode->theta_e) {
+    return 0.0f;
+  }
+
+  return knode->energy * fast_cosf(theta_prime) / distance_sq;
+}
+
+/* Probability of picking the left child of an inner node, or -1 if no emitter
+ * below the node contributes. */
+ccl_device_inline float light_tree_left_probability(KernelGlobals *kg, const float3 P, int child)
+{
+  const float left = light_tree_node_importance(kg, P, child);
+  const float right = light_tree_node_importance(kg, P, child + 1);
+  const float total = left + right;
+
+  return (total > 0.0f) ? left / total : -1.0f;
+}
+
+/* Sample an emitter below the root, rescaling randu for reuse. Returns -1 if
+ * there is no emitter to sample. */
+ccl_device int light_tree_sample(KernelGlobals *kg, const float3 P, float *randu, float *pdf)
+{
+  float r = *randu;
+  float tree_pdf = 1.0f;
+  int index = 0;
+
+  while (true) {
+    const int child = kernel_tex_fetch(__light_tree_nodes, index).child;
+
+    if (child < 0) {
+      *randu = r;
+      *pdf = tree_pdf;
+      return ~child;
+    }
+
+    const float left_pdf = light_tree_left_probability(kg, P, child);
+
+    if (left_pdf < 0.0f) {
+      *pdf = 0.0f;
+      return -1;
+    }
+
+    if (r < left_pdf) {
+      index = child;
+      r = r / left_pdf;
+      tree_pdf *= left_pdf;
+    }
+    else {
+      index = child + 1;
+      r = (r - left_pdf) / (1.0f - left_pdf);
+      tree_pdf *= 1.0f - left_pdf;
+    }
+
+    /* Float precision runs out deep in the tree. */
+    r = min(r, 1.0f - FLT_EPSILON);
+  }
+}
+
+/* Probability of light_tree_sample() returning the emitter. */
+ccl_device float light_tree_emitter_pdf(KernelGlobals *kg, const float3 P, int emitter)
+{
+  int index = kernel_tex_fetch(__light_tree_emitters, emitter).node;
+  float pdf = 1.0f;
+
+  while (index != 0) {
+    const int parent = kernel_tex_fetch(__light_tree_nodes, index).parent;
+    const int child = kernel_tex_fetch(__light_tree_nodes, parent).child;
+    const float left_pdf = light_tree_left_probability(kg, P, child);
+
+    if (left_pdf < 0.0f) {
+      return 0.0f;
+    }
+
+    pdf *= (index == child) ? left_pdf : 1.0f - left_pdf;
+    index = parent;
+  }
+
+  return pdf;
+}
+
+/* Select any emitter, local or distant. Returns -1 if no emitter can be selected. */
+ccl_device int light_tree_sample_emitter(KernelGlobals *kg,
+                                         const float3 P,
+                                         float *randu,
+                                         float *pdf)
+{
+  const float local_pdf = kernel_data.integrator.light_tree_local_pdf;
+  const float r = *randu;
+
+  if (r < local_pdf) {
+    *randu = r / local_pdf;
+    const int emitter = light_tree_sample(kg, P, randu, pdf);
+    *pdf *= local_pdf;
+    return emitter;
+  }
+
+  /* Distant and background lights, uniformly. */
+  const int num_local = kernel_data.integrator.light_tree_num_local;
+  const int num_distant = kernel_data.integrator.light_tree_num_distant;
+  const float distant_r = (r - local_pdf) / (1.0f - local_pdf) * num_distant;
+  const int index = min(float_to_int(distant_r), num_distant - 1);
+
+  *randu = distant_r - index;
+  *pdf = (1.0f - local_pdf) / num_distant;
+  return num_local + index;
+}
+
+/* Selection probability of a lamp, for multiple importance sampling. */
+ccl_device float light_tree_lamp_pdf(KernelGlobals *kg, int lamp, const float3 P)
+{
+  const int emitter = kernel_tex_fetch(__light_tree_emitter_map, lamp);
+
+  if (emitter >= kernel_data.integrator.light_tree_num_local) {
+    return (1.0f - kernel_data.integrator.light_tree_local_pdf) /
+           kernel_data.integrator.light_tree_num_distant;
+  }
+
+  return kernel_data.integrator.light_tree_local_pdf * light_tree_emitter_pdf(kg, P, emitter);
+}
+
+/* Selection probability of a triangle divided by its area, zero for triangles
+ * that are not in the tree. */
+ccl_device float light_tree_triangle_pdf_area(KernelGlobals *kg,
+                                              int object,
+                                              int prim,
+                                              const float3 P)
+{
+  const ccl_global KernelLightTreeObject *kobject = &kernel_tex_fetch(__light_tree_objects,
+                                                                     object);
+  if (kobject->map_offset < 0) {
+    return 0.0f;
+  }
+
+  const int emitter = kernel_tex_fetch(__light_tree_emitter_map,
+                                       kobject->map_offset + prim - kobject->prim_offset);
+  if (emitter < 0) {
+    return 0.0f;
+  }
+
+  return kernel_data.integrator.light_tree_local_pdf * light_tree_emitter_pdf(kg, P, emitter) *
+         kernel_tex_fetch(__light_tree_emitters, emitter).inv_area;
+}
+
+CCL_NAMESPACE_END
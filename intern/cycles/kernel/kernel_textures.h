@@ -50,6 +50,8 @@ KERNEL_TEX(float2, __tri_patch_uv)
 /* curves */
 KERNEL_TEX(float4, __curves)
 KERNEL_TEX(float4, __curve_keys)
+KERNEL_TEX(ushort4, __curve_keys_quantized)
+KERNEL_TEX(float4, __curve_bounds)
 
 /* patches */
 KERNEL_TEX(uint, __patches)
@@ -66,6 +68,10 @@ KERNEL_TEX(KernelLightDistribution, __light_distribution)
 KERNEL_TEX(KernelLight, __lights)
 KERNEL_TEX(float2, __light_background_marginal_cdf)
 KERNEL_TEX(float2, __light_background_conditional_cdf)
+KERNEL_TEX(KernelLightTreeNode, __light_tree_nodes)
+KERNEL_TEX(KernelLightTreeEmitter, __light_tree_emitters)
+KERNEL_TEX(int, __light_tree_emitter_map)
+KERNEL_TEX(KernelLightTreeObject, __light_tree_objects)
 
 /* particles */
 KERNEL_TEX(KernelParticle, __particles)
@@ -86,4 +92,7 @@ KERNEL_TEX(TextureInfo, __texture_info)
 /* ies lights */
 KERNEL_TEX(float, __ies)
 
+/* baking */
+KERNEL_TEX(KernelBakeTarget, __bake_targets)
+
 #undef KERNEL_TEX
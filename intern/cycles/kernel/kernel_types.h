@@ -128,6 +128,7 @@ CCL_NAMESPACE_BEGIN
 #  endif
 #  define __VOLUME_DECOUPLED__
 #  define __VOLUME_RECORD_ALL__
+#  define __TEXTURE_CACHE__
 #endif /* __KERNEL_CPU__ */
 
 #ifdef __KERNEL_CUDA__
@@ -374,6 +375,7 @@ typedef enum PassType {
   PASS_AOV_VALUE,
   PASS_ADAPTIVE_AUX_BUFFER,
   PASS_SAMPLE_COUNT,
+  PASS_ADAPTIVE_ERROR,
   PASS_CATEGORY_MAIN_END = 31,
 
   PASS_MIST = 32,
@@ -1254,7 +1256,9 @@ typedef struct KernelFilm {
   int pass_aov_value;
   int pass_aov_color_num;
   int pass_aov_value_num;
-  int pad1, pad2, pad3;
+  int pass_adaptive_error;
+  int pass_render_time;
+  int pad1;
 
   /* XYZ to rendering color space transform. float4 instead of float3 to
    * ensure consistent padding/alignment across devices. */
@@ -1389,6 +1393,12 @@ typedef struct KernelIntegrator {
 
   int max_closures;
 
+  /* light tree */
+  int use_light_tree;
+  int light_tree_num_local;
+  int light_tree_num_distant;
+  float light_tree_local_pdf;
+
   int pad1, pad2;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
@@ -1413,6 +1423,8 @@ typedef struct KernelBVH {
   int bvh_layout;
   int use_bvh_steps;
   int curve_subdivisions;
+  int curve_keys_quantized;
+  int pad1, pad3, pad4;
 
   /* Custom BVH */
 #ifdef __KERNEL_OPTIX__
@@ -1441,6 +1453,9 @@ typedef struct KernelBake {
   int tri_offset;
   int type;
   int pass_filter;
+  /* Baking multiple objects at once, the object of a pixel is an index into __bake_targets. */
+  int use_targets;
+  int pad1, pad2, pad3;
 } KernelBake;
 static_assert_align(KernelBake, 16);
 
@@ -1548,6 +1563,50 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+/* Light tree, see render/light_tree.h. */
+
+typedef struct KernelLightTreeNode {
+  /* Bounds of the emitters below the node. */
+  float bbox_min[3];
+  /* Estimated emitted intensity along the cone axis. */
+  float energy;
+  float bbox_max[3];
+  /* Spread of the emitter normals around the axis. */
+  float theta_o;
+  float axis[3];
+  /* Spread of the emission around the emitter normals. */
+  float theta_e;
+  /* First child of inner nodes, the second child follows it. ~emitter for leaves. */
+  int child;
+  int parent;
+  /* Emitters emit on both sides of their normal. */
+  int two_sided;
+  int pad;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
+typedef struct KernelLightTreeEmitter {
+  /* Triangle primitive, or ~lamp. */
+  int prim;
+  int object_id;
+  int shader_flag;
+  /* Leaf node of the emitter. */
+  int node;
+  /* Inverse of the triangle area, for converting to area measure. */
+  float inv_area;
+  float pad1, pad2, pad3;
+} KernelLightTreeEmitter;
+static_assert_align(KernelLightTreeEmitter, 16);
+
+typedef struct KernelLightTreeObject {
+  /* Offset of the object's triangles in the emitter map, -1 for objects without mesh lights. */
+  int map_offset;
+  /* First triangle of the object's mesh. */
+  int prim_offset;
+  int pad1, pad2;
+} KernelLightTreeObject;
+static_assert_align(KernelLightTreeObject, 16);
+
 typedef struct KernelParticle {
   int index;
   float age;
@@ -1571,6 +1630,13 @@ typedef struct KernelShader {
 } KernelShader;
 static_assert_align(KernelShader, 16);
 
+typedef struct KernelBakeTarget {
+  int object_index;
+  int tri_offset;
+  int pad1, pad2;
+} KernelBakeTarget;
+static_assert_align(KernelBakeTarget, 16);
+
 /* Declarations required for split kernel */
 
 /* Macro for queues */
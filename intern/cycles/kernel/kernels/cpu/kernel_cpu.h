@@ -42,7 +42,8 @@ void KERNEL_FUNCTION_FULL_NAME(shader)(KernelGlobals *kg,
                                        float4 *output,
                                        int type,
                                        int filter,
-                                       int i,
+                                       int x,
+                                       int w,
                                        int offset,
                                        int sample);
 
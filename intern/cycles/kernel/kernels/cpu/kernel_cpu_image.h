@@ -22,8 +22,60 @@
 #  include <nanovdb/util/SampleFromVoxels.h>
 #endif
 
+#include "util/util_texture_cache.h"
+
 CCL_NAMESPACE_BEGIN
 
+#ifdef WITH_NANOVDB
+/* Tree accessors of recently sampled NanoVDB grids, kept per thread in KernelGlobals. An
+ * accessor remembers the nodes of its last lookup, so that nearby samples along a volume ray
+ * skip most of the descent from the root. Multiple grids are kept since volume shaders
+ * usually sample a few grids (density, color, temperature) at every step. */
+#  define NANOVDB_ACCESSOR_CACHE_SIZE 4
+
+template<typename T> struct NanoVDBAccessorSlots {
+  typedef typename nanovdb::NanoGrid<T>::AccessorType AccessorType;
+
+  const nanovdb::NanoGrid<T> *grid[NANOVDB_ACCESSOR_CACHE_SIZE];
+  /* Uninitialized storage, accessors can only be constructed from a grid. */
+  alignas(AccessorType) char accessor[NANOVDB_ACCESSOR_CACHE_SIZE][sizeof(AccessorType)];
+  int next;
+
+  AccessorType &get(const nanovdb::NanoGrid<T> *g)
+  {
+    for (int i = 0; i < NANOVDB_ACCESSOR_CACHE_SIZE; i++) {
+      if (grid[i] == g) {
+        return *(AccessorType *)accessor[i];
+      }
+    }
+
+    const int i = next;
+    next = (next + 1) % NANOVDB_ACCESSOR_CACHE_SIZE;
+    grid[i] = g;
+    return *new (accessor[i]) AccessorType(g->getAccessor());
+  }
+};
+
+/* Zero initialized memory is an empty cache. */
+struct NanoVDBAccessorCache {
+  NanoVDBAccessorSlots<float> float_grids;
+  NanoVDBAccessorSlots<nanovdb::Vec3f> float3_grids;
+
+  template<typename T> NanoVDBAccessorSlots<T> &slots();
+};
+
+template<> inline NanoVDBAccessorSlots<float> &NanoVDBAccessorCache::slots<float>()
+{
+  return float_grids;
+}
+
+template<>
+inline NanoVDBAccessorSlots<nanovdb::Vec3f> &NanoVDBAccessorCache::slots<nanovdb::Vec3f>()
+{
+  return float3_grids;
+}
+#endif
+
 /* Make template functions private so symbols don't conflict between kernels with different
  * instruction sets. */
 namespace {
@@ -561,13 +613,21 @@ template<typename T> struct NanoVDBInterpolator {
 #  undef DATA
   }
 
-  static ccl_always_inline float4
-  interp_3d(const TextureInfo &info, float x, float y, float z, InterpolationType interp)
+  static ccl_always_inline float4 interp_3d(KernelGlobals *kg,
+                                            const TextureInfo &info,
+                                            float x,
+                                            float y,
+                                            float z,
+                                            InterpolationType interp)
   {
     using namespace nanovdb;
 
-    NanoGrid<T> *const grid = (NanoGrid<T> *)info.data;
-    AccessorType acc = grid->getAccessor();
+    if (kg->nanovdb_accessors == NULL) {
+      kg->nanovdb_accessors = (NanoVDBAccessorCache *)calloc(1, sizeof(NanoVDBAccessorCache));
+    }
+
+    const NanoGrid<T> *const grid = (const NanoGrid<T> *)info.data;
+    const AccessorType &acc = kg->nanovdb_accessors->slots<T>().get(grid);
 
     switch ((interp == INTERPOLATION_NONE) ? info.interpolation : interp) {
       case INTERPOLATION_CLOSEST:
@@ -583,10 +643,17 @@ template<typename T> struct NanoVDBInterpolator {
 
 #undef SET_CUBIC_SPLINE_WEIGHTS
 
-ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, float y)
+/* Image lookup with the derivatives of the texture coordinates, which pick the mip level for
+ * images in the texture cache. Other images are always sampled at full resolution. */
+ccl_device float4
+kernel_tex_image_interp_diff(KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy)
 {
   const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
 
+  if (info.cache_handle) {
+    return kg->texture_cache->lookup(kg->texture_cache_tdata, info, x, y, dx, dy);
+  }
+
   switch (info.data_type) {
     case IMAGE_DATA_TYPE_HALF:
       return TextureInterpolator<half>::interp(info, x, y);
@@ -611,6 +678,12 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
   }
 }
 
+ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, float y)
+{
+  return kernel_tex_image_interp_diff(
+      kg, id, x, y, make_float2(0.0f, 0.0f), make_float2(0.0f, 0.0f));
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg,
                                              int id,
                                              float3 P,
@@ -641,9 +714,9 @@ ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg,
       return TextureInterpolator<float4>::interp_3d(info, P.x, P.y, P.z, interp);
 #ifdef WITH_NANOVDB
     case IMAGE_DATA_TYPE_NANOVDB_FLOAT:
-      return NanoVDBInterpolator<float>::interp_3d(info, P.x, P.y, P.z, interp);
+      return NanoVDBInterpolator<float>::interp_3d(kg, info, P.x, P.y, P.z, interp);
     case IMAGE_DATA_TYPE_NANOVDB_FLOAT3:
-      return NanoVDBInterpolator<nanovdb::Vec3f>::interp_3d(info, P.x, P.y, P.z, interp);
+      return NanoVDBInterpolator<nanovdb::Vec3f>::interp_3d(kg, info, P.x, P.y, P.z, interp);
 #endif
     default:
       assert(0);
@@ -153,7 +153,8 @@ void KERNEL_FUNCTION_FULL_NAME(shader)(KernelGlobals *kg,
                                        float4 *output,
                                        int type,
                                        int filter,
-                                       int i,
+                                       int x,
+                                       int w,
                                        int offset,
                                        int sample)
 {
@@ -161,10 +162,18 @@ void KERNEL_FUNCTION_FULL_NAME(shader)(KernelGlobals *kg,
   STUB_ASSERT(KERNEL_ARCH, shader);
 #  else
   if (type == SHADER_EVAL_DISPLACE) {
-    kernel_displace_evaluate(kg, input, output, i);
+#    if defined(__KERNEL_SSE2__) && defined(__SVM__)
+    kernel_displace_evaluate_batch(kg, input, output, x, w);
+#    else
+    for (int i = x; i < x + w; i++) {
+      kernel_displace_evaluate(kg, input, output, i);
+    }
+#    endif
   }
   else {
-    kernel_background_evaluate(kg, input, output, i);
+    for (int i = x; i < x + w; i++) {
+      kernel_background_evaluate(kg, input, output, i);
+    }
   }
 #  endif /* KERNEL_STUB */
 }
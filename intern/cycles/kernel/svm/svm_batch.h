@@ -0,0 +1,364 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SVM_BATCH_H__
+#define __SVM_BATCH_H__
+
+/* Batched Shader Virtual Machine for Displacement
+ *
+ * Evaluates the displacement shader of SVM_BATCH_SIZE points at once, on the
+ * CPU. Every lane has its own ShaderData and stack, so any node can be
+ * evaluated by running the regular node once per lane. Math, mix and noise
+ * nodes instead load their inputs from all stacks into SIMD registers and
+ * evaluate all lanes together. The batch size is NOISE_BATCH_SIZE, 8 in AVX2
+ * kernels and 4 otherwise.
+ *
+ * Only displacement is batched. Its points come in as one array, so points
+ * with the same shader can be gathered. Surface shading in the path tracer
+ * happens one path at a time, and the next point of a path isn't known before
+ * the previous one is shaded, so batching it would first need the path tracer
+ * to queue shading points by shader.
+ *
+ * Only nodes found in typical displacement shaders are supported. Evaluation
+ * returns false when it runs into any other node, and the caller then
+ * evaluates the points one by one with svm_eval_nodes(). */
+
+#include "kernel/svm/svm_noise_batch.h"
+
+CCL_NAMESPACE_BEGIN
+
+#ifdef __KERNEL_SSE2__
+
+#  define SVM_BATCH_SIZE NOISE_BATCH_SIZE
+
+typedef struct SVMBatch {
+  ShaderData *sd[SVM_BATCH_SIZE];
+  float stack[SVM_BATCH_SIZE][SVM_STACK_SIZE];
+} SVMBatch;
+
+/* Stack */
+
+ccl_device_inline batchf svm_batch_load_float(const SVMBatch *batch, uint a)
+{
+  kernel_assert(a < SVM_STACK_SIZE);
+
+  batchf f;
+  for (int lane = 0; lane < SVM_BATCH_SIZE; lane++) {
+    f[lane] = batch->stack[lane][a];
+  }
+  return f;
+}
+
+ccl_device_inline batchf svm_batch_load_float_default(const SVMBatch *batch, uint a, uint value)
+{
+  return (a == (uint)SVM_STACK_INVALID) ? batchf(__uint_as_float(value)) :
+                                          svm_batch_load_float(batch, a);
+}
+
+ccl_device_inline void svm_batch_store_float(SVMBatch *batch, uint a, const batchf &f)
+{
+  kernel_assert(a < SVM_STACK_SIZE);
+
+  for (int lane = 0; lane < SVM_BATCH_SIZE; lane++) {
+    batch->stack[lane][a] = f[lane];
+  }
+}
+
+/* Nodes */
+
+ccl_device void svm_batch_node_math(SVMBatch *batch,
+                                    uint type,
+                                    uint inputs_stack_offsets,
+                                    uint result_stack_offset)
+{
+  uint a_stack_offset, b_stack_offset, c_stack_offset;
+  svm_unpack_node_uchar3(inputs_stack_offsets, &a_stack_offset, &b_stack_offset, &c_stack_offset);
+
+  const batchf a = svm_batch_load_float(batch, a_stack_offset);
+  const batchf b = svm_batch_load_float(batch, b_stack_offset);
+  batchf result;
+
+  switch (type) {
+    case NODE_MATH_ADD:
+      result = a + b;
+      break;
+    case NODE_MATH_SUBTRACT:
+      result = a - b;
+      break;
+    case NODE_MATH_MULTIPLY:
+      result = a * b;
+      break;
+    case NODE_MATH_DIVIDE:
+      result = select(b != batchf(0.0f), a / b, batchf(0.0f));
+      break;
+    case NODE_MATH_MULTIPLY_ADD:
+      result = a * b + svm_batch_load_float(batch, c_stack_offset);
+      break;
+    case NODE_MATH_ABSOLUTE:
+      result = abs(a);
+      break;
+    case NODE_MATH_MINIMUM:
+      result = min(a, b);
+      break;
+    case NODE_MATH_MAXIMUM:
+      result = max(a, b);
+      break;
+    default: {
+      /* Other operations are evaluated one lane at a time. */
+      for (int lane = 0; lane < SVM_BATCH_SIZE; lane++) {
+        float *stack = batch->stack[lane];
+        stack_store_float(stack,
+                          result_stack_offset,
+                          svm_math((NodeMathType)type,
+                                   stack_load_float(stack, a_stack_offset),
+                                   stack_load_float(stack, b_stack_offset),
+                                   stack_load_float(stack, c_stack_offset)));
+      }
+      return;
+    }
+  }
+
+  svm_batch_store_float(batch, result_stack_offset, result);
+}
+
+ccl_device void svm_batch_node_mix(KernelGlobals *kg,
+                                   SVMBatch *batch,
+                                   uint fac_offset,
+                                   uint c1_offset,
+                                   uint c2_offset,
+                                   int *offset)
+{
+  /* read extra data */
+  uint4 node1 = read_node(kg, offset);
+  const NodeMix type = (NodeMix)node1.y;
+
+  if (!(type == NODE_MIX_BLEND || type == NODE_MIX_ADD || type == NODE_MIX_MUL ||
+        type == NODE_MIX_SUB)) {
+    /* Other blend modes are evaluated one lane at a time. */
+    for (int lane = 0; lane < SVM_BATCH_SIZE; lane++) {
+      float *stack = batch->stack[lane];
+      float fac = stack_load_float(stack, fac_offset);
+      float3 c1 = stack_load_float3(stack, c1_offset);
+      float3 c2 = stack_load_float3(stack, c2_offset);
+      stack_store_float3(stack, node1.z, svm_mix(type, fac, c1, c2));
+    }
+    return;
+  }
+
+  const batchf fac = svm_batch_load_float(batch, fac_offset);
+  const batchf t = min(max(fac, batchf(0.0f)), batchf(1.0f));
+
+  for (int i = 0; i < 3; i++) {
+    const batchf c1 = svm_batch_load_float(batch, c1_offset + i);
+    const batchf c2 = svm_batch_load_float(batch, c2_offset + i);
+    batchf c;
+
+    switch (type) {
+      case NODE_MIX_ADD:
+        c = c1 + c2;
+        break;
+      case NODE_MIX_MUL:
+        c = c1 * c2;
+        break;
+      case NODE_MIX_SUB:
+        c = c1 - c2;
+        break;
+      default:
+        c = c2;
+        break;
+    }
+
+    /* Same as interp(c1, c, t). */
+    svm_batch_store_float(batch, node1.z + i, c1 + t * (c - c1));
+  }
+}
+
+ccl_device void svm_batch_node_tex_noise(KernelGlobals *kg,
+                                         SVMBatch *batch,
+                                         uint dimensions,
+                                         uint offsets1,
+                                         uint offsets2,
+                                         int *offset)
+{
+  if (dimensions != 3) {
+    /* Other dimensions are evaluated one lane at a time. */
+    const int node_offset = *offset;
+    for (int lane = 0; lane < SVM_BATCH_SIZE; lane++) {
+      *offset = node_offset;
+      svm_node_tex_noise(
+          kg, batch->sd[lane], batch->stack[lane], dimensions, offsets1, offsets2, offset);
+    }
+    return;
+  }
+
+  uint vector_stack_offset, w_stack_offset, scale_stack_offset;
+  uint detail_stack_offset, roughness_stack_offset, distortion_stack_offset;
+  uint value_stack_offset, color_stack_offset;
+
+  svm_unpack_node_uchar4(
+      offsets1, &vector_stack_offset, &w_stack_offset, &scale_stack_offset, &detail_stack_offset);
+  svm_unpack_node_uchar4(offsets2,
+                         &roughness_stack_offset,
+                         &distortion_stack_offset,
+                         &value_stack_offset,
+                         &color_stack_offset);
+
+  uint4 defaults1 = read_node(kg, offset);
+  uint4 defaults2 = read_node(kg, offset);
+
+  batchf scale = svm_batch_load_float_default(batch, scale_stack_offset, defaults1.y);
+  batchf x = svm_batch_load_float(batch, vector_stack_offset + 0) * scale;
+  batchf y = svm_batch_load_float(batch, vector_stack_offset + 1) * scale;
+  batchf z = svm_batch_load_float(batch, vector_stack_offset + 2) * scale;
+  batchf detail = svm_batch_load_float_default(batch, detail_stack_offset, defaults1.z);
+  batchf roughness = svm_batch_load_float_default(batch, roughness_stack_offset, defaults1.w);
+  batchf distortion = svm_batch_load_float_default(batch, distortion_stack_offset, defaults2.x);
+
+  batchf value;
+  batchf color[3];
+  noise_texture_3d_batch(
+      x, y, z, detail, roughness, distortion, stack_valid(color_stack_offset), &value, color);
+
+  if (stack_valid(value_stack_offset)) {
+    svm_batch_store_float(batch, value_stack_offset, value);
+  }
+  if (stack_valid(color_stack_offset)) {
+    for (int i = 0; i < 3; i++) {
+      svm_batch_store_float(batch, color_stack_offset + i, color[i]);
+    }
+  }
+}
+
+/* Run a regular node for every lane. Extra node data is the same for all
+ * lanes, so every lane reads it starting from the same offset. */
+#  define SVM_BATCH_EACH_LANE(node_call) \
+    { \
+      const int node_offset = offset; \
+      for (int lane = 0; lane < SVM_BATCH_SIZE; lane++) { \
+        ShaderData *sd = batch->sd[lane]; \
+        float *stack = batch->stack[lane]; \
+        offset = node_offset; \
+        node_call; \
+        (void)sd; \
+        (void)stack; \
+      } \
+    } \
+    (void)0
+
+/* Main Interpreter Loop */
+
+ccl_device_noinline bool svm_eval_displacement_batch(KernelGlobals *kg, SVMBatch *batch)
+{
+  int offset = batch->sd[0]->shader & SHADER_MASK;
+
+  for (int lane = 1; lane < SVM_BATCH_SIZE; lane++) {
+    kernel_assert((batch->sd[lane]->shader & SHADER_MASK) == offset);
+  }
+
+  while (1) {
+    uint4 node = read_node(kg, &offset);
+
+    switch (node.x) {
+      case NODE_END:
+        return true;
+      case NODE_SHADER_JUMP:
+        offset = node.w;
+        break;
+      case NODE_MATH:
+        svm_batch_node_math(batch, node.y, node.z, node.w);
+        break;
+      case NODE_MIX:
+        svm_batch_node_mix(kg, batch, node.y, node.z, node.w, &offset);
+        break;
+      case NODE_TEX_NOISE:
+        svm_batch_node_tex_noise(kg, batch, node.y, node.z, node.w, &offset);
+        break;
+      case NODE_TEX_COORD:
+        SVM_BATCH_EACH_LANE(svm_node_tex_coord(kg, sd, 0, stack, node, &offset));
+        break;
+      case NODE_VALUE_F:
+        SVM_BATCH_EACH_LANE(svm_node_value_f(kg, sd, stack, node.y, node.z));
+        break;
+      case NODE_VALUE_V:
+        SVM_BATCH_EACH_LANE(svm_node_value_v(kg, sd, stack, node.y, &offset));
+        break;
+      case NODE_CONVERT:
+        SVM_BATCH_EACH_LANE(svm_node_convert(kg, sd, stack, node.y, node.z, node.w));
+        break;
+      case NODE_ATTR:
+        SVM_BATCH_EACH_LANE(svm_node_attr(kg, sd, stack, node));
+        break;
+      case NODE_GEOMETRY:
+        SVM_BATCH_EACH_LANE(svm_node_geometry(kg, sd, stack, node.y, node.z));
+        break;
+      case NODE_VECTOR_MATH:
+        SVM_BATCH_EACH_LANE(
+            svm_node_vector_math(kg, sd, stack, node.y, node.z, node.w, &offset));
+        break;
+      case NODE_MAPPING:
+        SVM_BATCH_EACH_LANE(svm_node_mapping(kg, sd, stack, node.y, node.z, node.w, &offset));
+        break;
+      case NODE_TEXTURE_MAPPING:
+        SVM_BATCH_EACH_LANE(svm_node_texture_mapping(kg, sd, stack, node.y, node.z, &offset));
+        break;
+      case NODE_MAP_RANGE:
+        SVM_BATCH_EACH_LANE(svm_node_map_range(kg, sd, stack, node.y, node.z, node.w, &offset));
+        break;
+      case NODE_CLAMP:
+        SVM_BATCH_EACH_LANE(svm_node_clamp(kg, sd, stack, node.y, node.z, node.w, &offset));
+        break;
+      case NODE_SEPARATE_VECTOR:
+        SVM_BATCH_EACH_LANE(svm_node_separate_vector(sd, stack, node.y, node.z, node.w));
+        break;
+      case NODE_COMBINE_VECTOR:
+        SVM_BATCH_EACH_LANE(svm_node_combine_vector(sd, stack, node.y, node.z, node.w));
+        break;
+      case NODE_TEX_IMAGE:
+        SVM_BATCH_EACH_LANE(svm_node_tex_image(kg, sd, stack, node, &offset));
+        break;
+      case NODE_TEX_VORONOI:
+        SVM_BATCH_EACH_LANE(
+            svm_node_tex_voronoi(kg, sd, stack, node.y, node.z, node.w, &offset));
+        break;
+      case NODE_TEX_MUSGRAVE:
+        SVM_BATCH_EACH_LANE(
+            svm_node_tex_musgrave(kg, sd, stack, node.y, node.z, node.w, &offset));
+        break;
+      case NODE_TEX_WAVE:
+        SVM_BATCH_EACH_LANE(svm_node_tex_wave(kg, sd, stack, node, &offset));
+        break;
+      case NODE_SET_DISPLACEMENT:
+        SVM_BATCH_EACH_LANE(svm_node_set_displacement(kg, sd, stack, node.y));
+        break;
+      case NODE_DISPLACEMENT:
+        SVM_BATCH_EACH_LANE(svm_node_displacement(kg, sd, stack, node));
+        break;
+      case NODE_VECTOR_DISPLACEMENT:
+        SVM_BATCH_EACH_LANE(svm_node_vector_displacement(kg, sd, stack, node, &offset));
+        break;
+      default:
+        return false;
+    }
+  }
+}
+
+#  undef SVM_BATCH_EACH_LANE
+
+#endif /* __KERNEL_SSE2__ */
+
+CCL_NAMESPACE_END
+
+#endif /* __SVM_BATCH_H__ */
@@ -16,14 +16,19 @@
 
 CCL_NAMESPACE_BEGIN
 
-ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, uint flags)
+ccl_device float4 svm_image_texture_diff(
+    KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy, uint flags)
 {
   if (id == -1) {
     return make_float4(
         TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
   }
 
+#ifdef __TEXTURE_CACHE__
+  float4 r = kernel_tex_image_interp_diff(kg, id, x, y, dx, dy);
+#else
   float4 r = kernel_tex_image_interp(kg, id, x, y);
+#endif
   const float alpha = r.w;
 
   if ((flags & NODE_IMAGE_ALPHA_UNASSOCIATE) && alpha != 1.0f && alpha != 0.0f) {
@@ -38,6 +43,33 @@ ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y,
   return r;
 }
 
+ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, uint flags)
+{
+  return svm_image_texture_diff(
+      kg, id, x, y, make_float2(0.0f, 0.0f), make_float2(0.0f, 0.0f), flags);
+}
+
+#ifdef __TEXTURE_CACHE__
+/* Texture space footprint of the shading point, for picking the mip level of images in the
+ * texture cache. Taken from the default UV map, so transforms of the coordinates between the
+ * UV map and the image node are not taken into account. */
+ccl_device_inline void svm_image_texture_uv_differentials(KernelGlobals *kg,
+                                                          ShaderData *sd,
+                                                          float2 *dx,
+                                                          float2 *dy)
+{
+  const AttributeDescriptor desc = find_attribute(kg, sd, ATTR_STD_UV);
+
+  if (desc.offset == ATTR_STD_NOT_FOUND) {
+    *dx = make_float2(0.0f, 0.0f);
+    *dy = make_float2(0.0f, 0.0f);
+    return;
+  }
+
+  primitive_surface_attribute_float2(kg, sd, desc, dx, dy);
+}
+#endif
+
 /* Remap coordnate from 0..1 box to -1..-1 */
 ccl_device_inline float3 texco_remap_square(float3 co)
 {
@@ -108,7 +140,16 @@ ccl_device void svm_node_tex_image(
     id = -num_nodes;
   }
 
+#ifdef __TEXTURE_CACHE__
+  float2 dx = make_float2(0.0f, 0.0f), dy = make_float2(0.0f, 0.0f);
+  if (id != -1 && node.w == NODE_IMAGE_PROJ_FLAT &&
+      kernel_tex_fetch(__texture_info, id).cache_handle) {
+    svm_image_texture_uv_differentials(kg, sd, &dx, &dy);
+  }
+  float4 f = svm_image_texture_diff(kg, id, tex_co.x, tex_co.y, dx, dy, flags);
+#else
   float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, flags);
+#endif
 
   if (stack_valid(out_offset))
     stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
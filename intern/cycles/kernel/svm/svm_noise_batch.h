@@ -0,0 +1,214 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+CCL_NAMESPACE_BEGIN
+
+/* Batched Noise
+ *
+ * 3D Perlin and fractal noise for NOISE_BATCH_SIZE points at once, one point
+ * in each SIMD lane. The regular SSE noise functions instead use the lanes for
+ * the corners of a single point, which leaves the fractal and texture code
+ * around them scalar. Results match noise_texture_3d() up to floating point
+ * rounding.
+ *
+ * AVX2 kernels use 8 lanes, other SSE kernels 4. AVX without AVX2 has no 8 wide
+ * integer operations for the hash, so it stays at 4. */
+
+#ifdef __KERNEL_SSE2__
+
+#  ifdef __KERNEL_AVX2__
+#    define NOISE_BATCH_SIZE 8
+typedef avxf batchf;
+typedef avxi batchi;
+typedef avxb batchb;
+
+ccl_device_inline batchi noise_batch_hash3(const batchi &x, const batchi &y, const batchi &z)
+{
+  return hash_avxi3(x, y, z);
+}
+#  else
+#    define NOISE_BATCH_SIZE 4
+typedef ssef batchf;
+typedef ssei batchi;
+typedef sseb batchb;
+
+ccl_device_inline batchi noise_batch_hash3(const batchi &x, const batchi &y, const batchi &z)
+{
+  return hash_ssei3(x, y, z);
+}
+#  endif
+
+ccl_device_inline batchf noise_batch_fade(const batchf &t)
+{
+  batchf a = madd(t, 6.0f, -15.0f);
+  batchf b = madd(t, a, 10.0f);
+  return (t * t) * (t * b);
+}
+
+/* Negate val if the nth bit of h is 1. */
+#  define noise_batch_negate_if_nth_bit(val, h, n) \
+    ((val) ^ cast(((h) & (1 << (n))) << (31 - (n))))
+
+ccl_device_inline batchf noise_batch_grad3(const batchi &hash,
+                                         const batchf &x,
+                                         const batchf &y,
+                                         const batchf &z)
+{
+  batchi h = hash & 15;
+  batchf u = select(h < 8, x, y);
+  batchf vt = select((h == 12) | (h == 14), x, z);
+  batchf v = select(h < 4, y, vt);
+  return noise_batch_negate_if_nth_bit(u, h, 0) + noise_batch_negate_if_nth_bit(v, h, 1);
+}
+
+#  undef noise_batch_negate_if_nth_bit
+
+ccl_device_inline batchf perlin_3d_batch(const batchf &x, const batchf &y, const batchf &z)
+{
+  batchi X, Y, Z;
+  batchf fx = floorfrac(x, &X);
+  batchf fy = floorfrac(y, &Y);
+  batchf fz = floorfrac(z, &Z);
+
+  batchf u = noise_batch_fade(fx);
+  batchf v = noise_batch_fade(fy);
+  batchf w = noise_batch_fade(fz);
+
+  batchi X1 = X + 1;
+  batchi Y1 = Y + 1;
+  batchi Z1 = Z + 1;
+  batchf fx1 = fx - 1.0f;
+  batchf fy1 = fy - 1.0f;
+  batchf fz1 = fz - 1.0f;
+
+  /* Gradients at the cell corners, named after their offset from the lowest corner. */
+  batchf g000 = noise_batch_grad3(noise_batch_hash3(X, Y, Z), fx, fy, fz);
+  batchf g100 = noise_batch_grad3(noise_batch_hash3(X1, Y, Z), fx1, fy, fz);
+  batchf g010 = noise_batch_grad3(noise_batch_hash3(X, Y1, Z), fx, fy1, fz);
+  batchf g110 = noise_batch_grad3(noise_batch_hash3(X1, Y1, Z), fx1, fy1, fz);
+  batchf g001 = noise_batch_grad3(noise_batch_hash3(X, Y, Z1), fx, fy, fz1);
+  batchf g101 = noise_batch_grad3(noise_batch_hash3(X1, Y, Z1), fx1, fy, fz1);
+  batchf g011 = noise_batch_grad3(noise_batch_hash3(X, Y1, Z1), fx, fy1, fz1);
+  batchf g111 = noise_batch_grad3(noise_batch_hash3(X1, Y1, Z1), fx1, fy1, fz1);
+
+  /* Interpolate along x, then y, then z, in the same order as perlin_3d(). */
+  batchf s00 = mix(g000, g100, u);
+  batchf s10 = mix(g010, g110, u);
+  batchf s01 = mix(g001, g101, u);
+  batchf s11 = mix(g011, g111, u);
+  batchf t0 = mix(s00, s10, v);
+  batchf t1 = mix(s01, s11, v);
+  return mix(t0, t1, w);
+}
+
+ccl_device_inline batchf snoise_3d_batch(const batchf &x, const batchf &y, const batchf &z)
+{
+  const batchf p = perlin_3d_batch(x, y, z);
+  /* Same as ensure_finite(), NaN and infinity both fail the comparison. */
+  return 0.9820f * select(abs(p) <= batchf(FLT_MAX), p, batchf(0.0f));
+}
+
+ccl_device_inline batchf noise_3d_batch(const batchf &x, const batchf &y, const batchf &z)
+{
+  return 0.5f * snoise_3d_batch(x, y, z) + 0.5f;
+}
+
+/* Lanes can have a different number of octaves, lanes that are done keep
+ * their state while the others continue. */
+ccl_device_noinline batchf fractal_noise_3d_batch(
+    const batchf &x, const batchf &y, const batchf &z, batchf octaves, const batchf &roughness)
+{
+  batchf fscale = batchf(1.0f);
+  batchf amp = batchf(1.0f);
+  batchf maxamp = batchf(0.0f);
+  batchf sum = batchf(0.0f);
+  const batchf amp_scale = min(max(roughness, batchf(0.0f)), batchf(1.0f));
+
+  octaves = min(max(octaves, batchf(0.0f)), batchf(16.0f));
+  batchi n;
+  const batchf rmd = floorfrac(octaves, &n);
+  int max_n = n[0];
+  for (int lane = 1; lane < NOISE_BATCH_SIZE; lane++) {
+    max_n = max(max_n, n[lane]);
+  }
+
+  for (int i = 0; i <= max_n; i++) {
+    const batchb active = batchi(i) <= n;
+    batchf t = noise_3d_batch(fscale * x, fscale * y, fscale * z);
+    sum = select(active, sum + t * amp, sum);
+    maxamp = select(active, maxamp + amp, maxamp);
+    amp = select(active, amp * amp_scale, amp);
+    fscale = select(active, fscale * 2.0f, fscale);
+  }
+
+  batchf result = sum / maxamp;
+  const batchb has_rmd = rmd != batchf(0.0f);
+  if (any(has_rmd)) {
+    batchf t = noise_3d_batch(fscale * x, fscale * y, fscale * z);
+    batchf sum2 = (sum + t * amp) / (maxamp + amp);
+    result = select(has_rmd, (1.0f - rmd) * result + rmd * sum2, result);
+  }
+  return result;
+}
+
+/* random_float3_offset(seed), broadcast to all lanes. */
+ccl_device_inline void noise_batch_offset(float seed, batchf *x, batchf *y, batchf *z)
+{
+  *x = batchf(100.0f + hash_float2_to_float(make_float2(seed, 0.0f)) * 100.0f);
+  *y = batchf(100.0f + hash_float2_to_float(make_float2(seed, 1.0f)) * 100.0f);
+  *z = batchf(100.0f + hash_float2_to_float(make_float2(seed, 2.0f)) * 100.0f);
+}
+
+/* Same as noise_texture_3d(), with the points as separate x, y and z registers. */
+ccl_device void noise_texture_3d_batch(batchf x,
+                                       batchf y,
+                                       batchf z,
+                                       const batchf &detail,
+                                       const batchf &roughness,
+                                       const batchf &distortion,
+                                       bool color_is_needed,
+                                       batchf *value,
+                                       batchf color[3])
+{
+  batchf ox, oy, oz;
+
+  if (any(distortion != batchf(0.0f))) {
+    noise_batch_offset(0.0f, &ox, &oy, &oz);
+    batchf dx = snoise_3d_batch(x + ox, y + oy, z + oz);
+    noise_batch_offset(1.0f, &ox, &oy, &oz);
+    batchf dy = snoise_3d_batch(x + ox, y + oy, z + oz);
+    noise_batch_offset(2.0f, &ox, &oy, &oz);
+    batchf dz = snoise_3d_batch(x + ox, y + oy, z + oz);
+
+    /* Lanes without distortion add zero, the noise is always finite. */
+    x = x + dx * distortion;
+    y = y + dy * distortion;
+    z = z + dz * distortion;
+  }
+
+  *value = fractal_noise_3d_batch(x, y, z, detail, roughness);
+  if (color_is_needed) {
+    color[0] = *value;
+    noise_batch_offset(3.0f, &ox, &oy, &oz);
+    color[1] = fractal_noise_3d_batch(x + ox, y + oy, z + oz, detail, roughness);
+    noise_batch_offset(4.0f, &ox, &oy, &oz);
+    color[2] = fractal_noise_3d_batch(x + ox, y + oy, z + oz, detail, roughness);
+  }
+}
+
+#endif /* __KERNEL_SSE2__ */
+
+CCL_NAMESPACE_END
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2011-2013 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SVM_UTIL_H__
+#define __SVM_UTIL_H__
+
+/* Stack and node access shared by all SVM nodes. */
+
+CCL_NAMESPACE_BEGIN
+
+/* Stack */
+
+ccl_device_inline float3 stack_load_float3(float *stack, uint a)
+{
+  kernel_assert(a + 2 < SVM_STACK_SIZE);
+
+  return make_float3(stack[a + 0], stack[a + 1], stack[a + 2]);
+}
+
+ccl_device_inline void stack_store_float3(float *stack, uint a, float3 f)
+{
+  kernel_assert(a + 2 < SVM_STACK_SIZE);
+
+  stack[a + 0] = f.x;
+  stack[a + 1] = f.y;
+  stack[a + 2] = f.z;
+}
+
+ccl_device_inline float stack_load_float(float *stack, uint a)
+{
+  kernel_assert(a < SVM_STACK_SIZE);
+
+  return stack[a];
+}
+
+ccl_device_inline float stack_load_float_default(float *stack, uint a, uint value)
+{
+  return (a == (uint)SVM_STACK_INVALID) ? __uint_as_float(value) : stack_load_float(stack, a);
+}
+
+ccl_device_inline void stack_store_float(float *stack, uint a, float f)
+{
+  kernel_assert(a < SVM_STACK_SIZE);
+
+  stack[a] = f;
+}
+
+ccl_device_inline int stack_load_int(float *stack, uint a)
+{
+  kernel_assert(a < SVM_STACK_SIZE);
+
+  return __float_as_int(stack[a]);
+}
+
+ccl_device_inline int stack_load_int_default(float *stack, uint a, uint value)
+{
+  return (a == (uint)SVM_STACK_INVALID) ? (int)value : stack_load_int(stack, a);
+}
+
+ccl_device_inline void stack_store_int(float *stack, uint a, int i)
+{
+  kernel_assert(a < SVM_STACK_SIZE);
+
+  stack[a] = __int_as_float(i);
+}
+
+ccl_device_inline bool stack_valid(uint a)
+{
+  return a != (uint)SVM_STACK_INVALID;
+}
+
+/* Reading Nodes */
+
+ccl_device_inline uint4 read_node(KernelGlobals *kg, int *offset)
+{
+  uint4 node = kernel_tex_fetch(__svm_nodes, *offset);
+  (*offset)++;
+  return node;
+}
+
+ccl_device_inline float4 read_node_float(KernelGlobals *kg, int *offset)
+{
+  uint4 node = kernel_tex_fetch(__svm_nodes, *offset);
+  float4 f = make_float4(__uint_as_float(node.x),
+                         __uint_as_float(node.y),
+                         __uint_as_float(node.z),
+                         __uint_as_float(node.w));
+  (*offset)++;
+  return f;
+}
+
+ccl_device_inline float4 fetch_node_float(KernelGlobals *kg, int offset)
+{
+  uint4 node = kernel_tex_fetch(__svm_nodes, offset);
+  return make_float4(__uint_as_float(node.x),
+                     __uint_as_float(node.y),
+                     __uint_as_float(node.z),
+                     __uint_as_float(node.w));
+}
+
+ccl_device_forceinline void svm_unpack_node_uchar2(uint i, uint *x, uint *y)
+{
+  *x = (i & 0xFF);
+  *y = ((i >> 8) & 0xFF);
+}
+
+ccl_device_forceinline void svm_unpack_node_uchar3(uint i, uint *x, uint *y, uint *z)
+{
+  *x = (i & 0xFF);
+  *y = ((i >> 8) & 0xFF);
+  *z = ((i >> 16) & 0xFF);
+}
+
+ccl_device_forceinline void svm_unpack_node_uchar4(uint i, uint *x, uint *y, uint *z, uint *w)
+{
+  *x = (i & 0xFF);
+  *y = ((i >> 8) & 0xFF);
+  *z = ((i >> 16) & 0xFF);
+  *w = ((i >> 24) & 0xFF);
+}
+
+CCL_NAMESPACE_END
+
+#endif /* __SVM_UTIL_H__ */
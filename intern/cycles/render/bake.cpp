@@ -23,6 +23,7 @@
 #include "render/stats.h"
 
 #include "util/util_foreach.h"
+#include "util/util_map.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -87,15 +88,15 @@ BakeManager::~BakeManager()
 
 bool BakeManager::get_baking()
 {
-  return !object_name.empty();
+  return !object_names.empty();
 }
 
 void BakeManager::set(Scene *scene,
-                      const std::string &object_name_,
+                      const vector<std::string> &object_names_,
                       ShaderEvalType type_,
                       int pass_filter_)
 {
-  object_name = object_name_;
+  object_names = object_names_;
   type = type_;
   pass_filter = shader_type_to_pass_filter(type_, pass_filter_);
 
@@ -138,25 +139,64 @@ void BakeManager::device_update(Device * /*device*/,
 
   kbake->type = type;
   kbake->pass_filter = pass_filter;
+  kbake->use_targets = (object_names.size() > 1);
 
+  dscene->bake_targets.free();
+
+  KernelBakeTarget *ktargets = NULL;
+  if (kbake->use_targets) {
+    ktargets = dscene->bake_targets.alloc(object_names.size());
+    memset(ktargets, 0, sizeof(KernelBakeTarget) * object_names.size());
+  }
+
+  /* Index of each target by name, objects are matched in a single pass over the scene. */
+  map<std::string, int> target_index;
+  for (int i = 0; i < object_names.size(); i++) {
+    target_index[object_names[i]] = i;
+  }
+
+  int max_aa_samples = 0;
   int object_index = 0;
   foreach (Object *object, scene->objects) {
     const Geometry *geom = object->get_geometry();
-    if (object->name == object_name && geom->geometry_type == Geometry::MESH) {
-      kbake->object_index = object_index;
-      kbake->tri_offset = geom->prim_offset;
-      kintegrator->aa_samples = aa_samples(scene, object, type);
-      break;
+    map<std::string, int>::const_iterator it = target_index.find(object->name.string());
+
+    if (it != target_index.end() && geom->geometry_type == Geometry::MESH) {
+      if (ktargets) {
+        ktargets[it->second].object_index = object_index;
+        ktargets[it->second].tri_offset = geom->prim_offset;
+      }
+      else {
+        kbake->object_index = object_index;
+        kbake->tri_offset = geom->prim_offset;
+      }
+
+      /* Objects share the samples, use enough for the one that needs most. */
+      max_aa_samples = max(max_aa_samples, aa_samples(scene, object, type));
+      target_index.erase(it);
+
+      if (target_index.empty()) {
+        break;
+      }
     }
 
     object_index++;
   }
 
+  if (max_aa_samples > 0) {
+    kintegrator->aa_samples = max_aa_samples;
+  }
+
+  if (ktargets) {
+    dscene->bake_targets.copy_to_device();
+  }
+
   need_update = false;
 }
 
-void BakeManager::device_free(Device * /*device*/, DeviceScene * /*dscene*/)
+void BakeManager::device_free(Device * /*device*/, DeviceScene *dscene)
 {
+  dscene->bake_targets.free();
 }
 
 CCL_NAMESPACE_END
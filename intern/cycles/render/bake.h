@@ -30,7 +30,12 @@ class BakeManager {
   BakeManager();
   ~BakeManager();
 
-  void set(Scene *scene, const std::string &object_name, ShaderEvalType type, int pass_filter);
+  /* Objects to bake. When baking multiple objects at once, the object of a pixel is its index in
+   * this list, otherwise the object id of pixels is ignored. */
+  void set(Scene *scene,
+           const vector<std::string> &object_names,
+           ShaderEvalType type,
+           int pass_filter);
   bool get_baking();
 
   void device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress &progress);
@@ -41,7 +46,7 @@ class BakeManager {
  private:
   ShaderEvalType type;
   int pass_filter;
-  std::string object_name;
+  vector<std::string> object_names;
 };
 
 CCL_NAMESPACE_END
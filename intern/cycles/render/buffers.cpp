@@ -300,10 +300,23 @@ bool RenderBuffers::get_pass_rect(
     int size = params.width * params.height;
 
     if (components == 1 && type == PASS_RENDER_TIME) {
-      /* Render time is not stored by kernel, but measured per tile. */
-      float val = (float)(1000.0 * render_time / (params.width * params.height * sample));
-      for (int i = 0; i < size; i++, pixels++) {
-        pixels[0] = val;
+      /* Render time in seconds is accumulated per pixel by the CPU device. Other devices only
+       * measure it per tile, in which case the average over the tile is used. */
+      bool have_pixel_time = false;
+      for (int i = 0; i < size && !have_pixel_time; i++) {
+        have_pixel_time = (in[i * pass_stride] != 0.0f);
+      }
+
+      if (have_pixel_time) {
+        for (int i = 0; i < size; i++, in += pass_stride, pixels++) {
+          pixels[0] = 1000.0f * (*in) / (float)sample;
+        }
+      }
+      else {
+        float val = (float)(1000.0 * render_time / (params.width * params.height * sample));
+        for (int i = 0; i < size; i++, pixels++) {
+          pixels[0] = val;
+        }
       }
     }
     else if (components == 1) {
@@ -0,0 +1,311 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "render/buffers.h"
+#include "render/checkpoint.h"
+
+#include "util/util_foreach.h"
+#include "util/util_logging.h"
+#include "util/util_path.h"
+
+CCL_NAMESPACE_BEGIN
+
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_RECORD_MARKER 0x454c4954 /* "TILE" */
+
+static const char CHECKPOINT_MAGIC[8] = {'C', 'Y', 'C', 'L', 'E', 'S', 'C', 'P'};
+
+static void checkpoint_header(BufferParams &params, vector<int> &header)
+{
+  header.clear();
+  header.push_back(params.width);
+  header.push_back(params.height);
+  header.push_back(params.full_x);
+  header.push_back(params.full_y);
+  header.push_back(params.full_width);
+  header.push_back(params.full_height);
+  header.push_back(params.get_passes_size());
+  header.push_back(params.passes.size());
+  foreach (const Pass &pass, params.passes) {
+    header.push_back(pass.type);
+  }
+  header.push_back((params.denoising_data_pass ? 1 : 0) |
+                   (params.denoising_clean_pass ? 2 : 0) |
+                   (params.denoising_prefiltered_pass ? 4 : 0));
+}
+
+RenderCheckpoint::RenderCheckpoint() : file(NULL), pass_stride(0), loaded_end(0)
+{
+}
+
+RenderCheckpoint::~RenderCheckpoint()
+{
+  end(false);
+}
+
+bool RenderCheckpoint::load(const string &filepath_, BufferParams &params)
+{
+  thread_scoped_lock lock(mutex);
+
+  tiles.clear();
+  loaded_end = 0;
+
+  checkpoint_header(params, header);
+  pass_stride = params.get_passes_size();
+
+  FILE *f = path_fopen(filepath_, "rb");
+  if (!f) {
+    return false;
+  }
+
+  /* Only use checkpoints written for the same buffer layout. */
+  char magic[sizeof(CHECKPOINT_MAGIC)];
+  uint32_t version = 0;
+  vector<int> file_header(header.size());
+
+  bool ok = fread(magic, sizeof(magic), 1, f) == 1 &&
+            memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) == 0 &&
+            fread(&version, sizeof(version), 1, f) == 1 && version == CHECKPOINT_VERSION &&
+            fread(file_header.data(), sizeof(int), file_header.size(), f) == file_header.size() &&
+            file_header == header;
+
+  if (!ok) {
+    VLOG(1) << "Ignoring checkpoint " << filepath_ << ", it was written for different render "
+            << "settings.";
+    fclose(f);
+    return false;
+  }
+
+  const int width = header[0];
+  const int height = header[1];
+  const int64_t file_size = path_file_size(filepath_);
+  loaded_end = path_ftell(f);
+
+  while (true) {
+    int record[6];
+    if (fread(record, sizeof(int), 6, f) != 6 || record[5] != CHECKPOINT_RECORD_MARKER) {
+      break;
+    }
+
+    Tile tile;
+    tile.x = record[0];
+    tile.y = record[1];
+    tile.w = record[2];
+    tile.h = record[3];
+    tile.num_samples = record[4];
+    tile.offset = path_ftell(f);
+
+    /* Tiles must lie inside the buffer, which also keeps the size computation
+     * from overflowing on a corrupt record. */
+    if (tile.x < 0 || tile.y < 0 || tile.w <= 0 || tile.h <= 0 || tile.x > width - tile.w ||
+        tile.y > height - tile.h || tile.num_samples < 0) {
+      break;
+    }
+
+    const int64_t size = (int64_t)tile.w * tile.h * pass_stride * sizeof(float);
+    if (tile.offset + size > file_size || !path_fseek(f, tile.offset + size, SEEK_SET)) {
+      break;
+    }
+
+    /* Later records for the same tile replace earlier ones. */
+    bool found = false;
+    foreach (Tile &other, tiles) {
+      if (other.x == tile.x && other.y == tile.y && other.w == tile.w && other.h == tile.h) {
+        other = tile;
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      tiles.push_back(tile);
+    }
+
+    loaded_end = tile.offset + size;
+  }
+
+  fclose(f);
+
+  VLOG(1) << "Loaded checkpoint " << filepath_ << " with " << tiles.size() << " tiles.";
+
+  filepath = filepath_;
+  return true;
+}
+
+bool RenderCheckpoint::read_tile(const Tile &tile, float *pixels)
+{
+  thread_scoped_lock lock(mutex);
+
+  FILE *f = (file) ? file : path_fopen(filepath, "rb");
+  if (!f) {
+    error = "Failed to open checkpoint " + filepath;
+    return false;
+  }
+
+  const size_t size = (size_t)tile.w * tile.h * pass_stride;
+  const int64_t write_offset = (file) ? path_ftell(file) : 0;
+
+  bool ok = path_fseek(f, tile.offset, SEEK_SET) && fread(pixels, sizeof(float), size, f) == size;
+
+  if (file) {
+    /* Restore the write position, the file is shared with write_tile(). */
+    ok &= path_fseek(file, write_offset, SEEK_SET);
+  }
+  else {
+    fclose(f);
+  }
+
+  if (!ok) {
+    error = "Failed to read checkpoint " + filepath;
+  }
+
+  return ok;
+}
+
+bool RenderCheckpoint::write_header(FILE *f)
+{
+  const uint32_t version = CHECKPOINT_VERSION;
+  return fwrite(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC), 1, f) == 1 &&
+         fwrite(&version, sizeof(version), 1, f) == 1 &&
+         fwrite(header.data(), sizeof(int), header.size(), f) == header.size();
+}
+
+bool RenderCheckpoint::write_record(
+    FILE *f, int x, int y, int w, int h, int num_samples, const float *pixels)
+{
+  const int record[6] = {x, y, w, h, num_samples, CHECKPOINT_RECORD_MARKER};
+  const size_t size = (size_t)w * h * pass_stride;
+
+  /* Flush so a crash right after leaves a complete record on disk. */
+  return fwrite(record, sizeof(int), 6, f) == 6 &&
+         fwrite(pixels, sizeof(float), size, f) == size && fflush(f) == 0;
+}
+
+bool RenderCheckpoint::begin(const string &filepath_, BufferParams &params)
+{
+  thread_scoped_lock lock(mutex);
+
+  vector<int> new_header;
+  checkpoint_header(params, new_header);
+
+  /* Continue after the last complete record of a loaded checkpoint, anything
+   * behind it is an incomplete record that gets overwritten. */
+  if (filepath_ == filepath && new_header == header && loaded_end > 0) {
+    file = path_fopen(filepath, "r+b");
+    if (file && path_fseek(file, loaded_end, SEEK_SET)) {
+      return true;
+    }
+  }
+
+  if (file) {
+    fclose(file);
+  }
+
+  filepath = filepath_;
+  header = new_header;
+  pass_stride = params.get_passes_size();
+  tiles.clear();
+  loaded_end = 0;
+
+  file = path_fopen(filepath, "wb");
+  if (!file || !write_header(file) || fflush(file) != 0) {
+    error = "Failed to write checkpoint " + filepath;
+    if (file) {
+      fclose(file);
+      file = NULL;
+    }
+    return false;
+  }
+
+  return true;
+}
+
+bool RenderCheckpoint::write_tile(int x, int y, int w, int h, int num_samples, const float *pixels)
+{
+  thread_scoped_lock lock(mutex);
+
+  if (!file) {
+    return false;
+  }
+
+  if (!write_record(file, x, y, w, h, num_samples, pixels)) {
+    error = "Failed to write checkpoint " + filepath;
+    return false;
+  }
+
+  return true;
+}
+
+bool RenderCheckpoint::write_frame(int w, int h, int num_samples, const float *pixels)
+{
+  thread_scoped_lock lock(mutex);
+
+  if (!file) {
+    return false;
+  }
+
+  /* Write to a temporary file first, so there is always a complete
+   * checkpoint on disk even if rendering is interrupted while writing. */
+  const string temp_filepath = filepath + ".tmp";
+  FILE *f = path_fopen(temp_filepath, "wb");
+
+  bool ok = f && write_header(f) && write_record(f, 0, 0, w, h, num_samples, pixels);
+  if (f) {
+    ok &= (fclose(f) == 0);
+  }
+
+  if (!ok) {
+    /* The previous checkpoint is untouched, only the incomplete temporary file goes. */
+    error = "Failed to write checkpoint " + filepath;
+    path_remove(temp_filepath);
+    return false;
+  }
+
+  /* Replace the previous checkpoint in one step, so a complete checkpoint is on disk at any
+   * point in time. If that fails the temporary file is kept, it holds the latest frame. */
+  fclose(file);
+  ok = path_rename(temp_filepath, filepath);
+
+  /* Keep the previous checkpoint open when renaming failed, the next frame tries again. */
+  file = path_fopen(filepath, "ab");
+
+  if (!ok || !file) {
+    error = "Failed to write checkpoint " + filepath;
+    return false;
+  }
+
+  return true;
+}
+
+void RenderCheckpoint::end(bool remove_file)
+{
+  thread_scoped_lock lock(mutex);
+
+  if (file) {
+    fclose(file);
+    file = NULL;
+  }
+
+  if (remove_file && !filepath.empty()) {
+    path_remove(filepath);
+  }
+
+  tiles.clear();
+  loaded_end = 0;
+}
+
+CCL_NAMESPACE_END
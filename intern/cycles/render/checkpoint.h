@@ -0,0 +1,115 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include <stdio.h>
+
+#include "util/util_string.h"
+#include "util/util_thread.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class BufferParams;
+
+/* Render Checkpoint
+ *
+ * Render buffers of finished tiles or of a whole progressive frame, saved
+ * during rendering so an interrupted render can continue where it stopped.
+ *
+ * File layout, native endian:
+ *
+ *   char    magic[8]          "CYCLESCP"
+ *   uint32  version
+ *   int32   width, height, full_x, full_y, full_width, full_height
+ *   int32   pass_stride       floats per pixel
+ *   int32   num_passes
+ *   int32   pass_type[num_passes]
+ *   int32   denoising flags   data, clean and prefiltered passes as bits 0-2
+ *
+ * followed by any number of tile records:
+ *
+ *   int32   x, y, w, h        tile rectangle relative to the buffer
+ *   int32   num_samples       samples accumulated in the pixels
+ *   int32   marker            "TILE", to detect partially written records
+ *   float   pixels[w * h * pass_stride]
+ *
+ * Pixels are the raw render buffer contents, including the sample count and
+ * adaptive sampling passes. Records are appended as tiles finish, a later
+ * record for the same rectangle replaces an earlier one and a truncated last
+ * record is ignored. */
+
+class RenderCheckpoint {
+ public:
+  struct Tile {
+    int x, y, w, h;
+    int num_samples;
+    int64_t offset;
+  };
+
+  RenderCheckpoint();
+  ~RenderCheckpoint();
+
+  /* Find tiles saved by an earlier render with the same buffer layout. Returns
+   * false if there is no usable checkpoint. */
+  bool load(const string &filepath, BufferParams &params);
+
+  /* Read pixels of a loaded tile, w * h * pass_stride floats. */
+  bool read_tile(const Tile &tile, float *pixels);
+
+  /* Start writing checkpoints, keeping previously loaded tiles. */
+  bool begin(const string &filepath, BufferParams &params);
+  bool is_open() const
+  {
+    return file != NULL;
+  }
+
+  /* Append a finished tile. Safe to call from multiple threads. */
+  bool write_tile(int x, int y, int w, int h, int num_samples, const float *pixels);
+
+  /* Replace the checkpoint with a single record for the whole buffer, for
+   * progressive rendering where all pixels are updated every sample. */
+  bool write_frame(int w, int h, int num_samples, const float *pixels);
+
+  /* Stop writing, removing the file when the render completed. */
+  void end(bool remove_file);
+
+  /* Tiles found by load(). */
+  vector<Tile> tiles;
+
+  /* Error message after a failed operation. */
+  string error;
+
+ protected:
+  bool write_header(FILE *f);
+  bool write_record(FILE *f, int x, int y, int w, int h, int num_samples, const float *pixels);
+
+  string filepath;
+  FILE *file;
+  /* Header fields after the magic and version, for the current buffer layout. */
+  vector<int> header;
+  int pass_stride;
+  /* End of the last complete record of a loaded checkpoint. */
+  int64_t loaded_end;
+  thread_mutex mutex;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __CHECKPOINT_H__ */
@@ -43,14 +43,17 @@ void curvebounds(float *lower, float *upper, float3 *p, int dim)
   curve_coef[2] = 0.5f * (2 * p0[dim] - 5 * p1[dim] + 4 * p2[dim] - p3[dim]);
   curve_coef[3] = 0.5f * (-p0[dim] + 3 * p1[dim] - 3 * p2[dim] + p3[dim]);
 
+  /* Extrema where the derivative is zero. The roots are computed without cancellation, so
+   * nearly quadratic segments with a tiny cubic coefficient keep their extremum. */
   float discroot = curve_coef[2] * curve_coef[2] - 3 * curve_coef[3] * curve_coef[1];
   float ta = -1.0f;
   float tb = -1.0f;
 
   if (discroot >= 0) {
     discroot = sqrtf(discroot);
-    ta = (-curve_coef[2] - discroot) / (3 * curve_coef[3]);
-    tb = (-curve_coef[2] + discroot) / (3 * curve_coef[3]);
+    const float q = -(curve_coef[2] + copysignf(discroot, curve_coef[2]));
+    ta = (curve_coef[3] != 0.0f) ? q / (3 * curve_coef[3]) : -1.0f;
+    tb = (q != 0.0f) ? curve_coef[1] / q : -1.0f;
     ta = (ta > 1.0f || ta < 0.0f) ? -1.0f : ta;
     tb = (tb > 1.0f || tb < 0.0f) ? -1.0f : tb;
   }
@@ -28,6 +28,9 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Number of scanlines of neighbor frames read at a time. */
+#define DENOISE_READ_BAND_HEIGHT 64
+
 /* Utility Functions */
 
 static void print_progress(int num, int total, int frame, int num_frames)
@@ -460,14 +463,19 @@ bool DenoiseTask::load_input_pixels(int layer)
     buffer_data += frame_stride;
   }
 
-  /* Preprocess */
+  /* Preprocess, rows in parallel. Each pass only writes its own rows, so the
+   * result does not depend on the number of threads. */
   buffer_data = input_pixels.data();
   for (int neighbor = 0; neighbor < image.in_neighbors.size() + 1; neighbor++) {
     /* Clamp */
     if (denoiser->params.clamp_input) {
-      for (int i = 0; i < num_pixels * INPUT_NUM_CHANNELS; i++) {
-        buffer_data[i] = clamp(buffer_data[i], -1e8f, 1e8f);
-      }
+      parallel_for(blocked_range<int>(0, h), [&](const blocked_range<int> &rows) {
+        const int begin = rows.begin() * w * INPUT_NUM_CHANNELS;
+        const int end = rows.end() * w * INPUT_NUM_CHANNELS;
+        for (int i = begin; i < end; i++) {
+          buffer_data[i] = clamp(buffer_data[i], -1e8f, 1e8f);
+        }
+      });
     }
 
     /* Box blur */
@@ -475,42 +483,48 @@ bool DenoiseTask::load_input_pixels(int layer)
     float *data = buffer_data + 14;
     array<float> temp(num_pixels);
 
-    for (int y = 0; y < h; y++) {
-      for (int x = 0; x < w; x++) {
-        int n = 0;
-        float sum = 0.0f;
-        for (int dx = max(x - r, 0); dx < min(x + r + 1, w); dx++, n++) {
-          sum += data[INPUT_NUM_CHANNELS * (y * w + dx)];
+    parallel_for(blocked_range<int>(0, h), [&](const blocked_range<int> &rows) {
+      for (int y = rows.begin(); y < rows.end(); y++) {
+        for (int x = 0; x < w; x++) {
+          int n = 0;
+          float sum = 0.0f;
+          for (int dx = max(x - r, 0); dx < min(x + r + 1, w); dx++, n++) {
+            sum += data[INPUT_NUM_CHANNELS * (y * w + dx)];
+          }
+          temp[y * w + x] = sum / n;
         }
-        temp[y * w + x] = sum / n;
       }
-    }
+    });
 
-    for (int y = 0; y < h; y++) {
-      for (int x = 0; x < w; x++) {
-        int n = 0;
-        float sum = 0.0f;
+    parallel_for(blocked_range<int>(0, h), [&](const blocked_range<int> &rows) {
+      for (int y = rows.begin(); y < rows.end(); y++) {
+        for (int x = 0; x < w; x++) {
+          int n = 0;
+          float sum = 0.0f;
 
-        for (int dy = max(y - r, 0); dy < min(y + r + 1, h); dy++, n++) {
-          sum += temp[dy * w + x];
-        }
+          for (int dy = max(y - r, 0); dy < min(y + r + 1, h); dy++, n++) {
+            sum += temp[dy * w + x];
+          }
 
-        data[INPUT_NUM_CHANNELS * (y * w + x)] = sum / n;
+          data[INPUT_NUM_CHANNELS * (y * w + x)] = sum / n;
+        }
       }
-    }
+    });
 
     /* Highlight compression */
     data = buffer_data + 8;
-    for (int y = 0; y < h; y++) {
-      for (int x = 0; x < w; x++) {
-        int idx = INPUT_NUM_CHANNELS * (y * w + x);
-        float3 color = make_float3(data[idx], data[idx + 1], data[idx + 2]);
-        color = color_highlight_compress(color, NULL);
-        data[idx] = color.x;
-        data[idx + 1] = color.y;
-        data[idx + 2] = color.z;
+    parallel_for(blocked_range<int>(0, h), [&](const blocked_range<int> &rows) {
+      for (int y = rows.begin(); y < rows.end(); y++) {
+        for (int x = 0; x < w; x++) {
+          int idx = INPUT_NUM_CHANNELS * (y * w + x);
+          float3 color = make_float3(data[idx], data[idx + 1], data[idx + 2]);
+          color = color_highlight_compress(color, NULL);
+          data[idx] = color.x;
+          data[idx + 1] = color.y;
+          data[idx + 2] = color.z;
+        }
       }
-    }
+    });
 
     buffer_data += frame_stride;
   }
@@ -682,13 +696,16 @@ void DenoiseImage::read_pixels(const DenoiseImageLayer &layer, float *input_pixe
    * We copy a subset into the device input buffer with channels reshuffled. */
   const int *input_to_image_channel = layer.input_to_image_channel.data();
 
-  for (int i = 0; i < width * height; i++) {
-    for (int j = 0; j < INPUT_NUM_CHANNELS; j++) {
-      int image_channel = input_to_image_channel[j];
-      input_pixels[i * INPUT_NUM_CHANNELS + j] =
-          pixels[((size_t)i) * num_channels + image_channel];
-    }
-  }
+  parallel_for(blocked_range<size_t>(0, (size_t)width * (size_t)height, 4096),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i < r.end(); i++) {
+                   for (int j = 0; j < INPUT_NUM_CHANNELS; j++) {
+                     int image_channel = input_to_image_channel[j];
+                     input_pixels[i * INPUT_NUM_CHANNELS + j] =
+                         pixels[i * num_channels + image_channel];
+                   }
+                 }
+               });
 }
 
 bool DenoiseImage::read_neighbor_pixels(int neighbor,
@@ -696,21 +713,42 @@ bool DenoiseImage::read_neighbor_pixels(int neighbor,
                                         float *input_pixels)
 {
   /* Load pixels from neighboring frames, and copy them into device buffer
-   * with channels reshuffled. */
-  size_t num_pixels = (size_t)width * (size_t)height;
-  array<float> neighbor_pixels(num_pixels * num_channels);
-  if (!in_neighbors[neighbor]->read_image(TypeDesc::FLOAT, neighbor_pixels.data())) {
-    return false;
-  }
+   * with channels reshuffled. Frames are read in bands of scanlines, so the
+   * full neighbor frame with all its channels is never in memory. */
+  ImageInput *in = in_neighbors[neighbor].get();
+  const ImageSpec &spec = in->spec();
+  const int neighbor_channels = spec.nchannels;
+
+  array<float> neighbor_pixels((size_t)width * DENOISE_READ_BAND_HEIGHT * neighbor_channels);
 
   const int *input_to_image_channel = layer.neighbor_input_to_image_channel[neighbor].data();
 
-  for (int i = 0; i < width * height; i++) {
-    for (int j = 0; j < INPUT_NUM_CHANNELS; j++) {
-      int image_channel = input_to_image_channel[j];
-      input_pixels[i * INPUT_NUM_CHANNELS + j] =
-          neighbor_pixels[((size_t)i) * num_channels + image_channel];
+  for (int y = 0; y < height; y += DENOISE_READ_BAND_HEIGHT) {
+    const int num_rows = min(DENOISE_READ_BAND_HEIGHT, height - y);
+
+    if (!in->read_scanlines(0,
+                            0,
+                            spec.y + y,
+                            spec.y + y + num_rows,
+                            spec.z,
+                            0,
+                            neighbor_channels,
+                            TypeDesc::FLOAT,
+                            neighbor_pixels.data())) {
+      return false;
     }
+
+    float *band_input_pixels = input_pixels + (size_t)y * width * INPUT_NUM_CHANNELS;
+    parallel_for(blocked_range<size_t>(0, (size_t)width * num_rows, 4096),
+                 [&](const blocked_range<size_t> &r) {
+                   for (size_t i = r.begin(); i < r.end(); i++) {
+                     for (int j = 0; j < INPUT_NUM_CHANNELS; j++) {
+                       int image_channel = input_to_image_channel[j];
+                       band_input_pixels[i * INPUT_NUM_CHANNELS + j] =
+                           neighbor_pixels[i * neighbor_channels + image_channel];
+                     }
+                   }
+                 });
   }
 
   return true;
@@ -63,6 +63,7 @@ static NodeEnum *get_pass_type_enum()
   pass_type_enum.insert("aov_value", PASS_AOV_VALUE);
   pass_type_enum.insert("adaptive_aux_buffer", PASS_ADAPTIVE_AUX_BUFFER);
   pass_type_enum.insert("sample_count", PASS_SAMPLE_COUNT);
+  pass_type_enum.insert("adaptive_error", PASS_ADAPTIVE_ERROR);
   pass_type_enum.insert("mist", PASS_MIST);
   pass_type_enum.insert("emission", PASS_EMISSION);
   pass_type_enum.insert("background", PASS_BACKGROUND);
@@ -210,8 +211,9 @@ void Pass::add(PassType type, vector<Pass> &passes, const char *name)
       break;
 #endif
     case PASS_RENDER_TIME:
-      /* This pass is handled entirely on the host side. */
-      pass.components = 0;
+      /* Measured per pixel by the CPU device, other devices only measure the time per tile. */
+      pass.components = 1;
+      pass.filter = false;
       break;
 
     case PASS_DIFFUSE_COLOR:
@@ -252,6 +254,10 @@ void Pass::add(PassType type, vector<Pass> &passes, const char *name)
       pass.components = 1;
       pass.exposure = false;
       break;
+    case PASS_ADAPTIVE_ERROR:
+      pass.components = 1;
+      pass.filter = false;
+      break;
     case PASS_AOV_COLOR:
       pass.components = 4;
       break;
@@ -453,6 +459,8 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
   kfilm->pass_stride = 0;
   kfilm->use_light_pass = use_light_visibility;
   kfilm->pass_aov_value_num = 0;
+  kfilm->pass_adaptive_error = 0;
+  kfilm->pass_render_time = 0;
   kfilm->pass_aov_color_num = 0;
 
   bool have_cryptomatte = false;
@@ -585,6 +593,7 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
         break;
 #endif
       case PASS_RENDER_TIME:
+        kfilm->pass_render_time = kfilm->pass_stride;
         break;
       case PASS_CRYPTOMATTE:
         kfilm->pass_cryptomatte = have_cryptomatte ?
@@ -598,6 +607,9 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
       case PASS_SAMPLE_COUNT:
         kfilm->pass_sample_count = kfilm->pass_stride;
         break;
+      case PASS_ADAPTIVE_ERROR:
+        kfilm->pass_adaptive_error = kfilm->pass_stride;
+        break;
       case PASS_AOV_COLOR:
         if (kfilm->pass_aov_color_num == 0) {
           kfilm->pass_aov_color = kfilm->pass_stride;
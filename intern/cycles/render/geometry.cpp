@@ -40,7 +40,9 @@
 
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
+#include "util/util_mmap.h"
 #include "util/util_progress.h"
+#include "util/util_string.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -61,6 +63,7 @@ Geometry::Geometry(const NodeType *node_type, const Type type)
     : Node(node_type), geometry_type(type), attributes(this, ATTR_PRIM_GEOMETRY)
 {
   need_update_rebuild = false;
+  need_repack = true;
 
   transform_applied = false;
   transform_negative_scaled = false;
@@ -74,6 +77,11 @@ Geometry::Geometry(const NodeType *node_type, const Type type)
   attr_map_offset = 0;
   optix_prim_offset = 0;
   prim_offset = 0;
+
+  attr_float_offset = 0;
+  attr_float2_offset = 0;
+  attr_float3_offset = 0;
+  attr_uchar4_offset = 0;
 }
 
 Geometry::~Geometry()
@@ -193,6 +201,14 @@ void Geometry::compute_bvh(
   if (progress->get_cancel())
     return;
 
+  if (is_hair()) {
+    /* Bounds must contain the curves intersected with the quantized keys. */
+    Hair *hair = static_cast<Hair *>(this);
+    hair->curve_keys_padding = (params->hair_compression) ?
+                                   hair->curve_keys_quantization_padding() :
+                                   0.0f;
+  }
+
   compute_bounds();
 
   const BVHLayout bvh_layout = BVHParams::best_bvh_layout(params->bvh_layout,
@@ -285,6 +301,9 @@ GeometryManager::GeometryManager()
 {
   need_update = true;
   need_flags_update = true;
+  packed_arrays_valid = false;
+  num_bvh_built = 0;
+  num_bvh_refit = 0;
 }
 
 GeometryManager::~GeometryManager()
@@ -568,7 +587,8 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
                                                       Attribute *mattr,
                                                       AttributePrimitive prim,
                                                       TypeDesc &type,
-                                                      AttributeDescriptor &desc)
+                                                      AttributeDescriptor &desc,
+                                                      bool copy_data)
 {
   if (mattr) {
     /* store element and type */
@@ -592,8 +612,10 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
       offset = attr_uchar4_offset;
 
       assert(attr_uchar4.size() >= offset + size);
-      for (size_t k = 0; k < size; k++) {
-        attr_uchar4[offset + k] = data[k];
+      if (copy_data) {
+        for (size_t k = 0; k < size; k++) {
+          attr_uchar4[offset + k] = data[k];
+        }
       }
       attr_uchar4_offset += size;
     }
@@ -602,8 +624,10 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
       offset = attr_float_offset;
 
       assert(attr_float.size() >= offset + size);
-      for (size_t k = 0; k < size; k++) {
-        attr_float[offset + k] = data[k];
+      if (copy_data) {
+        for (size_t k = 0; k < size; k++) {
+          attr_float[offset + k] = data[k];
+        }
       }
       attr_float_offset += size;
     }
@@ -612,8 +636,10 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
       offset = attr_float2_offset;
 
       assert(attr_float2.size() >= offset + size);
-      for (size_t k = 0; k < size; k++) {
-        attr_float2[offset + k] = data[k];
+      if (copy_data) {
+        for (size_t k = 0; k < size; k++) {
+          attr_float2[offset + k] = data[k];
+        }
       }
       attr_float2_offset += size;
     }
@@ -622,8 +648,10 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
       offset = attr_float3_offset;
 
       assert(attr_float3.size() >= offset + size * 3);
-      for (size_t k = 0; k < size * 3; k++) {
-        attr_float3[offset + k] = (&tfm->x)[k];
+      if (copy_data) {
+        for (size_t k = 0; k < size * 3; k++) {
+          attr_float3[offset + k] = (&tfm->x)[k];
+        }
       }
       attr_float3_offset += size * 3;
     }
@@ -632,8 +660,10 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
       offset = attr_float3_offset;
 
       assert(attr_float3.size() >= offset + size);
-      for (size_t k = 0; k < size; k++) {
-        attr_float3[offset + k] = data[k];
+      if (copy_data) {
+        for (size_t k = 0; k < size; k++) {
+          attr_float3[offset + k] = data[k];
+        }
       }
       attr_float3_offset += size;
     }
@@ -693,6 +723,9 @@ void GeometryManager::device_update_attributes(Device *device,
    * been set per shader by the shader manager */
   vector<AttributeRequestSet> geom_attributes(scene->geometry.size());
 
+  AttributeRequestSet global_attributes;
+  scene->need_global_attributes(global_attributes);
+
   for (size_t i = 0; i < scene->geometry.size(); i++) {
     Geometry *geom = scene->geometry[i];
 
@@ -793,6 +826,15 @@ void GeometryManager::device_update_attributes(Device *device,
     }
   }
 
+  /* Data of geometry that did not change or move is still in place, unless the arrays
+   * are reallocated or the requests changed for all geometry at once. */
+  const bool copy_all = global_attributes.modified(packed_global_attributes) ||
+                        dscene->attributes_float.size() != attr_float_size ||
+                        dscene->attributes_float2.size() != attr_float2_size ||
+                        dscene->attributes_float3.size() != attr_float3_size ||
+                        dscene->attributes_uchar4.size() != attr_uchar4_size;
+  bool copy_to_device = copy_all;
+
   dscene->attributes_float.alloc(attr_float_size);
   dscene->attributes_float2.alloc(attr_float2_size);
   dscene->attributes_float3.alloc(attr_float3_size);
@@ -808,6 +850,21 @@ void GeometryManager::device_update_attributes(Device *device,
     Geometry *geom = scene->geometry[i];
     AttributeRequestSet &attributes = geom_attributes[i];
 
+    const bool copy_data = copy_all || geom->need_repack ||
+                           geom->attr_float_offset != attr_float_offset ||
+                           geom->attr_float2_offset != attr_float2_offset ||
+                           geom->attr_float3_offset != attr_float3_offset ||
+                           geom->attr_uchar4_offset != attr_uchar4_offset;
+
+    geom->attr_float_offset = attr_float_offset;
+    geom->attr_float2_offset = attr_float2_offset;
+    geom->attr_float3_offset = attr_float3_offset;
+    geom->attr_uchar4_offset = attr_uchar4_offset;
+
+    if (copy_data && attributes.size()) {
+      copy_to_device = true;
+    }
+
     /* todo: we now store std and name attributes from requests even if
      * they actually refer to the same mesh attributes, optimize */
     foreach (AttributeRequest &req, attributes.requests) {
@@ -824,7 +881,8 @@ void GeometryManager::device_update_attributes(Device *device,
                                       attr,
                                       ATTR_PRIM_GEOMETRY,
                                       req.type,
-                                      req.desc);
+                                      req.desc,
+                                      copy_data);
 
       if (geom->is_mesh()) {
         Mesh *mesh = static_cast<Mesh *>(geom);
@@ -842,7 +900,8 @@ void GeometryManager::device_update_attributes(Device *device,
                                         subd_attr,
                                         ATTR_PRIM_SUBD,
                                         req.subd_type,
-                                        req.subd_desc);
+                                        req.subd_desc,
+                                        copy_data);
       }
 
       if (progress.get_cancel())
@@ -855,6 +914,11 @@ void GeometryManager::device_update_attributes(Device *device,
     AttributeRequestSet &attributes = object_attributes[i];
     AttributeSet &values = object_attribute_values[i];
 
+    /* Object attributes are few and not tracked, always copy them. */
+    if (attributes.size()) {
+      copy_to_device = true;
+    }
+
     foreach (AttributeRequest &req, attributes.requests) {
       Attribute *attr = values.find(req);
 
@@ -870,7 +934,8 @@ void GeometryManager::device_update_attributes(Device *device,
                                       attr,
                                       ATTR_PRIM_GEOMETRY,
                                       req.type,
-                                      req.desc);
+                                      req.desc,
+                                      true);
 
       /* object attributes don't care about subdivision */
       req.subd_type = req.type;
@@ -893,19 +958,23 @@ void GeometryManager::device_update_attributes(Device *device,
   /* copy to device */
   progress.set_status("Updating Mesh", "Copying Attributes to device");
 
-  if (dscene->attributes_float.size()) {
-    dscene->attributes_float.copy_to_device();
-  }
-  if (dscene->attributes_float2.size()) {
-    dscene->attributes_float2.copy_to_device();
-  }
-  if (dscene->attributes_float3.size()) {
-    dscene->attributes_float3.copy_to_device();
-  }
-  if (dscene->attributes_uchar4.size()) {
-    dscene->attributes_uchar4.copy_to_device();
+  if (copy_to_device) {
+    if (dscene->attributes_float.size()) {
+      dscene->attributes_float.copy_to_device();
+    }
+    if (dscene->attributes_float2.size()) {
+      dscene->attributes_float2.copy_to_device();
+    }
+    if (dscene->attributes_float3.size()) {
+      dscene->attributes_float3.copy_to_device();
+    }
+    if (dscene->attributes_uchar4.size()) {
+      dscene->attributes_uchar4.copy_to_device();
+    }
   }
 
+  packed_global_attributes = global_attributes;
+
   if (progress.get_cancel())
     return;
 
@@ -928,10 +997,19 @@ void GeometryManager::mesh_calc_offset(Scene *scene)
 
   size_t optix_prim_size = 0;
 
+  /* Offsets are running sums in scene order, so they only change for geometry after
+   * one that was resized, added or removed. Packed data of geometry whose offsets stay
+   * the same can be kept as is. */
   foreach (Geometry *geom, scene->geometry) {
     if (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME) {
       Mesh *mesh = static_cast<Mesh *>(geom);
 
+      if (mesh->vert_offset != vert_size || mesh->prim_offset != tri_size ||
+          mesh->patch_offset != patch_size || mesh->face_offset != face_size ||
+          mesh->corner_offset != corner_size) {
+        mesh->need_repack = true;
+      }
+
       mesh->vert_offset = vert_size;
       mesh->prim_offset = tri_size;
 
@@ -948,6 +1026,9 @@ void GeometryManager::mesh_calc_offset(Scene *scene)
 
         /* patch tables are stored in same array so include them in patch_size */
         if (mesh->patch_table) {
+          if (mesh->patch_table_offset != patch_size) {
+            mesh->need_repack = true;
+          }
           mesh->patch_table_offset = patch_size;
           patch_size += mesh->patch_table->total_size();
         }
@@ -962,6 +1043,10 @@ void GeometryManager::mesh_calc_offset(Scene *scene)
     else if (geom->is_hair()) {
       Hair *hair = static_cast<Hair *>(geom);
 
+      if (hair->curvekey_offset != curve_key_size || hair->prim_offset != curve_size) {
+        hair->need_repack = true;
+      }
+
       hair->curvekey_offset = curve_key_size;
       hair->prim_offset = curve_size;
 
@@ -1037,11 +1122,20 @@ void GeometryManager::device_update_mesh(
     }
   }
 
-  /* Fill in all the arrays. */
+  /* Shader ids are indices into the scene shader list, so the packed ids of all geometry
+   * change along with it. */
+  const bool shaders_modified = (packed_shaders != scene->shaders);
+
+  /* Fill in the arrays. Only geometry that was modified or moved is packed again, the
+   * rest of the data is still in place unless the arrays had to be reallocated. */
   if (tri_size != 0) {
     /* normals */
     progress.set_status("Updating Mesh", "Computing normals");
 
+    const bool pack_all = shaders_modified || dscene->tri_shader.size() != tri_size ||
+                          dscene->tri_vnormal.size() != vert_size;
+    bool repacked = pack_all;
+
     uint *tri_shader = dscene->tri_shader.alloc(tri_size);
     float4 *vnormal = dscene->tri_vnormal.alloc(vert_size);
     uint4 *tri_vindex = dscene->tri_vindex.alloc(tri_size);
@@ -1051,6 +1145,9 @@ void GeometryManager::device_update_mesh(
     foreach (Geometry *geom, scene->geometry) {
       if (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME) {
         Mesh *mesh = static_cast<Mesh *>(geom);
+        if (!(pack_all || mesh->need_repack)) {
+          continue;
+        }
         mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
         mesh->pack_normals(&vnormal[mesh->vert_offset]);
         mesh->pack_verts(tri_prim_index,
@@ -1059,51 +1156,130 @@ void GeometryManager::device_update_mesh(
                          &tri_patch_uv[mesh->vert_offset],
                          mesh->vert_offset,
                          mesh->prim_offset);
+        repacked = true;
         if (progress.get_cancel())
           return;
       }
     }
 
+    /* The primitive array index changes with every BVH build, including for geometry
+     * that was not packed again. */
+    bool vindex_modified = repacked;
+    for (size_t i = 0; i < tri_size; i++) {
+      if (tri_vindex[i].w != tri_prim_index[i]) {
+        tri_vindex[i].w = tri_prim_index[i];
+        vindex_modified = true;
+      }
+    }
+
     /* vertex coordinates */
     progress.set_status("Updating Mesh", "Copying Mesh to device");
 
-    dscene->tri_shader.copy_to_device();
-    dscene->tri_vnormal.copy_to_device();
-    dscene->tri_vindex.copy_to_device();
-    dscene->tri_patch.copy_to_device();
-    dscene->tri_patch_uv.copy_to_device();
+    if (repacked) {
+      dscene->tri_shader.copy_to_device();
+      dscene->tri_vnormal.copy_to_device();
+      dscene->tri_patch.copy_to_device();
+      dscene->tri_patch_uv.copy_to_device();
+    }
+    if (vindex_modified) {
+      dscene->tri_vindex.copy_to_device();
+    }
+  }
+  else {
+    dscene->tri_shader.free();
+    dscene->tri_vnormal.free();
+    dscene->tri_vindex.free();
+    dscene->tri_patch.free();
+    dscene->tri_patch_uv.free();
   }
 
   if (curve_size != 0) {
     progress.set_status("Updating Mesh", "Copying Strands to device");
 
-    float4 *curve_keys = dscene->curve_keys.alloc(curve_key_size);
+    const bool use_quantized = scene->params.hair_compression;
+    const size_t curve_keys_packed_size = (use_quantized) ?
+                                              dscene->curve_keys_quantized.size() :
+                                              dscene->curve_keys.size();
+    const bool pack_all = shaders_modified || curve_keys_packed_size != curve_key_size ||
+                          dscene->curves.size() != curve_size;
+    bool repacked = pack_all;
+
+    float4 *curve_keys = NULL;
+    ushort4 *curve_keys_quantized = NULL;
+    float4 *curve_bounds = NULL;
+    if (use_quantized) {
+      curve_keys_quantized = dscene->curve_keys_quantized.alloc(curve_key_size);
+      curve_bounds = dscene->curve_bounds.alloc(curve_size);
+      dscene->curve_keys.free();
+    }
+    else {
+      curve_keys = dscene->curve_keys.alloc(curve_key_size);
+      dscene->curve_keys_quantized.free();
+      dscene->curve_bounds.free();
+    }
     float4 *curves = dscene->curves.alloc(curve_size);
 
     foreach (Geometry *geom, scene->geometry) {
       if (geom->is_hair()) {
         Hair *hair = static_cast<Hair *>(geom);
+        if (!(pack_all || hair->need_repack)) {
+          continue;
+        }
         hair->pack_curves(scene,
-                          &curve_keys[hair->curvekey_offset],
+                          (curve_keys) ? &curve_keys[hair->curvekey_offset] : NULL,
                           &curves[hair->prim_offset],
                           hair->curvekey_offset);
+        if (use_quantized) {
+          hair->pack_curve_keys_quantized(&curve_keys_quantized[hair->curvekey_offset],
+                                          &curve_bounds[hair->prim_offset],
+                                          &curves[hair->prim_offset]);
+        }
+        repacked = true;
         if (progress.get_cancel())
           return;
       }
     }
 
-    dscene->curve_keys.copy_to_device();
-    dscene->curves.copy_to_device();
+    if (repacked) {
+      if (use_quantized) {
+        dscene->curve_keys_quantized.copy_to_device();
+        dscene->curve_bounds.copy_to_device();
+
+        VLOG(1) << "Quantized " << curve_key_size << " curve keys to "
+                << string_human_readable_size(dscene->curve_keys_quantized.memory_size() +
+                                              dscene->curve_bounds.memory_size())
+                << ", full precision keys would use "
+                << string_human_readable_size(curve_key_size * sizeof(float4)) << ".";
+      }
+      else {
+        dscene->curve_keys.copy_to_device();
+      }
+      dscene->curves.copy_to_device();
+    }
+
+    dscene->data.bvh.curve_keys_quantized = use_quantized;
+  }
+  else {
+    dscene->curve_keys.free();
+    dscene->curve_keys_quantized.free();
+    dscene->curve_bounds.free();
+    dscene->curves.free();
   }
 
   if (patch_size != 0) {
     progress.set_status("Updating Mesh", "Copying Patches to device");
 
+    const bool pack_all = dscene->patches.size() != patch_size;
+    bool repacked = pack_all;
+
     uint *patch_data = dscene->patches.alloc(patch_size);
 
     foreach (Geometry *geom, scene->geometry) {
       if (geom->is_mesh()) {
         Mesh *mesh = static_cast<Mesh *>(geom);
+        if (!(pack_all || mesh->need_repack)) {
+          continue;
+        }
         mesh->pack_patches(&patch_data[mesh->patch_offset],
                            mesh->vert_offset,
                            mesh->face_offset,
@@ -1113,13 +1289,19 @@ void GeometryManager::device_update_mesh(
           mesh->patch_table->copy_adjusting_offsets(&patch_data[mesh->patch_table_offset],
                                                     mesh->patch_table_offset);
         }
+        repacked = true;
 
         if (progress.get_cancel())
           return;
       }
     }
 
-    dscene->patches.copy_to_device();
+    if (repacked) {
+      dscene->patches.copy_to_device();
+    }
+  }
+  else {
+    dscene->patches.free();
   }
 
   if (for_displacement) {
@@ -1138,6 +1320,55 @@ void GeometryManager::device_update_mesh(
     }
     dscene->prim_tri_verts.copy_to_device();
   }
+
+  packed_shaders = scene->shaders;
+}
+
+bool GeometryManager::can_keep_bvh_instances(Scene *scene, BVHLayout bvh_layout)
+{
+  if (bvh_layout != BVH_LAYOUT_BVH2 || bvh_instances.geometry.empty()) {
+    return false;
+  }
+
+  /* Same order as BVH::pack_instances(). */
+  set<Geometry *> merged_geometry;
+  size_t num_instances = 0;
+
+  foreach (Object *object, scene->objects) {
+    Geometry *geom = object->get_geometry();
+
+    if (!geom->need_build_bvh(bvh_layout) || !merged_geometry.insert(geom).second) {
+      continue;
+    }
+
+    /* The object BVH is rebuilt or refit for modified geometry, and primitive indices
+     * of the merged BVH change along with the geometry offsets. */
+    if (num_instances >= bvh_instances.geometry.size() ||
+        bvh_instances.geometry[num_instances] != geom || geom->need_repack) {
+      return false;
+    }
+
+    num_instances++;
+  }
+
+  return num_instances == bvh_instances.geometry.size();
+}
+
+/* Copy the top level part of a BVH2 array after the object BVHs kept in place. */
+template<typename T>
+static void copy_bvh_after_instances(device_vector<T> &dst, array<T> &src, size_t offset)
+{
+  if (src.size() == 0) {
+    dst.free();
+    return;
+  }
+
+  assert(offset <= src.size() && offset <= dst.size());
+  T *data = dst.resize(src.size());
+  if (src.size() > offset) {
+    memcpy(data + offset, src.data() + offset, sizeof(T) * (src.size() - offset));
+  }
+  dst.copy_to_device();
 }
 
 void GeometryManager::device_update_bvh(Device *device,
@@ -1163,6 +1394,14 @@ void GeometryManager::device_update_bvh(Device *device,
   VLOG(1) << "Using " << bvh_layout_name(bparams.bvh_layout) << " layout.";
 
   BVH *bvh = BVH::create(bparams, scene->geometry, scene->objects, device);
+
+  /* Object BVHs are still in the device arrays if only the top level changed. */
+  const bool instances_in_place = !bvh_instances.geometry.empty();
+  if (instances_in_place) {
+    VLOG(1) << "Reusing " << bvh_instances.geometry.size() << " object BVHs in place.";
+    bvh->use_packed_instances(bvh_instances);
+  }
+
   bvh->build(progress, &device->stats);
 
   if (progress.get_cancel()) {
@@ -1181,45 +1420,67 @@ void GeometryManager::device_update_bvh(Device *device,
 
   PackedBVH &pack = bvh->pack;
 
-  if (pack.nodes.size()) {
-    dscene->bvh_nodes.steal_data(pack.nodes);
-    dscene->bvh_nodes.copy_to_device();
-  }
-  if (pack.leaf_nodes.size()) {
-    dscene->bvh_leaf_nodes.steal_data(pack.leaf_nodes);
-    dscene->bvh_leaf_nodes.copy_to_device();
+  if (instances_in_place) {
+    const PackedBVHInstances &instances = bvh->instances;
+    const size_t prim_offset = instances.prim_index_size;
+
+    copy_bvh_after_instances(dscene->bvh_nodes, pack.nodes, instances.nodes_size);
+    copy_bvh_after_instances(dscene->bvh_leaf_nodes, pack.leaf_nodes, instances.leaf_nodes_size);
+    copy_bvh_after_instances(dscene->object_node, pack.object_node, 0);
+    copy_bvh_after_instances(dscene->prim_tri_index, pack.prim_tri_index, prim_offset);
+    copy_bvh_after_instances(
+        dscene->prim_tri_verts, pack.prim_tri_verts, instances.prim_tri_verts_size);
+    copy_bvh_after_instances(dscene->prim_type, pack.prim_type, prim_offset);
+    copy_bvh_after_instances(dscene->prim_visibility, pack.prim_visibility, prim_offset);
+    copy_bvh_after_instances(dscene->prim_index, pack.prim_index, prim_offset);
+    copy_bvh_after_instances(dscene->prim_object, pack.prim_object, prim_offset);
+    copy_bvh_after_instances(dscene->prim_time, pack.prim_time, prim_offset);
   }
-  if (pack.object_node.size()) {
-    dscene->object_node.steal_data(pack.object_node);
-    dscene->object_node.copy_to_device();
-  }
-  if (pack.prim_tri_index.size()) {
-    dscene->prim_tri_index.steal_data(pack.prim_tri_index);
-    dscene->prim_tri_index.copy_to_device();
-  }
-  if (pack.prim_tri_verts.size()) {
-    dscene->prim_tri_verts.steal_data(pack.prim_tri_verts);
-    dscene->prim_tri_verts.copy_to_device();
-  }
-  if (pack.prim_type.size()) {
-    dscene->prim_type.steal_data(pack.prim_type);
-    dscene->prim_type.copy_to_device();
-  }
-  if (pack.prim_visibility.size()) {
-    dscene->prim_visibility.steal_data(pack.prim_visibility);
-    dscene->prim_visibility.copy_to_device();
-  }
-  if (pack.prim_index.size()) {
-    dscene->prim_index.steal_data(pack.prim_index);
-    dscene->prim_index.copy_to_device();
-  }
-  if (pack.prim_object.size()) {
-    dscene->prim_object.steal_data(pack.prim_object);
-    dscene->prim_object.copy_to_device();
-  }
-  if (pack.prim_time.size()) {
-    dscene->prim_time.steal_data(pack.prim_time);
-    dscene->prim_time.copy_to_device();
+  else {
+    if (bparams.bvh_layout == BVH_LAYOUT_BVH2) {
+      bvh_instances = bvh->instances;
+    }
+
+    if (pack.nodes.size()) {
+      dscene->bvh_nodes.steal_data(pack.nodes);
+      dscene->bvh_nodes.copy_to_device();
+    }
+    if (pack.leaf_nodes.size()) {
+      dscene->bvh_leaf_nodes.steal_data(pack.leaf_nodes);
+      dscene->bvh_leaf_nodes.copy_to_device();
+    }
+    if (pack.object_node.size()) {
+      dscene->object_node.steal_data(pack.object_node);
+      dscene->object_node.copy_to_device();
+    }
+    if (pack.prim_tri_index.size()) {
+      dscene->prim_tri_index.steal_data(pack.prim_tri_index);
+      dscene->prim_tri_index.copy_to_device();
+    }
+    if (pack.prim_tri_verts.size()) {
+      dscene->prim_tri_verts.steal_data(pack.prim_tri_verts);
+      dscene->prim_tri_verts.copy_to_device();
+    }
+    if (pack.prim_type.size()) {
+      dscene->prim_type.steal_data(pack.prim_type);
+      dscene->prim_type.copy_to_device();
+    }
+    if (pack.prim_visibility.size()) {
+      dscene->prim_visibility.steal_data(pack.prim_visibility);
+      dscene->prim_visibility.copy_to_device();
+    }
+    if (pack.prim_index.size()) {
+      dscene->prim_index.steal_data(pack.prim_index);
+      dscene->prim_index.copy_to_device();
+    }
+    if (pack.prim_object.size()) {
+      dscene->prim_object.steal_data(pack.prim_object);
+      dscene->prim_object.copy_to_device();
+    }
+    if (pack.prim_time.size()) {
+      dscene->prim_time.steal_data(pack.prim_time);
+      dscene->prim_time.copy_to_device();
+    }
   }
 
   dscene->data.bvh.root = pack.root_index;
@@ -1366,6 +1627,9 @@ void GeometryManager::device_update(Device *device,
                                     Scene *scene,
                                     Progress &progress)
 {
+  num_bvh_built = 0;
+  num_bvh_refit = 0;
+
   if (!need_update)
     return;
 
@@ -1374,6 +1638,13 @@ void GeometryManager::device_update(Device *device,
   bool true_displacement_used = false;
   size_t total_tess_needed = 0;
 
+  /* Packed arrays can only be partially updated if the previous update completed. */
+  const bool pack_all = !packed_arrays_valid;
+  packed_arrays_valid = false;
+
+  /* Large arrays are allocated in memory mapped files, so they are never fully in memory. */
+  device_update_out_of_core(device, dscene, scene, false);
+
   {
     scoped_callback_timer timer([scene](double time) {
       if (scene->update_stats) {
@@ -1388,6 +1659,8 @@ void GeometryManager::device_update(Device *device,
           geom->tag_modified();
       }
 
+      geom->need_repack = pack_all || geom->is_modified();
+
       if (geom->is_modified() &&
           (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME)) {
         Mesh *mesh = static_cast<Mesh *>(geom);
@@ -1456,6 +1729,9 @@ void GeometryManager::device_update(Device *device,
         DiagSplit dsplit(*mesh->subd_params);
         mesh->tessellate(&dsplit);
 
+        VLOG(2) << "Tessellated " << mesh->name << ", split " << dsplit.num_faces_reused << " of "
+                << mesh->get_num_subd_faces() << " faces as in the previous tessellation.";
+
         i++;
 
         if (progress.get_cancel()) {
@@ -1484,9 +1760,16 @@ void GeometryManager::device_update(Device *device,
   }
 
   /* Device update. */
-  device_free(device, dscene);
-
   mesh_calc_offset(scene);
+
+  BVHLayout bvh_layout = BVHParams::best_bvh_layout(scene->params.bvh_layout,
+                                                    device->get_bvh_layout_mask());
+
+  /* Displacement overwrites the triangle vertices of the BVH arrays. */
+  const bool keep_bvh_instances = !true_displacement_used &&
+                                  can_keep_bvh_instances(scene, bvh_layout);
+  device_free_bvh(dscene, keep_bvh_instances);
+
   if (true_displacement_used) {
     scoped_callback_timer timer([scene](double time) {
       if (scene->update_stats) {
@@ -1513,8 +1796,6 @@ void GeometryManager::device_update(Device *device,
   }
 
   /* Update displacement. */
-  BVHLayout bvh_layout = BVHParams::best_bvh_layout(scene->params.bvh_layout,
-                                                    device->get_bvh_layout_mask());
   bool displacement_done = false;
   size_t num_bvh = 0;
 
@@ -1557,7 +1838,7 @@ void GeometryManager::device_update(Device *device,
             {"device_update (displacement: attributes)", time});
       }
     });
-    device_free(device, dscene);
+    device_free_bvh(dscene, false);
 
     device_update_attributes(device, dscene, scene, progress);
     if (progress.get_cancel()) {
@@ -1576,6 +1857,15 @@ void GeometryManager::device_update(Device *device,
     size_t i = 0;
     foreach (Geometry *geom, scene->geometry) {
       if (geom->is_modified()) {
+        if (geom->need_build_bvh(bvh_layout)) {
+          /* Same test as in compute_bvh(), done here so no counting is needed in the tasks. */
+          if (geom->bvh && !geom->need_update_rebuild) {
+            num_bvh_refit++;
+          }
+          else {
+            num_bvh_built++;
+          }
+        }
         pool.push(function_bind(
             &Geometry::compute_bvh, geom, device, dscene, &scene->params, &progress, i, num_bvh));
         if (geom->need_build_bvh(bvh_layout)) {
@@ -1638,7 +1928,18 @@ void GeometryManager::device_update(Device *device,
     }
   }
 
+  {
+    scoped_callback_timer timer([scene](double time) {
+      if (scene->update_stats) {
+        scene->update_stats->geometry.times.add_entry(
+            {"device_update (out-of-core geometry)", time});
+      }
+    });
+    device_update_out_of_core(device, dscene, scene, true);
+  }
+
   need_update = false;
+  packed_arrays_valid = true;
 
   if (true_displacement_used) {
     /* Re-tag flags for update, so they're re-evaluated
@@ -1651,7 +1952,92 @@ void GeometryManager::device_update(Device *device,
   }
 }
 
-void GeometryManager::device_free(Device *device, DeviceScene *dscene)
+void GeometryManager::device_update_out_of_core(Device *device,
+                                                DeviceScene *dscene,
+                                                Scene *scene,
+                                                const bool packed)
+{
+  /* Only the CPU renders from host memory directly, other devices have their own copy. */
+  const bool use_out_of_core = scene->params.use_out_of_core_geometry &&
+                               device->info.type == DEVICE_CPU;
+
+  device_memory *geometry_arrays[] = {&dscene->bvh_nodes,
+                                      &dscene->bvh_leaf_nodes,
+                                      &dscene->prim_tri_index,
+                                      &dscene->prim_tri_verts,
+                                      &dscene->prim_type,
+                                      &dscene->prim_visibility,
+                                      &dscene->prim_index,
+                                      &dscene->prim_object,
+                                      &dscene->prim_time,
+                                      &dscene->tri_shader,
+                                      &dscene->tri_vnormal,
+                                      &dscene->tri_vindex,
+                                      &dscene->tri_patch,
+                                      &dscene->tri_patch_uv,
+                                      &dscene->curves,
+                                      &dscene->curve_keys,
+                                      &dscene->curve_keys_quantized,
+                                      &dscene->curve_bounds,
+                                      &dscene->patches,
+                                      &dscene->attributes_float,
+                                      &dscene->attributes_float2,
+                                      &dscene->attributes_float3,
+                                      &dscene->attributes_uchar4};
+
+  const size_t threshold = (size_t)scene->params.out_of_core_geometry_threshold * 1024 * 1024;
+
+  /* Before packing, set up arrays to be allocated in files directly. */
+  if (!packed) {
+    if (use_out_of_core && util_mmap_dir_in_memory(scene->params.out_of_core_geometry_path)) {
+      LOG(WARNING) << "Out-of-core geometry directory \""
+                   << scene->params.out_of_core_geometry_path
+                   << "\" is kept in memory, choose a directory on disk to save memory.";
+    }
+    for (device_memory *mem : geometry_arrays) {
+      mem->host_map_allocations(
+          use_out_of_core, scene->params.out_of_core_geometry_path, threshold);
+    }
+    return;
+  }
+
+  if (!use_out_of_core) {
+    return;
+  }
+
+  /* Arrays taken over from the BVH build with steal_data() are moved to files after packing.
+   * The others are already mapped, unless mapping failed. */
+  size_t mapped_size = 0, total_size = 0;
+
+  for (device_memory *mem : geometry_arrays) {
+    total_size += mem->memory_size();
+    if (!mem->is_host_mapped()) {
+      if (mem->memory_size() == 0 || mem->memory_size() < threshold) {
+        continue;
+      }
+      if (!mem->host_map_to_file(scene->params.out_of_core_geometry_path)) {
+        /* Keep rendering from memory, it may still fit. */
+        VLOG(1) << "Failed to map " << mem->name << " to a file in \""
+                << scene->params.out_of_core_geometry_path << "\".";
+        continue;
+      }
+    }
+
+    VLOG(2) << "Out-of-core " << mem->name << ", "
+            << string_human_readable_size(mem->memory_size()) << ".";
+    mapped_size += mem->memory_size();
+  }
+
+  /* The host geometry arrays and the Embree BVH with its vertex and index copies are not part
+   * of these arrays and stay in memory. */
+  const size_t mem_used = device->stats.mem_used;
+  const size_t resident_size = (mem_used > mapped_size) ? mem_used - mapped_size : 0;
+  VLOG(1) << "Out-of-core geometry " << string_human_readable_size(mapped_size) << " of "
+          << string_human_readable_size(total_size) << " in device arrays, "
+          << string_human_readable_size(resident_size) << " of device memory stays in memory.";
+}
+
+void GeometryManager::device_free_bvh(DeviceScene *dscene, bool keep_instances)
 {
 #ifdef WITH_EMBREE
   if (dscene->data.bvh.scene) {
@@ -1661,16 +2047,29 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene)
   }
 #endif
 
-  dscene->bvh_nodes.free();
-  dscene->bvh_leaf_nodes.free();
-  dscene->object_node.free();
-  dscene->prim_tri_verts.free();
-  dscene->prim_tri_index.free();
-  dscene->prim_type.free();
-  dscene->prim_visibility.free();
-  dscene->prim_index.free();
-  dscene->prim_object.free();
-  dscene->prim_time.free();
+  if (!keep_instances) {
+    dscene->bvh_nodes.free();
+    dscene->bvh_leaf_nodes.free();
+    dscene->object_node.free();
+    dscene->prim_tri_verts.free();
+    dscene->prim_tri_index.free();
+    dscene->prim_type.free();
+    dscene->prim_visibility.free();
+    dscene->prim_index.free();
+    dscene->prim_object.free();
+    dscene->prim_time.free();
+
+    bvh_instances.clear();
+  }
+
+  /* Signal for shaders like displacement not to do ray tracing. */
+  dscene->data.bvh.bvh_layout = BVH_LAYOUT_NONE;
+}
+
+void GeometryManager::device_free(Device *device, DeviceScene *dscene)
+{
+  device_free_bvh(dscene, false);
+
   dscene->tri_shader.free();
   dscene->tri_vnormal.free();
   dscene->tri_vindex.free();
@@ -1678,6 +2077,8 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene)
   dscene->tri_patch_uv.free();
   dscene->curves.free();
   dscene->curve_keys.free();
+  dscene->curve_keys_quantized.free();
+  dscene->curve_bounds.free();
   dscene->patches.free();
   dscene->attributes_map.free();
   dscene->attributes_float.free();
@@ -1685,8 +2086,7 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene)
   dscene->attributes_float3.free();
   dscene->attributes_uchar4.free();
 
-  /* Signal for shaders like displacement not to do ray tracing. */
-  dscene->data.bvh.bvh_layout = BVH_LAYOUT_NONE;
+  packed_arrays_valid = false;
 
 #ifdef WITH_OSL
   OSLGlobals *og = (OSLGlobals *)device->osl_memory();
@@ -1707,12 +2107,44 @@ void GeometryManager::tag_update(Scene *scene)
   scene->object_manager->need_update = true;
 }
 
-void GeometryManager::collect_statistics(const Scene *scene, RenderStats *stats)
+void GeometryManager::collect_statistics(Scene *scene, RenderStats *stats)
 {
   foreach (Geometry *geometry, scene->geometry) {
     stats->mesh.geometry.add_entry(
         NamedSizeEntry(string(geometry->name.c_str()), geometry->get_total_size_in_bytes()));
   }
+
+  /* Packed BVH arrays, BVHs built by Embree or OptiX live on the device and
+   * are not included here. */
+  DeviceScene *dscene = &scene->dscene;
+  NamedSizeStats &bvh = stats->mesh.bvh;
+  bvh.add_entry(NamedSizeEntry("Nodes", dscene->bvh_nodes.memory_size()));
+  bvh.add_entry(NamedSizeEntry("Leaf nodes", dscene->bvh_leaf_nodes.memory_size()));
+  bvh.add_entry(NamedSizeEntry("Object nodes", dscene->object_node.memory_size()));
+  bvh.add_entry(NamedSizeEntry("Triangle vertices",
+                               dscene->prim_tri_verts.memory_size() +
+                                   dscene->prim_tri_index.memory_size()));
+  bvh.add_entry(NamedSizeEntry("Primitives",
+                               dscene->prim_type.memory_size() +
+                                   dscene->prim_visibility.memory_size() +
+                                   dscene->prim_index.memory_size() +
+                                   dscene->prim_object.memory_size() +
+                                   dscene->prim_time.memory_size()));
+
+  const BVHLayout bvh_layout = BVHParams::best_bvh_layout(
+      scene->params.bvh_layout, scene->device->get_bvh_layout_mask());
+  size_t num_bvh = 0;
+  foreach (Geometry *geometry, scene->geometry) {
+    if (geometry->need_build_bvh(bvh_layout)) {
+      num_bvh++;
+    }
+  }
+
+  stats->mesh.num_bvh_built = num_bvh_built;
+  stats->mesh.num_bvh_refit = num_bvh_refit;
+  stats->mesh.num_bvh_reused = (num_bvh > num_bvh_built + num_bvh_refit) ?
+                                   num_bvh - num_bvh_built - num_bvh_refit :
+                                   0;
 }
 
 CCL_NAMESPACE_END
@@ -19,6 +19,7 @@
 
 #include "graph/node.h"
 
+#include "bvh/bvh.h"
 #include "bvh/bvh_params.h"
 
 #include "render/attribute.h"
@@ -87,9 +88,20 @@ class Geometry : public Node {
   bool has_volume;         /* Set in the device_update_flags(). */
   bool has_surface_bssrdf; /* Set in the device_update_flags(). */
 
+  /* Offsets of this geometry's data in the packed attribute arrays at the last
+   * device update, used to detect when the data has to be copied again. */
+  size_t attr_float_offset;
+  size_t attr_float2_offset;
+  size_t attr_float3_offset;
+  size_t attr_uchar4_offset;
+
   /* Update Flags */
   bool need_update_rebuild;
 
+  /* Set in device_update() when the packed device arrays of this geometry are out of
+   * date, either because it was modified or because its offsets changed. */
+  bool need_repack;
+
   /* Index into scene->geometry (only valid during update) */
   size_t index;
 
@@ -177,11 +189,20 @@ class GeometryManager {
   void tag_update(Scene *scene);
 
   /* Statistics */
-  void collect_statistics(const Scene *scene, RenderStats *stats);
+  void collect_statistics(Scene *scene, RenderStats *stats);
 
  protected:
   bool displace(Device *device, DeviceScene *dscene, Scene *scene, Mesh *mesh, Progress &progress);
 
+  /* Free the BVH and primitive arrays, which are rebuilt on every update. Mesh and
+   * attribute arrays are kept so unchanged geometry does not have to be packed again,
+   * and so are the object BVHs merged into the BVH2 arrays if keep_instances is set. */
+  void device_free_bvh(DeviceScene *dscene, bool keep_instances);
+
+  /* Test if the object BVHs merged into the BVH2 arrays can stay in place, because the
+   * same geometry BVHs are used in the same order and none of them changed. */
+  bool can_keep_bvh_instances(Scene *scene, BVHLayout bvh_layout);
+
   void create_volume_mesh(Volume *volume, Progress &progress);
 
   /* Attributes */
@@ -216,6 +237,24 @@ class GeometryManager {
 
   void device_update_volume_images(Device *device, Scene *scene, Progress &progress);
 
+  void device_update_out_of_core(Device *device,
+                                 DeviceScene *dscene,
+                                 Scene *scene,
+                                 const bool packed);
+
+  /* State of the last device update, to find out which parts of the packed arrays
+   * are still valid. Everything is packed again if that update did not complete. */
+  bool packed_arrays_valid;
+  AttributeRequestSet packed_global_attributes;
+  vector<Shader *> packed_shaders;
+
+  /* Object BVHs merged into the BVH2 arrays that were kept from the last update. */
+  PackedBVHInstances bvh_instances;
+
+  /* Object BVHs built and refitted in the last update, for statistics. */
+  size_t num_bvh_built;
+  size_t num_bvh_refit;
+
  private:
   static void update_attribute_element_offset(Geometry *geom,
                                               device_vector<float> &attr_float,
@@ -229,7 +268,8 @@ class GeometryManager {
                                               Attribute *mattr,
                                               AttributePrimitive prim,
                                               TypeDesc &type,
-                                              AttributeDescriptor &desc);
+                                              AttributeDescriptor &desc,
+                                              bool copy_data);
 };
 
 CCL_NAMESPACE_END
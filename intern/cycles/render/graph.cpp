@@ -742,6 +742,24 @@ void ShaderGraph::break_cycles(ShaderNode *node, vector<bool> &visited, vector<b
   on_stack[node->id] = false;
 }
 
+static void node_hash(ShaderNode *node, MD5Hash &md5)
+{
+  node->hash(md5);
+  node->hash_runtime(md5);
+  foreach (ShaderInput *input, node->inputs) {
+    int link_id = (input->link) ? input->link->parent->id : 0;
+    md5.append((uint8_t *)&link_id, sizeof(link_id));
+    md5.append((input->link) ? input->link->name().c_str() : "");
+  }
+
+  if (node->special_type == SHADER_SPECIAL_TYPE_OSL) {
+    /* Hash takes into account socket values, to detect changes
+     * in the code of the node we need an exception. */
+    OSLNode *oslnode = static_cast<OSLNode *>(node);
+    md5.append(oslnode->bytecode_hash);
+  }
+}
+
 void ShaderGraph::compute_displacement_hash()
 {
   /* Compute hash of all nodes linked to displacement, to detect if we need
@@ -758,24 +776,24 @@ void ShaderGraph::compute_displacement_hash()
 
   MD5Hash md5;
   foreach (ShaderNode *node, nodes_displace) {
-    node->hash(md5);
-    foreach (ShaderInput *input, node->inputs) {
-      int link_id = (input->link) ? input->link->parent->id : 0;
-      md5.append((uint8_t *)&link_id, sizeof(link_id));
-      md5.append((input->link) ? input->link->name().c_str() : "");
-    }
-
-    if (node->special_type == SHADER_SPECIAL_TYPE_OSL) {
-      /* Hash takes into account socket values, to detect changes
-       * in the code of the node we need an exception. */
-      OSLNode *oslnode = static_cast<OSLNode *>(node);
-      md5.append(oslnode->bytecode_hash);
-    }
+    node_hash(node, md5);
   }
 
   displacement_hash = md5.get_hex();
 }
 
+void ShaderGraph::compute_content_hash()
+{
+  /* Node IDs are assigned in the order nodes are added, so graphs built the
+   * same way get the same hash. */
+  MD5Hash md5;
+  foreach (ShaderNode *node, nodes) {
+    node_hash(node, md5);
+  }
+
+  content_hash = md5.get_hex();
+}
+
 void ShaderGraph::clean(Scene *scene)
 {
   /* Graph simplification */
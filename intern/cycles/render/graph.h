@@ -268,6 +268,12 @@ class ShaderNode : public Node {
    * is to be handled in the subclass.
    */
   virtual bool equals(const ShaderNode &other);
+
+  /* Add runtime state that is not stored in sockets but affects the compiled
+   * nodes, like image handles, to the hash of the node. */
+  virtual void hash_runtime(MD5Hash & /*md5*/)
+  {
+  }
 };
 
 /* Node definition utility macros */
@@ -319,6 +325,9 @@ class ShaderGraph : public NodeOwner {
   bool finalized;
   bool simplified;
   string displacement_hash;
+  /* Hash of all nodes, socket values and links before finalizing, used to share
+   * compiled shaders between identical graphs. */
+  string content_hash;
 
   ShaderGraph();
   ~ShaderGraph();
@@ -335,6 +344,7 @@ class ShaderGraph : public NodeOwner {
 
   void remove_proxy_nodes();
   void compute_displacement_hash();
+  void compute_content_hash();
   void simplify(Scene *scene);
   void finalize(Scene *scene,
                 bool do_bump = false,
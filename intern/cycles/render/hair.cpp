@@ -295,6 +295,7 @@ Hair::Hair() : Geometry(node_type, Geometry::HAIR)
 {
   curvekey_offset = 0;
   curve_shape = CURVE_RIBBON;
+  curve_keys_padding = 0.0f;
 }
 
 Hair::~Hair()
@@ -384,7 +385,7 @@ void Hair::compute_bounds()
 
   if (curve_keys_size > 0) {
     for (size_t i = 0; i < curve_keys_size; i++)
-      bnds.grow(curve_keys[i], curve_radius[i]);
+      bnds.grow(curve_keys[i], curve_radius[i] + curve_keys_padding);
 
     Attribute *curve_attr = attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
     if (use_motion_blur && curve_attr) {
@@ -400,7 +401,7 @@ void Hair::compute_bounds()
 
       /* skip nan or inf coordinates */
       for (size_t i = 0; i < curve_keys_size; i++)
-        bnds.grow_safe(curve_keys[i], curve_radius[i]);
+        bnds.grow_safe(curve_keys[i], curve_radius[i] + curve_keys_padding);
 
       if (use_motion_blur && curve_attr) {
         size_t steps_size = curve_keys.size() * (motion_steps - 1);
@@ -465,8 +466,8 @@ void Hair::pack_curves(Scene *scene,
 {
   size_t curve_keys_size = curve_keys.size();
 
-  /* pack curve keys */
-  if (curve_keys_size) {
+  /* pack curve keys, unless they are quantized */
+  if (curve_keys_size && curve_key_co) {
     float3 *keys_ptr = curve_keys.data();
     float *radius_ptr = curve_radius.data();
 
@@ -492,4 +493,79 @@ void Hair::pack_curves(Scene *scene,
   }
 }
 
+/* Bounds and quantization steps of a curve. The same step is used along all axes, so
+ * quantization does not change the curve direction. */
+static void curve_quantization(const Hair::Curve &curve,
+                               const float3 *keys,
+                               const float *radius,
+                               BoundBox &bounds,
+                               float &step,
+                               float &radius_step)
+{
+  bounds = BoundBox::empty;
+  float max_radius = 0.0f;
+  for (int k = 0; k < curve.num_keys; k++) {
+    bounds.grow(keys[curve.first_key + k]);
+    max_radius = max(max_radius, radius[curve.first_key + k]);
+  }
+
+  step = max3(bounds.size()) / 65535.0f;
+  radius_step = max_radius / 65535.0f;
+}
+
+void Hair::pack_curve_keys_quantized(ushort4 *curve_key_quantized,
+                                     float4 *curve_bounds,
+                                     float4 *curve_data)
+{
+  const float3 *keys_ptr = curve_keys.data();
+  const float *radius_ptr = curve_radius.data();
+  const size_t curve_num = num_curves();
+
+  for (size_t i = 0; i < curve_num; i++) {
+    const Curve curve = get_curve(i);
+    const int first_key = curve.first_key;
+
+    BoundBox bounds;
+    float step, radius_step;
+    curve_quantization(curve, keys_ptr, radius_ptr, bounds, step, radius_step);
+    const float inv_step = (step > 0.0f) ? 1.0f / step : 0.0f;
+    const float inv_radius_step = (radius_step > 0.0f) ? 1.0f / radius_step : 0.0f;
+
+    for (int k = 0; k < curve.num_keys; k++) {
+      const float3 offset = (keys_ptr[first_key + k] - bounds.min) * inv_step;
+      const float radius = max(radius_ptr[first_key + k], 0.0f) * inv_radius_step;
+
+      ushort4 &key = curve_key_quantized[first_key + k];
+      key.x = (uint16_t)clamp((int)(offset.x + 0.5f), 0, 65535);
+      key.y = (uint16_t)clamp((int)(offset.y + 0.5f), 0, 65535);
+      key.z = (uint16_t)clamp((int)(offset.z + 0.5f), 0, 65535);
+      key.w = (uint16_t)clamp((int)(radius + 0.5f), 0, 65535);
+    }
+
+    curve_bounds[i] = make_float4(bounds.min.x, bounds.min.y, bounds.min.z, step);
+    curve_data[i].w = radius_step;
+  }
+}
+
+float Hair::curve_keys_quantization_padding() const
+{
+  const float3 *keys_ptr = curve_keys.data();
+  const float *radius_ptr = curve_radius.data();
+  const size_t curve_num = num_curves();
+  float padding = 0.0f;
+
+  for (size_t i = 0; i < curve_num; i++) {
+    BoundBox bounds;
+    float step, radius_step;
+    curve_quantization(get_curve(i), keys_ptr, radius_ptr, bounds, step, radius_step);
+
+    /* Keys are rounded by at most half a step along each axis, so they move by at most
+     * sqrt(3) / 2 steps, and radii by at most half a radius step. Points on a Catmull-Rom
+     * segment are weighted sums of four keys with absolute weights summing to at most 1.25. */
+    padding = max(padding, 1.25f * (0.5f * sqrtf(3.0f) * step + 0.5f * radius_step));
+  }
+
+  return padding;
+}
+
 CCL_NAMESPACE_END
@@ -97,6 +97,9 @@ class Hair : public Geometry {
   /* BVH */
   size_t curvekey_offset;
   CurveShapeType curve_shape;
+  /* Distance by which the curves of quantized keys can lie outside the curves of the full
+   * precision keys, zero when keys are not quantized. Curve bounds are grown by it. */
+  float curve_keys_padding;
 
   /* Constructor/Destructor */
   Hair();
@@ -145,6 +148,24 @@ class Hair : public Geometry {
 
   /* BVH */
   void pack_curves(Scene *scene, float4 *curve_key_co, float4 *curve_data, size_t curvekey_offset);
+  /* Pack keys quantized to 16 bits relative to the bounds of their curve, instead of the full
+   * precision keys from pack_curves. Decoded by curve_key_fetch() in the kernel. */
+  void pack_curve_keys_quantized(ushort4 *curve_key_quantized,
+                                 float4 *curve_bounds,
+                                 float4 *curve_data);
+  /* Largest distance between a curve of the full precision keys and the same curve of the
+   * quantized keys, radius included. */
+  float curve_keys_quantization_padding() const;
+
+  void pad_curve_bounds(BoundBox &bounds) const
+  {
+    if (curve_keys_padding > 0.0f && bounds.valid()) {
+      const float3 padding = make_float3(
+          curve_keys_padding, curve_keys_padding, curve_keys_padding);
+      bounds.min -= padding;
+      bounds.max += padding;
+    }
+  }
 };
 
 CCL_NAMESPACE_END
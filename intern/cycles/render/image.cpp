@@ -30,6 +30,7 @@
 #include "util/util_progress.h"
 #include "util/util_task.h"
 #include "util/util_texture.h"
+#include "util/util_texture_cache.h"
 #include "util/util_unique_ptr.h"
 
 #ifdef WITH_OSL
@@ -301,6 +302,7 @@ ImageManager::ImageManager(const DeviceInfo &info)
   need_update = true;
   osl_texture_system = NULL;
   animation_frame = 0;
+  num_loaded_images = 0;
 
   /* Set image limits */
   has_half_images = info.has_half_images;
@@ -646,6 +648,52 @@ bool ImageManager::file_load_image(Image *img, int texture_limit)
   return true;
 }
 
+bool ImageManager::texture_cache_load_image(Device *device, Scene *scene, Image *img)
+{
+  TextureCache *texture_cache = device->texture_cache();
+  if (texture_cache == NULL || !scene->params.use_texture_cache) {
+    return false;
+  }
+
+  /* Only plain 2D image files, other images and resized images are loaded fully. */
+  const ustring filepath = img->loader->osl_filepath();
+  const ImageMetaData &metadata = img->metadata;
+  if (filepath.empty() || scene->params.texture_limit > 0 || metadata.depth > 1) {
+    return false;
+  }
+
+  /* Channels are expanded to RGBA like #file_load_image, except for grayscale with alpha. */
+  if (!(metadata.channels == 1 || metadata.channels == 3 || metadata.channels == 4)) {
+    return false;
+  }
+
+  /* Lookups return file values with associated alpha, images that need color space conversion
+   * or unassociated alpha can't be cached. The sRGB transform is done in the kernel. */
+  if (metadata.colorspace != u_colorspace_raw && metadata.colorspace != u_colorspace_srgb) {
+    return false;
+  }
+  if (metadata.channels == 4 && !image_associate_alpha(img)) {
+    return false;
+  }
+
+  void *handle = texture_cache->file_handle(filepath.string());
+  if (handle == NULL) {
+    return false;
+  }
+
+  thread_scoped_lock device_lock(device_mutex);
+
+  /* Placeholder pixel, the kernel reads from the texture cache instead. */
+  void *pixels = img->mem->alloc(1, 1);
+  memset(pixels, 0, img->mem->memory_size());
+
+  img->mem->info.width = metadata.width;
+  img->mem->info.height = metadata.height;
+  img->mem->info.cache_handle = (uint64_t)handle;
+
+  return true;
+}
+
 void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Progress *progress)
 {
   if (progress->get_cancel()) {
@@ -677,7 +725,10 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
   img->mem->info.transform_3d = img->metadata.transform_3d;
 
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
+  if (texture_cache_load_image(device, scene, img)) {
+    VLOG(1) << "Using texture cache for " << img->loader->name() << ".";
+  }
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
     if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
@@ -782,13 +833,17 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
   img->need_load = false;
 }
 
-void ImageManager::device_free_image(Device *, int slot)
+void ImageManager::device_free_image(Device *device, int slot)
 {
   Image *img = images[slot];
   if (img == NULL) {
     return;
   }
 
+  if (img->mem && img->mem->info.cache_handle) {
+    device->texture_cache()->invalidate(img->loader->osl_filepath().string());
+  }
+
   if (osl_texture_system) {
 #ifdef WITH_OSL
     ustring filepath = img->loader->osl_filepath();
@@ -810,6 +865,8 @@ void ImageManager::device_free_image(Device *, int slot)
 
 void ImageManager::device_update(Device *device, Scene *scene, Progress &progress)
 {
+  num_loaded_images = 0;
+
   if (!need_update) {
     return;
   }
@@ -820,6 +877,11 @@ void ImageManager::device_update(Device *device, Scene *scene, Progress &progres
     }
   });
 
+  TextureCache *texture_cache = device->texture_cache();
+  if (texture_cache && scene->params.use_texture_cache) {
+    texture_cache->set_max_memory(scene->params.texture_cache_size);
+  }
+
   TaskPool pool;
   for (size_t slot = 0; slot < images.size(); slot++) {
     Image *img = images[slot];
@@ -829,6 +891,7 @@ void ImageManager::device_update(Device *device, Scene *scene, Progress &progres
     else if (img && img->need_load) {
       pool.push(
           function_bind(&ImageManager::device_load_image, this, device, scene, slot, &progress));
+      num_loaded_images++;
     }
   }
 
@@ -890,10 +953,18 @@ void ImageManager::device_free(Device *device)
 
 void ImageManager::collect_statistics(RenderStats *stats)
 {
+  size_t num_images = 0;
   foreach (const Image *image, images) {
+    if (image == NULL) {
+      continue;
+    }
     stats->image.textures.add_entry(
         NamedSizeEntry(image->loader->name(), image->mem->memory_size()));
+    num_images++;
   }
+
+  stats->image.num_loaded = num_loaded_images;
+  stats->image.num_reused = (num_images > num_loaded_images) ? num_images - num_loaded_images : 0;
 }
 
 CCL_NAMESPACE_END
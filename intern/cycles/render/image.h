@@ -215,6 +215,9 @@ class ImageManager {
   thread_mutex images_mutex;
   int animation_frame;
 
+  /* Images loaded in the last update, for statistics. */
+  size_t num_loaded_images;
+
   vector<Image *> images;
   void *osl_texture_system;
 
@@ -226,6 +229,7 @@ class ImageManager {
 
   template<TypeDesc::BASETYPE FileFormat, typename StorageType>
   bool file_load_image(Image *img, int texture_limit);
+  bool texture_cache_load_image(Device *device, Scene *scene, Image *img);
 
   void device_load_image(Device *device, Scene *scene, int slot, Progress *progress);
   void device_free_image(Device *device, int slot);
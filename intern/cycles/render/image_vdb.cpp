@@ -24,6 +24,9 @@
 #  include <nanovdb/util/OpenToNanoVDB.h>
 #endif
 
+#include "util/util_logging.h"
+#include "util/util_string.h"
+
 CCL_NAMESPACE_BEGIN
 
 VDBImageLoader::VDBImageLoader(const string &grid_name) : grid_name(grid_name)
@@ -125,6 +128,15 @@ bool VDBImageLoader::load_metadata(ImageMetaData &metadata)
   else {
     metadata.type = IMAGE_DATA_TYPE_NANOVDB_FLOAT3;
   }
+
+  /* Sampled sparse on all devices, compare against the size of the dense texture that would
+   * be used otherwise. */
+  VLOG(1) << "NanoVDB grid " << grid_name << " of " << dim.x() << "x" << dim.y() << "x"
+          << dim.z() << " voxels, " << string_human_readable_size(metadata.byte_size)
+          << " instead of "
+          << string_human_readable_size(sizeof(float) * ((metadata.channels == 1) ? 1 : 4) *
+                                        dim.x() * dim.y() * dim.z())
+          << " dense.";
 #  else
   if (metadata.channels == 1) {
     metadata.type = IMAGE_DATA_TYPE_FLOAT;
@@ -20,6 +20,7 @@
 #include "render/film.h"
 #include "render/graph.h"
 #include "render/integrator.h"
+#include "render/light_tree.h"
 #include "render/mesh.h"
 #include "render/nodes.h"
 #include "render/object.h"
@@ -276,6 +277,27 @@ bool LightManager::object_usable_as_light(Object *object)
   return false;
 }
 
+/* Flags for rays that don't see the object's mesh lights. */
+static int object_light_shader_flag(Object *object)
+{
+  int shader_flag = 0;
+
+  if (!(object->get_visibility() & PATH_RAY_DIFFUSE)) {
+    shader_flag |= SHADER_EXCLUDE_DIFFUSE;
+  }
+  if (!(object->get_visibility() & PATH_RAY_GLOSSY)) {
+    shader_flag |= SHADER_EXCLUDE_GLOSSY;
+  }
+  if (!(object->get_visibility() & PATH_RAY_TRANSMIT)) {
+    shader_flag |= SHADER_EXCLUDE_TRANSMIT;
+  }
+  if (!(object->get_visibility() & PATH_RAY_VOLUME_SCATTER)) {
+    shader_flag |= SHADER_EXCLUDE_SCATTER;
+  }
+
+  return shader_flag;
+}
+
 void LightManager::device_update_distribution(Device *,
                                               DeviceScene *dscene,
                                               Scene *scene,
@@ -347,22 +369,9 @@ void LightManager::device_update_distribution(Device *,
     bool transform_applied = mesh->transform_applied;
     Transform tfm = object->get_tfm();
     int object_id = j;
-    int shader_flag = 0;
+    int shader_flag = object_light_shader_flag(object);
 
-    if (!(object->get_visibility() & PATH_RAY_DIFFUSE)) {
-      shader_flag |= SHADER_EXCLUDE_DIFFUSE;
-      use_light_visibility = true;
-    }
-    if (!(object->get_visibility() & PATH_RAY_GLOSSY)) {
-      shader_flag |= SHADER_EXCLUDE_GLOSSY;
-      use_light_visibility = true;
-    }
-    if (!(object->get_visibility() & PATH_RAY_TRANSMIT)) {
-      shader_flag |= SHADER_EXCLUDE_TRANSMIT;
-      use_light_visibility = true;
-    }
-    if (!(object->get_visibility() & PATH_RAY_VOLUME_SCATTER)) {
-      shader_flag |= SHADER_EXCLUDE_SCATTER;
+    if (shader_flag) {
       use_light_visibility = true;
     }
 
@@ -529,6 +538,259 @@ void LightManager::device_update_distribution(Device *,
   }
 }
 
+/* Estimated emission of a shader, for weighting emitters in the light tree. */
+static float shader_emission_estimate(Shader *shader)
+{
+  float3 emission;
+  if (shader->is_constant_emission(&emission)) {
+    return max(average(emission), 0.0f);
+  }
+  /* Unknown, assume unit strength. */
+  return 1.0f;
+}
+
+void LightManager::device_update_tree(Device *,
+                                      DeviceScene *dscene,
+                                      Scene *scene,
+                                      Progress &progress)
+{
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+
+  kintegrator->use_light_tree = false;
+  kintegrator->light_tree_num_local = 0;
+  kintegrator->light_tree_num_distant = 0;
+  kintegrator->light_tree_local_pdf = 0.0f;
+
+  /* Branched path tracing samples lamps and mesh lights separately, which
+   * depends on the layout of the light distribution. */
+  if (!scene->integrator->get_use_light_tree() ||
+      scene->integrator->get_method() != Integrator::PATH || !kintegrator->use_direct_light) {
+    return;
+  }
+
+  scoped_callback_timer timer([scene](double time) {
+    if (scene->update_stats) {
+      scene->update_stats->light.times.add_entry({"device_update (compute light tree)", time});
+    }
+  });
+
+  progress.set_status("Updating Lights", "Building light tree");
+
+  /* Local emitters in the order they are added, distant and background lamps
+   * are sampled separately. */
+  vector<LightTreeEmitter> emitters;
+  vector<KernelLightTreeEmitter> kemitters;
+  vector<int> distant_lamps;
+
+  /* Emitter of every lamp, followed by the emitters of the triangles of all
+   * objects with mesh lights. Refers to the emitters above until the tree is
+   * built. */
+  vector<int> emitter_map;
+
+  KernelLightTreeEmitter kemitter;
+  memset(&kemitter, 0, sizeof(kemitter));
+
+  /* lamps */
+  int light_index = 0;
+  foreach (Light *light, scene->lights) {
+    if (!light->is_enabled) {
+      continue;
+    }
+
+    emitter_map.push_back(-1);
+
+    if (light->light_type == LIGHT_DISTANT || light->light_type == LIGHT_BACKGROUND) {
+      distant_lamps.push_back(light_index++);
+      continue;
+    }
+
+    Shader *shader = (light->shader) ? light->shader : scene->default_light;
+    LightTreeEmitter emitter;
+    emitter.energy = average(light->strength) * shader_emission_estimate(shader);
+
+    if (light->light_type == LIGHT_AREA) {
+      const float3 axisu = light->axisu * (light->sizeu * light->size);
+      const float3 axisv = light->axisv * (light->sizev * light->size);
+      emitter.bbox = BoundBox::empty;
+      emitter.bbox.grow(light->co + 0.5f * (axisu + axisv));
+      emitter.bbox.grow(light->co + 0.5f * (axisu - axisv));
+      emitter.bbox.grow(light->co - 0.5f * (axisu + axisv));
+      emitter.bbox.grow(light->co - 0.5f * (axisu - axisv));
+      emitter.cone = LightTreeCone(safe_normalize(light->dir), 0.0f, M_PI_2_F, false);
+      /* Emits on one side, with cosine falloff. */
+      emitter.energy *= M_1_PI_F;
+    }
+    else {
+      const float3 radius = make_float3(light->size, light->size, light->size);
+      emitter.bbox = BoundBox(light->co - radius, light->co + radius);
+      if (light->light_type == LIGHT_SPOT) {
+        emitter.cone = LightTreeCone(
+            safe_normalize(light->dir), 0.0f, min(0.5f * light->spot_angle, M_PI_F), false);
+      }
+      else {
+        emitter.cone = LightTreeCone(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F, false);
+      }
+      /* Emits in all directions. */
+      emitter.energy *= 0.25f * M_1_PI_F;
+    }
+
+    kemitter.prim = ~light_index;
+    kemitter.inv_area = 1.0f;
+
+    emitter_map[light_index++] = emitters.size();
+    emitters.push_back(emitter);
+    kemitters.push_back(kemitter);
+  }
+
+  /* triangles */
+  KernelLightTreeObject *kobjects = dscene->light_tree_objects.alloc(scene->objects.size());
+  memset(kobjects, 0, sizeof(KernelLightTreeObject) * scene->objects.size());
+
+  int object_id = 0;
+  foreach (Object *object, scene->objects) {
+    if (progress.get_cancel())
+      return;
+
+    kobjects[object_id].map_offset = -1;
+
+    if (!object_usable_as_light(object)) {
+      object_id++;
+      continue;
+    }
+
+    Mesh *mesh = static_cast<Mesh *>(object->get_geometry());
+    const bool transform_applied = mesh->transform_applied;
+    const Transform tfm = object->get_tfm();
+    const int shader_flag = object_light_shader_flag(object);
+    const size_t mesh_num_triangles = mesh->num_triangles();
+    const int map_offset = emitter_map.size();
+
+    kobjects[object_id].map_offset = map_offset;
+    kobjects[object_id].prim_offset = mesh->prim_offset;
+    emitter_map.resize(map_offset + mesh_num_triangles, -1);
+
+    /* Estimate emission once per shader, negative until computed. */
+    vector<float> shader_emission(mesh->get_used_shaders().size(), -1.0f);
+
+    for (size_t i = 0; i < mesh_num_triangles; i++) {
+      int shader_index = mesh->get_shader()[i];
+      Shader *shader = (shader_index < mesh->get_used_shaders().size()) ?
+                           static_cast<Shader *>(mesh->get_used_shaders()[shader_index]) :
+                           scene->default_surface;
+
+      if (!(shader->get_use_mis() && shader->has_surface_emission)) {
+        continue;
+      }
+
+      Mesh::Triangle t = mesh->get_triangle(i);
+      if (!t.valid(&mesh->get_verts()[0])) {
+        continue;
+      }
+      float3 p1 = mesh->get_verts()[t.v[0]];
+      float3 p2 = mesh->get_verts()[t.v[1]];
+      float3 p3 = mesh->get_verts()[t.v[2]];
+
+      if (!transform_applied) {
+        p1 = transform_point(&tfm, p1);
+        p2 = transform_point(&tfm, p2);
+        p3 = transform_point(&tfm, p3);
+      }
+
+      const float area = triangle_area(p1, p2, p3);
+      if (area == 0.0f) {
+        continue;
+      }
+
+      float emission = 1.0f;
+      if (shader_index < shader_emission.size()) {
+        if (shader_emission[shader_index] < 0.0f) {
+          shader_emission[shader_index] = shader_emission_estimate(shader);
+        }
+        emission = shader_emission[shader_index];
+      }
+
+      /* Mesh lights emit on both sides, with cosine falloff. */
+      LightTreeEmitter emitter;
+      emitter.bbox = BoundBox(p1);
+      emitter.bbox.grow(p2);
+      emitter.bbox.grow(p3);
+      emitter.cone = LightTreeCone(safe_normalize(cross(p2 - p1, p3 - p1)), 0.0f, M_PI_2_F, true);
+      emitter.energy = emission * area * M_1_PI_F;
+
+      kemitter.prim = i + mesh->prim_offset;
+      kemitter.object_id = object_id;
+      kemitter.shader_flag = shader_flag;
+      kemitter.inv_area = 1.0f / area;
+
+      emitter_map[map_offset + i] = emitters.size();
+      emitters.push_back(emitter);
+      kemitters.push_back(kemitter);
+    }
+
+    object_id++;
+  }
+
+  const int num_local = emitters.size();
+  const int num_distant = distant_lamps.size();
+
+  if (num_local == 0) {
+    /* Nothing to build a tree of, use the light distribution. */
+    dscene->light_tree_objects.free();
+    return;
+  }
+
+  LightTree tree(emitters);
+
+  /* Emitters in leaf order, followed by distant lamps. */
+  vector<int> tree_index(num_local);
+  KernelLightTreeEmitter *tree_emitters = dscene->light_tree_emitters.alloc(num_local +
+                                                                           num_distant);
+
+  for (int i = 0; i < num_local; i++) {
+    tree_index[tree.order[i]] = i;
+    tree_emitters[i] = kemitters[tree.order[i]];
+    tree_emitters[i].node = tree.leaf_nodes[i];
+  }
+
+  foreach (int &index, emitter_map) {
+    if (index >= 0) {
+      index = tree_index[index];
+    }
+  }
+
+  for (int i = 0; i < num_distant; i++) {
+    kemitter.prim = ~distant_lamps[i];
+    kemitter.object_id = 0;
+    kemitter.shader_flag = 0;
+    kemitter.node = -1;
+    kemitter.inv_area = 1.0f;
+    tree_emitters[num_local + i] = kemitter;
+    emitter_map[distant_lamps[i]] = num_local + i;
+  }
+
+  KernelLightTreeNode *nodes = dscene->light_tree_nodes.alloc(tree.nodes.size());
+  memcpy(nodes, tree.nodes.data(), sizeof(KernelLightTreeNode) * tree.nodes.size());
+
+  int *map = dscene->light_tree_emitter_map.alloc(emitter_map.size());
+  memcpy(map, emitter_map.data(), sizeof(int) * emitter_map.size());
+
+  dscene->light_tree_nodes.copy_to_device();
+  dscene->light_tree_emitters.copy_to_device();
+  dscene->light_tree_emitter_map.copy_to_device();
+  dscene->light_tree_objects.copy_to_device();
+
+  /* Distant and background lamps are selected uniformly, half of the time if
+   * there are also local emitters. */
+  kintegrator->use_light_tree = true;
+  kintegrator->light_tree_num_local = num_local;
+  kintegrator->light_tree_num_distant = num_distant;
+  kintegrator->light_tree_local_pdf = (num_distant > 0) ? 0.5f : 1.0f;
+  kintegrator->pdf_lights = (num_distant > 0) ? 0.5f / num_distant : 0.0f;
+
+  VLOG(1) << "Light tree with " << num_local << " local emitters, " << num_distant
+          << " distant lights and " << tree.nodes.size() << " nodes.";
+}
+
 static void background_cdf(
     int start, int end, int res_x, int res_y, const vector<float3> *pixels, float2 *cond_cdf)
 {
@@ -988,6 +1250,10 @@ void LightManager::device_update(Device *device,
   if (progress.get_cancel())
     return;
 
+  device_update_tree(device, dscene, scene, progress);
+  if (progress.get_cancel())
+    return;
+
   if (need_update_background) {
     device_update_background(device, dscene, scene, progress);
     if (progress.get_cancel())
@@ -1008,6 +1274,10 @@ void LightManager::device_free(Device *, DeviceScene *dscene, const bool free_ba
 {
   dscene->light_distribution.free();
   dscene->lights.free();
+  dscene->light_tree_nodes.free();
+  dscene->light_tree_emitters.free();
+  dscene->light_tree_emitter_map.free();
+  dscene->light_tree_objects.free();
   if (free_background) {
     dscene->light_background_marginal_cdf.free();
     dscene->light_background_conditional_cdf.free();
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/light_tree.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Number of bins per axis when searching for a split. */
+#define LIGHT_TREE_NUM_BINS 12
+
+/* Cone */
+
+LightTreeCone LightTreeCone::merge(const LightTreeCone &cone_a, const LightTreeCone &cone_b)
+{
+  /* Let a be the wider cone. */
+  LightTreeCone a = (cone_a.theta_o >= cone_b.theta_o) ? cone_a : cone_b;
+  LightTreeCone b = (cone_a.theta_o >= cone_b.theta_o) ? cone_b : cone_a;
+
+  /* Two sided cones are symmetric, turn them towards the other cone. */
+  if (dot(a.axis, b.axis) < 0.0f) {
+    if (b.two_sided) {
+      b.axis = -b.axis;
+    }
+    else if (a.two_sided) {
+      a.axis = -a.axis;
+    }
+  }
+
+  const float theta_e = max(a.theta_e, b.theta_e);
+  const bool two_sided = a.two_sided || b.two_sided;
+  const float theta_d = safe_acosf(dot(a.axis, b.axis));
+
+  if (min(theta_d + b.theta_o, M_PI_F) <= a.theta_o) {
+    return LightTreeCone(a.axis, a.theta_o, theta_e, two_sided);
+  }
+
+  const float theta_o = 0.5f * (a.theta_o + theta_d + b.theta_o);
+  if (theta_o >= M_PI_F) {
+    return LightTreeCone(a.axis, M_PI_F, theta_e, two_sided);
+  }
+
+  /* Rotate the axis of a towards b, to the middle of the merged cone. */
+  const float3 ortho = b.axis - a.axis * dot(a.axis, b.axis);
+  const float ortho_len = len(ortho);
+  if (ortho_len < 1e-6f) {
+    return LightTreeCone(a.axis, M_PI_F, theta_e, two_sided);
+  }
+
+  const float theta_r = theta_o - a.theta_o;
+  const float3 axis = normalize(a.axis * cosf(theta_r) + ortho * (sinf(theta_r) / ortho_len));
+  return LightTreeCone(axis, theta_o, theta_e, two_sided);
+}
+
+float LightTreeCone::measure() const
+{
+  const float theta_w = min(theta_o + theta_e, M_PI_F);
+  const float cos_o = cosf(theta_o);
+  const float sin_o = sinf(theta_o);
+  const float measure = M_2PI_F * (1.0f - cos_o) +
+                        M_PI_2_F * (2.0f * theta_w * sin_o - cosf(theta_o - 2.0f * theta_w) -
+                                    2.0f * theta_o * sin_o + cos_o);
+  return (two_sided) ? 2.0f * measure : measure;
+}
+
+/* Bounds of a group of emitters. */
+
+namespace {
+
+struct LightTreeBounds {
+  BoundBox bbox;
+  LightTreeCone cone;
+  float energy;
+  bool empty;
+
+  LightTreeBounds() : bbox(BoundBox::empty), energy(0.0f), empty(true)
+  {
+  }
+
+  void add(const BoundBox &other_bbox, const LightTreeCone &other_cone, float other_energy)
+  {
+    cone = (empty) ? other_cone : LightTreeCone::merge(cone, other_cone);
+    bbox.grow(other_bbox);
+    energy += other_energy;
+    empty = false;
+  }
+
+  void add(const LightTreeEmitter &emitter)
+  {
+    add(emitter.bbox, emitter.cone, emitter.energy);
+  }
+
+  void add(const LightTreeBounds &other)
+  {
+    if (!other.empty) {
+      add(other.bbox, other.cone, other.energy);
+    }
+  }
+
+  /* Surface area orientation heuristic. */
+  float cost() const
+  {
+    return (empty) ? 0.0f : energy * bbox.area() * cone.measure();
+  }
+};
+
+}  // namespace
+
+/* Tree */
+
+LightTree::LightTree(const vector<LightTreeEmitter> &emitters) : emitters(emitters)
+{
+  const int num_emitters = emitters.size();
+  if (num_emitters == 0) {
+    return;
+  }
+
+  order.resize(num_emitters);
+  for (int i = 0; i < num_emitters; i++) {
+    order[i] = i;
+  }
+  leaf_nodes.resize(num_emitters);
+
+  nodes.reserve(2 * num_emitters - 1);
+  nodes.resize(1);
+  build(0, -1, 0, num_emitters);
+}
+
+void LightTree::build(int index, int parent, int start, int end)
+{
+  struct BuildTask {
+    int index, parent, start, end;
+  };
+
+  /* Explicit stack instead of recursion, splits can be very unbalanced. */
+  vector<BuildTask> stack;
+  stack.push_back({index, parent, start, end});
+
+  while (!stack.empty()) {
+    const BuildTask task = stack.back();
+    stack.pop_back();
+
+    LightTreeBounds bounds;
+    BoundBox centroid_bounds = BoundBox::empty;
+    for (int i = task.start; i < task.end; i++) {
+      bounds.add(emitters[order[i]]);
+      centroid_bounds.grow(emitters[order[i]].centroid());
+    }
+
+    KernelLightTreeNode &knode = nodes[task.index];
+    knode.bbox_min[0] = bounds.bbox.min.x;
+    knode.bbox_min[1] = bounds.bbox.min.y;
+    knode.bbox_min[2] = bounds.bbox.min.z;
+    knode.bbox_max[0] = bounds.bbox.max.x;
+    knode.bbox_max[1] = bounds.bbox.max.y;
+    knode.bbox_max[2] = bounds.bbox.max.z;
+    knode.energy = bounds.energy;
+    knode.axis[0] = bounds.cone.axis.x;
+    knode.axis[1] = bounds.cone.axis.y;
+    knode.axis[2] = bounds.cone.axis.z;
+    knode.theta_o = bounds.cone.theta_o;
+    knode.theta_e = bounds.cone.theta_e;
+    knode.two_sided = bounds.cone.two_sided;
+    knode.parent = task.parent;
+    knode.pad = 0;
+
+    if (task.end - task.start == 1) {
+      knode.child = ~task.start;
+      leaf_nodes[task.start] = task.index;
+      continue;
+    }
+
+    const int mid = split(task.start, task.end, centroid_bounds);
+    const int child = nodes.size();
+    knode.child = child;
+    nodes.resize(child + 2);
+
+    stack.push_back({child, task.index, task.start, mid});
+    stack.push_back({child + 1, task.index, mid, task.end});
+  }
+}
+
+int LightTree::split(int start, int end, const BoundBox &centroid_bounds)
+{
+  const float3 extent = centroid_bounds.size();
+  const float max_extent = max3(extent);
+
+  float best_cost = FLT_MAX;
+  int best_axis = -1;
+  int best_bin = 0;
+
+  for (int axis = 0; axis < 3 && max_extent > 0.0f; axis++) {
+    if (extent[axis] <= 0.0f) {
+      continue;
+    }
+
+    const float bin_scale = LIGHT_TREE_NUM_BINS / extent[axis];
+    LightTreeBounds bins[LIGHT_TREE_NUM_BINS];
+
+    for (int i = start; i < end; i++) {
+      const LightTreeEmitter &emitter = emitters[order[i]];
+      const int bin = min(
+          (int)((emitter.centroid()[axis] - centroid_bounds.min[axis]) * bin_scale),
+          LIGHT_TREE_NUM_BINS - 1);
+      bins[bin].add(emitter);
+    }
+
+    /* Sweep from the right, then evaluate split planes from the left. */
+    LightTreeBounds right[LIGHT_TREE_NUM_BINS];
+    right[LIGHT_TREE_NUM_BINS - 1] = bins[LIGHT_TREE_NUM_BINS - 1];
+    for (int bin = LIGHT_TREE_NUM_BINS - 2; bin > 0; bin--) {
+      right[bin] = right[bin + 1];
+      right[bin].add(bins[bin]);
+    }
+
+    /* Prefer splitting along the longer axes. */
+    const float axis_factor = max_extent / extent[axis];
+
+    LightTreeBounds left;
+    for (int bin = 1; bin < LIGHT_TREE_NUM_BINS; bin++) {
+      left.add(bins[bin - 1]);
+      if (left.empty || right[bin].empty) {
+        continue;
+      }
+
+      const float cost = (left.cost() + right[bin].cost()) * axis_factor;
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin = bin;
+      }
+    }
+  }
+
+  if (best_axis == -1) {
+    /* All centroids are at the same position. */
+    return (start + end) / 2;
+  }
+
+  const float bin_scale = LIGHT_TREE_NUM_BINS / extent[best_axis];
+  const float bin_min = centroid_bounds.min[best_axis];
+  vector<int>::iterator mid = std::partition(
+      order.begin() + start, order.begin() + end, [&](const int i) {
+        const int bin = min((int)((emitters[i].centroid()[best_axis] - bin_min) * bin_scale),
+                            LIGHT_TREE_NUM_BINS - 1);
+        return bin < best_bin;
+      });
+
+  return mid - order.begin();
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel/kernel_types.h"
+
+#include "util/util_boundbox.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Cone bounding the directions in which emitters emit light. Emitters have
+ * normals within theta_o of the axis, and emit within theta_e of their normal.
+ * Two sided emitters also emit around the negated normals. */
+
+struct LightTreeCone {
+  float3 axis;
+  float theta_o;
+  float theta_e;
+  bool two_sided;
+
+  LightTreeCone()
+      : axis(make_float3(0.0f, 0.0f, 1.0f)), theta_o(0.0f), theta_e(0.0f), two_sided(false)
+  {
+  }
+
+  LightTreeCone(const float3 &axis, float theta_o, float theta_e, bool two_sided)
+      : axis(axis), theta_o(theta_o), theta_e(theta_e), two_sided(two_sided)
+  {
+  }
+
+  /* Cone containing both cones. */
+  static LightTreeCone merge(const LightTreeCone &a, const LightTreeCone &b);
+
+  /* Orientation measure of the cone, used in the split cost. */
+  float measure() const;
+};
+
+/* Light source given to the builder, a triangle or a local lamp. */
+
+struct LightTreeEmitter {
+  BoundBox bbox;
+  LightTreeCone cone;
+  /* Estimated emitted intensity along the normal. */
+  float energy;
+
+  float3 centroid() const
+  {
+    return bbox.center();
+  }
+};
+
+/* Light Tree
+ *
+ * Bounding volume hierarchy over emitters, for sampling lights by their
+ * estimated contribution at a shading point. Nodes store the bounds, total
+ * energy and emission cone of the emitters below them, following "Importance
+ * Sampling of Many Lights with Adaptive Tree Splitting" by Conty Estevez and
+ * Kulla. Splits are chosen by binning with their surface area orientation
+ * heuristic, and every leaf holds a single emitter.
+ *
+ * Traversal is done by kernel/kernel_light_tree.h. */
+
+class LightTree {
+ public:
+  LightTree(const vector<LightTreeEmitter> &emitters);
+
+  /* Nodes in kernel layout, the root is the first node. */
+  vector<KernelLightTreeNode> nodes;
+
+  /* Emitters in the order of the leaves, as indices into the emitters given to
+   * the constructor. Leaf nodes refer to emitters in this order. */
+  vector<int> order;
+
+  /* Leaf node of each emitter, in leaf order. */
+  vector<int> leaf_nodes;
+
+ protected:
+  void build(int index, int parent, int start, int end);
+  int split(int start, int end, const BoundBox &centroid_bounds);
+
+  const vector<LightTreeEmitter> &emitters;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
@@ -19,6 +19,7 @@
 #include "util/util_array.h"
 #include "util/util_map.h"
 #include "util/util_system.h"
+#include "util/util_task.h"
 #include "util/util_time.h"
 #include "util/util_unique_ptr.h"
 
@@ -359,6 +360,53 @@ static void alloc_pixels(const ImageSpec &spec, array<float> &pixels)
   pixels.resize(num_pixels * num_channels);
 }
 
+/* Merge the pixels of one image into the output pixels, for a range of num_pixels pixels. */
+static void merge_image_pixels(const MergeImage &image,
+                               const ImageSpec &out_spec,
+                               const vector<int> &channel_total_samples,
+                               const float *pixels,
+                               const size_t num_pixels,
+                               float *out_pixels)
+{
+  const size_t stride = image.in->spec().nchannels;
+  const size_t out_stride = out_spec.nchannels;
+  const size_t size = num_pixels * stride;
+
+  for (size_t li = 0; li < image.layers.size(); li++) {
+    const MergeImageLayer &layer = image.layers[li];
+
+    for (const MergeImagePass &pass : layer.passes) {
+      size_t offset = pass.offset;
+      size_t out_offset = pass.merge_offset;
+
+      switch (pass.op) {
+        case MERGE_CHANNEL_NOP:
+          break;
+        case MERGE_CHANNEL_COPY:
+          for (; offset < size; offset += stride, out_offset += out_stride) {
+            out_pixels[out_offset] = pixels[offset];
+          }
+          break;
+        case MERGE_CHANNEL_SUM:
+          for (; offset < size; offset += stride, out_offset += out_stride) {
+            out_pixels[out_offset] += pixels[offset];
+          }
+          break;
+        case MERGE_CHANNEL_AVERAGE:
+          /* Weights based on sample metadata. Per channel since not
+           * all files are guaranteed to have the same channels. */
+          const int total_samples = channel_total_samples[out_offset];
+          const float t = (float)layer.samples / (float)total_samples;
+
+          for (; offset < size; offset += stride, out_offset += out_stride) {
+            out_pixels[out_offset] += t * pixels[offset];
+          }
+          break;
+      }
+    }
+  }
+}
+
 static bool merge_pixels(const vector<MergeImage> &images,
                          const ImageSpec &out_spec,
                          const vector<int> &channel_total_samples,
@@ -379,77 +427,46 @@ static bool merge_pixels(const vector<MergeImage> &images,
       return false;
     }
 
-    for (size_t li = 0; li < image.layers.size(); li++) {
-      const MergeImageLayer &layer = image.layers[li];
-
-      const size_t stride = image.in->spec().nchannels;
-      const size_t out_stride = out_spec.nchannels;
-      const size_t num_pixels = pixels.size();
-
-      for (const MergeImagePass &pass : layer.passes) {
-        size_t offset = pass.offset;
-        size_t out_offset = pass.merge_offset;
-
-        switch (pass.op) {
-          case MERGE_CHANNEL_NOP:
-            break;
-          case MERGE_CHANNEL_COPY:
-            for (; offset < num_pixels; offset += stride, out_offset += out_stride) {
-              out_pixels[out_offset] = pixels[offset];
-            }
-            break;
-          case MERGE_CHANNEL_SUM:
-            for (; offset < num_pixels; offset += stride, out_offset += out_stride) {
-              out_pixels[out_offset] += pixels[offset];
-            }
-            break;
-          case MERGE_CHANNEL_AVERAGE:
-            /* Weights based on sample metadata. Per channel since not
-             * all files are guaranteed to have the same channels. */
-            const int total_samples = channel_total_samples[out_offset];
-            const float t = (float)layer.samples / (float)total_samples;
-
-            for (; offset < num_pixels; offset += stride, out_offset += out_stride) {
-              out_pixels[out_offset] += t * pixels[offset];
-            }
-            break;
-        }
-      }
-    }
+    const size_t num_pixels = (size_t)out_spec.width * (size_t)out_spec.height;
+    merge_image_pixels(
+        image, out_spec, channel_total_samples, pixels.data(), num_pixels, out_pixels.data());
   }
 
   return true;
 }
 
-static bool save_output(const string &filepath,
-                        const ImageSpec &spec,
-                        const array<float> &pixels,
-                        string &error)
+/* Write to temporary file path, so we merge images in place and don't
+ * risk destroying files when something goes wrong in file saving. */
+static unique_ptr<ImageOutput> open_output(const string &filepath,
+                                           const ImageSpec &spec,
+                                           string &tmp_filepath,
+                                           string &error)
 {
-  /* Write to temporary file path, so we merge images in place and don't
-   * risk destroying files when something goes wrong in file saving. */
   string extension = OIIO::Filesystem::extension(filepath);
   string unique_name = ".merge-tmp-" + OIIO::Filesystem::unique_path();
-  string tmp_filepath = filepath + unique_name + extension;
+  tmp_filepath = filepath + unique_name + extension;
   unique_ptr<ImageOutput> out(ImageOutput::create(tmp_filepath));
 
   if (!out) {
     error = "Failed to open temporary file " + tmp_filepath + " for writing";
-    return false;
+    return NULL;
   }
 
   /* Open temporary file and write image buffers. */
   if (!out->open(tmp_filepath, spec)) {
     error = "Failed to open file " + tmp_filepath + " for writing: " + out->geterror();
-    return false;
+    return NULL;
   }
 
-  bool ok = true;
-  if (!out->write_image(TypeDesc::FLOAT, pixels.data())) {
-    error = "Failed to write to file " + tmp_filepath + ": " + out->geterror();
-    ok = false;
-  }
+  return out;
+}
 
+static bool close_output(unique_ptr<ImageOutput> &out,
+                         const string &tmp_filepath,
+                         const string &filepath,
+                         bool ok,
+                         string &error)
+{
   if (!out->close()) {
     error = "Failed to save to file " + tmp_filepath + ": " + out->geterror();
     ok = false;
@@ -471,10 +488,153 @@ static bool save_output(const string &filepath,
   return ok;
 }
 
+static bool save_output(const string &filepath,
+                        const ImageSpec &spec,
+                        const array<float> &pixels,
+                        string &error)
+{
+  string tmp_filepath;
+  unique_ptr<ImageOutput> out = open_output(filepath, spec, tmp_filepath, error);
+  if (!out) {
+    return false;
+  }
+
+  bool ok = true;
+  if (!out->write_image(TypeDesc::FLOAT, pixels.data())) {
+    error = "Failed to write to file " + tmp_filepath + ": " + out->geterror();
+    ok = false;
+  }
+
+  return close_output(out, tmp_filepath, filepath, ok, error);
+}
+
+/* Streaming Merge
+ *
+ * Read, merge and write the images a band of scanlines at a time, so only a
+ * band of every image is in memory. Bands of the input images are read in
+ * parallel, and each band is written while the next one is read and merged.
+ * Pixels are merged in the same order as for full images, so the result is
+ * identical. */
+
+static bool write_band(ImageOutput *out,
+                       const ImageSpec &spec,
+                       const int y,
+                       const int num_rows,
+                       const array<float> &pixels)
+{
+  if (spec.tile_width > 0) {
+    return out->write_tiles(spec.x,
+                            spec.x + spec.width,
+                            spec.y + y,
+                            spec.y + y + num_rows,
+                            spec.z,
+                            spec.z + 1,
+                            TypeDesc::FLOAT,
+                            pixels.data());
+  }
+
+  return out->write_scanlines(
+      spec.y + y, spec.y + y + num_rows, spec.z, TypeDesc::FLOAT, pixels.data());
+}
+
+static bool merge_pixels_streaming(vector<MergeImage> &images,
+                                   const ImageSpec &out_spec,
+                                   const vector<int> &channel_total_samples,
+                                   const int band_height,
+                                   const string &tmp_filepath,
+                                   ImageOutput *out,
+                                   string &error)
+{
+  const size_t width = out_spec.width;
+  const int height = out_spec.height;
+  const size_t out_stride = out_spec.nchannels;
+
+  /* Tiled files are written a full row of tiles at a time. */
+  const int rows = (out_spec.tile_height > 0) ? round_up(band_height, out_spec.tile_height) :
+                                                band_height;
+
+  vector<array<float>> pixels(images.size());
+  vector<int> read_ok(images.size());
+
+  /* Two output bands, one being written while the other is merged. */
+  array<float> out_pixels[2];
+  TaskPool write_pool;
+  bool write_ok = true;
+
+  for (int y = 0, band = 0; y < height; y += rows, band++) {
+    const int num_rows = min(rows, height - y);
+    const size_t num_pixels = width * num_rows;
+
+    /* Decompressing takes most of the time, so read the images in parallel,
+     * each from a single thread. */
+    parallel_for(blocked_range<size_t>(0, images.size(), 1), [&](const blocked_range<size_t> &r) {
+      for (size_t i = r.begin(); i != r.end(); i++) {
+        const ImageSpec &spec = images[i].in->spec();
+        pixels[i].resize(num_pixels * spec.nchannels);
+        read_ok[i] = images[i].in->read_scanlines(0,
+                                                  0,
+                                                  spec.y + y,
+                                                  spec.y + y + num_rows,
+                                                  spec.z,
+                                                  0,
+                                                  spec.nchannels,
+                                                  TypeDesc::FLOAT,
+                                                  pixels[i].data());
+      }
+    });
+
+    for (size_t i = 0; i < images.size(); i++) {
+      if (!read_ok[i]) {
+        write_pool.wait_work();
+        error = "Failed to read image: " + images[i].filepath;
+        return false;
+      }
+    }
+
+    /* Merge rows in parallel, with images in the same order as for full images. */
+    array<float> &band_pixels = out_pixels[band % 2];
+    band_pixels.resize(num_pixels * out_stride);
+    memset(band_pixels.data(), 0, band_pixels.size() * sizeof(float));
+
+    parallel_for(blocked_range<size_t>(0, num_rows), [&](const blocked_range<size_t> &r) {
+      const size_t row_pixels = width * (r.end() - r.begin());
+      for (size_t i = 0; i < images.size(); i++) {
+        const size_t stride = images[i].in->spec().nchannels;
+        merge_image_pixels(images[i],
+                           out_spec,
+                           channel_total_samples,
+                           pixels[i].data() + r.begin() * width * stride,
+                           row_pixels,
+                           band_pixels.data() + r.begin() * width * out_stride);
+      }
+    });
+
+    /* Wait for the previous band to be written, its buffer is used next. */
+    write_pool.wait_work();
+    if (!write_ok) {
+      error = "Failed to write to file " + tmp_filepath + ": " + out->geterror();
+      return false;
+    }
+
+    write_pool.push([out, &out_spec, y, num_rows, &band_pixels, &write_ok]() {
+      write_ok = write_band(out, out_spec, y, num_rows, band_pixels);
+    });
+  }
+
+  write_pool.wait_work();
+  if (!write_ok) {
+    error = "Failed to write to file " + tmp_filepath + ": " + out->geterror();
+    return false;
+  }
+
+  return true;
+}
+
 /* Image Merger */
 
 ImageMerger::ImageMerger()
 {
+  band_height = 32;
 }
 
 bool ImageMerger::run()
@@ -499,6 +659,23 @@ bool ImageMerger::run()
   vector<int> channel_total_samples;
   merge_channels_metadata(images, out_spec, channel_total_samples);
 
+  if (band_height > 0) {
+    /* Merge and write pixels band by band. */
+    string tmp_filepath;
+    unique_ptr<ImageOutput> out = open_output(output, out_spec, tmp_filepath, error);
+    if (!out) {
+      return false;
+    }
+
+    const bool ok = merge_pixels_streaming(
+        images, out_spec, channel_total_samples, band_height, tmp_filepath, out.get(), error);
+
+    /* Close input before possibly overwriting the same file. */
+    images.clear();
+
+    return close_output(out, tmp_filepath, output, ok, error);
+  }
+
   /* Merge pixels. */
   array<float> out_pixels;
   if (!merge_pixels(images, out_spec, channel_total_samples, out_pixels, error)) {
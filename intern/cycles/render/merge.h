@@ -36,6 +36,11 @@ class ImageMerger {
   vector<string> input;
   /* Output filepath. */
   string output;
+
+  /* Number of scanlines to read, merge and write at a time. Memory usage then
+   * no longer depends on the image height. Zero merges the full images in
+   * memory. */
+  int band_height;
 };
 
 CCL_NAMESPACE_END
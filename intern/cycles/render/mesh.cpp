@@ -188,6 +188,7 @@ Mesh::Mesh(const NodeType *node_type, Type geom_type_)
   vert_offset = 0;
 
   patch_offset = 0;
+  patch_table_offset = 0;
   face_offset = 0;
   corner_offset = 0;
 
@@ -210,6 +211,7 @@ Mesh::~Mesh()
 {
   delete patch_table;
   delete subd_params;
+  delete subd_dicing_cache;
 }
 
 void Mesh::resize_mesh(int numverts, int numtris)
@@ -47,6 +47,7 @@ class SceneParams;
 class AttributeRequest;
 struct SubdParams;
 class DiagSplit;
+struct DiagSplitCache;
 struct PackedPatchTable;
 
 /* Mesh */
@@ -194,6 +195,8 @@ class Mesh : public Geometry {
   friend class ObjectManager;
 
   SubdParams *subd_params = nullptr;
+  /* Split decisions kept from the previous tessellation. */
+  DiagSplitCache *subd_dicing_cache = nullptr;
 
  public:
   /* Functions */
@@ -31,6 +31,7 @@
 
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
+#include "util/util_md5.h"
 #include "util/util_transform.h"
 
 #include "kernel/svm/svm_color_util.h"
@@ -206,6 +207,25 @@ void TextureMapping::compile(OSLCompiler &compiler)
   }
 }
 
+/* Image Slot Texture */
+
+/* Images that are not loaded from a file, like packed, generated and builtin
+ * images, are only identified by their handle. */
+static void image_handle_hash(ImageHandle &handle, MD5Hash &md5)
+{
+  const int num_tiles = handle.num_tiles();
+  md5.append((const uint8_t *)&num_tiles, sizeof(num_tiles));
+  for (int i = 0; i < num_tiles; i++) {
+    const int slot = handle.svm_slot(i);
+    md5.append((const uint8_t *)&slot, sizeof(slot));
+  }
+}
+
+void ImageSlotTextureNode::hash_runtime(MD5Hash &md5)
+{
+  image_handle_hash(handle, md5);
+}
+
 /* Image Texture */
 
 NODE_DEFINE(ImageTextureNode)
@@ -1806,6 +1826,11 @@ void PointDensityTextureNode::attributes(Shader *shader, AttributeRequestSet *at
   ShaderNode::attributes(shader, attributes);
 }
 
+void PointDensityTextureNode::hash_runtime(MD5Hash &md5)
+{
+  image_handle_hash(handle, md5);
+}
+
 ImageParams PointDensityTextureNode::image_params() const
 {
   ImageParams params;
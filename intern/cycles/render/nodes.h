@@ -97,6 +97,8 @@ class ImageSlotTextureNode : public TextureNode {
     return TextureNode::equals(other) && handle == other_node.handle;
   }
 
+  virtual void hash_runtime(MD5Hash &md5);
+
   ImageHandle handle;
 };
 
@@ -435,6 +437,8 @@ class PointDensityTextureNode : public ShaderNode {
     const PointDensityTextureNode &other_node = (const PointDensityTextureNode &)other;
     return ShaderNode::equals(other) && handle == other_node.handle;
   }
+
+  virtual void hash_runtime(MD5Hash &md5);
 };
 
 class IESLightNode : public TextureNode {
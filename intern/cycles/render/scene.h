@@ -87,6 +87,8 @@ class DeviceScene {
 
   device_vector<float4> curves;
   device_vector<float4> curve_keys;
+  device_vector<ushort4> curve_keys_quantized;
+  device_vector<float4> curve_bounds;
 
   device_vector<uint> patches;
 
@@ -112,6 +114,10 @@ class DeviceScene {
   device_vector<KernelLight> lights;
   device_vector<float2> light_background_marginal_cdf;
   device_vector<float2> light_background_conditional_cdf;
+  device_vector<KernelLightTreeNode> light_tree_nodes;
+  device_vector<KernelLightTreeEmitter> light_tree_emitters;
+  device_vector<int> light_tree_emitter_map;
+  device_vector<KernelLightTreeObject> light_tree_objects;
 
   /* particles */
   device_vector<KernelParticle> particles;
@@ -129,6 +135,9 @@ class DeviceScene {
   /* ies lights */
   device_vector<float> ies_lights;
 
+  /* baking */
+  device_vector<KernelBakeTarget> bake_targets;
+
   KernelData data;
 
   DeviceScene(Device *device);
@@ -174,8 +183,18 @@ class SceneParams {
   int num_bvh_time_steps;
   int hair_subdivisions;
   CurveShapeType hair_shape;
+  /* Store curve keys quantized to 16 bits, at half the memory of full precision keys. */
+  bool hair_compression;
   bool persistent_data;
   int texture_limit;
+  /* Load image files on demand during CPU rendering, with a memory budget in megabytes. */
+  bool use_texture_cache;
+  int texture_cache_size;
+  /* Move geometry arrays larger than the threshold in megabytes to memory mapped files in
+   * the given directory during CPU rendering, so they can be paged out by the system. */
+  bool use_out_of_core_geometry;
+  int out_of_core_geometry_threshold;
+  string out_of_core_geometry_path;
 
   bool background;
 
@@ -189,8 +208,13 @@ class SceneParams {
     num_bvh_time_steps = 0;
     hair_subdivisions = 3;
     hair_shape = CURVE_RIBBON;
+    hair_compression = false;
     persistent_data = false;
     texture_limit = 0;
+    use_texture_cache = false;
+    texture_cache_size = 4096;
+    use_out_of_core_geometry = false;
+    out_of_core_geometry_threshold = 64;
     background = true;
   }
 
@@ -202,7 +226,13 @@ class SceneParams {
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
-             persistent_data == params.persistent_data && texture_limit == params.texture_limit);
+             hair_compression == params.hair_compression &&
+             persistent_data == params.persistent_data && texture_limit == params.texture_limit &&
+             use_texture_cache == params.use_texture_cache &&
+             texture_cache_size == params.texture_cache_size &&
+             use_out_of_core_geometry == params.use_out_of_core_geometry &&
+             out_of_core_geometry_threshold == params.out_of_core_geometry_threshold &&
+             out_of_core_geometry_path == params.out_of_core_geometry_path);
   }
 
   int curve_subdivisions()
@@ -61,6 +61,13 @@ Session::Session(const SessionParams &params_)
 
   TaskScheduler::init(params.threads);
 
+  /* Split the tiles handed out near the end of a final render, so CPU threads that run out
+   * of tiles share the work of the remaining ones. */
+  if (params.background && !params.progressive && !params.progressive_refine &&
+      params.device.type == DEVICE_CPU) {
+    tile_manager.handout_split_threshold = TaskScheduler::num_threads();
+  }
+
   session_thread = NULL;
   scene = NULL;
 
@@ -72,6 +79,8 @@ Session::Session(const SessionParams &params_)
 
   display_outdated = false;
   gpu_draw_ready = false;
+  checkpoint_need_resume = false;
+  last_checkpoint_time = 0.0;
   gpu_need_display_buffer_update = false;
   pause = false;
 
@@ -303,6 +312,12 @@ void Session::run_gpu()
        * reset and draw in between */
       thread_scoped_lock buffers_lock(buffers_mutex);
 
+      /* continue from checkpoint of an interrupted render */
+      if (checkpoint_need_resume) {
+        checkpoint_need_resume = false;
+        checkpoint_resume();
+      }
+
       /* update status and timing */
       update_status_time();
 
@@ -316,6 +331,8 @@ void Session::run_gpu()
       if (!device->error_message().empty())
         progress.set_cancel(device->error_message());
 
+      checkpoint_frame();
+
       /* update status and timing */
       update_status_time();
 
@@ -575,6 +592,9 @@ void Session::update_tile_sample(RenderTile &rtile)
 
 void Session::release_tile(RenderTile &rtile, const bool need_denoise)
 {
+  checkpoint_tile(rtile);
+  collect_adaptive_tile_stats(rtile);
+
   thread_scoped_lock tile_lock(tile_mutex);
 
   if (rtile.stealing_state != RenderTile::NO_STEALING) {
@@ -708,6 +728,223 @@ void Session::unmap_neighbor_tiles(RenderTileNeighbors &neighbors, Device *tile_
   device->unmap_neighbor_tiles(tile_device, neighbors);
 }
 
+bool Session::checkpoint_enabled()
+{
+  /* Progressive refine without session buffers keeps all tiles alive between samples,
+   * checkpoints only support finished tiles or a single progressive buffer. */
+  return params.background && !params.checkpoint_path.empty() && !read_bake_tile_cb &&
+         (buffers || !params.progressive);
+}
+
+void Session::checkpoint_resume()
+{
+  if (checkpoint.load(params.checkpoint_path, tile_manager.params)) {
+    if (buffers) {
+      checkpoint_resume_frame();
+    }
+    else {
+      checkpoint_resume_tiles();
+    }
+  }
+
+  /* Failing to write checkpoints is not fatal, the render just can't be resumed. */
+  if (!checkpoint.begin(params.checkpoint_path, tile_manager.params)) {
+    LOG(ERROR) << checkpoint.error;
+  }
+
+  last_checkpoint_time = time_dt();
+}
+
+void Session::checkpoint_resume_frame()
+{
+  /* Progressive rendering accumulates all samples in the session buffers, continue
+   * from the saved frame by skipping the samples it already contains. */
+  const int width = buffers->params.width;
+  const int height = buffers->params.height;
+
+  foreach (const RenderCheckpoint::Tile &ctile, checkpoint.tiles) {
+    if (ctile.x != 0 || ctile.y != 0 || ctile.w != width || ctile.h != height ||
+        ctile.num_samples <= 0 || ctile.num_samples >= tile_manager.get_num_effective_samples()) {
+      continue;
+    }
+
+    if (!checkpoint.read_tile(ctile, buffers->buffer.data())) {
+      LOG(ERROR) << checkpoint.error;
+      buffers->zero();
+      return;
+    }
+    buffers->buffer.copy_to_device();
+
+    tile_manager.state.sample += ctile.num_samples;
+    progress.add_samples((uint64_t)width * height * ctile.num_samples, tile_manager.state.sample);
+
+    VLOG(1) << "Resumed render from checkpoint at sample " << tile_manager.state.sample << ".";
+    return;
+  }
+}
+
+void Session::checkpoint_resume_tiles()
+{
+  bool delayed_denoise = false;
+  const bool need_denoise = render_need_denoise(delayed_denoise);
+  int num_resumed = 0;
+
+  foreach (const RenderCheckpoint::Tile &ctile, checkpoint.tiles) {
+    if (ctile.num_samples != tile_manager.state.num_samples) {
+      continue;
+    }
+
+    /* Find the tile containing the rectangle, still waiting to be rendered. Tiles that were
+     * split near the end of the interrupted render are split the same way again. */
+    int tile_index = -1;
+    foreach (const Tile &other, tile_manager.state.tiles) {
+      if (ctile.x >= other.x && ctile.y >= other.y && ctile.x + ctile.w <= other.x + other.w &&
+          ctile.y + ctile.h <= other.y + other.h && other.state == Tile::RENDER &&
+          other.buffers == NULL) {
+        tile_index = tile_manager.split_tile_to(other.index, ctile.x, ctile.y, ctile.w, ctile.h);
+        break;
+      }
+    }
+    if (tile_index == -1) {
+      continue;
+    }
+    Tile *tile = &tile_manager.state.tiles[tile_index];
+
+    BufferParams buffer_params = tile_manager.params;
+    buffer_params.full_x = tile_manager.state.buffer.full_x + tile->x;
+    buffer_params.full_y = tile_manager.state.buffer.full_y + tile->y;
+    buffer_params.width = tile->w;
+    buffer_params.height = tile->h;
+
+    RenderBuffers *tile_buffers = new RenderBuffers(device);
+    tile_buffers->reset(buffer_params);
+
+    if (!checkpoint.read_tile(ctile, tile_buffers->buffer.data())) {
+      LOG(ERROR) << checkpoint.error;
+      delete tile_buffers;
+      break;
+    }
+    tile_buffers->buffer.copy_to_device();
+
+    {
+      thread_scoped_lock tile_lock(tile_mutex);
+      tile_manager.state.render_tiles[tile->device].remove(tile->index);
+      tile->buffers = tile_buffers;
+    }
+
+    RenderTile rtile;
+    rtile.x = buffer_params.full_x;
+    rtile.y = buffer_params.full_y;
+    rtile.w = tile->w;
+    rtile.h = tile->h;
+    rtile.start_sample = tile_manager.state.sample;
+    rtile.num_samples = tile_manager.state.num_samples;
+    rtile.sample = rtile.start_sample + rtile.num_samples;
+    rtile.resolution = tile_manager.state.resolution_divider;
+    rtile.tile_index = tile->index;
+    rtile.task = RenderTile::PATH_TRACE;
+    rtile.buffers = tile_buffers;
+    rtile.buffer = tile_buffers->buffer.device_pointer;
+    tile_buffers->params.get_offset_stride(rtile.offset, rtile.stride);
+
+    progress.add_samples((uint64_t)rtile.w * rtile.h * rtile.num_samples, rtile.sample);
+
+    /* Same as a tile that just finished rendering: write it out and schedule denoising. */
+    release_tile(rtile, need_denoise);
+    num_resumed++;
+  }
+
+  VLOG(1) << "Resumed " << num_resumed << " tiles from checkpoint.";
+}
+
+void Session::checkpoint_tile(RenderTile &rtile)
+{
+  /* Only tiles that rendered all their samples, progressive rendering saves the whole frame. */
+  if (!checkpoint.is_open() || buffers || rtile.task != RenderTile::PATH_TRACE ||
+      rtile.stealing_state == RenderTile::WAS_STOLEN ||
+      rtile.sample != rtile.start_sample + rtile.num_samples || progress.get_cancel()) {
+    return;
+  }
+
+  if (!rtile.buffers->copy_from_device() ||
+      !checkpoint.write_tile(rtile.x - tile_manager.state.buffer.full_x,
+                             rtile.y - tile_manager.state.buffer.full_y,
+                             rtile.w,
+                             rtile.h,
+                             tile_manager.state.num_samples,
+                             rtile.buffers->buffer.data())) {
+    LOG(ERROR) << checkpoint.error;
+  }
+}
+
+void Session::collect_adaptive_tile_stats(RenderTile &rtile)
+{
+  const KernelFilm &kfilm = scene->dscene.data.film;
+
+  /* Only gathered when the adaptive error debug pass was requested, for tiles that rendered
+   * all their samples into their own buffers. */
+  if (!kfilm.pass_adaptive_error || !kfilm.pass_adaptive_aux_buffer || !kfilm.pass_sample_count ||
+      buffers || rtile.task != RenderTile::PATH_TRACE ||
+      rtile.stealing_state == RenderTile::WAS_STOLEN ||
+      rtile.sample != rtile.start_sample + rtile.num_samples || progress.get_cancel()) {
+    return;
+  }
+
+  if (!rtile.buffers->copy_from_device()) {
+    return;
+  }
+
+  const float *render_buffer = rtile.buffers->buffer.data();
+  const int pass_stride = rtile.buffers->params.get_passes_size();
+
+  AdaptiveTileStats tile;
+  tile.x = rtile.x;
+  tile.y = rtile.y;
+  tile.w = rtile.w;
+  tile.h = rtile.h;
+
+  for (int y = rtile.y; y < rtile.y + rtile.h; y++) {
+    for (int x = rtile.x; x < rtile.x + rtile.w; x++) {
+      const int index = rtile.offset + x + y * rtile.stride;
+      const float *buffer = render_buffer + (size_t)index * pass_stride;
+
+      /* Sample count is negative until the device finished adaptive sampling of the tile. */
+      tile.add_pixel((int)fabsf(buffer[kfilm.pass_sample_count]),
+                     buffer[kfilm.pass_adaptive_error],
+                     buffer[kfilm.pass_adaptive_aux_buffer + 3] != 0.0f,
+                     kfilm.pass_render_time ? buffer[kfilm.pass_render_time] : 0.0);
+    }
+  }
+
+  tile.finish(rtile.buffers->render_time);
+
+  thread_scoped_lock tile_lock(tile_mutex);
+  adaptive_stats.tiles.push_back(tile);
+}
+
+void Session::checkpoint_frame()
+{
+  if (!checkpoint.is_open() || !buffers || progress.get_cancel() ||
+      time_dt() - last_checkpoint_time < params.checkpoint_interval) {
+    return;
+  }
+
+  const int num_samples = tile_manager.state.sample + tile_manager.state.num_samples -
+                          tile_manager.range_start_sample;
+  if (num_samples <= 0 || tile_manager.done()) {
+    return;
+  }
+
+  if (!buffers->copy_from_device() || !checkpoint.write_frame(buffers->params.width,
+                                                              buffers->params.height,
+                                                              num_samples,
+                                                              buffers->buffer.data())) {
+    LOG(ERROR) << checkpoint.error;
+  }
+
+  last_checkpoint_time = time_dt();
+}
+
 void Session::run_cpu()
 {
   bool tiles_written = false;
@@ -807,6 +1044,12 @@ void Session::run_cpu()
        * reset and draw in between */
       thread_scoped_lock buffers_lock(buffers_mutex);
 
+      /* continue from checkpoint of an interrupted render */
+      if (checkpoint_need_resume) {
+        checkpoint_need_resume = false;
+        checkpoint_resume();
+      }
+
       /* update status and timing */
       update_status_time();
 
@@ -846,6 +1089,8 @@ void Session::run_cpu()
       if (!device->error_message().empty())
         progress.set_error(device->error_message());
 
+      checkpoint_frame();
+
       tiles_written = update_progressive_refine(progress.get_cancel());
     }
 
@@ -876,6 +1121,9 @@ void Session::run()
       run_cpu();
   }
 
+  /* Completed renders don't need their checkpoint anymore. */
+  checkpoint.end(!progress.get_cancel() && !progress.get_error());
+
   profiler.stop();
 
   /* progress update */
@@ -905,9 +1153,12 @@ void Session::reset_(BufferParams &buffer_params, int samples)
 
   tile_manager.reset(buffer_params, samples);
   stealable_tiles = 0;
+  adaptive_stats.tiles.clear();
   tile_stealing_state = NOT_STEALING;
   progress.reset_sample();
 
+  checkpoint_need_resume = checkpoint_enabled();
+
   bool show_progress = params.background || tile_manager.get_num_effective_samples() != INT_MAX;
   progress.set_total_pixel_samples(show_progress ? tile_manager.state.total_pixel_samples : 0);
 
@@ -1298,6 +1549,32 @@ void Session::device_free()
 void Session::collect_statistics(RenderStats *render_stats)
 {
   scene->collect_statistics(render_stats);
+
+  progress.get_time(render_stats->total_time, render_stats->render_time);
+  render_stats->mem_peak = stats.mem_peak;
+
+  {
+    thread_scoped_lock tile_lock(tile_mutex);
+    render_stats->adaptive = adaptive_stats;
+    render_stats->adaptive.threshold = scene->dscene.data.integrator.adaptive_threshold;
+  }
+
+  NamedSizeStats &buffer_stats = render_stats->buffer.buffers;
+  if (buffers) {
+    buffer_stats.add_entry(NamedSizeEntry("Render buffers", buffers->buffer.memory_size()));
+  }
+  if (display) {
+    buffer_stats.add_entry(NamedSizeEntry(
+        "Display buffers", display->rgba_byte.memory_size() + display->rgba_half.memory_size()));
+  }
+  else {
+    /* Tile buffers are freed as soon as tiles are written, report the size
+     * they take when all tiles of the frame are in memory at once. */
+    BufferParams &buffer_params = tile_manager.params;
+    const size_t pixel_size = buffer_params.get_passes_size() * sizeof(float);
+    buffer_stats.add_entry(NamedSizeEntry(
+        "Tile buffers", (size_t)buffer_params.width * buffer_params.height * pixel_size));
+  }
   if (params.use_profiling && (params.device.type == DEVICE_CPU)) {
     render_stats->collect_profiling(scene, profiler);
   }
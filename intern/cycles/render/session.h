@@ -19,6 +19,7 @@
 
 #include "device/device.h"
 #include "render/buffers.h"
+#include "render/checkpoint.h"
 #include "render/shader.h"
 #include "render/stats.h"
 #include "render/tile.h"
@@ -71,6 +72,11 @@ class SessionParams {
 
   ShadingSystem shadingsystem;
 
+  /* Periodically save render buffers to this file in background renders, and
+   * continue from it when restarting an interrupted render. */
+  string checkpoint_path;
+  double checkpoint_interval;
+
   function<bool(const uchar *pixels, int width, int height, int channels)> write_render_cb;
 
   SessionParams()
@@ -99,6 +105,8 @@ class SessionParams {
 
     shadingsystem = SHADINGSYSTEM_SVM;
     tile_order = TILE_CENTER;
+
+    checkpoint_interval = 60.0;
   }
 
   bool modified(const SessionParams &params)
@@ -203,6 +211,16 @@ class Session {
   void map_neighbor_tiles(RenderTileNeighbors &neighbors, Device *tile_device);
   void unmap_neighbor_tiles(RenderTileNeighbors &neighbors, Device *tile_device);
 
+  bool checkpoint_enabled();
+  void checkpoint_resume();
+  void checkpoint_resume_frame();
+  void checkpoint_resume_tiles();
+  void checkpoint_tile(RenderTile &rtile);
+  void checkpoint_frame();
+
+  /* Summarize the adaptive sampling debug passes of a finished tile. */
+  void collect_adaptive_tile_stats(RenderTile &rtile);
+
   bool device_use_gl;
 
   thread *session_thread;
@@ -238,6 +256,13 @@ class Session {
 
   /* progressive refine */
   bool update_progressive_refine(bool cancel);
+
+  RenderCheckpoint checkpoint;
+  bool checkpoint_need_resume;
+  double last_checkpoint_time;
+
+  /* Per tile adaptive sampling statistics of the current render, protected by tile_mutex. */
+  AdaptiveSamplingStats adaptive_stats;
 };
 
 CCL_NAMESPACE_END
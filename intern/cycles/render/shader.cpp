@@ -211,6 +211,9 @@ Shader::Shader() : Node(node_type)
   has_volume_attribute_dependency = false;
   has_integrator_dependency = false;
   has_volume_connected = false;
+  reused_compiled_nodes = false;
+  reused_has_constant_emission = false;
+  reused_constant_emission = make_float3(0.0f, 0.0f, 0.0f);
   prev_volume_step_rate = 0.0f;
 
   displacement_method = DISPLACE_BUMP;
@@ -228,6 +231,13 @@ Shader::~Shader()
 
 bool Shader::is_constant_emission(float3 *emission)
 {
+  if (reused_compiled_nodes) {
+    if (reused_has_constant_emission) {
+      *emission = reused_constant_emission;
+    }
+    return reused_has_constant_emission;
+  }
+
   /* If the shader has AOVs, they need to be evaluated, so we can't skip the shader. */
   foreach (ShaderNode *node, graph->nodes) {
     if (node->special_type == SHADER_SPECIAL_TYPE_OUTPUT_AOV) {
@@ -298,6 +308,7 @@ void Shader::set_graph(ShaderGraph *graph_)
   /* assign graph */
   delete graph;
   graph = graph_;
+  reused_compiled_nodes = false;
 
   /* Store info here before graph optimization to make sure that
    * nodes that get optimized away still count. */
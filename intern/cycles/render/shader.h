@@ -125,6 +125,13 @@ class Shader : public Node {
   bool has_volume_attribute_dependency;
   bool has_integrator_dependency;
 
+  /* Set when the compiled nodes of an identical graph were reused, in which case the graph of
+   * this shader is not finalized. is_constant_emission() then returns the result for the graph
+   * the nodes were compiled from. */
+  bool reused_compiled_nodes;
+  bool reused_has_constant_emission;
+  float3 reused_constant_emission;
+
   /* requested mesh attributes */
   AttributeRequestSet attributes;
 
@@ -101,6 +101,20 @@ string NamedSizeStats::full_report(int indent_level)
   return result;
 }
 
+string NamedSizeStats::json_report()
+{
+  sort(entries.begin(), entries.end(), namedSizeEntryComparator);
+  string result = string_printf("{\"total_size\": %zu, \"entries\": [", total_size);
+  for (size_t i = 0; i < entries.size(); i++) {
+    result += string_printf("%s{\"name\": %s, \"size\": %zu}",
+                            (i == 0) ? "" : ", ",
+                            string_json_quote(entries[i].name).c_str(),
+                            entries[i].size);
+  }
+  result += "]}";
+  return result;
+}
+
 string NamedTimeStats::full_report(int indent_level)
 {
   const string indent(indent_level * kIndentNumSpaces, ' ');
@@ -115,6 +129,20 @@ string NamedTimeStats::full_report(int indent_level)
   return result;
 }
 
+string NamedTimeStats::json_report()
+{
+  sort(entries.begin(), entries.end(), namedTimeEntryComparator);
+  string result = "{\"total_time\": " + string_json_number(total_time) + ", \"entries\": [";
+  for (size_t i = 0; i < entries.size(); i++) {
+    result += string_printf("%s{\"name\": %s, \"time\": %s}",
+                            (i == 0) ? "" : ", ",
+                            string_json_quote(entries[i].name).c_str(),
+                            string_json_number(entries[i].time).c_str());
+  }
+  result += "]}";
+  return result;
+}
+
 /* Named time sample statistics. */
 
 NamedNestedSampleStats::NamedNestedSampleStats() : name(""), self_samples(0), sum_samples(0)
@@ -170,6 +198,27 @@ string NamedNestedSampleStats::full_report(int indent_level, uint64_t total_samp
   return result;
 }
 
+string NamedNestedSampleStats::json_report()
+{
+  update_sum();
+
+  string result = string_printf(
+      "{\"name\": %s, \"self_samples\": %llu, \"sum_samples\": %llu, "
+      "\"self_time\": %.3f, \"sum_time\": %.3f, \"entries\": [",
+      string_json_quote(name).c_str(),
+      (unsigned long long)self_samples,
+      (unsigned long long)sum_samples,
+      self_samples * 0.001,
+      sum_samples * 0.001);
+
+  sort(entries.begin(), entries.end(), namedTimeSampleEntryComparator);
+  for (size_t i = 0; i < entries.size(); i++) {
+    result += ((i == 0) ? "" : ", ") + entries[i].json_report();
+  }
+  result += "]}";
+  return result;
+}
+
 /* Named sample count pairs. */
 
 NamedSampleCountPair::NamedSampleCountPair(const ustring &name, uint64_t samples, uint64_t hits)
@@ -224,9 +273,49 @@ string NamedSampleCountStats::full_report(int indent_level)
   return result;
 }
 
+string NamedSampleCountStats::json_report()
+{
+  vector<NamedSampleCountPair> sorted_entries;
+  sorted_entries.reserve(entries.size());
+
+  uint64_t total_hits = 0, total_samples = 0;
+  foreach (entry_map::const_reference entry, entries) {
+    const NamedSampleCountPair &pair = entry.second;
+
+    total_hits += pair.hits;
+    total_samples += pair.samples;
+
+    sorted_entries.push_back(pair);
+  }
+  const double avg_samples_per_hit = (total_hits != 0) ? ((double)total_samples) / total_hits :
+                                                         0.0;
+
+  sort(sorted_entries.begin(), sorted_entries.end(), namedSampleCountPairComparator);
+
+  string result = "[";
+  for (size_t i = 0; i < sorted_entries.size(); i++) {
+    const NamedSampleCountPair &entry = sorted_entries[i];
+    const double relative = (entry.hits != 0 && avg_samples_per_hit != 0.0) ?
+                                ((double)entry.samples) / (entry.hits * avg_samples_per_hit) :
+                                0.0;
+
+    result += string_printf(
+        "%s{\"name\": %s, \"samples\": %llu, \"hits\": %llu, \"time\": %.3f, "
+        "\"relative_cost\": %s}",
+        (i == 0) ? "" : ", ",
+        string_json_quote(entry.name.string()).c_str(),
+        (unsigned long long)entry.samples,
+        (unsigned long long)entry.hits,
+        entry.samples * 0.001,
+        string_json_number(relative).c_str());
+  }
+  result += "]";
+  return result;
+}
+
 /* Mesh statistics. */
 
-MeshStats::MeshStats()
+MeshStats::MeshStats() : num_bvh_built(0), num_bvh_refit(0), num_bvh_reused(0)
 {
 }
 
@@ -235,12 +324,26 @@ string MeshStats::full_report(int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Geometry:\n" + geometry.full_report(indent_level + 1);
+  result += indent + "BVH:\n" + bvh.full_report(indent_level + 1);
+  result += indent + string_printf("Object BVHs: %zu built, %zu refit, %zu reused\n",
+                                   num_bvh_built,
+                                   num_bvh_refit,
+                                   num_bvh_reused);
   return result;
 }
 
+string MeshStats::json_report()
+{
+  return "{\"geometry\": " + geometry.json_report() + ", \"bvh\": " + bvh.json_report() +
+         string_printf(", \"bvh_built\": %zu, \"bvh_refit\": %zu, \"bvh_reused\": %zu}",
+                       num_bvh_built,
+                       num_bvh_refit,
+                       num_bvh_reused);
+}
+
 /* Image statistics. */
 
-ImageStats::ImageStats()
+ImageStats::ImageStats() : num_loaded(0), num_reused(0)
 {
 }
 
@@ -249,6 +352,168 @@ string ImageStats::full_report(int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Textures:\n" + textures.full_report(indent_level + 1);
+  result += indent +
+            string_printf("Images: %zu loaded, %zu reused\n", num_loaded, num_reused);
+  return result;
+}
+
+string ImageStats::json_report()
+{
+  return "{\"textures\": " + textures.json_report() +
+         string_printf(", \"loaded\": %zu, \"reused\": %zu}", num_loaded, num_reused);
+}
+
+/* Render buffer statistics. */
+
+BufferStats::BufferStats()
+{
+}
+
+string BufferStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  string result = "";
+  result += indent + "Buffers:\n" + buffers.full_report(indent_level + 1);
+  return result;
+}
+
+string BufferStats::json_report()
+{
+  return "{\"buffers\": " + buffers.json_report() + "}";
+}
+
+/* Adaptive sampling statistics. */
+
+AdaptiveTileStats::AdaptiveTileStats()
+    : x(0),
+      y(0),
+      w(0),
+      h(0),
+      min_samples(0),
+      max_samples(0),
+      mean_samples(0.0f),
+      num_converged(0),
+      mean_error(0.0f),
+      max_error(0.0f),
+      render_time(0.0),
+      num_pixels(0),
+      total_samples(0.0),
+      total_error(0.0)
+{
+}
+
+void AdaptiveTileStats::add_pixel(int samples, float error, bool converged, double time)
+{
+  min_samples = (num_pixels == 0) ? samples : min(min_samples, samples);
+  max_samples = max(max_samples, samples);
+  max_error = max(max_error, error);
+  if (converged) {
+    num_converged++;
+  }
+  render_time += time;
+
+  num_pixels++;
+  total_samples += samples;
+  total_error += error;
+}
+
+void AdaptiveTileStats::finish(double tile_time)
+{
+  if (num_pixels) {
+    mean_samples = (float)(total_samples / num_pixels);
+    mean_error = (float)(total_error / num_pixels);
+  }
+  if (render_time == 0.0) {
+    render_time = tile_time;
+  }
+}
+
+AdaptiveSamplingStats::AdaptiveSamplingStats() : threshold(0.0f)
+{
+}
+
+namespace {
+
+bool adaptiveTileTimeComparator(const AdaptiveTileStats &a, const AdaptiveTileStats &b)
+{
+  /* We sort in descending order. */
+  return a.render_time > b.render_time;
+}
+
+}  // namespace
+
+string AdaptiveSamplingStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const string double_indent = indent + indent;
+
+  size_t num_pixels = 0, num_converged = 0;
+  double total_samples = 0.0, total_time = 0.0;
+  foreach (const AdaptiveTileStats &tile, tiles) {
+    num_pixels += tile.w * tile.h;
+    num_converged += tile.num_converged;
+    total_samples += (double)tile.mean_samples * tile.w * tile.h;
+    total_time += tile.render_time;
+  }
+
+  string result = "";
+  result += indent + string_printf("Noise threshold: %f\n", (double)threshold);
+  result += indent + string_printf("Tiles: %zu, %.2f%% of pixels converged\n",
+                                   tiles.size(),
+                                   num_pixels ? 100.0 * num_converged / num_pixels : 0.0);
+  result += indent + string_printf("Mean samples per pixel: %.2f\n",
+                                   num_pixels ? total_samples / num_pixels : 0.0);
+
+  /* Tiles which took longest, these are the ones to look at when tuning. */
+  vector<AdaptiveTileStats> sorted_tiles = tiles;
+  sort(sorted_tiles.begin(), sorted_tiles.end(), adaptiveTileTimeComparator);
+  const size_t num_slowest = min(sorted_tiles.size(), (size_t)10);
+
+  result += indent + "Slowest tiles:\n";
+  for (size_t i = 0; i < num_slowest; i++) {
+    const AdaptiveTileStats &tile = sorted_tiles[i];
+    result += double_indent +
+              string_printf("(%d, %d) %dx%d: %.3fs (%.2f%%), samples %d/%.2f/%d, "
+                            "%d converged, error %f/%f\n",
+                            tile.x,
+                            tile.y,
+                            tile.w,
+                            tile.h,
+                            tile.render_time,
+                            total_time > 0.0 ? 100.0 * tile.render_time / total_time : 0.0,
+                            tile.min_samples,
+                            (double)tile.mean_samples,
+                            tile.max_samples,
+                            tile.num_converged,
+                            (double)tile.mean_error,
+                            (double)tile.max_error);
+  }
+  return result;
+}
+
+string AdaptiveSamplingStats::json_report()
+{
+  string result = "{\"threshold\": " + string_json_number(threshold) + ", \"tiles\": [";
+  for (size_t i = 0; i < tiles.size(); i++) {
+    const AdaptiveTileStats &tile = tiles[i];
+    result += string_printf(
+        "%s{\"x\": %d, \"y\": %d, \"w\": %d, \"h\": %d, \"min_samples\": %d, "
+        "\"mean_samples\": %s, \"max_samples\": %d, \"converged\": %d, "
+        "\"mean_error\": %s, \"max_error\": %s, \"time\": %s}",
+        (i == 0) ? "" : ", ",
+        tile.x,
+        tile.y,
+        tile.w,
+        tile.h,
+        tile.min_samples,
+        string_json_number(tile.mean_samples).c_str(),
+        tile.max_samples,
+        tile.num_converged,
+        string_json_number(tile.mean_error).c_str(),
+        string_json_number(tile.max_error).c_str(),
+        string_json_number(tile.render_time).c_str());
+  }
+  result += "]}";
   return result;
 }
 
@@ -257,6 +522,9 @@ string ImageStats::full_report(int indent_level)
 RenderStats::RenderStats()
 {
   has_profiling = false;
+  total_time = 0.0;
+  render_time = 0.0;
+  mem_peak = 0;
 }
 
 void RenderStats::collect_profiling(Scene *scene, Profiler &prof)
@@ -334,6 +602,10 @@ string RenderStats::full_report()
   string result = "";
   result += "Mesh statistics:\n" + mesh.full_report(1);
   result += "Image statistics:\n" + image.full_report(1);
+  result += "Buffer statistics:\n" + buffer.full_report(1);
+  if (!adaptive.tiles.empty()) {
+    result += "Adaptive sampling statistics:\n" + adaptive.full_report(1);
+  }
   if (has_profiling) {
     result += "Kernel statistics:\n" + kernel.full_report(1);
     result += "Shader statistics:\n" + shaders.full_report(1);
@@ -345,6 +617,27 @@ string RenderStats::full_report()
   return result;
 }
 
+string RenderStats::json_report()
+{
+  string result = "{";
+  result += "\"total_time\": " + string_json_number(total_time) + ", ";
+  result += "\"render_time\": " + string_json_number(render_time) + ", ";
+  result += string_printf("\"mem_peak\": %zu, ", mem_peak);
+  result += "\"mesh\": " + mesh.json_report() + ", ";
+  result += "\"image\": " + image.json_report() + ", ";
+  result += "\"buffer\": " + buffer.json_report();
+  if (!adaptive.tiles.empty()) {
+    result += ", \"adaptive\": " + adaptive.json_report();
+  }
+  if (has_profiling) {
+    result += ", \"kernel\": " + kernel.json_report();
+    result += ", \"shaders\": " + shaders.json_report();
+    result += ", \"objects\": " + objects.json_report();
+  }
+  result += "}";
+  return result;
+}
+
 NamedTimeStats::NamedTimeStats() : total_time(0.0)
 {
 }
@@ -354,6 +647,11 @@ string UpdateTimeStats::full_report(int indent_level)
   return times.full_report(indent_level + 1);
 }
 
+string UpdateTimeStats::json_report()
+{
+  return times.json_report();
+}
+
 SceneUpdateStats::SceneUpdateStats()
 {
 }
@@ -378,6 +676,27 @@ string SceneUpdateStats::full_report()
   return result;
 }
 
+string SceneUpdateStats::json_report()
+{
+  string result = "{";
+  result += "\"scene\": " + scene.json_report();
+  result += ", \"geometry\": " + geometry.json_report();
+  result += ", \"light\": " + light.json_report();
+  result += ", \"object\": " + object.json_report();
+  result += ", \"image\": " + image.json_report();
+  result += ", \"background\": " + background.json_report();
+  result += ", \"bake\": " + bake.json_report();
+  result += ", \"camera\": " + camera.json_report();
+  result += ", \"film\": " + film.json_report();
+  result += ", \"integrator\": " + integrator.json_report();
+  result += ", \"osl\": " + osl.json_report();
+  result += ", \"particles\": " + particles.json_report();
+  result += ", \"svm\": " + svm.json_report();
+  result += ", \"tables\": " + tables.json_report();
+  result += "}";
+  return result;
+}
+
 void SceneUpdateStats::clear()
 {
   geometry.times.clear();
@@ -64,6 +64,9 @@ class NamedSizeStats {
   /* Generate full human-readable report. */
   string full_report(int indent_level = 0);
 
+  /* Generate machine-readable JSON report. */
+  string json_report();
+
   /* Total size of all entries. */
   size_t total_size;
 
@@ -87,6 +90,9 @@ class NamedTimeStats {
   /* Generate full human-readable report. */
   string full_report(int indent_level = 0);
 
+  /* Generate machine-readable JSON report. */
+  string json_report();
+
   /* Total time of all entries. */
   double total_time;
 
@@ -113,6 +119,7 @@ class NamedNestedSampleStats {
   void update_sum();
 
   string full_report(int indent_level = 0, uint64_t total_samples = 0);
+  string json_report();
 
   string name;
 
@@ -141,6 +148,7 @@ class NamedSampleCountStats {
   NamedSampleCountStats();
 
   string full_report(int indent_level = 0);
+  string json_report();
   void add(const ustring &name, uint64_t samples, uint64_t hits);
 
   typedef unordered_map<ustring, NamedSampleCountPair, ustringHash> entry_map;
@@ -155,11 +163,23 @@ class MeshStats {
   /* Generate full human-readable report. */
   string full_report(int indent_level = 0);
 
+  /* Generate machine-readable JSON report. */
+  string json_report();
+
   /* Input geometry statistics, this is what is coming as an input to render
    * from. say, Blender. This does not include runtime or engine specific
    * memory like BVH.
    */
   NamedSizeStats geometry;
+
+  /* Device memory used by the BVH of the scene. */
+  NamedSizeStats bvh;
+
+  /* Object BVHs built, refitted or kept unchanged in the last update. With
+   * persistent data, unchanged geometry keeps its BVH from previous frames. */
+  size_t num_bvh_built;
+  size_t num_bvh_refit;
+  size_t num_bvh_reused;
 };
 
 /* Statistics about images held in memory. */
@@ -170,7 +190,80 @@ class ImageStats {
   /* Generate full human-readable report. */
   string full_report(int indent_level = 0);
 
+  /* Generate machine-readable JSON report. */
+  string json_report();
+
   NamedSizeStats textures;
+
+  /* Images loaded in the last update, and images kept from previous updates. */
+  size_t num_loaded;
+  size_t num_reused;
+};
+
+/* Statistics about render buffers held in memory. */
+class BufferStats {
+ public:
+  BufferStats();
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  /* Generate machine-readable JSON report. */
+  string json_report();
+
+  NamedSizeStats buffers;
+};
+
+/* Adaptive sampling summary of a single tile, gathered from the debug passes. */
+class AdaptiveTileStats {
+ public:
+  AdaptiveTileStats();
+
+  /* Tile bounds in pixels. */
+  int x, y, w, h;
+
+  /* Samples taken per pixel. */
+  int min_samples;
+  int max_samples;
+  float mean_samples;
+
+  /* Pixels which were flagged as converged by adaptive sampling. */
+  int num_converged;
+
+  /* Error at the last convergence check, in the same units as the noise threshold. */
+  float mean_error;
+  float max_error;
+
+  /* Seconds spent path tracing the tile. */
+  double render_time;
+
+  /* Add a pixel to the summary. Time is the seconds spent on the pixel, or zero when the
+   * device does not measure time per pixel. */
+  void add_pixel(int samples, float error, bool converged, double time);
+
+  /* Compute the means once all pixels were added. Without per pixel timing, the time measured
+   * for the whole tile is used. */
+  void finish(double tile_time);
+
+ private:
+  size_t num_pixels;
+  double total_samples;
+  double total_error;
+};
+
+/* Statistics about adaptive sampling, per tile. */
+class AdaptiveSamplingStats {
+ public:
+  AdaptiveSamplingStats();
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  /* Generate machine-readable JSON report. */
+  string json_report();
+
+  float threshold;
+  vector<AdaptiveTileStats> tiles;
 };
 
 /* Render process statistics. */
@@ -181,13 +274,26 @@ class RenderStats {
   /* Return full report as string. */
   string full_report();
 
+  /* Return all statistics as a JSON object, for tools which keep track of
+   * render time and memory usage over many renders. */
+  string json_report();
+
   /* Collect kernel sampling information from Stats. */
   void collect_profiling(Scene *scene, Profiler &prof);
 
   bool has_profiling;
 
+  /* Wall clock time of the whole session and of the rendering part of it. */
+  double total_time;
+  double render_time;
+
+  /* Peak memory usage of the device, over all categories. */
+  size_t mem_peak;
+
   MeshStats mesh;
   ImageStats image;
+  BufferStats buffer;
+  AdaptiveSamplingStats adaptive;
   NamedNestedSampleStats kernel;
   NamedSampleCountStats shaders;
   NamedSampleCountStats objects;
@@ -198,6 +304,9 @@ class UpdateTimeStats {
   /* Generate full human-readable report. */
   string full_report(int indent_level = 0);
 
+  /* Generate machine-readable JSON report. */
+  string json_report();
+
   NamedTimeStats times;
 };
 
@@ -221,6 +330,7 @@ class SceneUpdateStats {
   UpdateTimeStats tables;
 
   string full_report();
+  string json_report();
 
   void clear();
 };
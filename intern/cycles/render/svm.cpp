@@ -28,6 +28,7 @@
 
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
+#include "util/util_md5.h"
 #include "util/util_progress.h"
 #include "util/util_task.h"
 
@@ -45,28 +46,148 @@ SVMShaderManager::~SVMShaderManager()
 
 void SVMShaderManager::reset(Scene * /*scene*/)
 {
+  compiled_shaders.clear();
 }
 
-void SVMShaderManager::device_update_shader(Scene *scene,
-                                            Shader *shader,
-                                            Progress *progress,
-                                            array<int4> *svm_nodes)
+/* Shader information filled in by the compiler, stored along with cached nodes. */
+
+enum {
+  SHADER_COMPILED_SURFACE = (1 << 0),
+  SHADER_COMPILED_SURFACE_EMISSION = (1 << 1),
+  SHADER_COMPILED_SURFACE_TRANSPARENT = (1 << 2),
+  SHADER_COMPILED_SURFACE_BSSRDF = (1 << 3),
+  SHADER_COMPILED_VOLUME = (1 << 4),
+  SHADER_COMPILED_DISPLACEMENT = (1 << 5),
+  SHADER_COMPILED_BUMP = (1 << 6),
+  SHADER_COMPILED_BSSRDF_BUMP = (1 << 7),
+  SHADER_COMPILED_SURFACE_SPATIAL_VARYING = (1 << 8),
+  SHADER_COMPILED_VOLUME_SPATIAL_VARYING = (1 << 9),
+  SHADER_COMPILED_VOLUME_ATTRIBUTE_DEPENDENCY = (1 << 10),
+};
+
+static uint shader_compiled_flags(const Shader *shader)
+{
+  uint flags = 0;
+  flags |= (shader->has_surface) ? SHADER_COMPILED_SURFACE : 0;
+  flags |= (shader->has_surface_emission) ? SHADER_COMPILED_SURFACE_EMISSION : 0;
+  flags |= (shader->has_surface_transparent) ? SHADER_COMPILED_SURFACE_TRANSPARENT : 0;
+  flags |= (shader->has_surface_bssrdf) ? SHADER_COMPILED_SURFACE_BSSRDF : 0;
+  flags |= (shader->has_volume) ? SHADER_COMPILED_VOLUME : 0;
+  flags |= (shader->has_displacement) ? SHADER_COMPILED_DISPLACEMENT : 0;
+  flags |= (shader->has_bump) ? SHADER_COMPILED_BUMP : 0;
+  flags |= (shader->has_bssrdf_bump) ? SHADER_COMPILED_BSSRDF_BUMP : 0;
+  flags |= (shader->has_surface_spatial_varying) ? SHADER_COMPILED_SURFACE_SPATIAL_VARYING : 0;
+  flags |= (shader->has_volume_spatial_varying) ? SHADER_COMPILED_VOLUME_SPATIAL_VARYING : 0;
+  flags |= (shader->has_volume_attribute_dependency) ?
+               SHADER_COMPILED_VOLUME_ATTRIBUTE_DEPENDENCY :
+               0;
+  return flags;
+}
+
+static void shader_set_compiled_flags(Shader *shader, const uint flags)
+{
+  shader->has_surface = (flags & SHADER_COMPILED_SURFACE) != 0;
+  shader->has_surface_emission = (flags & SHADER_COMPILED_SURFACE_EMISSION) != 0;
+  shader->has_surface_transparent = (flags & SHADER_COMPILED_SURFACE_TRANSPARENT) != 0;
+  shader->has_surface_bssrdf = (flags & SHADER_COMPILED_SURFACE_BSSRDF) != 0;
+  shader->has_volume = (flags & SHADER_COMPILED_VOLUME) != 0;
+  shader->has_displacement = (flags & SHADER_COMPILED_DISPLACEMENT) != 0;
+  shader->has_bump = (flags & SHADER_COMPILED_BUMP) != 0;
+  shader->has_bssrdf_bump = (flags & SHADER_COMPILED_BSSRDF_BUMP) != 0;
+  shader->has_surface_spatial_varying = (flags & SHADER_COMPILED_SURFACE_SPATIAL_VARYING) != 0;
+  shader->has_volume_spatial_varying = (flags & SHADER_COMPILED_VOLUME_SPATIAL_VARYING) != 0;
+  shader->has_volume_attribute_dependency = (flags &
+                                             SHADER_COMPILED_VOLUME_ATTRIBUTE_DEPENDENCY) != 0;
+  shader->has_integrator_dependency = false;
+}
+
+/* Compiled nodes stay valid as long as the graph that was compiled still belongs
+ * to its shader, as that graph holds the image and IES slots referenced by the
+ * nodes. A replaced graph is not finalized yet, even if it was allocated at the
+ * same address as the old one. */
+void SVMShaderManager::validate_compiled_shaders(Scene *scene)
+{
+  set<Shader *> shaders(scene->shaders.begin(), scene->shaders.end());
+
+  for (CompiledShaderMap::iterator it = compiled_shaders.begin(); it != compiled_shaders.end();) {
+    const CompiledShader &compiled = it->second;
+    if (shaders.find(compiled.shader) == shaders.end() ||
+        compiled.shader->graph != compiled.graph || !compiled.graph->finalized) {
+      it = compiled_shaders.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+}
+
+void SVMShaderManager::device_update_shader(
+    Scene *scene, Shader *shader, Progress *progress, array<int4> *svm_nodes, int *reused)
 {
   if (progress->get_cancel()) {
     return;
   }
   assert(shader->graph);
 
+  ShaderGraph *graph = shader->graph;
+  const bool background = (shader == scene->background->get_shader(scene));
+
+  /* Identify the compiled nodes by the graph contents before finalizing, along
+   * with the shader settings that affect compilation. This way shaders with an
+   * identical graph skip both finalizing and compiling. */
+  if (graph->content_hash.empty() && !graph->finalized) {
+    graph->compute_content_hash();
+  }
+
+  string key;
+  if (!graph->content_hash.empty()) {
+    MD5Hash md5;
+    md5.append(graph->content_hash);
+    const int settings[3] = {shader->used, shader->get_displacement_method(), background};
+    md5.append((const uint8_t *)settings, sizeof(settings));
+    key = md5.get_hex();
+
+    thread_scoped_lock lock(compiled_shaders_mutex);
+    CompiledShaderMap::const_iterator it = compiled_shaders.find(key);
+    if (it != compiled_shaders.end()) {
+      const CompiledShader &compiled = it->second;
+      *svm_nodes = compiled.svm_nodes;
+      shader_set_compiled_flags(shader, compiled.flags);
+      shader->reused_compiled_nodes = true;
+      shader->reused_has_constant_emission = compiled.has_constant_emission;
+      shader->reused_constant_emission = compiled.constant_emission;
+      *reused = 1;
+      return;
+    }
+  }
+
+  shader->reused_compiled_nodes = false;
+
   svm_nodes->push_back_slow(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
 
   SVMCompiler::Summary summary;
   SVMCompiler compiler(scene);
-  compiler.background = (shader == scene->background->get_shader(scene));
+  compiler.background = background;
   compiler.compile(shader, *svm_nodes, 0, &summary);
 
   VLOG(2) << "Compilation summary:\n"
           << "Shader name: " << shader->name << "\n"
           << summary.full_report();
+
+  /* Shaders depending on integrator settings are simplified again on every
+   * update, so their nodes can not be reused. */
+  if (!key.empty() && !shader->has_integrator_dependency) {
+    thread_scoped_lock lock(compiled_shaders_mutex);
+    if (compiled_shaders.find(key) == compiled_shaders.end()) {
+      CompiledShader &compiled = compiled_shaders[key];
+      compiled.shader = shader;
+      compiled.graph = graph;
+      compiled.svm_nodes = *svm_nodes;
+      compiled.flags = shader_compiled_flags(shader);
+      compiled.constant_emission = make_float3(0.0f, 0.0f, 0.0f);
+      compiled.has_constant_emission = shader->is_constant_emission(&compiled.constant_emission);
+    }
+  }
 }
 
 void SVMShaderManager::device_update(Device *device,
@@ -77,12 +198,6 @@ void SVMShaderManager::device_update(Device *device,
   if (!need_update)
     return;
 
-  scoped_callback_timer timer([scene](double time) {
-    if (scene->update_stats) {
-      scene->update_stats->svm.times.add_entry({"device_update", time});
-    }
-  });
-
   const int num_shaders = scene->shaders.size();
 
   VLOG(1) << "Total " << num_shaders << " shaders.";
@@ -92,23 +207,48 @@ void SVMShaderManager::device_update(Device *device,
   /* test if we need to update */
   device_free(device, dscene, scene);
 
-  /* Build all shaders. */
-  TaskPool task_pool;
+  /* Build all shaders, reusing nodes of unchanged and identical shaders. */
   vector<array<int4>> shader_svm_nodes(num_shaders);
-  for (int i = 0; i < num_shaders; i++) {
-    task_pool.push(function_bind(&SVMShaderManager::device_update_shader,
-                                 this,
-                                 scene,
-                                 scene->shaders[i],
-                                 &progress,
-                                 &shader_svm_nodes[i]));
+  vector<int> shader_reused(num_shaders, 0);
+  {
+    scoped_callback_timer timer([scene](double time) {
+      if (scene->update_stats) {
+        scene->update_stats->svm.times.add_entry({"device_update (compile shaders)", time});
+      }
+    });
+
+    validate_compiled_shaders(scene);
+
+    TaskPool task_pool;
+    for (int i = 0; i < num_shaders; i++) {
+      task_pool.push(function_bind(&SVMShaderManager::device_update_shader,
+                                   this,
+                                   scene,
+                                   scene->shaders[i],
+                                   &progress,
+                                   &shader_svm_nodes[i],
+                                   &shader_reused[i]));
+    }
+    task_pool.wait_work();
   }
-  task_pool.wait_work();
 
   if (progress.get_cancel()) {
     return;
   }
 
+  int num_reused = 0;
+  foreach (int reused, shader_reused) {
+    num_reused += reused;
+  }
+  VLOG(1) << "Compiled " << num_shaders - num_reused << " shaders, reused " << num_reused
+          << " compiled shaders.";
+
+  scoped_callback_timer timer([scene](double time) {
+    if (scene->update_stats) {
+      scene->update_stats->svm.times.add_entry({"device_update", time});
+    }
+  });
+
   /* The global node list contains a jump table (one node per shader)
    * followed by the nodes of all shaders. */
   int svm_nodes_size = num_shaders;
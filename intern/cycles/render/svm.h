@@ -22,6 +22,7 @@
 #include "render/shader.h"
 
 #include "util/util_array.h"
+#include "util/util_map.h"
 #include "util/util_set.h"
 #include "util/util_string.h"
 #include "util/util_thread.h"
@@ -50,10 +51,29 @@ class SVMShaderManager : public ShaderManager {
   void device_free(Device *device, DeviceScene *dscene, Scene *scene);
 
  protected:
+  /* Compiled nodes of a shader, reused for shaders with an identical graph and
+   * settings, and for shaders that did not change since the previous update. */
+  struct CompiledShader {
+    /* Shader whose graph holds the image and IES references used by the nodes. */
+    Shader *shader;
+    ShaderGraph *graph;
+    array<int4> svm_nodes;
+    uint flags;
+    /* Result of is_constant_emission() for the finalized graph. */
+    bool has_constant_emission;
+    float3 constant_emission;
+  };
+
+  typedef unordered_map<string, CompiledShader> CompiledShaderMap;
+  CompiledShaderMap compiled_shaders;
+  thread_mutex compiled_shaders_mutex;
+
   void device_update_shader(Scene *scene,
                             Shader *shader,
                             Progress *progress,
-                            array<int4> *svm_nodes);
+                            array<int4> *svm_nodes,
+                            int *reused);
+  void validate_compiled_shaders(Scene *scene);
 };
 
 /* Graph Compiler */
@@ -107,6 +107,7 @@ TileManager::TileManager(bool progressive_,
   preserve_tile_device = preserve_tile_device_;
   background = background_;
   schedule_denoising = false;
+  handout_split_threshold = 0;
 
   range_start_sample = 0;
   range_num_samples = -1;
@@ -131,6 +132,18 @@ void TileManager::device_free()
   state.tiles.clear();
 }
 
+/* Smallest tile width or height produced by splitting. */
+#define TILE_SPLIT_MIN_SIZE 16
+
+/* Room for split tiles, enough to split each of the last tiles down to the smallest size.
+ * With less room splitting stops at the cheap tiles handed out first, before it reaches the
+ * last and often slowest ones. */
+static int tile_split_reserve(int2 tile_size, int split_threshold)
+{
+  return split_threshold * max(tile_size.x / TILE_SPLIT_MIN_SIZE, 1) *
+         max(tile_size.y / TILE_SPLIT_MIN_SIZE, 1);
+}
+
 static int get_divider(int w, int h, int start_resolution)
 {
   int divider = 1;
@@ -382,6 +395,13 @@ void TileManager::set_tiles()
 
   state.num_tiles = gen_tiles(!background);
 
+  /* Reserve room for split tiles up front, tiles are referenced by pointer while
+   * other threads may be splitting. */
+  if (handout_split_threshold > 0) {
+    state.tiles.reserve(state.tiles.size() +
+                        tile_split_reserve(tile_size, handout_split_threshold));
+  }
+
   state.buffer.width = image_w;
   state.buffer.height = image_h;
 
@@ -544,6 +564,7 @@ bool TileManager::next_tile(Tile *&tile, int device, uint tile_types)
 
       tile_index = state.render_tiles[logical_device].front();
       state.render_tiles[logical_device].pop_front();
+      split_tile_on_handout(tile_index, state.render_tiles[logical_device]);
       break;
     }
 
@@ -556,6 +577,97 @@ bool TileManager::next_tile(Tile *&tile, int device, uint tile_types)
   return false;
 }
 
+/* Split a tile in halves along its longer side, as long as the halves are not smaller than
+ * TILE_SPLIT_MIN_SIZE. Returns the index of the new second half, or -1. */
+int TileManager::split_tile_in_half(int index)
+{
+  Tile &tile = state.tiles[index];
+  const int new_index = state.tiles.size();
+  Tile second;
+
+  if (tile.w >= tile.h && tile.w >= 2 * TILE_SPLIT_MIN_SIZE) {
+    const int w = tile.w / 2;
+    second = Tile(new_index, tile.x + w, tile.y, tile.w - w, tile.h, tile.device, Tile::RENDER);
+    tile.w = w;
+  }
+  else if (tile.h >= 2 * TILE_SPLIT_MIN_SIZE) {
+    const int h = tile.h / 2;
+    second = Tile(new_index, tile.x, tile.y + h, tile.w, tile.h - h, tile.device, Tile::RENDER);
+    tile.h = h;
+  }
+  else {
+    return -1;
+  }
+
+  /* Only add after modifying the tile, the reference is invalid if the tiles are
+   * reallocated. */
+  state.tiles.push_back(second);
+  state.num_tiles++;
+  return new_index;
+}
+
+/* Near the end of a frame there are fewer tiles left than threads, and the threads that
+ * finish first sit idle while the slowest tiles render. Instead split the tile that is
+ * handed out in halves along its longer side until there is enough work left for every
+ * thread. The other halves are queued in front, so idle threads pick up neighboring
+ * pixels next.
+ *
+ * Only tiles that are handed out are split. A tile already being rendered is never split,
+ * so a heavy tile handed out before the threshold was reached still renders on a single
+ * thread, see render_tile_performance_test.cpp. */
+void TileManager::split_tile_on_handout(int index, list<int> &render_tiles)
+{
+  /* Denoising finds neighbors on the regular tile grid, and progressive rendering
+   * keeps the same tiles for all samples. */
+  if (handout_split_threshold == 0 || schedule_denoising || progressive) {
+    return;
+  }
+
+  while ((int)render_tiles.size() + 1 < handout_split_threshold &&
+         state.tiles.size() < state.tiles.capacity()) {
+    const int new_index = split_tile_in_half(index);
+    if (new_index == -1) {
+      break;
+    }
+    render_tiles.push_front(new_index);
+  }
+}
+
+/* Splitting always halves the same way, so the pieces of a tile split by an interrupted
+ * render are found again by repeatedly splitting the half containing the rectangle. This
+ * happens before rendering starts, so unlike split_tile_on_handout() the tiles may be
+ * reallocated. */
+int TileManager::split_tile_to(int index, int x, int y, int w, int h)
+{
+  while (true) {
+    const Tile &tile = state.tiles[index];
+    if (tile.x == x && tile.y == y && tile.w == w && tile.h == h) {
+      return index;
+    }
+    if (schedule_denoising || progressive) {
+      return -1;
+    }
+    if (x < tile.x || y < tile.y || x + w > tile.x + tile.w || y + h > tile.y + tile.h) {
+      return -1;
+    }
+
+    /* Keep the room reserved for splitting during rendering. */
+    state.tiles.reserve(state.tiles.size() + 1 +
+                        tile_split_reserve(tile_size, handout_split_threshold));
+
+    const int new_index = split_tile_in_half(index);
+    if (new_index == -1) {
+      return -1;
+    }
+
+    const Tile &second = state.tiles[new_index];
+    state.render_tiles[second.device].push_front(new_index);
+    if (x >= second.x && y >= second.y) {
+      index = new_index;
+    }
+  }
+}
+
 bool TileManager::done()
 {
   int end_sample = (range_num_samples == -1) ? num_samples :
@@ -133,6 +133,17 @@ class TileManager {
   /* Schedule tiles for denoising after they've been rendered. */
   bool schedule_denoising;
 
+  /* Split tiles as they are handed out once fewer than this many are left to render,
+   * so threads that run out of work near the end of a frame take part of the remaining
+   * tiles instead of sitting idle. Tiles that are already being rendered are not split.
+   * Zero disables splitting. */
+  int handout_split_threshold;
+
+  /* Split a tile waiting to be rendered until one of the pieces is the given rectangle,
+   * for resuming tiles that were split by an interrupted render. Returns the index of the
+   * piece or -1. */
+  int split_tile_to(int index, int x, int y, int w, int h);
+
  protected:
   void set_tiles();
 
@@ -165,6 +176,9 @@ class TileManager {
   /* Generate tile list, return number of tiles. */
   int gen_tiles(bool sliced);
   void gen_render_tiles();
+
+  int split_tile_in_half(int index);
+  void split_tile_on_handout(int index, list<int> &render_tiles);
 };
 
 CCL_NAMESPACE_END
@@ -224,9 +224,25 @@ float QuadDice::scale_factor(Subpatch &sub, int Mu, int Mv)
   return S;
 }
 
-void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
+void QuadDice::grid_size(Subpatch &sub, int *Mu, int *Mv)
 {
-  /* create inner grid */
+  /* compute inner grid size with scale factor */
+  *Mu = max(sub.edge_u0.T, sub.edge_u1.T);
+  *Mv = max(sub.edge_v0.T, sub.edge_v1.T);
+
+#if 0 /* Doesn't work very well, especially at grazing angles. */
+  float S = scale_factor(sub, ef, *Mu, *Mv);
+#else
+  float S = 1.0f;
+#endif
+
+  *Mu = max((int)ceilf(S * *Mu), 2);  // XXX handle 0 & 1?
+  *Mv = max((int)ceilf(S * *Mv), 2);  // XXX handle 0 & 1?
+}
+
+void QuadDice::set_grid_verts(Subpatch &sub, int Mu, int Mv, int offset)
+{
+  /* create inner grid verts */
   float du = 1.0f / (float)Mu;
   float dv = 1.0f / (float)Mv;
 
@@ -236,37 +252,41 @@ void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
       float v = j * dv;
 
       set_vert(sub, offset + (i - 1) + (j - 1) * (Mu - 1), u, v);
+    }
+  }
+}
 
-      if (i < Mu - 1 && j < Mv - 1) {
-        int i1 = offset + (i - 1) + (j - 1) * (Mu - 1);
-        int i2 = offset + i + (j - 1) * (Mu - 1);
-        int i3 = offset + i + j * (Mu - 1);
-        int i4 = offset + (i - 1) + j * (Mu - 1);
-
-        add_triangle(sub.patch, i1, i2, i3);
-        add_triangle(sub.patch, i1, i3, i4);
-      }
+void QuadDice::add_grid_triangles(Subpatch &sub, int Mu, int Mv, int offset)
+{
+  /* create inner grid triangles */
+  for (int j = 1; j < Mv - 1; j++) {
+    for (int i = 1; i < Mu - 1; i++) {
+      int i1 = offset + (i - 1) + (j - 1) * (Mu - 1);
+      int i2 = offset + i + (j - 1) * (Mu - 1);
+      int i3 = offset + i + j * (Mu - 1);
+      int i4 = offset + (i - 1) + j * (Mu - 1);
+
+      add_triangle(sub.patch, i1, i2, i3);
+      add_triangle(sub.patch, i1, i3, i4);
     }
   }
 }
 
-void QuadDice::dice(Subpatch &sub)
+void QuadDice::dice_inner_verts(Subpatch &sub)
 {
-  /* compute inner grid size with scale factor */
-  int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
-  int Mv = max(sub.edge_v0.T, sub.edge_v1.T);
+  int Mu, Mv;
+  grid_size(sub, &Mu, &Mv);
 
-#if 0 /* Doesn't work very well, especially at grazing angles. */
-  float S = scale_factor(sub, ef, Mu, Mv);
-#else
-  float S = 1.0f;
-#endif
+  set_grid_verts(sub, Mu, Mv, sub.inner_grid_vert_offset);
+}
 
-  Mu = max((int)ceilf(S * Mu), 2);  // XXX handle 0 & 1?
-  Mv = max((int)ceilf(S * Mv), 2);  // XXX handle 0 & 1?
+void QuadDice::dice(Subpatch &sub)
+{
+  int Mu, Mv;
+  grid_size(sub, &Mu, &Mv);
 
-  /* inner grid */
-  add_grid(sub, Mu, Mv, sub.inner_grid_vert_offset);
+  /* inner grid, verts are set by dice_inner_verts() */
+  add_grid_triangles(sub, Mu, Mv, sub.inner_grid_vert_offset);
 
   /* sides */
   set_side(sub, 0);
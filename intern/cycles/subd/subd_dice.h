@@ -43,6 +43,9 @@ struct SubdParams {
   int max_level;
   Camera *camera;
   Transform objecttoworld;
+  /* Relative change of edge factors below which faces are split as in the previous
+   * tessellation of the mesh. */
+  float reuse_tolerance;
 
   SubdParams(Mesh *mesh_, bool ptex_ = false)
   {
@@ -54,6 +57,7 @@ struct SubdParams {
     dicing_rate = 1.0f;
     max_level = 12;
     camera = NULL;
+    reuse_tolerance = 0.1f;
   }
 };
 
@@ -88,13 +92,18 @@ class QuadDice : public EdgeDice {
   float2 map_uv(Subpatch &sub, float u, float v);
   void set_vert(Subpatch &sub, int index, float u, float v);
 
-  void add_grid(Subpatch &sub, int Mu, int Mv, int offset);
+  void grid_size(Subpatch &sub, int *Mu, int *Mv);
+  void set_grid_verts(Subpatch &sub, int Mu, int Mv, int offset);
+  void add_grid_triangles(Subpatch &sub, int Mu, int Mv, int offset);
 
   void set_side(Subpatch &sub, int edge);
 
   float quad_area(const float3 &a, const float3 &b, const float3 &c, const float3 &d);
   float scale_factor(Subpatch &sub, int Mu, int Mv);
 
+  /* Vertices inside the subpatch, which are not shared with other subpatches so can be set
+   * for many subpatches in parallel before dicing them. */
+  void dice_inner_verts(Subpatch &sub);
   void dice(Subpatch &sub);
 };
 
@@ -24,7 +24,10 @@
 #include "util/util_algorithm.h"
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
+#include "util/util_map.h"
 #include "util/util_math.h"
+#include "util/util_task.h"
+#include "util/util_time.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -57,12 +60,10 @@ static void order_float2(float2 &a, float2 &b)
   }
 }
 
-int DiagSplit::T(Patch *patch, float2 Pstart, float2 Pend, bool recursive_resolve)
+void DiagSplit::edge_length(Patch *patch, float2 Pstart, float2 Pend, float *Lsum, float *Lmax)
 {
-  order_float2(Pstart, Pend); /* May not be necessary, but better to be safe. */
-
-  float Lsum = 0.0f;
-  float Lmax = 0.0f;
+  *Lsum = 0.0f;
+  *Lmax = 0.0f;
 
   float3 Plast = to_world(patch, Pstart);
 
@@ -83,11 +84,50 @@ int DiagSplit::T(Patch *patch, float2 Pstart, float2 Pend, bool recursive_resolv
       L = len(P - Plast) / pixel_width;
     }
 
-    Lsum += L;
-    Lmax = max(L, Lmax);
+    *Lsum += L;
+    *Lmax = max(L, *Lmax);
 
     Plast = P;
   }
+}
+
+void DiagSplit::patch_edge_factors(Patch *patch, float factors[4])
+{
+  const Subpatch sub(patch);
+  const float2 edges[4][2] = {
+      {sub.c00, sub.c10}, {sub.c01, sub.c11}, {sub.c00, sub.c01}, {sub.c10, sub.c11}};
+
+  for (int i = 0; i < 4; i++) {
+    float2 Pstart = edges[i][0], Pend = edges[i][1];
+    order_float2(Pstart, Pend);
+
+    float Lsum, Lmax;
+    edge_length(patch, Pstart, Pend, &Lsum, &Lmax);
+    factors[i] = Lsum / params.dicing_rate;
+  }
+}
+
+int DiagSplit::T(Patch *patch, float2 Pstart, float2 Pend, bool recursive_resolve)
+{
+  if (replay_T) {
+    return *(replay_T++);
+  }
+
+  const int res = T_eval(patch, Pstart, Pend, recursive_resolve);
+
+  if (record_T) {
+    record_T->push_back(res);
+  }
+
+  return res;
+}
+
+int DiagSplit::T_eval(Patch *patch, float2 Pstart, float2 Pend, bool recursive_resolve)
+{
+  order_float2(Pstart, Pend); /* May not be necessary, but better to be safe. */
+
+  float Lsum, Lmax;
+  edge_length(patch, Pstart, Pend, &Lsum, &Lmax);
 
   int tmin = (int)ceilf(Lsum / params.dicing_rate);
   int tmax = (int)ceilf((params.test_steps - 1) * Lmax /
@@ -100,7 +140,7 @@ int DiagSplit::T(Patch *patch, float2 Pstart, float2 Pend, bool recursive_resolv
     }
     else {
       float2 P = (Pstart + Pend) * 0.5f;
-      res = T(patch, Pstart, P, true) + T(patch, P, Pend, true);
+      res = T_eval(patch, Pstart, P, true) + T_eval(patch, P, Pend, true);
     }
   }
 
@@ -337,31 +377,196 @@ Edge *DiagSplit::alloc_edge()
   return &edges.back();
 }
 
+static bool split_cache_valid(const DiagSplitCache *cache, const SubdParams &params)
+{
+  const Mesh *mesh = params.mesh;
+
+  return cache->subdivision_type == mesh->get_subdivision_type() &&
+         cache->dicing_rate == params.dicing_rate && cache->max_level == params.max_level &&
+         cache->use_camera == (params.camera != NULL) &&
+         cache->subd_num_corners == mesh->get_subd_num_corners() &&
+         cache->subd_face_corners == mesh->get_subd_face_corners();
+}
+
+static int face_region_find(vector<int> &parent, int f)
+{
+  while (parent[f] != f) {
+    parent[f] = parent[parent[f]];
+    f = parent[f];
+  }
+  return f;
+}
+
+/* Faces sharing an edge each split it on their own, and stitching expects them to end up with
+ * the same edge factors. Replayed factors only match those of faces that are replayed too, so
+ * faces connected through edges are only reused together, if all of them can be. Reusing single
+ * faces would need the factors of the sub-edges along each shared edge to be cached per edge, so
+ * a face split again can take them from a reused neighbor. */
+static void face_reuse_by_region(const Mesh *mesh, vector<char> &face_reuse)
+{
+  const int num_faces = face_reuse.size();
+  vector<int> parent(num_faces);
+  for (int f = 0; f < num_faces; f++) {
+    parent[f] = f;
+  }
+
+  /* Join the regions of faces sharing an edge, found by its sorted verts. */
+  unordered_map<uint64_t, int> edge_face;
+  for (int f = 0; f < num_faces; f++) {
+    const Mesh::SubdFace face = mesh->get_subd_face(f);
+    const int *corners = &mesh->get_subd_face_corners()[face.start_corner];
+
+    for (int corner = 0; corner < face.num_corners; corner++) {
+      uint a = corners[corner];
+      uint b = corners[(corner + 1) % face.num_corners];
+      if (b < a) {
+        swap(a, b);
+      }
+
+      const uint64_t key = ((uint64_t)a << 32) | b;
+      unordered_map<uint64_t, int>::iterator it = edge_face.find(key);
+      if (it == edge_face.end()) {
+        edge_face[key] = f;
+      }
+      else {
+        parent[face_region_find(parent, f)] = face_region_find(parent, it->second);
+      }
+    }
+  }
+
+  vector<char> region_reuse(num_faces, true);
+  for (int f = 0; f < num_faces; f++) {
+    if (!face_reuse[f]) {
+      region_reuse[face_region_find(parent, f)] = false;
+    }
+  }
+  for (int f = 0; f < num_faces; f++) {
+    face_reuse[f] = region_reuse[face_region_find(parent, f)];
+  }
+}
+
 void DiagSplit::split_patches(Patch *patches, size_t patches_byte_stride)
 {
+  Mesh *mesh = params.mesh;
+  const int num_faces = mesh->get_num_subd_faces();
+
+  int num_patches = 0;
+  for (int f = 0; f < num_faces; f++) {
+    num_patches += mesh->get_subd_num_corners()[f] == 4 ? 1 : mesh->get_subd_num_corners()[f];
+  }
+
+  double time_start = time_dt();
+
+  /* Edge factors of all patches, which decide if faces can be split as before. */
+  vector<float> patch_factors(num_patches * 4);
+  parallel_for(blocked_range<int>(0, num_patches, 64), [&](const blocked_range<int> &range) {
+    for (int p = range.begin(); p != range.end(); p++) {
+      Patch *patch = (Patch *)(((char *)patches) + p * patches_byte_stride);
+      patch_edge_factors(patch, &patch_factors[p * 4]);
+    }
+  });
+
+  if (!mesh->subd_dicing_cache) {
+    mesh->subd_dicing_cache = new DiagSplitCache();
+  }
+
+  DiagSplitCache *cache = mesh->subd_dicing_cache;
+  const bool use_cache = split_cache_valid(cache, params);
+
+  /* Faces whose patch factors are all within the tolerance. */
+  vector<char> face_reuse(num_faces, use_cache);
   int patch_index = 0;
 
-  for (int f = 0; f < params.mesh->get_num_subd_faces(); f++) {
-    Mesh::SubdFace face = params.mesh->get_subd_face(f);
+  if (use_cache) {
+    for (int f = 0; f < num_faces; f++) {
+      const int face_num_patches = mesh->get_subd_num_corners()[f] == 4 ?
+                                       1 :
+                                       mesh->get_subd_num_corners()[f];
+
+      for (int i = patch_index * 4; face_reuse[f] && i < (patch_index + face_num_patches) * 4;
+           i++) {
+        const float factor = cache->patch_factors[i];
+        face_reuse[f] = fabsf(patch_factors[i] - factor) <=
+                        params.reuse_tolerance * max(factor, 1.0f);
+      }
+
+      patch_index += face_num_patches;
+    }
+
+    face_reuse_by_region(mesh, face_reuse);
+  }
+
+  double time_end = time_dt();
+  factors_time = time_end - time_start;
+  time_start = time_end;
+
+  vector<int> face_T;
+  vector<int> face_T_offset(num_faces + 1);
+  face_T.reserve(cache->face_T.size());
+
+  patch_index = 0;
+
+  for (int f = 0; f < num_faces; f++) {
+    Mesh::SubdFace face = mesh->get_subd_face(f);
+    const int face_num_patches = face.is_quad() ? 1 : face.num_corners;
 
     Patch *patch = (Patch *)(((char *)patches) + patch_index * patches_byte_stride);
 
-    if (face.is_quad()) {
-      patch_index++;
+    const bool reuse = face_reuse[f];
 
-      split_quad(face, patch);
+    face_T_offset[f] = face_T.size();
+
+    if (reuse) {
+      /* Keep the factors the face was split for, so slow changes add up to a new split. */
+      std::copy(cache->patch_factors.begin() + patch_index * 4,
+                cache->patch_factors.begin() + (patch_index + face_num_patches) * 4,
+                patch_factors.begin() + patch_index * 4);
+      face_T.insert(face_T.end(),
+                    cache->face_T.begin() + cache->face_T_offset[f],
+                    cache->face_T.begin() + cache->face_T_offset[f + 1]);
+      replay_T = cache->face_T.data() + cache->face_T_offset[f];
+      num_faces_reused++;
     }
     else {
-      patch_index += face.num_corners;
+      record_T = &face_T;
+    }
 
+    if (face.is_quad()) {
+      split_quad(face, patch);
+    }
+    else {
       split_ngon(face, patch, patches_byte_stride);
     }
+
+    assert(!reuse || replay_T == cache->face_T.data() + cache->face_T_offset[f + 1]);
+    replay_T = nullptr;
+    record_T = nullptr;
+
+    patch_index += face_num_patches;
   }
 
+  face_T_offset[num_faces] = face_T.size();
+
+  cache->subd_face_corners = mesh->get_subd_face_corners();
+  cache->subd_num_corners = mesh->get_subd_num_corners();
+  cache->subdivision_type = mesh->get_subdivision_type();
+  cache->dicing_rate = params.dicing_rate;
+  cache->max_level = params.max_level;
+  cache->use_camera = (params.camera != NULL);
+  cache->patch_factors.swap(patch_factors);
+  cache->face_T.swap(face_T);
+  cache->face_T_offset.swap(face_T_offset);
+
   params.mesh->vert_to_stitching_key_map.clear();
   params.mesh->vert_stitching_map.clear();
 
+  time_end = time_dt();
+  split_time = time_end - time_start;
+  time_start = time_end;
+
   post_split();
+
+  dice_time = time_dt() - time_start;
 }
 
 static Edge *create_edge_from_corner(DiagSplit *split,
@@ -736,8 +941,18 @@ void DiagSplit::post_split()
     sub.edge_u1.T = max(sub.edge_u1.T, 1);
     sub.edge_v0.T = max(sub.edge_v0.T, 1);
     sub.edge_v1.T = max(sub.edge_v1.T, 1);
+  }
 
-    dice.dice(sub);
+  /* Evaluate patches for the inner verts in parallel, most verts are inside subpatches. */
+  parallel_for(blocked_range<size_t>(0, subpatches.size(), 16),
+               [&](const blocked_range<size_t> &range) {
+                 for (size_t i = range.begin(); i != range.end(); i++) {
+                   dice.dice_inner_verts(subpatches[i]);
+                 }
+               });
+
+  for (size_t i = 0; i < subpatches.size(); i++) {
+    dice.dice(subpatches[i]);
   }
 
   /* Cleanup */
@@ -25,6 +25,7 @@
 #include "subd/subd_dice.h"
 #include "subd/subd_subpatch.h"
 
+#include "util/util_array.h"
 #include "util/util_deque.h"
 #include "util/util_types.h"
 #include "util/util_vector.h"
@@ -36,15 +37,49 @@ CCL_NAMESPACE_BEGIN
 class Mesh;
 class Patch;
 
+/* Split decisions of the previous tessellation of a mesh. Faces whose patches have edge factors
+ * close to those they were split for are split the same way again, which skips evaluating the
+ * camera dependent factors and keeps the diced topology stable when the camera or mesh move
+ * little between frames. Faces connected through edges are reused together or not at all, so
+ * both sides of an edge get the same factors. Reuse is therefore per connected region of the
+ * cage: a single face over the tolerance splits its whole region again.
+ *
+ * Only the T() evaluations of splitting are skipped. The edge factors of all patches are still
+ * evaluated to decide what can be reused, and all subpatches are stitched and diced again. The
+ * phase times of DiagSplit and test/performance/subd_split_performance_test.cpp show what that
+ * saves. */
+struct DiagSplitCache {
+  /* Topology and settings the cache is valid for. */
+  array<int> subd_face_corners;
+  array<int> subd_num_corners;
+  int subdivision_type = 0;
+  float dicing_rate = 0.0f;
+  int max_level = 0;
+  bool use_camera = false;
+
+  /* Edge factors of the u0, u1, v0 and v1 edges of every patch, when its face was split. */
+  vector<float> patch_factors;
+  /* Results of T() while splitting each face, indexed by face_T_offset. */
+  vector<int> face_T;
+  vector<int> face_T_offset;
+};
+
 class DiagSplit {
   SubdParams params;
 
+  /* Results of T() replayed from the cache, or recorded for it, for the face being split. */
+  const int *replay_T = nullptr;
+  vector<int> *record_T = nullptr;
+
   vector<Subpatch> subpatches;
   /* deque is used so that element pointers remain vaild when size is changed. */
   deque<Edge> edges;
 
   float3 to_world(Patch *patch, float2 uv);
+  void edge_length(Patch *patch, float2 Pstart, float2 Pend, float *Lsum, float *Lmax);
+  void patch_edge_factors(Patch *patch, float factors[4]);
   int T(Patch *patch, float2 Pstart, float2 Pend, bool recursive_resolve = false);
+  int T_eval(Patch *patch, float2 Pstart, float2 Pend, bool recursive_resolve);
 
   void limit_edge_factor(int &T, Patch *patch, float2 Pstart, float2 Pend);
   void resolve_edge_factors(Subpatch &sub);
@@ -58,6 +93,13 @@ class DiagSplit {
   int alloc_verts(int n); /* Returns start index of new verts. */
 
  public:
+  /* Number of faces split the same way as in the previous tessellation. */
+  int num_faces_reused = 0;
+  /* Time spent evaluating patch edge factors, splitting faces, and stitching and dicing. */
+  double factors_time = 0.0;
+  double split_time = 0.0;
+  double dice_time = 0.0;
+
   Edge *alloc_edge();
 
   explicit DiagSplit(const SubdParams &params);
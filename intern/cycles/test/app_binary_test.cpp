@@ -0,0 +1,252 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include "app/cycles_binary.h"
+
+#include "device/device.h"
+
+#include "render/graph.h"
+#include "render/mesh.h"
+#include "render/nodes.h"
+#include "render/object.h"
+#include "render/scene.h"
+#include "render/shader.h"
+
+#include "util/util_foreach.h"
+#include "util/util_path.h"
+#include "util/util_stats.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+class AppBinary : public testing::Test {
+ protected:
+  Stats stats;
+  Profiler profiler;
+  DeviceInfo device_info;
+  Device *device_cpu;
+  SceneParams scene_params;
+  Scene *scene;
+  Scene *scene_read;
+  string filepath;
+
+  virtual void SetUp()
+  {
+    device_cpu = Device::create(device_info, stats, profiler, true);
+    scene = new Scene(scene_params, device_cpu);
+    scene_read = new Scene(scene_params, device_cpu);
+    filepath = path_join(testing::TempDir(), "cycles_app_binary_test.cyb");
+  }
+
+  virtual void TearDown()
+  {
+    delete scene_read;
+    delete scene;
+    delete device_cpu;
+    path_remove(filepath);
+  }
+
+  /* Quad with a vertex attribute, using an emission shader. */
+  void add_test_mesh()
+  {
+    Shader *shader = scene->create_node<Shader>();
+    shader->name = "emission";
+
+    ShaderGraph *graph = new ShaderGraph();
+    EmissionNode *emission = graph->create_node<EmissionNode>();
+    emission->set_color(make_float3(0.25f, 0.5f, 1.0f));
+    emission->set_strength(4.0f);
+    graph->add(emission);
+    graph->connect(emission->output("Emission"), graph->output()->input("Surface"));
+    shader->set_graph(graph);
+
+    Mesh *mesh = scene->create_node<Mesh>();
+    mesh->name = "quad";
+    mesh->reserve_mesh(4, 2);
+    mesh->add_vertex(make_float3(0.0f, 0.0f, 0.0f));
+    mesh->add_vertex(make_float3(1.0f, 0.0f, 0.0f));
+    mesh->add_vertex(make_float3(1.0f, 1.0f, 0.0f));
+    mesh->add_vertex(make_float3(0.0f, 1.0f, 0.5f));
+    mesh->add_triangle(0, 1, 2, 0, false);
+    mesh->add_triangle(0, 2, 3, 0, true);
+
+    array<Node *> used_shaders;
+    used_shaders.push_back_slow(shader);
+    mesh->set_used_shaders(used_shaders);
+
+    Attribute *attr = mesh->attributes.add(
+        ustring("weight"), TypeDesc::TypeFloat, ATTR_ELEMENT_VERTEX);
+    float *weight = attr->data_float();
+    for (int i = 0; i < 4; i++) {
+      weight[i] = i * 0.25f;
+    }
+
+    Object *object = scene->create_node<Object>();
+    object->name = "quad";
+    object->set_geometry(mesh);
+    object->set_tfm(transform_translate(1.0f, 2.0f, 3.0f));
+  }
+};
+
+template<typename T> T *find_node(const vector<T *> &nodes, const char *name)
+{
+  foreach (T *node, nodes) {
+    if (node->name == name) {
+      return node;
+    }
+  }
+  return NULL;
+}
+
+}  // namespace
+
+TEST_F(AppBinary, round_trip)
+{
+  add_test_mesh();
+  ASSERT_TRUE(binary_write_file(scene, filepath.c_str()));
+  ASSERT_TRUE(binary_is_file(filepath.c_str()));
+  ASSERT_TRUE(binary_read_file(scene_read, filepath.c_str()));
+
+  Mesh *mesh = static_cast<Mesh *>(scene->geometry[0]);
+  ASSERT_EQ(scene_read->geometry.size(), 1);
+  ASSERT_TRUE(scene_read->geometry[0]->is_mesh());
+  Mesh *mesh_read = static_cast<Mesh *>(scene_read->geometry[0]);
+
+  EXPECT_EQ(mesh_read->name, mesh->name);
+  EXPECT_EQ(mesh_read->get_verts(), mesh->get_verts());
+  EXPECT_EQ(mesh_read->get_triangles(), mesh->get_triangles());
+  EXPECT_EQ(mesh_read->get_smooth(), mesh->get_smooth());
+
+  Attribute *attr = mesh->attributes.find(ustring("weight"));
+  Attribute *attr_read = mesh_read->attributes.find(ustring("weight"));
+  ASSERT_NE(attr_read, (Attribute *)NULL);
+  EXPECT_EQ(attr_read->element, attr->element);
+  EXPECT_EQ(attr_read->buffer, attr->buffer);
+
+  Shader *shader_read = find_node(scene_read->shaders, "emission");
+  ASSERT_NE(shader_read, (Shader *)NULL);
+  ASSERT_EQ(mesh_read->get_used_shaders().size(), 1);
+  EXPECT_EQ(mesh_read->get_used_shaders()[0], shader_read);
+  Shader *shader = find_node(scene->shaders, "emission");
+  EXPECT_EQ(shader_read->graph->nodes.size(), shader->graph->nodes.size());
+
+  EmissionNode *emission_read = NULL;
+  foreach (ShaderNode *node, shader_read->graph->nodes) {
+    if (node->type == EmissionNode::node_type) {
+      emission_read = static_cast<EmissionNode *>(node);
+    }
+  }
+  ASSERT_NE(emission_read, (EmissionNode *)NULL);
+  EXPECT_EQ(emission_read->get_strength(), 4.0f);
+  EXPECT_EQ(emission_read->output("Emission")->links.size(), 1);
+
+  ASSERT_EQ(scene_read->objects.size(), 1);
+  Object *object_read = scene_read->objects[0];
+  EXPECT_EQ(object_read->get_geometry(), mesh_read);
+  EXPECT_EQ(object_read->get_tfm(), scene->objects[0]->get_tfm());
+}
+
+/* Every truncation of the file must fail to load, without reading or
+ * allocating based on sizes that point past the end of the file. */
+TEST_F(AppBinary, truncated)
+{
+  add_test_mesh();
+  ASSERT_TRUE(binary_write_file(scene, filepath.c_str()));
+
+  vector<uint8_t> binary;
+  ASSERT_TRUE(path_read_binary(filepath, binary));
+
+  const string truncated_filepath = filepath + ".truncated";
+  const size_t step = (binary.size() > 100) ? binary.size() / 100 : 1;
+  for (size_t size = 0; size < binary.size(); size += step) {
+    const vector<uint8_t> truncated(binary.begin(), binary.begin() + size);
+    ASSERT_TRUE(path_write_binary(truncated_filepath, truncated));
+
+    Scene *scene_truncated = new Scene(scene_params, device_cpu);
+    EXPECT_FALSE(binary_read_file(scene_truncated, truncated_filepath.c_str()));
+    delete scene_truncated;
+  }
+  path_remove(truncated_filepath);
+}
+
+/* Sizes are validated against the file length, a corrupt array size must not
+ * be used to allocate memory. */
+TEST_F(AppBinary, corrupt_size)
+{
+  add_test_mesh();
+  ASSERT_TRUE(binary_write_file(scene, filepath.c_str()));
+
+  vector<uint8_t> binary;
+  ASSERT_TRUE(path_read_binary(filepath, binary));
+
+  /* Array sizes are written followed by the element size, find the vertex
+   * array by its size and element size and make it huge. */
+  const uint64_t num_verts = 4;
+  const uint32_t element_size = sizeof(float3);
+  size_t offset = 0;
+  bool found = false;
+  for (; offset + sizeof(num_verts) + sizeof(element_size) <= binary.size(); offset++) {
+    if (memcmp(&binary[offset], &num_verts, sizeof(num_verts)) == 0 &&
+        memcmp(&binary[offset + sizeof(num_verts)], &element_size, sizeof(element_size)) == 0) {
+      found = true;
+      break;
+    }
+  }
+  ASSERT_TRUE(found);
+
+  const uint64_t huge = ((uint64_t)1) << 60;
+  memcpy(&binary[offset], &huge, sizeof(huge));
+  ASSERT_TRUE(path_write_binary(filepath, binary));
+
+  EXPECT_FALSE(binary_read_file(scene_read, filepath.c_str()));
+}
+
+/* Attribute buffers must match the size computed from the geometry, a shorter buffer would be
+ * read past its end when packing. */
+TEST_F(AppBinary, attribute_size_mismatch)
+{
+  add_test_mesh();
+  ASSERT_TRUE(binary_write_file(scene, filepath.c_str()));
+
+  vector<uint8_t> binary;
+  ASSERT_TRUE(path_read_binary(filepath, binary));
+
+  /* The name is followed by the type, element and flags, then the buffer size. */
+  const char name[] = "weight";
+  const uint8_t *found = std::search(
+      binary.data(), binary.data() + binary.size(), name, name + strlen(name));
+  ASSERT_NE(found, binary.data() + binary.size());
+  const size_t offset = (found - binary.data()) + strlen(name) + 6 * sizeof(int32_t);
+
+  uint64_t size;
+  memcpy(&size, &binary[offset], sizeof(size));
+  ASSERT_EQ(size, 4 * sizeof(float));
+
+  size -= sizeof(float);
+  memcpy(&binary[offset], &size, sizeof(size));
+  ASSERT_TRUE(path_write_binary(filepath, binary));
+
+  EXPECT_FALSE(binary_read_file(scene_read, filepath.c_str()));
+}
+
+CCL_NAMESPACE_END
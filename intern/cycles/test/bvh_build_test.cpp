@@ -0,0 +1,160 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "bvh/bvh_build.h"
+#include "bvh/bvh_node.h"
+#include "bvh/bvh_params.h"
+
+#include "render/mesh.h"
+#include "render/object.h"
+
+#include "util/util_progress.h"
+#include "util/util_task.h"
+
+#include "test/bvh_test_util.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+struct BVHBuildResult {
+  array<int> prim_type;
+  array<int> prim_index;
+  array<int> prim_object;
+  array<float2> prim_time;
+  BoundBox bounds;
+  /* Primitives of every leaf in depth first order, each leaf terminated by -1.
+   * Unlike the packed arrays this does not depend on the order in which
+   * threads finished their leaves. */
+  vector<int> leaf_prims;
+};
+
+void bvh_collect_leaf_prims(const BVHNode *node, BVHBuildResult &result)
+{
+  if (node->is_leaf()) {
+    const LeafNode *leaf = static_cast<const LeafNode *>(node);
+    for (int i = leaf->lo; i < leaf->hi; i++) {
+      result.leaf_prims.push_back(result.prim_index[i]);
+    }
+    result.leaf_prims.push_back(-1);
+    return;
+  }
+  for (int i = 0; i < node->num_children(); i++) {
+    bvh_collect_leaf_prims(node->get_child(i), result);
+  }
+}
+
+void build_bvh(Mesh *mesh, const bool use_spatial_split, BVHBuildResult &result)
+{
+  mesh->compute_bounds();
+
+  Object object;
+  object.set_geometry(mesh);
+  object.compute_bounds(false);
+
+  vector<Object *> objects;
+  objects.push_back(&object);
+
+  BVHParams params;
+  params.use_spatial_split = use_spatial_split;
+
+  Progress progress;
+  BVHBuild bvh_build(objects,
+                     result.prim_type,
+                     result.prim_index,
+                     result.prim_object,
+                     result.prim_time,
+                     params,
+                     progress);
+
+  BVHNode *root = bvh_build.run();
+
+  ASSERT_NE(root, nullptr);
+  result.bounds = root->bounds;
+  bvh_collect_leaf_prims(root, result);
+  root->deleteSubtree();
+}
+
+/* Every triangle must be referenced by the BVH, exactly once unless spatial
+ * splits are allowed to duplicate references. */
+void bvh_verify(Mesh *mesh, const bool use_spatial_split, const BVHBuildResult &result)
+{
+  const size_t num_triangles = mesh->num_triangles();
+  vector<int> num_references(num_triangles, 0);
+
+  for (size_t i = 0; i < result.prim_index.size(); i++) {
+    ASSERT_GE(result.prim_index[i], 0);
+    ASSERT_LT(result.prim_index[i], (int)num_triangles);
+    num_references[result.prim_index[i]]++;
+  }
+
+  for (size_t i = 0; i < num_triangles; i++) {
+    if (use_spatial_split) {
+      EXPECT_GE(num_references[i], 1);
+    }
+    else {
+      EXPECT_EQ(num_references[i], 1);
+    }
+  }
+
+  EXPECT_LE(result.bounds.min.x, mesh->bounds.min.x);
+  EXPECT_LE(result.bounds.min.y, mesh->bounds.min.y);
+  EXPECT_LE(result.bounds.min.z, mesh->bounds.min.z);
+  EXPECT_GE(result.bounds.max.x, mesh->bounds.max.x);
+  EXPECT_GE(result.bounds.max.y, mesh->bounds.max.y);
+  EXPECT_GE(result.bounds.max.z, mesh->bounds.max.z);
+}
+
+void bvh_build_test(const int num_triangles, const bool use_spatial_split)
+{
+  Mesh mesh;
+  mesh_add_random_triangles(&mesh, num_triangles);
+
+  /* Large enough to go through the multi-threaded binning and partitioning,
+   * which must give the same tree as a single threaded build, on every run. */
+  BVHBuildResult result_serial;
+  TaskScheduler::init(1);
+  build_bvh(&mesh, use_spatial_split, result_serial);
+  TaskScheduler::exit();
+
+  bvh_verify(&mesh, use_spatial_split, result_serial);
+
+  TaskScheduler::init(0);
+  for (int run = 0; run < 4; run++) {
+    BVHBuildResult result;
+    build_bvh(&mesh, use_spatial_split, result);
+
+    bvh_verify(&mesh, use_spatial_split, result);
+    EXPECT_EQ(result.leaf_prims, result_serial.leaf_prims);
+  }
+  TaskScheduler::exit();
+}
+
+}  // namespace
+
+TEST(bvh_build, binning)
+{
+  bvh_build_test(100000, false);
+}
+
+TEST(bvh_build, spatial_split)
+{
+  bvh_build_test(100000, true);
+}
+
+CCL_NAMESPACE_END
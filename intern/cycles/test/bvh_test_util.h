@@ -0,0 +1,78 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __BVH_TEST_UTIL_H__
+#define __BVH_TEST_UTIL_H__
+
+/* Synthetic meshes for BVH tests and benchmarks. */
+
+#include "render/mesh.h"
+
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Wavy grid of size by size quads, split into two triangles each. */
+inline void mesh_add_grid(Mesh *mesh, const int size)
+{
+  const int verts_side = size + 1;
+  mesh->reserve_mesh(verts_side * verts_side, 2 * size * size);
+
+  for (int y = 0; y < verts_side; y++) {
+    for (int x = 0; x < verts_side; x++) {
+      mesh->add_vertex(make_float3((float)x, (float)y, sinf(x * 0.3f) * cosf(y * 0.2f)));
+    }
+  }
+
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int v00 = y * verts_side + x;
+      const int v10 = v00 + 1;
+      const int v01 = v00 + verts_side;
+      const int v11 = v01 + 1;
+      mesh->add_triangle(v00, v10, v11, 0, false);
+      mesh->add_triangle(v00, v11, v01, 0, false);
+    }
+  }
+}
+
+/* Randomly placed and sized overlapping triangles, which is where spatial
+ * splits kick in. Uses a fixed seed so runs are comparable. */
+inline void mesh_add_random_triangles(Mesh *mesh, const int num_triangles)
+{
+  mesh->reserve_mesh(num_triangles * 3, num_triangles);
+
+  uint seed = 0x12345678;
+  auto random_float = [&]() {
+    seed = seed * 1664525u + 1013904223u;
+    return (float)(seed >> 8) * (1.0f / (float)(1 << 24));
+  };
+
+  const float extent = cbrtf((float)num_triangles);
+  for (int i = 0; i < num_triangles; i++) {
+    const float3 center = make_float3(random_float(), random_float(), random_float()) * extent;
+    const float size = (random_float() < 0.05f) ? extent * 0.25f : 1.0f;
+    for (int j = 0; j < 3; j++) {
+      const float3 offset = make_float3(random_float(), random_float(), random_float()) - 0.5f;
+      mesh->add_vertex(center + offset * size);
+    }
+    mesh->add_triangle(i * 3, i * 3 + 1, i * 3 + 2, 0, false);
+  }
+}
+
+CCL_NAMESPACE_END
+
+#endif /* __BVH_TEST_UTIL_H__ */
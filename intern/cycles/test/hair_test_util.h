@@ -0,0 +1,89 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __HAIR_TEST_UTIL_H__
+#define __HAIR_TEST_UTIL_H__
+
+/* Synthetic hair and kernel data for curve tests and benchmarks. */
+
+#include "test/kernel_test_util.h"
+
+#include "render/hair.h"
+
+#include "util/util_hash.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Wavy strands growing from a plane, tapering towards the tip. */
+inline void hair_set_curves(Hair *hair, const int num_curves)
+{
+  const int num_keys_per_curve = 8;
+
+  hair->clear();
+  hair->reserve_curves(num_curves, num_curves * num_keys_per_curve);
+
+  for (int i = 0; i < num_curves; i++) {
+    const float3 root = make_float3(
+        hash_uint2_to_float(i, 0) * 10.0f, hash_uint2_to_float(i, 1) * 10.0f, 0.0f);
+    const float length = 0.05f + hash_uint2_to_float(i, 2) * 0.3f;
+    const float root_radius = 0.0005f + hash_uint2_to_float(i, 3) * 0.002f;
+
+    hair->add_curve(i * num_keys_per_curve, 0);
+    for (int k = 0; k < num_keys_per_curve; k++) {
+      const float t = k / (float)(num_keys_per_curve - 1);
+      const float3 P = root + make_float3(sinf(t * 5.0f + i) * 0.02f,
+                                          cosf(t * 3.0f + i) * 0.02f,
+                                          t * length);
+      hair->add_curve_key(P, root_radius * (1.0f - t));
+    }
+  }
+}
+
+/* Kernel data with the curve keys of a single hair, packed both ways. */
+struct HairKernelData : public KernelTestData {
+  vector<float4> curves;
+  vector<float4> curve_keys;
+  vector<ushort4> curve_keys_quantized;
+  vector<float4> curve_bounds;
+
+  HairKernelData(Hair *hair)
+      : curves(hair->num_curves()),
+        curve_keys(hair->num_keys()),
+        curve_keys_quantized(hair->num_keys()),
+        curve_bounds(hair->num_curves())
+  {
+    for (int i = 0; i < curves.size(); i++) {
+      const Hair::Curve curve = hair->get_curve(i);
+      curves[i] = make_float4(
+          __int_as_float(curve.first_key), __int_as_float(curve.num_keys), 0.0f, 0.0f);
+    }
+    for (int k = 0; k < curve_keys.size(); k++) {
+      const float3 P = hair->get_curve_keys()[k];
+      curve_keys[k] = make_float4(P.x, P.y, P.z, hair->get_curve_radius()[k]);
+    }
+    hair->pack_curve_keys_quantized(
+        curve_keys_quantized.data(), curve_bounds.data(), curves.data());
+
+    set_texture(kg.__curves, curves);
+    set_texture(kg.__curve_keys, curve_keys);
+    set_texture(kg.__curve_keys_quantized, curve_keys_quantized);
+    set_texture(kg.__curve_bounds, curve_bounds);
+  }
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __HAIR_TEST_UTIL_H__ */
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KERNEL_TEST_UTIL_H__
+#define __KERNEL_TEST_UTIL_H__
+
+/* Kernel globals for calling CPU kernel functions directly from tests and benchmarks. */
+
+#include "kernel/kernel_compat_cpu.h"
+#include "kernel/kernel_math.h"
+#include "kernel/kernel_types.h"
+
+#include "kernel/split/kernel_split_data.h"
+#include "kernel/kernel_globals.h"
+
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Zero initialized kernel globals. Derived classes own the arrays the textures point to. */
+struct KernelTestData {
+  KernelGlobals kg;
+
+  KernelTestData() : kg()
+  {
+  }
+
+  ~KernelTestData()
+  {
+#ifdef WITH_NANOVDB
+    free(kg.nanovdb_accessors);
+#endif
+  }
+
+  template<typename T> static void set_texture(texture<T> &tex, const vector<T> &data)
+  {
+    tex.data = (T *)data.data();
+    tex.width = data.size();
+  }
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __KERNEL_TEST_UTIL_H__ */
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_TEST_UTIL_H__
+#define __LIGHT_TREE_TEST_UTIL_H__
+
+/* Synthetic emitters and kernel data for light tree tests and benchmarks. */
+
+#include "test/kernel_test_util.h"
+
+#include "render/light_tree.h"
+
+#include "util/util_hash.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Small triangles and point lights scattered in a box, with varying energy. */
+inline void light_tree_emitters(const int num, vector<LightTreeEmitter> &emitters)
+{
+  emitters.resize(num);
+  for (int i = 0; i < num; i++) {
+    const float3 P = make_float3(hash_uint2_to_float(i, 0) * 100.0f,
+                                 hash_uint2_to_float(i, 1) * 100.0f,
+                                 hash_uint2_to_float(i, 2) * 10.0f);
+    const float size = 0.01f + hash_uint2_to_float(i, 3) * 0.1f;
+    const float3 N = normalize(make_float3(hash_uint2_to_float(i, 4) - 0.5f,
+                                           hash_uint2_to_float(i, 5) - 0.5f,
+                                           hash_uint2_to_float(i, 6) - 0.5f));
+
+    LightTreeEmitter &emitter = emitters[i];
+    emitter.bbox = BoundBox(P - make_float3(size, size, size), P + make_float3(size, size, size));
+    emitter.energy = 0.1f + hash_uint2_to_float(i, 7);
+    emitter.cone = (i % 3 == 0) ?
+                       LightTreeCone(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F, false) :
+                       LightTreeCone(N, 0.0f, M_PI_2_F, true);
+  }
+}
+
+/* Kernel data pointing to the tree, with all emitters local. */
+struct LightTreeKernelData : public KernelTestData {
+  vector<KernelLightTreeEmitter> kemitters;
+
+  LightTreeKernelData(const LightTree &tree) : kemitters(tree.order.size())
+  {
+    for (int i = 0; i < kemitters.size(); i++) {
+      kemitters[i].prim = tree.order[i];
+      kemitters[i].node = tree.leaf_nodes[i];
+      kemitters[i].inv_area = 1.0f;
+    }
+
+    set_texture(kg.__light_tree_nodes, tree.nodes);
+    set_texture(kg.__light_tree_emitters, kemitters);
+    kg.__data.integrator.use_light_tree = true;
+    kg.__data.integrator.light_tree_num_local = kemitters.size();
+    kg.__data.integrator.light_tree_local_pdf = 1.0f;
+  }
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_TEST_UTIL_H__ */
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "bvh/bvh_build.h"
+#include "bvh/bvh_node.h"
+#include "bvh/bvh_params.h"
+
+#include "render/mesh.h"
+#include "render/object.h"
+
+#include "util/util_progress.h"
+#include "util/util_task.h"
+#include "util/util_time.h"
+
+#include "test/bvh_test_util.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+double bvh_build_time(Mesh *mesh, const bool use_spatial_split)
+{
+  Object object;
+  object.set_geometry(mesh);
+  object.compute_bounds(false);
+
+  vector<Object *> objects;
+  objects.push_back(&object);
+
+  BVHParams params;
+  params.use_spatial_split = use_spatial_split;
+
+  array<int> prim_type, prim_index, prim_object;
+  array<float2> prim_time;
+  Progress progress;
+  BVHBuild bvh_build(
+      objects, prim_type, prim_index, prim_object, prim_time, params, progress);
+
+  const double time_start = time_dt();
+  BVHNode *root = bvh_build.run();
+  const double time = time_dt() - time_start;
+
+  root->deleteSubtree();
+  return time;
+}
+
+/* Build times of a smooth grid and of overlapping random triangles, with one thread and with
+ * all threads, to show the scaling of the threaded binning and partitioning. */
+void bvh_build_performance(const int grid_size, const int num_random, const int num_runs)
+{
+  Mesh grid, random;
+  mesh_add_grid(&grid, grid_size);
+  mesh_add_random_triangles(&random, num_random);
+  grid.compute_bounds();
+  random.compute_bounds();
+
+  const struct {
+    const char *name;
+    Mesh *mesh;
+    bool use_spatial_split;
+  } cases[] = {
+      {"grid, binning", &grid, false},
+      {"grid, spatial split", &grid, true},
+      {"random, binning", &random, false},
+      {"random, spatial split", &random, true},
+  };
+
+  for (int num_threads = 1; num_threads >= 0; num_threads--) {
+    TaskScheduler::init(num_threads);
+    printf("\n========== %d threads ==========\n", TaskScheduler::num_threads());
+
+    for (const auto &test_case : cases) {
+      double time = 0.0;
+      for (int run = 0; run < num_runs; run++) {
+        time += bvh_build_time(test_case.mesh, test_case.use_spatial_split);
+      }
+      printf("\t%s, %d triangles: %fs on average over %d runs\n",
+             test_case.name,
+             (int)test_case.mesh->num_triangles(),
+             time / num_runs,
+             num_runs);
+    }
+
+    TaskScheduler::exit();
+  }
+}
+
+}  // namespace
+
+TEST(bvh_build_performance, performance_10000)
+{
+  bvh_build_performance(71, 10000, 10);
+}
+
+TEST(bvh_build_performance, performance_100000)
+{
+  bvh_build_performance(224, 100000, 4);
+}
+
+TEST(bvh_build_performance, performance_1000000)
+{
+  bvh_build_performance(707, 1000000, 1);
+}
+
+CCL_NAMESPACE_END
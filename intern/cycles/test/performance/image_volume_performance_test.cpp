@@ -0,0 +1,218 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#if defined(WITH_OPENVDB) && defined(WITH_NANOVDB)
+
+#  include <openvdb/openvdb.h>
+#  include <openvdb/tools/Dense.h>
+
+#  include <nanovdb/util/OpenToNanoVDB.h>
+
+#  include "test/kernel_test_util.h"
+
+#  include "kernel/kernels/cpu/kernel_cpu_image.h"
+
+#  include "util/util_hash.h"
+#  include "util/util_string.h"
+#  include "util/util_time.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Spherical blobs of falling off density in a cube of resolution voxels. */
+openvdb::FloatGrid::Ptr volume_blobs(const int resolution, const int num_blobs, const float radius)
+{
+  openvdb::FloatGrid::Ptr grid = openvdb::FloatGrid::create(0.0f);
+  openvdb::FloatGrid::Accessor acc = grid->getAccessor();
+
+  for (int i = 0; i < num_blobs; i++) {
+    const float extent = resolution - 2.0f * radius;
+    const float3 center = make_float3(radius, radius, radius) +
+                          extent * make_float3(hash_uint2_to_float(i, 0),
+                                               hash_uint2_to_float(i, 1),
+                                               hash_uint2_to_float(i, 2));
+    const int3 min = make_int3(
+        (int)(center.x - radius), (int)(center.y - radius), (int)(center.z - radius));
+    const int3 max = make_int3(
+        (int)(center.x + radius), (int)(center.y + radius), (int)(center.z + radius));
+
+    for (int z = min.z; z <= max.z; z++) {
+      for (int y = min.y; y <= max.y; y++) {
+        for (int x = min.x; x <= max.x; x++) {
+          const float density = 1.0f - len(make_float3(x, y, z) - center) / radius;
+          const openvdb::Coord ijk(x, y, z);
+          if (density > 0.0f && density > acc.getValue(ijk)) {
+            acc.setValue(ijk, density);
+          }
+        }
+      }
+    }
+  }
+
+  return grid;
+}
+
+/* The same grid as a dense float texture over its active bounding box, as used without
+ * NanoVDB, and as a NanoVDB grid sampled sparse. */
+struct VolumeKernelData : public KernelTestData {
+  openvdb::CoordBBox bbox;
+  vector<float> dense;
+  nanovdb::GridHandle<> nanogrid;
+  vector<TextureInfo> texture_info;
+
+  VolumeKernelData(const openvdb::FloatGrid &grid)
+      : bbox(grid.evalActiveVoxelBoundingBox()), texture_info(2)
+  {
+    const openvdb::Coord dim = bbox.dim();
+    dense.resize((size_t)dim.x() * dim.y() * dim.z());
+    openvdb::tools::Dense<float, openvdb::tools::LayoutXYZ> dense_grid(bbox, dense.data());
+    openvdb::tools::copyToDense(grid, dense_grid);
+
+    nanogrid = nanovdb::openToNanoVDB(grid);
+
+    TextureInfo &dense_info = texture_info[0];
+    dense_info.data = (uint64_t)dense.data();
+    dense_info.data_type = IMAGE_DATA_TYPE_FLOAT;
+    dense_info.interpolation = INTERPOLATION_LINEAR;
+    dense_info.extension = EXTENSION_CLIP;
+    dense_info.width = dim.x();
+    dense_info.height = dim.y();
+    dense_info.depth = dim.z();
+
+    TextureInfo &nanovdb_info = texture_info[1];
+    nanovdb_info.data = (uint64_t)nanogrid.data();
+    nanovdb_info.data_type = IMAGE_DATA_TYPE_NANOVDB_FLOAT;
+    nanovdb_info.interpolation = INTERPOLATION_LINEAR;
+    nanovdb_info.extension = EXTENSION_CLIP;
+
+    set_texture(kg.__texture_info, texture_info);
+  }
+};
+
+enum VolumeLookup {
+  VOLUME_LOOKUP_DENSE,
+  VOLUME_LOOKUP_NANOVDB,
+  /* A new tree accessor for every lookup, as before accessors were cached. */
+  VOLUME_LOOKUP_NANOVDB_UNCACHED,
+};
+
+/* March random rays through the grid in half voxel steps, like a volume shader evaluating
+ * density along a ray. Returns the sum of all lookups to compare the paths. */
+float volume_march(VolumeKernelData &data,
+                   const VolumeLookup lookup,
+                   const int num_rays,
+                   double *r_time)
+{
+  KernelGlobals *kg = &data.kg;
+  const openvdb::Coord bbox_min = data.bbox.min();
+  const openvdb::Coord bbox_dim = data.bbox.dim();
+  const float3 offset = make_float3(bbox_min.x(), bbox_min.y(), bbox_min.z());
+  const float3 size = make_float3(bbox_dim.x(), bbox_dim.y(), bbox_dim.z());
+  const nanovdb::NanoGrid<float> *grid = data.nanogrid.grid<float>();
+
+  const double time_start = time_dt();
+  float sum = 0.0f;
+
+  for (int i = 0; i < num_rays; i++) {
+    /* Between two random points in the bounding box, in voxel index space. */
+    const float3 P0 = offset + size * make_float3(hash_uint2_to_float(i, 0),
+                                                  hash_uint2_to_float(i, 1),
+                                                  hash_uint2_to_float(i, 2));
+    const float3 P1 = offset + size * make_float3(hash_uint2_to_float(i, 3),
+                                                  hash_uint2_to_float(i, 4),
+                                                  hash_uint2_to_float(i, 5));
+    const int num_steps = max((int)(len(P1 - P0) * 2.0f), 1);
+    const float3 step = (P1 - P0) / num_steps;
+
+    for (int s = 0; s < num_steps; s++) {
+      const float3 P = P0 + step * (s + 0.5f);
+
+      switch (lookup) {
+        case VOLUME_LOOKUP_DENSE:
+          sum += kernel_tex_image_interp_3d(kg, 0, (P - offset) / size, INTERPOLATION_NONE).x;
+          break;
+        case VOLUME_LOOKUP_NANOVDB:
+          sum += kernel_tex_image_interp_3d(kg, 1, P, INTERPOLATION_NONE).x;
+          break;
+        case VOLUME_LOOKUP_NANOVDB_UNCACHED:
+          sum += NanoVDBInterpolator<float>::interp_3d_linear(grid->getAccessor(), P.x, P.y, P.z)
+                     .x;
+          break;
+      }
+    }
+  }
+
+  *r_time = time_dt() - time_start;
+  return sum;
+}
+
+/* Memory use and lookup time of the dense texture against the NanoVDB grid, with and without
+ * cached tree accessors. */
+void image_volume_performance(const int resolution,
+                              const int num_blobs,
+                              const float radius,
+                              const int num_rays)
+{
+  openvdb::initialize();
+  openvdb::FloatGrid::Ptr grid = volume_blobs(resolution, num_blobs, radius);
+  VolumeKernelData data(*grid);
+
+  const openvdb::Coord dim = data.bbox.dim();
+  printf("\n========== %d blobs of radius %.0f, %dx%dx%d voxels, %.1f%% active ==========\n",
+         num_blobs,
+         (double)radius,
+         dim.x(),
+         dim.y(),
+         dim.z(),
+         100.0 * grid->activeVoxelCount() / data.dense.size());
+  printf("\tdense: %s\n",
+         string_human_readable_size(data.dense.size() * sizeof(float)).c_str());
+  printf("\tNanoVDB: %s\n", string_human_readable_size(data.nanogrid.size()).c_str());
+
+  const struct {
+    const char *name;
+    VolumeLookup lookup;
+  } cases[] = {
+      {"dense", VOLUME_LOOKUP_DENSE},
+      {"NanoVDB, cached accessors", VOLUME_LOOKUP_NANOVDB},
+      {"NanoVDB, new accessor per lookup", VOLUME_LOOKUP_NANOVDB_UNCACHED},
+  };
+
+  for (const auto &test_case : cases) {
+    double time;
+    const float sum = volume_march(data, test_case.lookup, num_rays, &time);
+    printf("\t%s: %d rays in %fs, sum %f\n", test_case.name, num_rays, time, (double)sum);
+  }
+}
+
+}  // namespace
+
+TEST(image_volume_performance, sparse)
+{
+  image_volume_performance(256, 16, 12.0f, 10000);
+}
+
+TEST(image_volume_performance, filled)
+{
+  image_volume_performance(256, 1, 128.0f, 10000);
+}
+
+CCL_NAMESPACE_END
+
+#endif
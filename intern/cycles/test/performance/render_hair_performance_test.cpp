@@ -0,0 +1,158 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "test/hair_test_util.h"
+
+#include "kernel/geom/geom_attribute.h"
+#include "kernel/geom/geom_object.h"
+#include "kernel/geom/geom_patch.h"
+#include "kernel/geom/geom_triangle.h"
+#include "kernel/geom/geom_subd_triangle.h"
+
+#include "kernel/geom/geom_curve_keys.h"
+#include "kernel/geom/geom_motion_curve.h"
+#include "kernel/geom/geom_curve_intersect.h"
+
+#include "util/util_string.h"
+#include "util/util_time.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Kernel data for intersecting curves directly, without a BVH. */
+struct HairIntersectKernelData : public HairKernelData {
+  vector<uint> prim_index;
+  vector<uint> prim_visibility;
+
+  HairIntersectKernelData(Hair *hair)
+      : HairKernelData(hair),
+        prim_index(hair->num_curves()),
+        prim_visibility(hair->num_curves(), ~0)
+  {
+    for (int i = 0; i < prim_index.size(); i++) {
+      prim_index[i] = i;
+    }
+
+    set_texture(kg.__prim_index, prim_index);
+    set_texture(kg.__prim_visibility, prim_visibility);
+  }
+};
+
+/* Intersect rays aimed at random curve segments, fetching the keys like BVH2 traversal does
+ * for every candidate segment. The random order makes it bound by memory access like a render
+ * of many hairs. Returns the number of hits. */
+int hair_intersect(HairIntersectKernelData &data, const int num_rays, double *r_time)
+{
+  KernelGlobals *kg = &data.kg;
+  const int num_curves = data.curves.size();
+
+  const double time_start = time_dt();
+  int num_hits = 0;
+
+  for (int i = 0; i < num_rays; i++) {
+    const int curve = min((int)(hash_uint2_to_float(i, 0) * num_curves), num_curves - 1);
+    const float4 v00 = data.curves[curve];
+    const int num_segments = __float_as_int(v00.y) - 1;
+    const int segment = min((int)(hash_uint2_to_float(i, 1) * num_segments), num_segments - 1);
+
+    /* Towards the middle of the segment, from a random direction. */
+    const int k = __float_as_int(v00.x) + segment;
+    const float4 k0 = data.curve_keys[k], k1 = data.curve_keys[k + 1];
+    const float3 target = 0.5f * make_float3(k0.x + k1.x, k0.y + k1.y, k0.z + k1.z);
+    const float3 D = normalize(make_float3(hash_uint2_to_float(i, 2) - 0.5f,
+                                           hash_uint2_to_float(i, 3) - 0.5f,
+                                           hash_uint2_to_float(i, 4) - 0.5f));
+
+    Intersection isect;
+    isect.t = 2.0f;
+    if (curve_intersect(kg,
+                        &isect,
+                        target - D,
+                        D,
+                        PATH_RAY_ALL_VISIBILITY,
+                        0,
+                        curve,
+                        0.0f,
+                        PRIMITIVE_PACK_SEGMENT(PRIMITIVE_CURVE_THICK, segment))) {
+      num_hits++;
+    }
+  }
+
+  *r_time = time_dt() - time_start;
+  return num_hits;
+}
+
+/* Memory of the hair on the host, on the device with full precision and quantized keys, and
+ * of the copy Embree makes, followed by the intersection time with both kinds of keys. */
+void hair_performance(const int num_curves, const int num_rays)
+{
+  Hair hair;
+  hair_set_curves(&hair, num_curves);
+  HairIntersectKernelData data(&hair);
+
+  const size_t num_keys = hair.num_keys();
+  const size_t host_size = hair.get_curve_keys().size() * sizeof(float3) +
+                           hair.get_curve_radius().size() * sizeof(float) +
+                           hair.get_curve_first_key().size() * sizeof(int) +
+                           hair.get_curve_shader().size() * sizeof(int);
+  const size_t curves_size = num_curves * sizeof(float4);
+  const size_t full_size = curves_size + num_keys * sizeof(float4);
+  const size_t quantized_size = curves_size + num_keys * sizeof(ushort4) +
+                                num_curves * sizeof(float4);
+  /* Embree stores float4 keys with an extra key at both ends, and an index per segment. */
+  const size_t embree_size = (num_keys + 2 * num_curves) * sizeof(float4) +
+                             hair.num_segments() * sizeof(int);
+
+  printf("\n========== %d curves, %d keys ==========\n", num_curves, (int)num_keys);
+  printf("\thost arrays: %s\n", string_human_readable_size(host_size).c_str());
+  printf("\tdevice, full precision keys: %s\n", string_human_readable_size(full_size).c_str());
+  printf("\tdevice, quantized keys: %s\n", string_human_readable_size(quantized_size).c_str());
+  printf("\tEmbree copy: %s\n", string_human_readable_size(embree_size).c_str());
+  printf("\ttotal resident with BVH2: %s full precision, %s quantized\n",
+         string_human_readable_size(host_size + full_size).c_str(),
+         string_human_readable_size(host_size + quantized_size).c_str());
+  printf("\ttotal resident with Embree: %s full precision, %s quantized\n",
+         string_human_readable_size(host_size + full_size + embree_size).c_str(),
+         string_human_readable_size(host_size + quantized_size + embree_size).c_str());
+
+  for (int quantized = 0; quantized <= 1; quantized++) {
+    data.kg.__data.bvh.curve_keys_quantized = quantized;
+    double time;
+    const int num_hits = hair_intersect(data, num_rays, &time);
+    printf("\t%s keys: %d rays in %fs, %d hits\n",
+           (quantized) ? "quantized" : "full precision",
+           num_rays,
+           time,
+           num_hits);
+  }
+}
+
+}  // namespace
+
+TEST(render_hair_performance, performance_10000)
+{
+  hair_performance(10000, 1000000);
+}
+
+TEST(render_hair_performance, performance_1000000)
+{
+  hair_performance(1000000, 1000000);
+}
+
+CCL_NAMESPACE_END
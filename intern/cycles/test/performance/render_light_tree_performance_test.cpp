@@ -0,0 +1,210 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+
+#include "test/light_tree_test_util.h"
+
+#include "kernel/kernel_light_tree.h"
+
+#include "util/util_time.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Unshadowed contribution of an emitter at P, a point light for lamps and a two sided
+ * emitter facing along its normal for triangles. */
+float light_tree_contribution(const LightTreeEmitter &emitter, const float3 P)
+{
+  float distance;
+  const float3 D = normalize_len(P - emitter.centroid(), &distance);
+  const float size = 0.5f * (emitter.bbox.max.x - emitter.bbox.min.x);
+  const float distance_sq = max(distance * distance, size * size);
+
+  if (emitter.cone.theta_o == M_PI_F) {
+    return emitter.energy / distance_sq;
+  }
+  return emitter.energy * fabsf(dot(emitter.cone.axis, D)) / distance_sq;
+}
+
+/* Importance sampling of emitters from a fixed cumulative distribution, like the light
+ * distribution does for all shading points. */
+struct LightDistribution {
+  vector<float> cdf;
+
+  LightDistribution(const vector<float> &weights) : cdf(weights.size() + 1)
+  {
+    cdf[0] = 0.0f;
+    for (int i = 0; i < weights.size(); i++) {
+      cdf[i + 1] = cdf[i] + weights[i];
+    }
+    for (int i = 0; i < cdf.size(); i++) {
+      cdf[i] /= cdf.back();
+    }
+  }
+
+  int sample(const float randu, float *pdf) const
+  {
+    const int i = min((int)(std::upper_bound(cdf.begin(), cdf.end(), randu) - cdf.begin()) - 1,
+                      (int)cdf.size() - 2);
+    *pdf = cdf[i + 1] - cdf[i];
+    return i;
+  }
+};
+
+enum LightSelection {
+  LIGHT_SELECTION_TREE,
+  LIGHT_SELECTION_DISTRIBUTION,
+  LIGHT_SELECTION_ENERGY,
+};
+
+/* Estimate the total contribution at random shading points with one emitter sample at a
+ * time, and return the relative root mean square error over all points. */
+float light_selection_error(LightTreeKernelData &data,
+                            const vector<LightTreeEmitter> &emitters,
+                            const LightDistribution *distribution,
+                            const vector<float3> &points,
+                            const vector<float> &reference,
+                            const int num_samples,
+                            double *r_time)
+{
+  const double time_start = time_dt();
+  double error_sq = 0.0;
+
+  for (int j = 0; j < points.size(); j++) {
+    const float3 P = points[j];
+    float estimate = 0.0f;
+
+    for (int s = 0; s < num_samples; s++) {
+      float randu = hash_uint3_to_float(j, s, 0);
+      float pdf;
+      int emitter;
+
+      if (distribution) {
+        emitter = distribution->sample(randu, &pdf);
+      }
+      else {
+        const int leaf = light_tree_sample_emitter(&data.kg, P, &randu, &pdf);
+        emitter = (leaf >= 0) ? data.kemitters[leaf].prim : -1;
+      }
+
+      if (emitter >= 0 && pdf > 0.0f) {
+        estimate += light_tree_contribution(emitters[emitter], P) / pdf;
+      }
+    }
+
+    estimate /= num_samples;
+    const double error = (estimate - reference[j]) / reference[j];
+    error_sq += error * error;
+  }
+
+  *r_time = time_dt() - time_start;
+  return (float)sqrt(error_sq / points.size());
+}
+
+/* Noise of the light tree against the light distribution at equal samples, and the time per
+ * sample for selecting and evaluating the emitter. In a render each sample also traces a
+ * shadow ray, so the selection cost matters less than it does here. Selection by energy is
+ * included as a distribution that knows the emitter energy but not the shading point. */
+void light_tree_performance(const int num_emitters, const int num_points, const int num_samples)
+{
+  vector<LightTreeEmitter> emitters;
+  light_tree_emitters(num_emitters, emitters);
+
+  const double time_build_start = time_dt();
+  LightTree tree(emitters);
+  const double time_build = time_dt() - time_build_start;
+
+  LightTreeKernelData data(tree);
+
+  /* The light distribution picks triangles by area, and gives lamps the average area. */
+  vector<float> area_weights(num_emitters), energy_weights(num_emitters);
+  float total_area = 0.0f;
+  int num_triangles = 0;
+  for (int i = 0; i < num_emitters; i++) {
+    if (emitters[i].cone.theta_o != M_PI_F) {
+      const float3 size = emitters[i].bbox.size();
+      area_weights[i] = size.x * size.y;
+      total_area += area_weights[i];
+      num_triangles++;
+    }
+    energy_weights[i] = emitters[i].energy;
+  }
+  for (int i = 0; i < num_emitters; i++) {
+    if (emitters[i].cone.theta_o == M_PI_F) {
+      area_weights[i] = total_area / num_triangles;
+    }
+  }
+  const LightDistribution distribution(area_weights);
+  const LightDistribution energy(energy_weights);
+
+  /* Shading points in and around the emitters, with the exact total contribution. */
+  vector<float3> points(num_points);
+  vector<float> reference(num_points, 0.0f);
+  for (int j = 0; j < num_points; j++) {
+    points[j] = make_float3(hash_uint2_to_float(j, 10) * 120.0f - 10.0f,
+                            hash_uint2_to_float(j, 11) * 120.0f - 10.0f,
+                            hash_uint2_to_float(j, 12) * 30.0f - 10.0f);
+    for (int i = 0; i < num_emitters; i++) {
+      reference[j] += light_tree_contribution(emitters[i], points[j]);
+    }
+  }
+
+  printf("\n========== %d emitters, built in %fs ==========\n", num_emitters, time_build);
+
+  const struct {
+    const char *name;
+    const LightDistribution *distribution;
+  } cases[] = {
+      {"light distribution", &distribution},
+      {"light tree", NULL},
+      {"by energy", &energy},
+  };
+
+  for (const auto &test_case : cases) {
+    double time;
+    const float error = light_selection_error(
+        data, emitters, test_case.distribution, points, reference, num_samples, &time);
+
+    printf("\t%s: relative error %f at %d samples, %fus per sample\n",
+           test_case.name,
+           (double)error,
+           num_samples,
+           time * 1e6 / ((double)num_points * num_samples));
+  }
+}
+
+}  // namespace
+
+TEST(render_light_tree_performance, performance_1000)
+{
+  light_tree_performance(1000, 1000, 64);
+}
+
+TEST(render_light_tree_performance, performance_10000)
+{
+  light_tree_performance(10000, 1000, 64);
+}
+
+TEST(render_light_tree_performance, performance_100000)
+{
+  light_tree_performance(100000, 100, 64);
+}
+
+CCL_NAMESPACE_END
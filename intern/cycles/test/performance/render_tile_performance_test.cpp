@@ -0,0 +1,151 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/buffers.h"
+#include "render/tile.h"
+
+#include "util/util_algorithm.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+const int width = 1920;
+const int height = 1080;
+const int num_threads = 16;
+
+/* Cost of rendering each pixel of an uneven frame: a disc of expensive pixels, like hair or a
+ * volume, on a cheap background. */
+vector<float> frame_cost(const int center_x, const int center_y, const float heavy_cost)
+{
+  const int radius = height / 4;
+  vector<float> cost(width * height, 1.0f);
+
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const int dx = x - center_x, dy = y - center_y;
+      if (dx * dx + dy * dy < radius * radius) {
+        cost[y * width + x] = heavy_cost;
+      }
+    }
+  }
+
+  return cost;
+}
+
+struct TileSchedule {
+  /* Time until all threads are done. */
+  double frame_time = 0.0;
+  /* Time from the first thread running out of tiles until all threads are done. */
+  double tail_time = 0.0;
+  /* Time threads spend without a tile before the frame is done. */
+  double idle_time = 0.0;
+  int num_tiles = 0;
+};
+
+/* Render a frame with simulated threads, each taking the next tile as soon as it finishes the
+ * previous one and spending the cost of its pixels on it. Simulated time makes the tail
+ * independent of the machine running the test. */
+TileSchedule tile_schedule(const vector<float> &cost, const int split_threshold)
+{
+  TileManager tile_manager(false, 1, make_int2(64, 64), INT_MAX, false, true, TILE_CENTER);
+  tile_manager.handout_split_threshold = split_threshold;
+
+  BufferParams params;
+  params.width = params.full_width = width;
+  params.height = params.full_height = height;
+  tile_manager.reset(params, 1);
+  tile_manager.next();
+
+  TileSchedule schedule;
+  vector<double> thread_time(num_threads, 0.0);
+  double first_idle_time = 0.0;
+
+  while (true) {
+    /* The thread finishing its tile first asks for the next one. */
+    const int thread = std::min_element(thread_time.begin(), thread_time.end()) -
+                       thread_time.begin();
+
+    Tile *tile;
+    if (!tile_manager.next_tile(tile, 0, RenderTile::PATH_TRACE)) {
+      first_idle_time = thread_time[thread];
+      break;
+    }
+
+    for (int y = tile->y; y < tile->y + tile->h; y++) {
+      for (int x = tile->x; x < tile->x + tile->w; x++) {
+        thread_time[thread] += cost[y * width + x];
+      }
+    }
+    schedule.num_tiles++;
+  }
+
+  schedule.frame_time = *std::max_element(thread_time.begin(), thread_time.end());
+  schedule.tail_time = schedule.frame_time - first_idle_time;
+  for (int i = 0; i < num_threads; i++) {
+    schedule.idle_time += schedule.frame_time - thread_time[i];
+  }
+
+  return schedule;
+}
+
+/* Frame and tail time relative to the ideal frame time with all threads busy until the end,
+ * with and without splitting tiles as they are handed out. */
+void tile_performance(const char *name, const vector<float> &cost)
+{
+  double total_cost = 0.0;
+  for (float c : cost) {
+    total_cost += c;
+  }
+  const double ideal_time = total_cost / num_threads;
+
+  printf("\n========== %s, %dx%d, %d threads ==========\n", name, width, height, num_threads);
+
+  for (int split = 0; split <= 1; split++) {
+    const TileSchedule schedule = tile_schedule(cost, (split) ? num_threads : 0);
+    printf("\t%s: %d tiles, frame %.3fx ideal, tail %.3fx ideal, threads idle %.1f%%\n",
+           (split) ? "split on hand out" : "no split",
+           schedule.num_tiles,
+           schedule.frame_time / ideal_time,
+           schedule.tail_time / ideal_time,
+           100.0 * schedule.idle_time / (schedule.frame_time * num_threads));
+  }
+}
+
+}  // namespace
+
+TEST(render_tile_performance, uniform)
+{
+  tile_performance("uniform", frame_cost(0, 0, 1.0f));
+}
+
+/* Tiles are handed out from the center, so the heavy tiles in the corner are handed out last.
+ * The very last ones are split, but those handed out just before splitting starts render whole
+ * and are what is left of the tail. */
+TEST(render_tile_performance, heavy_corner)
+{
+  tile_performance("heavy corner", frame_cost(width, height, 20.0f));
+}
+
+/* The heavy tiles in the center are handed out first, and the tail is only cheap tiles. */
+TEST(render_tile_performance, heavy_center)
+{
+  tile_performance("heavy center", frame_cost(width / 2, height / 2, 20.0f));
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/mesh.h"
+
+#include "subd/subd_dice.h"
+#include "subd/subd_split.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Linear subdivision cage of square islands of wavy quads, laid out in a grid. The first vertex
+ * of the first island is raised by corner_height, which only changes the first face. */
+void mesh_set_islands(Mesh *mesh,
+                      const int num_islands_side,
+                      const int island_size,
+                      const float corner_height)
+{
+  mesh->clear();
+  mesh->set_subdivision_type(Mesh::SUBDIVISION_LINEAR);
+  mesh->set_subd_dicing_rate(0.1f);
+  mesh->set_subd_max_level(6);
+
+  const int verts_side = island_size + 1;
+  const int num_islands = num_islands_side * num_islands_side;
+  const int num_faces = num_islands * island_size * island_size;
+  mesh->reserve_mesh(num_islands * verts_side * verts_side, 0);
+
+  for (int i = 0; i < num_islands; i++) {
+    const int x0 = (i % num_islands_side) * verts_side;
+    const int y0 = (i / num_islands_side) * verts_side;
+
+    for (int y = y0; y < y0 + verts_side; y++) {
+      for (int x = x0; x < x0 + verts_side; x++) {
+        const float z = sinf(x * 0.7f) * cosf(y * 0.5f) * 0.5f +
+                        ((x == 0 && y == 0) ? corner_height : 0.0f);
+        mesh->add_vertex(make_float3((float)x, (float)y, z));
+      }
+    }
+  }
+
+  mesh->reserve_subd_faces(num_faces, 0, num_faces * 4);
+
+  for (int i = 0; i < num_islands; i++) {
+    for (int y = 0; y < island_size; y++) {
+      for (int x = 0; x < island_size; x++) {
+        const int v00 = (i * verts_side + y) * verts_side + x;
+        int corners[4] = {v00, v00 + 1, v00 + verts_side + 1, v00 + verts_side};
+        mesh->add_subd_face(corners, 4, 0, false);
+      }
+    }
+  }
+}
+
+struct SubdSplitTimes {
+  int num_faces_reused = 0;
+  double factors = 0.0;
+  double split = 0.0;
+  double dice = 0.0;
+
+  void tessellate(Mesh *mesh)
+  {
+    DiagSplit diag_split(*mesh->get_subd_params());
+    mesh->tessellate(&diag_split);
+
+    num_faces_reused += diag_split.num_faces_reused;
+    factors += diag_split.factors_time;
+    split += diag_split.split_time;
+    dice += diag_split.dice_time;
+  }
+
+  void print(const char *name, const int runs_num) const
+  {
+    printf("\t%s: %d faces reused, factors %fs, split %fs, stitch and dice %fs on average\n",
+           name,
+           num_faces_reused / runs_num,
+           factors / runs_num,
+           split / runs_num,
+           dice / runs_num);
+  }
+};
+
+/* Tessellate from scratch, again with the same cage, and again with one face changed beyond
+ * the reuse tolerance. Reuse is per island, so the changed face only splits its own island
+ * again. */
+void subd_split_performance(const int num_islands_side, const int island_size, const int runs_num)
+{
+  SubdSplitTimes scratch, unchanged, changed;
+  size_t num_triangles = 0;
+
+  for (int run = 0; run < runs_num; run++) {
+    Mesh mesh;
+
+    mesh_set_islands(&mesh, num_islands_side, island_size, 0.0f);
+    scratch.tessellate(&mesh);
+    num_triangles = mesh.num_triangles();
+
+    mesh_set_islands(&mesh, num_islands_side, island_size, 0.0f);
+    unchanged.tessellate(&mesh);
+
+    mesh_set_islands(&mesh, num_islands_side, island_size, 2.0f);
+    changed.tessellate(&mesh);
+  }
+
+  const int num_faces = num_islands_side * num_islands_side * island_size * island_size;
+  printf("\n========== %d faces in %d islands, %d triangles ==========\n",
+         num_faces,
+         num_islands_side * num_islands_side,
+         (int)num_triangles);
+  scratch.print("from scratch", runs_num);
+  unchanged.print("unchanged", runs_num);
+  changed.print("one face changed", runs_num);
+}
+
+}  // namespace
+
+TEST(subd_split_performance, connected)
+{
+  subd_split_performance(1, 64, 5);
+}
+
+TEST(subd_split_performance, islands)
+{
+  subd_split_performance(8, 8, 5);
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "kernel/kernel_compat_cpu.h"
+#include "kernel/kernel_math.h"
+#include "kernel/kernel_types.h"
+
+#include "kernel/split/kernel_split_data.h"
+#include "kernel/kernel_globals.h"
+
+#include "kernel/kernel_color.h"
+#include "kernel/kernels/cpu/kernel_cpu_image.h"
+#include "kernel/kernel_path.h"
+
+#include "util/util_time.h"
+
+CCL_NAMESPACE_BEGIN
+
+#ifdef __KERNEL_SSE2__
+
+namespace {
+
+/* Stack offsets of the displacement shaders. */
+enum {
+  STACK_COORDS = 0,
+  STACK_HEIGHT = 3,
+  STACK_MIDLEVEL = 4,
+  STACK_SCALE = 5,
+  STACK_DISPLACEMENT = 6,
+};
+
+uint encode_uchar4(uint x, uint y = 0, uint z = 0, uint w = 0)
+{
+  return x | (y << 8) | (z << 16) | (w << 24);
+}
+
+/* Nodes of a displacement shader as the SVM compiler would write them: object coordinates,
+ * optionally a 3D noise texture for the height, and a displacement node along the normal. */
+vector<uint4> displacement_nodes(const bool use_noise, const float detail, const float distortion)
+{
+  const uint invalid = SVM_STACK_INVALID;
+  vector<uint4> nodes;
+
+  nodes.push_back(make_uint4(NODE_SHADER_JUMP, 0, 0, 1));
+  nodes.push_back(make_uint4(NODE_TEX_COORD, NODE_TEXCO_OBJECT, STACK_COORDS, 0));
+  nodes.push_back(make_uint4(NODE_VALUE_F, __float_as_uint(0.5f), STACK_MIDLEVEL, 0));
+  nodes.push_back(make_uint4(NODE_VALUE_F, __float_as_uint(0.1f), STACK_SCALE, 0));
+
+  if (use_noise) {
+    nodes.push_back(make_uint4(NODE_TEX_NOISE,
+                               3,
+                               encode_uchar4(STACK_COORDS, invalid, invalid, invalid),
+                               encode_uchar4(invalid, invalid, STACK_HEIGHT, invalid)));
+    nodes.push_back(make_uint4(__float_as_uint(0.0f),
+                               __float_as_uint(5.0f),
+                               __float_as_uint(detail),
+                               __float_as_uint(0.5f)));
+    nodes.push_back(make_uint4(__float_as_uint(distortion), invalid, invalid, invalid));
+  }
+  else {
+    /* The height is the x coordinate. */
+    nodes.push_back(make_uint4(NODE_VALUE_F, __float_as_uint(0.0f), STACK_HEIGHT + 1, 0));
+    nodes.push_back(make_uint4(
+        NODE_MATH, NODE_MATH_ADD, encode_uchar4(STACK_COORDS, STACK_HEIGHT + 1), STACK_HEIGHT));
+  }
+
+  nodes.push_back(make_uint4(NODE_DISPLACEMENT,
+                             encode_uchar4(STACK_HEIGHT, STACK_MIDLEVEL, STACK_SCALE, invalid),
+                             STACK_DISPLACEMENT,
+                             NODE_NORMAL_MAP_WORLD));
+  nodes.push_back(make_uint4(NODE_SET_DISPLACEMENT, STACK_DISPLACEMENT, 0, 0));
+  nodes.push_back(make_uint4(NODE_END, 0, 0, 0));
+
+  return nodes;
+}
+
+/* Points on a wavy sheet. */
+void displacement_points(const int num, vector<float3> &P, vector<float3> &N)
+{
+  P.resize(num);
+  N.resize(num);
+  for (int i = 0; i < num; i++) {
+    const float u = (float)(i % 1000) * 0.01f, v = (float)(i / 1000) * 0.01f;
+    P[i] = make_float3(u, v, sinf(u) * cosf(v));
+    N[i] = normalize(make_float3(-cosf(u) * cosf(v), sinf(u) * sinf(v), 1.0f));
+  }
+}
+
+/* Shader data of a point not on any object, as the displacement kernel would set it up. */
+void displacement_shader_setup(ShaderData *sd, const float3 P, const float3 N)
+{
+  sd->P = P;
+  sd->N = N;
+  sd->object = OBJECT_NONE;
+  sd->shader = 0;
+  sd->num_closure = 0;
+  sd->num_closure_left = 0;
+}
+
+/* Displace all points one at a time, and SVM_BATCH_SIZE at a time as the displacement kernel
+ * does for points with the same shader. */
+void svm_batch_performance(const char *name,
+                           const bool use_noise,
+                           const float detail,
+                           const float distortion)
+{
+  const int num_points = 1000000;
+
+  vector<uint4> nodes = displacement_nodes(use_noise, detail, distortion);
+  KernelGlobals kg;
+  memset((void *)&kg, 0, sizeof(kg));
+  kg.__svm_nodes.data = nodes.data();
+  kg.__svm_nodes.width = nodes.size();
+
+  vector<float3> P, N;
+  displacement_points(num_points, P, N);
+  vector<float3> P_scalar(num_points), P_batch(num_points);
+
+  ShaderData sd[SVM_BATCH_SIZE];
+  PathState state = {0};
+
+  double time_start = time_dt();
+  for (int i = 0; i < num_points; i++) {
+    displacement_shader_setup(&sd[0], P[i], N[i]);
+    svm_eval_nodes(&kg, &sd[0], &state, NULL, SHADER_TYPE_DISPLACEMENT, 0);
+    P_scalar[i] = sd[0].P;
+  }
+  const double time_scalar = time_dt() - time_start;
+
+  SVMBatch batch;
+  for (int lane = 0; lane < SVM_BATCH_SIZE; lane++) {
+    batch.sd[lane] = &sd[lane];
+  }
+
+  time_start = time_dt();
+  for (int i = 0; i < num_points; i += SVM_BATCH_SIZE) {
+    for (int lane = 0; lane < SVM_BATCH_SIZE; lane++) {
+      displacement_shader_setup(&sd[lane], P[i + lane], N[i + lane]);
+    }
+    EXPECT_TRUE(svm_eval_displacement_batch(&kg, &batch));
+    for (int lane = 0; lane < SVM_BATCH_SIZE; lane++) {
+      P_batch[i + lane] = sd[lane].P;
+    }
+  }
+  const double time_batch = time_dt() - time_start;
+
+  /* The batched noise rounds differently when the kernel uses fused multiply-add. */
+  float max_error = 0.0f;
+  for (int i = 0; i < num_points; i++) {
+    max_error = max(max_error, len(P_scalar[i] - P_batch[i]));
+  }
+  EXPECT_LT(max_error, 1e-5f);
+
+  printf("\n========== Displacement of %d points, %s ==========\n", num_points, name);
+  printf("\tone at a time: %fs\n", time_scalar);
+  printf("\t%d at a time: %fs, %.2fx faster\n",
+         SVM_BATCH_SIZE,
+         time_batch,
+         time_scalar / time_batch);
+}
+
+}  // namespace
+
+/* Only nodes that run once per lane, this is the overhead of batching. */
+TEST(svm_batch_performance, coordinates)
+{
+  svm_batch_performance("object coordinates", false, 0.0f, 0.0f);
+}
+
+TEST(svm_batch_performance, noise_detail_2)
+{
+  svm_batch_performance("noise detail 2", true, 2.0f, 0.0f);
+}
+
+TEST(svm_batch_performance, noise_detail_8_distortion)
+{
+  svm_batch_performance("noise detail 8 with distortion", true, 8.0f, 1.0f);
+}
+
+#endif /* __KERNEL_SSE2__ */
+
+CCL_NAMESPACE_END
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/buffers.h"
+#include "render/checkpoint.h"
+
+#include "util/util_path.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+class RenderCheckpointTest : public testing::Test {
+ protected:
+  BufferParams params;
+  int pass_stride;
+  string filepath;
+
+  virtual void SetUp()
+  {
+    params.width = params.full_width = 8;
+    params.height = params.full_height = 6;
+    pass_stride = params.get_passes_size();
+    filepath = path_join(testing::TempDir(), "cycles_render_checkpoint_test.checkpoint");
+    path_remove(filepath);
+  }
+
+  virtual void TearDown()
+  {
+    path_remove(filepath);
+  }
+
+  vector<float> tile_pixels(int w, int h, float value)
+  {
+    vector<float> pixels(w * h * pass_stride);
+    for (size_t i = 0; i < pixels.size(); i++) {
+      pixels[i] = value + i;
+    }
+    return pixels;
+  }
+
+  void expect_tile(RenderCheckpoint &checkpoint,
+                   const RenderCheckpoint::Tile &tile,
+                   const vector<float> &expected)
+  {
+    vector<float> pixels(tile.w * tile.h * pass_stride);
+    ASSERT_TRUE(checkpoint.read_tile(tile, pixels.data()));
+    EXPECT_EQ(pixels, expected);
+  }
+};
+
+}  // namespace
+
+TEST_F(RenderCheckpointTest, round_trip)
+{
+  const vector<float> pixels_a = tile_pixels(4, 3, 1.0f);
+  const vector<float> pixels_b = tile_pixels(4, 3, 1000.0f);
+
+  RenderCheckpoint checkpoint;
+  EXPECT_FALSE(checkpoint.load(filepath, params));
+  ASSERT_TRUE(checkpoint.begin(filepath, params));
+  ASSERT_TRUE(checkpoint.write_tile(0, 0, 4, 3, 16, pixels_a.data()));
+  ASSERT_TRUE(checkpoint.write_tile(4, 3, 4, 3, 32, pixels_b.data()));
+  checkpoint.end(false);
+
+  RenderCheckpoint resumed;
+  ASSERT_TRUE(resumed.load(filepath, params));
+  ASSERT_EQ(resumed.tiles.size(), 2);
+
+  const RenderCheckpoint::Tile &tile_a = resumed.tiles[0];
+  EXPECT_EQ(tile_a.x, 0);
+  EXPECT_EQ(tile_a.y, 0);
+  EXPECT_EQ(tile_a.w, 4);
+  EXPECT_EQ(tile_a.h, 3);
+  EXPECT_EQ(tile_a.num_samples, 16);
+  expect_tile(resumed, tile_a, pixels_a);
+
+  const RenderCheckpoint::Tile &tile_b = resumed.tiles[1];
+  EXPECT_EQ(tile_b.x, 4);
+  EXPECT_EQ(tile_b.y, 3);
+  EXPECT_EQ(tile_b.num_samples, 32);
+  expect_tile(resumed, tile_b, pixels_b);
+
+  /* Continue writing after the loaded tiles, a later record for the same
+   * tile replaces the earlier one. */
+  const vector<float> pixels_c = tile_pixels(4, 3, 2000.0f);
+  ASSERT_TRUE(resumed.begin(filepath, params));
+  ASSERT_TRUE(resumed.write_tile(0, 0, 4, 3, 64, pixels_c.data()));
+  resumed.end(false);
+
+  RenderCheckpoint resumed_again;
+  ASSERT_TRUE(resumed_again.load(filepath, params));
+  ASSERT_EQ(resumed_again.tiles.size(), 2);
+  EXPECT_EQ(resumed_again.tiles[0].num_samples, 64);
+  expect_tile(resumed_again, resumed_again.tiles[0], pixels_c);
+  expect_tile(resumed_again, resumed_again.tiles[1], pixels_b);
+
+  resumed_again.end(true);
+  EXPECT_FALSE(path_exists(filepath));
+}
+
+TEST_F(RenderCheckpointTest, frame)
+{
+  const vector<float> pixels_a = tile_pixels(8, 6, 1.0f);
+  const vector<float> pixels_b = tile_pixels(8, 6, 5000.0f);
+
+  RenderCheckpoint checkpoint;
+  ASSERT_TRUE(checkpoint.begin(filepath, params));
+  ASSERT_TRUE(checkpoint.write_frame(8, 6, 4, pixels_a.data()));
+  ASSERT_TRUE(checkpoint.write_frame(8, 6, 8, pixels_b.data()));
+  checkpoint.end(false);
+  EXPECT_FALSE(path_exists(filepath + ".tmp"));
+
+  RenderCheckpoint resumed;
+  ASSERT_TRUE(resumed.load(filepath, params));
+  ASSERT_EQ(resumed.tiles.size(), 1);
+  EXPECT_EQ(resumed.tiles[0].w, 8);
+  EXPECT_EQ(resumed.tiles[0].h, 6);
+  EXPECT_EQ(resumed.tiles[0].num_samples, 8);
+  expect_tile(resumed, resumed.tiles[0], pixels_b);
+}
+
+TEST_F(RenderCheckpointTest, different_layout)
+{
+  const vector<float> pixels = tile_pixels(4, 3, 1.0f);
+
+  RenderCheckpoint checkpoint;
+  ASSERT_TRUE(checkpoint.begin(filepath, params));
+  ASSERT_TRUE(checkpoint.write_tile(0, 0, 4, 3, 16, pixels.data()));
+  checkpoint.end(false);
+
+  params.width = params.full_width = 16;
+  RenderCheckpoint resumed;
+  EXPECT_FALSE(resumed.load(filepath, params));
+}
+
+/* Truncated and corrupt records are ignored, along with everything after them. */
+TEST_F(RenderCheckpointTest, corrupt_records)
+{
+  const vector<float> pixels = tile_pixels(4, 3, 1.0f);
+
+  RenderCheckpoint checkpoint;
+  ASSERT_TRUE(checkpoint.begin(filepath, params));
+  ASSERT_TRUE(checkpoint.write_tile(0, 0, 4, 3, 16, pixels.data()));
+  /* Outside of the buffer. */
+  ASSERT_TRUE(checkpoint.write_tile(6, 0, 4, 3, 16, pixels.data()));
+  checkpoint.end(false);
+
+  RenderCheckpoint resumed;
+  ASSERT_TRUE(resumed.load(filepath, params));
+  EXPECT_EQ(resumed.tiles.size(), 1);
+
+  ASSERT_TRUE(checkpoint.begin(filepath, params));
+  ASSERT_TRUE(checkpoint.write_tile(0, 0, 4, 3, 16, pixels.data()));
+  ASSERT_TRUE(checkpoint.write_tile(4, 0, 4, 3, 16, pixels.data()));
+  checkpoint.end(false);
+
+  ASSERT_TRUE(resumed.load(filepath, params));
+  EXPECT_EQ(resumed.tiles.size(), 2);
+
+  /* Cut the file in the middle of the pixels of the second record. */
+  vector<uint8_t> binary;
+  ASSERT_TRUE(path_read_binary(filepath, binary));
+  binary.resize(binary.size() - sizeof(float));
+  ASSERT_TRUE(path_write_binary(filepath, binary));
+
+  ASSERT_TRUE(resumed.load(filepath, params));
+  EXPECT_EQ(resumed.tiles.size(), 1);
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "test/hair_test_util.h"
+
+#include "kernel/geom/geom_curve_keys.h"
+
+CCL_NAMESPACE_BEGIN
+
+TEST(render_hair, quantized_keys)
+{
+  Hair hair;
+  hair_set_curves(&hair, 1000);
+  HairKernelData data(&hair);
+  KernelGlobals *kg = &data.kg;
+
+  for (int i = 0; i < hair.num_curves(); i++) {
+    const Hair::Curve curve = hair.get_curve(i);
+    const float step = data.curve_bounds[i].w;
+    const float radius_step = data.curves[i].w;
+
+    for (int k = curve.first_key; k < curve.first_key + curve.num_keys; k++) {
+      kg->__data.bvh.curve_keys_quantized = false;
+      const float4 key = curve_key_fetch(kg, i, k);
+      kg->__data.bvh.curve_keys_quantized = true;
+      const float4 key_quantized = curve_key_fetch(kg, i, k);
+
+      /* Rounding to the nearest step, with some slack for float precision. */
+      EXPECT_NEAR(key_quantized.x, key.x, step * 0.5f + 1e-6f);
+      EXPECT_NEAR(key_quantized.y, key.y, step * 0.5f + 1e-6f);
+      EXPECT_NEAR(key_quantized.z, key.z, step * 0.5f + 1e-6f);
+      EXPECT_NEAR(key_quantized.w, key.w, radius_step * 0.5f + 1e-9f);
+    }
+
+    /* Tips with zero radius stay exactly zero. */
+    kg->__data.bvh.curve_keys_quantized = true;
+    EXPECT_EQ(curve_key_fetch(kg, i, curve.first_key + curve.num_keys - 1).w, 0.0f);
+  }
+}
+
+TEST(render_hair, quantized_bounds)
+{
+  Hair hair;
+  hair_set_curves(&hair, 1000);
+  HairKernelData data(&hair);
+  KernelGlobals *kg = &data.kg;
+  kg->__data.bvh.curve_keys_quantized = true;
+
+  /* The keys as decoded by the kernel. */
+  vector<float3> keys(hair.num_keys());
+  vector<float> radius(hair.num_keys());
+  for (int i = 0; i < hair.num_curves(); i++) {
+    const Hair::Curve curve = hair.get_curve(i);
+    for (int k = curve.first_key; k < curve.first_key + curve.num_keys; k++) {
+      const float4 key = curve_key_fetch(kg, i, k);
+      keys[k] = make_float3(key.x, key.y, key.z);
+      radius[k] = key.w;
+    }
+  }
+
+  /* Padded bounds of the full precision curves contain the decoded curves. */
+  hair.curve_keys_padding = hair.curve_keys_quantization_padding();
+  EXPECT_GT(hair.curve_keys_padding, 0.0f);
+
+  for (int i = 0; i < hair.num_curves(); i++) {
+    const Hair::Curve curve = hair.get_curve(i);
+    for (int k = 0; k < curve.num_segments(); k++) {
+      BoundBox bounds = BoundBox::empty;
+      curve.bounds_grow(k, hair.get_curve_keys().data(), hair.get_curve_radius().data(), bounds);
+      hair.pad_curve_bounds(bounds);
+
+      BoundBox decoded_bounds = BoundBox::empty;
+      curve.bounds_grow(k, keys.data(), radius.data(), decoded_bounds);
+
+      EXPECT_LE(bounds.min.x, decoded_bounds.min.x);
+      EXPECT_LE(bounds.min.y, decoded_bounds.min.y);
+      EXPECT_LE(bounds.min.z, decoded_bounds.min.z);
+      EXPECT_GE(bounds.max.x, decoded_bounds.max.x);
+      EXPECT_GE(bounds.max.y, decoded_bounds.max.y);
+      EXPECT_GE(bounds.max.z, decoded_bounds.max.z);
+    }
+  }
+}
+
+CCL_NAMESPACE_END
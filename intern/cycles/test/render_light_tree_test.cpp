@@ -0,0 +1,93 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "test/light_tree_test_util.h"
+
+#include "kernel/kernel_light_tree.h"
+
+CCL_NAMESPACE_BEGIN
+
+TEST(render_light_tree, structure)
+{
+  vector<LightTreeEmitter> emitters;
+  light_tree_emitters(1000, emitters);
+  LightTree tree(emitters);
+
+  ASSERT_EQ(tree.nodes.size(), 2 * emitters.size() - 1);
+  ASSERT_EQ(tree.order.size(), emitters.size());
+
+  /* Every emitter in exactly one leaf. */
+  vector<int> count(emitters.size(), 0);
+  for (int i = 0; i < tree.order.size(); i++) {
+    count[tree.order[i]]++;
+  }
+  for (int i = 0; i < count.size(); i++) {
+    EXPECT_EQ(count[i], 1);
+  }
+
+  EXPECT_EQ(tree.nodes[0].parent, -1);
+  for (int i = 0; i < tree.nodes.size(); i++) {
+    const KernelLightTreeNode &knode = tree.nodes[i];
+    if (knode.child < 0) {
+      EXPECT_EQ(tree.leaf_nodes[~knode.child], i);
+    }
+    else {
+      EXPECT_EQ(tree.nodes[knode.child].parent, i);
+      EXPECT_EQ(tree.nodes[knode.child + 1].parent, i);
+      EXPECT_NEAR(tree.nodes[knode.child].energy + tree.nodes[knode.child + 1].energy,
+                  knode.energy,
+                  knode.energy * 1e-4f);
+    }
+  }
+}
+
+TEST(render_light_tree, pdf)
+{
+  vector<LightTreeEmitter> emitters;
+  light_tree_emitters(200, emitters);
+  LightTree tree(emitters);
+  LightTreeKernelData data(tree);
+  KernelGlobals *kg = &data.kg;
+
+  for (int j = 0; j < 16; j++) {
+    const float3 P = make_float3(hash_uint2_to_float(j, 10) * 120.0f - 10.0f,
+                                 hash_uint2_to_float(j, 11) * 120.0f - 10.0f,
+                                 hash_uint2_to_float(j, 12) * 30.0f - 10.0f);
+
+    /* The pdfs of all emitters sum to one. */
+    float sum = 0.0f;
+    for (int i = 0; i < emitters.size(); i++) {
+      sum += light_tree_emitter_pdf(kg, P, i);
+    }
+    EXPECT_NEAR(sum, 1.0f, 1e-4f);
+
+    /* Sampling returns the pdf of the sampled emitter. */
+    for (int i = 0; i < 64; i++) {
+      float randu = (i + 0.5f) / 64.0f;
+      float pdf;
+      const int emitter = light_tree_sample_emitter(kg, P, &randu, &pdf);
+      ASSERT_GE(emitter, 0);
+      ASSERT_LT(emitter, emitters.size());
+      EXPECT_NEAR(pdf, light_tree_emitter_pdf(kg, P, emitter), 1e-5f);
+      EXPECT_GE(randu, 0.0f);
+      EXPECT_LT(randu, 1.0f);
+    }
+  }
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/stats.h"
+
+CCL_NAMESPACE_BEGIN
+
+TEST(render_stats, adaptive_tile)
+{
+  AdaptiveTileStats tile;
+  tile.add_pixel(16, 0.02f, false, 0.0);
+  tile.add_pixel(64, 0.01f, true, 0.0);
+  tile.add_pixel(32, 0.03f, false, 0.0);
+  tile.add_pixel(16, 0.0f, true, 0.0);
+  tile.finish(2.0);
+
+  EXPECT_EQ(tile.min_samples, 16);
+  EXPECT_EQ(tile.max_samples, 64);
+  EXPECT_FLOAT_EQ(tile.mean_samples, 32.0f);
+  EXPECT_EQ(tile.num_converged, 2);
+  EXPECT_FLOAT_EQ(tile.mean_error, 0.015f);
+  EXPECT_FLOAT_EQ(tile.max_error, 0.03f);
+  /* No per pixel timing, so the time of the whole tile is used. */
+  EXPECT_EQ(tile.render_time, 2.0);
+}
+
+TEST(render_stats, adaptive_tile_pixel_time)
+{
+  AdaptiveTileStats tile;
+  tile.add_pixel(8, 0.5f, false, 0.25);
+  tile.add_pixel(4, 0.25f, false, 0.5);
+  tile.finish(2.0);
+
+  EXPECT_EQ(tile.min_samples, 4);
+  EXPECT_EQ(tile.max_samples, 8);
+  EXPECT_EQ(tile.render_time, 0.75);
+}
+
+TEST(render_stats, adaptive_json_report)
+{
+  AdaptiveSamplingStats stats;
+  stats.threshold = 0.01f;
+  EXPECT_EQ(stats.json_report(), "{\"threshold\": 0.010000, \"tiles\": []}");
+
+  AdaptiveTileStats tile;
+  tile.x = 64;
+  tile.y = 32;
+  tile.w = 2;
+  tile.h = 1;
+  tile.add_pixel(16, 0.5f, true, 0.0);
+  tile.add_pixel(48, 0.25f, false, 0.0);
+  tile.finish(1.5);
+  stats.tiles.push_back(tile);
+  stats.tiles.push_back(tile);
+
+  const string json_tile =
+      "{\"x\": 64, \"y\": 32, \"w\": 2, \"h\": 1, \"min_samples\": 16, "
+      "\"mean_samples\": 32.000000, \"max_samples\": 48, \"converged\": 1, "
+      "\"mean_error\": 0.375000, \"max_error\": 0.500000, \"time\": 1.500000}";
+  EXPECT_EQ(stats.json_report(),
+            "{\"threshold\": 0.010000, \"tiles\": [" + json_tile + ", " + json_tile + "]}");
+}
+
+CCL_NAMESPACE_END
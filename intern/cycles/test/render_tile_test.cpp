@@ -0,0 +1,140 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/buffers.h"
+#include "render/tile.h"
+
+#include "util/util_foreach.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Hand out all tiles of a frame, and check every pixel is rendered exactly once. */
+void tile_manager_test(const int width, const int height, const int split_threshold)
+{
+  TileManager tile_manager(false, 16, make_int2(64, 64), INT_MAX, false, true, TILE_CENTER);
+  tile_manager.handout_split_threshold = split_threshold;
+
+  BufferParams params;
+  params.width = params.full_width = width;
+  params.height = params.full_height = height;
+  tile_manager.reset(params, 16);
+  ASSERT_TRUE(tile_manager.next());
+
+  const int num_grid_tiles = tile_manager.state.num_tiles;
+  vector<int> num_renders(width * height, 0);
+  int num_tiles = 0;
+
+  Tile *tile;
+  while (tile_manager.next_tile(tile, 0, RenderTile::PATH_TRACE)) {
+    ASSERT_GT(tile->w, 0);
+    ASSERT_GT(tile->h, 0);
+    for (int y = tile->y; y < tile->y + tile->h; y++) {
+      for (int x = tile->x; x < tile->x + tile->w; x++) {
+        num_renders[y * width + x]++;
+      }
+    }
+    num_tiles++;
+  }
+
+  for (int i = 0; i < width * height; i++) {
+    EXPECT_EQ(num_renders[i], 1);
+  }
+
+  EXPECT_EQ(num_tiles, tile_manager.state.num_tiles);
+  if (split_threshold > 0) {
+    EXPECT_GT(num_tiles, num_grid_tiles);
+  }
+  else {
+    EXPECT_EQ(num_tiles, num_grid_tiles);
+  }
+}
+
+/* Find the tiles handed out by a render that split tiles again, the same way resuming
+ * from a checkpoint does. */
+void tile_manager_resume_test(const int width, const int height, const int split_threshold)
+{
+  BufferParams params;
+  params.width = params.full_width = width;
+  params.height = params.full_height = height;
+
+  TileManager tile_manager(false, 16, make_int2(64, 64), INT_MAX, false, true, TILE_CENTER);
+  tile_manager.handout_split_threshold = split_threshold;
+  tile_manager.reset(params, 16);
+  ASSERT_TRUE(tile_manager.next());
+
+  vector<int4> rendered;
+  Tile *tile;
+  while (tile_manager.next_tile(tile, 0, RenderTile::PATH_TRACE)) {
+    rendered.push_back(make_int4(tile->x, tile->y, tile->w, tile->h));
+  }
+
+  TileManager resumed(false, 16, make_int2(64, 64), INT_MAX, false, true, TILE_CENTER);
+  resumed.handout_split_threshold = split_threshold;
+  resumed.reset(params, 16);
+  ASSERT_TRUE(resumed.next());
+
+  foreach (const int4 &rect, rendered) {
+    int index = -1;
+    foreach (const Tile &other, resumed.state.tiles) {
+      if (rect.x >= other.x && rect.y >= other.y && rect.x + rect.z <= other.x + other.w &&
+          rect.y + rect.w <= other.y + other.h && other.state == Tile::RENDER) {
+        index = resumed.split_tile_to(other.index, rect.x, rect.y, rect.z, rect.w);
+        break;
+      }
+    }
+    ASSERT_NE(index, -1);
+
+    Tile &resumed_tile = resumed.state.tiles[index];
+    EXPECT_EQ(resumed_tile.x, rect.x);
+    EXPECT_EQ(resumed_tile.y, rect.y);
+    EXPECT_EQ(resumed_tile.w, rect.z);
+    EXPECT_EQ(resumed_tile.h, rect.w);
+    resumed.state.render_tiles[resumed_tile.device].remove(index);
+    resumed_tile.state = Tile::DONE;
+  }
+
+  /* Nothing is left to render. */
+  EXPECT_FALSE(resumed.next_tile(tile, 0, RenderTile::PATH_TRACE));
+  EXPECT_EQ(resumed.state.num_tiles, tile_manager.state.num_tiles);
+}
+
+}  // namespace
+
+TEST(render_tile, no_split)
+{
+  tile_manager_test(256, 200, 0);
+}
+
+TEST(render_tile, split)
+{
+  tile_manager_test(256, 200, 8);
+}
+
+TEST(render_tile, split_small_tiles)
+{
+  tile_manager_test(70, 33, 32);
+}
+
+TEST(render_tile, resume_split)
+{
+  tile_manager_resume_test(256, 200, 8);
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/mesh.h"
+
+#include "subd/subd_dice.h"
+#include "subd/subd_split.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+const int grid_size = 4;
+const int num_faces = grid_size * grid_size + 1;
+
+/* Linear subdivision cage of a wavy grid of quads and a separate pentagon. The first grid
+ * vertex is raised by corner_height, which only changes the edges of the first face that are
+ * on the border. The vertex diagonal to it is moved along X by inner_shift, which changes the
+ * edges the first face shares with its neighbors. */
+void mesh_set_cage(Mesh *mesh,
+                   const float scale,
+                   const float wave,
+                   const float corner_height = 0.0f,
+                   const float inner_shift = 0.0f)
+{
+  mesh->clear();
+  mesh->set_subdivision_type(Mesh::SUBDIVISION_LINEAR);
+  mesh->set_subd_dicing_rate(0.25f);
+  mesh->set_subd_max_level(6);
+
+  const int verts_side = grid_size + 1;
+  const int num_grid_verts = verts_side * verts_side;
+  mesh->reserve_mesh(num_grid_verts + 5, 0);
+
+  for (int y = 0; y < verts_side; y++) {
+    for (int x = 0; x < verts_side; x++) {
+      const float z = sinf(x * 0.7f) * cosf(y * 0.5f) * wave +
+                      ((x == 0 && y == 0) ? corner_height : 0.0f);
+      const float shift = (x == 1 && y == 1) ? inner_shift : 0.0f;
+      mesh->add_vertex(make_float3(x + shift, (float)y, z) * scale);
+    }
+  }
+
+  for (int i = 0; i < 5; i++) {
+    const float angle = i * M_2PI_F / 5.0f;
+    mesh->add_vertex(make_float3(cosf(angle) - 2.0f, sinf(angle), 0.0f) * scale);
+  }
+
+  mesh->reserve_subd_faces(num_faces, 1, grid_size * grid_size * 4 + 5);
+
+  for (int y = 0; y < grid_size; y++) {
+    for (int x = 0; x < grid_size; x++) {
+      const int v00 = y * verts_side + x;
+      int corners[4] = {v00, v00 + 1, v00 + verts_side + 1, v00 + verts_side};
+      mesh->add_subd_face(corners, 4, 0, false);
+    }
+  }
+
+  int corners[5];
+  for (int i = 0; i < 5; i++) {
+    corners[i] = num_grid_verts + i;
+  }
+  mesh->add_subd_face(corners, 5, 0, false);
+
+  /* Ngon centers interpolate vertex normals. */
+  Attribute *attr_vN = mesh->subd_attributes.add(ATTR_STD_VERTEX_NORMAL);
+  float3 *vN = attr_vN->data_float3();
+  for (int i = 0; i < mesh->get_verts().size(); i++) {
+    vN[i] = make_float3(0.0f, 0.0f, 1.0f);
+  }
+}
+
+int mesh_tessellate(Mesh *mesh)
+{
+  DiagSplit split(*mesh->get_subd_params());
+  mesh->tessellate(&split);
+  return split.num_faces_reused;
+}
+
+}  // namespace
+
+TEST(subd_split, reuse_unchanged)
+{
+  Mesh mesh;
+
+  mesh_set_cage(&mesh, 1.0f, 0.5f);
+  EXPECT_EQ(mesh_tessellate(&mesh), 0);
+
+  const array<int> triangles = mesh.get_triangles();
+  const array<float3> verts = mesh.get_verts();
+  EXPECT_GT(mesh.num_triangles(), num_faces * 2);
+
+  /* Same cage again, all faces are split as before and dice to the same mesh. */
+  mesh_set_cage(&mesh, 1.0f, 0.5f);
+  EXPECT_EQ(mesh_tessellate(&mesh), num_faces);
+
+  EXPECT_TRUE(mesh.get_triangles() == triangles);
+  EXPECT_TRUE(mesh.get_verts() == verts);
+}
+
+TEST(subd_split, reuse_within_tolerance)
+{
+  Mesh mesh;
+
+  mesh_set_cage(&mesh, 1.0f, 0.5f);
+  mesh_tessellate(&mesh);
+  const array<int> triangles = mesh.get_triangles();
+
+  /* Slightly deformed cage, topology is kept and the verts follow the deformation. */
+  mesh_set_cage(&mesh, 1.0f, 0.52f);
+  EXPECT_EQ(mesh_tessellate(&mesh), num_faces);
+  EXPECT_TRUE(mesh.get_triangles() == triangles);
+}
+
+/* Only the first face of the grid exceeds the tolerance, the edges it shares with its neighbors
+ * change within the tolerance. The whole grid is split again, while the separate pentagon is
+ * reused. The result must match splitting from scratch, otherwise shared edges would get
+ * different factors on each side. */
+TEST(subd_split, resplit_partially_changed)
+{
+  Mesh mesh;
+
+  mesh_set_cage(&mesh, 1.0f, 0.5f);
+  mesh_tessellate(&mesh);
+
+  mesh_set_cage(&mesh, 1.0f, 0.5f, 2.0f, 0.05f);
+  EXPECT_EQ(mesh_tessellate(&mesh), 1);
+
+  Mesh mesh_reference;
+  mesh_set_cage(&mesh_reference, 1.0f, 0.5f, 2.0f, 0.05f);
+  EXPECT_EQ(mesh_tessellate(&mesh_reference), 0);
+
+  EXPECT_TRUE(mesh.get_triangles() == mesh_reference.get_triangles());
+  EXPECT_TRUE(mesh.get_verts() == mesh_reference.get_verts());
+}
+
+TEST(subd_split, resplit_changed)
+{
+  Mesh mesh;
+
+  mesh_set_cage(&mesh, 1.0f, 0.5f);
+  mesh_tessellate(&mesh);
+  const size_t num_triangles = mesh.num_triangles();
+
+  /* Scaled cage needs more triangles, no face can be reused. */
+  mesh_set_cage(&mesh, 2.0f, 0.5f);
+  EXPECT_EQ(mesh_tessellate(&mesh), 0);
+  EXPECT_GT(mesh.num_triangles(), num_triangles);
+
+  /* Different dicing rate invalidates the cache. */
+  mesh_set_cage(&mesh, 2.0f, 0.5f);
+  mesh.set_subd_dicing_rate(0.5f);
+  EXPECT_EQ(mesh_tessellate(&mesh), 0);
+}
+
+CCL_NAMESPACE_END
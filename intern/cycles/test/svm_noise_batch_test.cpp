@@ -0,0 +1,154 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "kernel/kernel_compat_cpu.h"
+#include "kernel/kernel_math.h"
+#include "kernel/kernel_types.h"
+
+#include "kernel/split/kernel_split_data.h"
+#include "kernel/kernel_globals.h"
+
+#include "kernel/svm/svm_types.h"
+#include "kernel/svm/svm_util.h"
+
+#include "util/util_hash.h"
+
+#include "kernel/svm/svm_noise.h"
+#include "kernel/svm/svm_fractal_noise.h"
+#include "kernel/svm/svm_noise_batch.h"
+#include "kernel/svm/svm_noisetex.h"
+
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+#ifdef __KERNEL_SSE2__
+
+namespace {
+
+struct NoiseParams {
+  float detail;
+  float roughness;
+  float distortion;
+};
+
+/* Points spread over a few noise cells, with negative coordinates and points
+ * on cell boundaries. */
+void noise_points(const int num, vector<float3> &points)
+{
+  points.resize(num);
+  for (int i = 0; i < num; i++) {
+    const float t = (float)i / num;
+    points[i] = make_float3(
+        -7.0f + 14.0f * t, 3.0f * sinf(t * 37.0f), floorf(t * 11.0f) + ((i % 3) ? 0.37f : 0.0f));
+  }
+}
+
+/* Lanes past the fourth repeat the parameters of the first four. */
+void noise_texture_batch(const vector<float3> &points,
+                         const int start,
+                         const NoiseParams params[4],
+                         const bool color_is_needed,
+                         float value[NOISE_BATCH_SIZE],
+                         float3 color[NOISE_BATCH_SIZE])
+{
+  batchf x, y, z, detail, roughness, distortion;
+  for (int lane = 0; lane < NOISE_BATCH_SIZE; lane++) {
+    x[lane] = points[start + lane].x;
+    y[lane] = points[start + lane].y;
+    z[lane] = points[start + lane].z;
+    detail[lane] = params[lane % 4].detail;
+    roughness[lane] = params[lane % 4].roughness;
+    distortion[lane] = params[lane % 4].distortion;
+  }
+
+  batchf batch_value;
+  batchf batch_color[3];
+  noise_texture_3d_batch(
+      x, y, z, detail, roughness, distortion, color_is_needed, &batch_value, batch_color);
+
+  for (int lane = 0; lane < NOISE_BATCH_SIZE; lane++) {
+    value[lane] = batch_value[lane];
+    if (color_is_needed) {
+      color[lane] = make_float3(batch_color[0][lane], batch_color[1][lane], batch_color[2][lane]);
+    }
+  }
+}
+
+void noise_texture_test(const NoiseParams params[4], const bool color_is_needed)
+{
+  vector<float3> points;
+  noise_points(1024, points);
+
+  for (int i = 0; i < points.size(); i += NOISE_BATCH_SIZE) {
+    float value[NOISE_BATCH_SIZE];
+    float3 color[NOISE_BATCH_SIZE];
+    noise_texture_batch(points, i, params, color_is_needed, value, color);
+
+    for (int lane = 0; lane < NOISE_BATCH_SIZE; lane++) {
+      const NoiseParams &param = params[lane % 4];
+      float expected_value;
+      float3 expected_color;
+      noise_texture_3d(points[i + lane],
+                       param.detail,
+                       param.roughness,
+                       param.distortion,
+                       color_is_needed,
+                       &expected_value,
+                       &expected_color);
+
+      /* Results match up to floating point rounding, kernels built with fused multiply-add
+       * may round differently in the batched and scalar code. */
+      EXPECT_NEAR(value[lane], expected_value, 1e-5f);
+      if (color_is_needed) {
+        EXPECT_NEAR(color[lane].x, expected_color.x, 1e-5f);
+        EXPECT_NEAR(color[lane].y, expected_color.y, 1e-5f);
+        EXPECT_NEAR(color[lane].z, expected_color.z, 1e-5f);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(svm_noise_batch, fractal_noise)
+{
+  /* Lanes with different numbers of octaves, including fractional ones. */
+  const NoiseParams params[4] = {
+      {0.0f, 0.5f, 0.0f}, {2.0f, 0.5f, 0.0f}, {2.5f, 0.7f, 0.0f}, {16.0f, 0.3f, 0.0f}};
+  noise_texture_test(params, false);
+}
+
+TEST(svm_noise_batch, distortion)
+{
+  /* Lanes with and without distortion in the same batch. */
+  const NoiseParams params[4] = {
+      {2.0f, 0.5f, 0.0f}, {2.0f, 0.5f, 1.0f}, {3.3f, 0.5f, 0.0f}, {1.0f, 0.2f, 4.0f}};
+  noise_texture_test(params, false);
+}
+
+TEST(svm_noise_batch, color)
+{
+  const NoiseParams params[4] = {
+      {2.0f, 0.5f, 0.5f}, {2.0f, 0.5f, 0.5f}, {5.0f, 0.5f, 0.0f}, {0.5f, 1.0f, 2.0f}};
+  noise_texture_test(params, true);
+}
+
+#endif /* __KERNEL_SSE2__ */
+
+CCL_NAMESPACE_END
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "util/util_mmap.h"
+
+CCL_NAMESPACE_BEGIN
+
+TEST(util_mmap, empty)
+{
+  EXPECT_EQ(util_mmap_temp_file("", 0), (void *)NULL);
+}
+
+TEST(util_mmap, read_write)
+{
+  const size_t num = 1 << 20;
+  uint *data = (uint *)util_mmap_temp_file("", num * sizeof(uint));
+  ASSERT_NE(data, (uint *)NULL);
+
+  for (size_t i = 0; i < num; i++) {
+    data[i] = (uint)(i * 2654435761u);
+  }
+  for (size_t i = 0; i < num; i++) {
+    ASSERT_EQ(data[i], (uint)(i * 2654435761u));
+  }
+
+  util_munmap(data, num * sizeof(uint));
+}
+
+TEST(util_mmap, invalid_directory)
+{
+  EXPECT_EQ(util_mmap_temp_file("/nonexistent/cycles/directory", 1024), (void *)NULL);
+}
+
+CCL_NAMESPACE_END
@@ -398,4 +398,23 @@ TEST(util_path_is_relative, relative_unixdir_on_windows)
 }
 #endif /* _WIN32 */
 
+TEST(util_path_rename, replace_existing)
+{
+  const string from = path_join(testing::TempDir(), "cycles_util_path_test_from.bin");
+  const string to = path_join(testing::TempDir(), "cycles_util_path_test_to.bin");
+  const vector<uint8_t> from_binary(4, 1), to_binary(8, 2);
+  ASSERT_TRUE(path_write_binary(from, from_binary));
+  ASSERT_TRUE(path_write_binary(to, to_binary));
+
+  EXPECT_TRUE(path_rename(from, to));
+  EXPECT_FALSE(path_exists(from));
+
+  vector<uint8_t> binary;
+  ASSERT_TRUE(path_read_binary(to, binary));
+  EXPECT_EQ(binary, from_binary);
+
+  EXPECT_FALSE(path_rename(from, to));
+  path_remove(to);
+}
+
 CCL_NAMESPACE_END
@@ -16,6 +16,8 @@
 
 #include "testing/testing.h"
 
+#include <limits>
+
 #include "util/util_string.h"
 
 CCL_NAMESPACE_BEGIN
@@ -281,4 +283,39 @@ TEST(util_string_remove_trademark, r_space_middle)
   EXPECT_EQ(str, "foo bar baz");
 }
 
+/* ******** Tests for string_json_quote() ******** */
+
+TEST(util_string_json_quote, plain)
+{
+  string str = string_json_quote("foo bar");
+  EXPECT_EQ(str, "\"foo bar\"");
+}
+
+TEST(util_string_json_quote, escape)
+{
+  string str = string_json_quote("a\"b\\c\nd\te");
+  EXPECT_EQ(str, "\"a\\\"b\\\\c\\nd\\te\"");
+}
+
+TEST(util_string_json_quote, control)
+{
+  string str = string_json_quote("a\x01");
+  EXPECT_EQ(str, "\"a\\u0001\"");
+}
+
+/* ******** Tests for string_json_number() ******** */
+
+TEST(util_string_json_number, finite)
+{
+  EXPECT_EQ(string_json_number(1.5), "1.500000");
+  EXPECT_EQ(string_json_number(-2.0), "-2.000000");
+}
+
+TEST(util_string_json_number, non_finite)
+{
+  EXPECT_EQ(string_json_number(std::numeric_limits<double>::quiet_NaN()), "null");
+  EXPECT_EQ(string_json_number(std::numeric_limits<double>::infinity()), "null");
+  EXPECT_EQ(string_json_number(-std::numeric_limits<double>::infinity()), "null");
+}
+
 CCL_NAMESPACE_END
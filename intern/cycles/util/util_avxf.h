@@ -150,6 +150,11 @@ __forceinline const avxf mm256_sqrt(const avxf &a)
   return _mm256_sqrt_ps(a.m256);
 }
 
+__forceinline const avxf abs(const avxf &a)
+{
+  return _mm256_and_ps(a.m256, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Binary Operators
 ////////////////////////////////////////////////////////////////////////////////
@@ -360,6 +365,16 @@ __forceinline const avxf msub(const avxf &a, const avxf &b, const avxf &c)
 ////////////////////////////////////////////////////////////////////////////////
 /// Comparison Operators + Select
 ////////////////////////////////////////////////////////////////////////////////
+__forceinline const avxb operator!=(const avxf &a, const avxf &b)
+{
+  return _mm256_cmp_ps(a.m256, b.m256, _CMP_NEQ_UQ);
+}
+
+__forceinline const avxb operator<(const avxf &a, const avxf &b)
+{
+  return _mm256_cmp_ps(a.m256, b.m256, _CMP_LT_OS);
+}
+
 __forceinline const avxb operator<=(const avxf &a, const avxf &b)
 {
   return _mm256_cmp_ps(a.m256, b.m256, _CMP_LE_OS);
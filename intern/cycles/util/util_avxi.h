@@ -649,6 +649,27 @@ template<size_t i> __forceinline const ssei extract(const avxi &a)
   return _mm256_extractf128_si256(a, i);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Conversion Functions
+////////////////////////////////////////////////////////////////////////////////
+
+__forceinline avxi truncatei(const avxf &a)
+{
+  return _mm256_cvttps_epi32(a.m256);
+}
+
+/* Same as floori(ssef), negative whole numbers are rounded down by one too. */
+__forceinline avxi floori(const avxf &a)
+{
+  return truncatei(a) + avxi(_mm256_castps_si256(a < avxf(0.0f)));
+}
+
+__forceinline avxf floorfrac(const avxf &x, avxi *i)
+{
+  *i = floori(x);
+  return x - avxf(_mm256_cvtepi32_ps(*i));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Reductions
 ////////////////////////////////////////////////////////////////////////////////
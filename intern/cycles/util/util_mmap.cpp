@@ -0,0 +1,171 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util/util_mmap.h"
+#include "util/util_logging.h"
+#include "util/util_path.h"
+
+#include <OpenImageIO/filesystem.h>
+
+#ifdef _WIN32
+#  include "util/util_windows.h"
+#else
+#  include <fcntl.h>
+#  include <stdlib.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#  ifdef __linux__
+#    include <sys/vfs.h>
+#  endif
+#endif
+
+CCL_NAMESPACE_BEGIN
+
+static string mmap_temp_dirpath(const string &dirpath)
+{
+  return (dirpath.empty()) ? OIIO::Filesystem::temp_directory_path() : dirpath;
+}
+
+#ifdef _WIN32
+
+/* Mapping extends the file, allocating its space, and fails if the disk is full. */
+void *util_mmap_temp_file(const string &dirpath, size_t size)
+{
+  if (size == 0) {
+    return NULL;
+  }
+
+  wchar_t filepath[MAX_PATH];
+  if (!GetTempFileNameW(
+          string_to_wstring(mmap_temp_dirpath(dirpath)).c_str(), L"cyc", 0, filepath)) {
+    VLOG(1) << "Failed to create temporary file in " << dirpath;
+    return NULL;
+  }
+
+  /* Deleted when the last handle is closed, the mapping keeps it open. */
+  HANDLE file = CreateFileW(filepath,
+                            GENERIC_READ | GENERIC_WRITE,
+                            0,
+                            NULL,
+                            CREATE_ALWAYS,
+                            FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE,
+                            NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    DeleteFileW(filepath);
+    return NULL;
+  }
+
+  HANDLE mapping = CreateFileMappingW(
+      file, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, NULL);
+  void *ptr = (mapping) ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size) : NULL;
+
+  if (mapping) {
+    CloseHandle(mapping);
+  }
+  CloseHandle(file);
+
+  return ptr;
+}
+
+void util_munmap(void *ptr, size_t /*size*/)
+{
+  if (ptr) {
+    UnmapViewOfFile(ptr);
+  }
+}
+
+bool util_mmap_dir_in_memory(const string & /*dirpath*/)
+{
+  return false;
+}
+
+#else
+
+static bool mmap_reserve_file(int fd, size_t size)
+{
+#  ifdef __APPLE__
+  /* No posix_fallocate on macOS, preallocate and then set the file size. */
+  fstore_t store = {F_ALLOCATEALL, F_PEOFPOSMODE, 0, (off_t)size, 0};
+  if (fcntl(fd, F_PREALLOCATE, &store) == -1) {
+    return false;
+  }
+  return ftruncate(fd, size) == 0;
+#  else
+  return posix_fallocate(fd, 0, size) == 0;
+#  endif
+}
+
+void *util_mmap_temp_file(const string &dirpath, size_t size)
+{
+  if (size == 0) {
+    return NULL;
+  }
+
+  string filepath = path_join(mmap_temp_dirpath(dirpath), "cycles_XXXXXX");
+  const int fd = mkstemp(&filepath[0]);
+  if (fd == -1) {
+    VLOG(1) << "Failed to create temporary file in " << dirpath;
+    return NULL;
+  }
+
+  /* Remove the name right away, the mapping keeps the file alive. */
+  unlink(filepath.c_str());
+
+  /* Reserve the disk space up front. A sparse file would only fail once a page is written
+   * back to a full disk, and then through a bus error instead of a failed allocation. */
+  void *ptr = NULL;
+  if (mmap_reserve_file(fd, size)) {
+    ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+      ptr = NULL;
+    }
+  }
+  else {
+    VLOG(1) << "Failed to reserve " << size << " bytes for temporary file in " << dirpath;
+  }
+
+  close(fd);
+
+  return ptr;
+}
+
+void util_munmap(void *ptr, size_t size)
+{
+  if (ptr) {
+    munmap(ptr, size);
+  }
+}
+
+bool util_mmap_dir_in_memory(const string &dirpath)
+{
+#  ifdef __linux__
+  /* File systems which keep their files in memory. */
+  const long TMPFS_MAGIC_NUMBER = 0x01021994;
+  const long RAMFS_MAGIC_NUMBER = 0x858458f6;
+
+  struct statfs st;
+  if (statfs(mmap_temp_dirpath(dirpath).c_str(), &st) == 0) {
+    return st.f_type == TMPFS_MAGIC_NUMBER || st.f_type == RAMFS_MAGIC_NUMBER;
+  }
+#  else
+  (void)dirpath;
+#  endif
+  return false;
+}
+
+#endif
+
+CCL_NAMESPACE_END
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_MMAP_H__
+#define __UTIL_MMAP_H__
+
+#include "util/util_string.h"
+#include "util/util_types.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Map a new temporary file of size bytes in the given directory into memory,
+ * readable and writable. Unlike anonymous memory, the operating system can
+ * write these pages back to the file and drop them when running low on memory,
+ * and read them back in when they are accessed again. The file is removed from
+ * disk once unmapped, or when the process exits. An empty directory uses the
+ * temporary directory of the system. The disk space is reserved up front.
+ *
+ * Returns NULL if the file could not be created, its space reserved, or mapped. */
+void *util_mmap_temp_file(const string &dirpath, size_t size);
+
+/* Unmap memory returned by util_mmap_temp_file. */
+void util_munmap(void *ptr, size_t size);
+
+/* Files in the directory are kept in memory, as on tmpfs, so mapping them saves no memory.
+ * Only detected on Linux. */
+bool util_mmap_dir_in_memory(const string &dirpath);
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_MMAP_H__ */
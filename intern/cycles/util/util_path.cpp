@@ -739,6 +739,17 @@ bool path_remove(const string &path)
   return remove(path.c_str()) == 0;
 }
 
+bool path_rename(const string &from, const string &to)
+{
+#ifdef _WIN32
+  wstring from_wc = string_to_wstring(from);
+  wstring to_wc = string_to_wstring(to);
+  return MoveFileExW(from_wc.c_str(), to_wc.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  return rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
 struct SourceReplaceState {
   typedef map<string, string> ProcessedMapping;
   /* Base director for all relative include headers. */
@@ -921,6 +932,24 @@ FILE *path_fopen(const string &path, const string &mode)
 #endif
 }
 
+int64_t path_ftell(FILE *f)
+{
+#ifdef _WIN32
+  return _ftelli64(f);
+#else
+  return ftello(f);
+#endif
+}
+
+bool path_fseek(FILE *f, int64_t offset, int origin)
+{
+#ifdef _WIN32
+  return _fseeki64(f, offset, origin) == 0;
+#else
+  return fseeko(f, offset, origin) == 0;
+#endif
+}
+
 void path_cache_clear_except(const string &name, const set<string> &except)
 {
   string dir = path_user_get("cache");
@@ -57,6 +57,10 @@ void path_create_directories(const string &path);
 /* file read/write utilities */
 FILE *path_fopen(const string &path, const string &mode);
 
+/* 64 bit file offsets, for files over 2GB. */
+int64_t path_ftell(FILE *f);
+bool path_fseek(FILE *f, int64_t offset, int origin);
+
 bool path_write_binary(const string &path, const vector<uint8_t> &binary);
 bool path_write_text(const string &path, string &text);
 bool path_read_binary(const string &path, vector<uint8_t> &binary);
@@ -64,6 +68,8 @@ bool path_read_text(const string &path, string &text);
 
 /* File manipulation. */
 bool path_remove(const string &path);
+/* Replace the destination file if it exists, atomically where the file system supports it. */
+bool path_rename(const string &from, const string &to);
 
 /* source code utility */
 string path_source_replace_includes(const string &source,
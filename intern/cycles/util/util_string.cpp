@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <math.h>
 #include <stdarg.h>
 #include <stdio.h>
 
@@ -144,6 +145,50 @@ void string_replace(string &haystack, const string &needle, const string &other)
   }
 }
 
+string string_json_quote(const string &s)
+{
+  string result = "\"";
+  result.reserve(s.size() + 2);
+  for (const char c : s) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\r':
+        result += "\\r";
+        break;
+      case '\t':
+        result += "\\t";
+        break;
+      default:
+        if ((unsigned char)c < 0x20) {
+          result += string_printf("\\u%04x", (unsigned int)c);
+        }
+        else {
+          result += c;
+        }
+        break;
+    }
+  }
+  result += "\"";
+  return result;
+}
+
+string string_json_number(double value)
+{
+  /* JSON has no representation for infinity or NaN. */
+  if (!isfinite(value)) {
+    return "null";
+  }
+  return string_printf("%f", value);
+}
+
 string string_remove_trademark(const string &s)
 {
   string result = s;
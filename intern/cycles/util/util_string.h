@@ -50,6 +50,10 @@ bool string_endswith(const string &s, const string &end);
 string string_strip(const string &s);
 string string_remove_trademark(const string &s);
 string string_from_bool(const bool var);
+/* Quote and escape string for use as a JSON string literal. */
+string string_json_quote(const string &s);
+/* Format number as a JSON number, non-finite values become null. */
+string string_json_number(double value);
 string to_string(const char *str);
 
 /* Wide char strings are only used on Windows to deal with non-ascii
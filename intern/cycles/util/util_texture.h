@@ -105,6 +105,8 @@ typedef struct TextureInfo {
   uint width, height, depth;
   /* Transform for 3D textures. */
   uint use_transform_3d;
+  /* Handle of images loaded on demand by the CPU texture cache, zero otherwise. */
+  uint64_t cache_handle;
   Transform transform_3d;
 } TextureInfo;
 
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util/util_texture_cache.h"
+#include "util/util_logging.h"
+
+#include <OpenImageIO/texture.h>
+
+OIIO_NAMESPACE_USING
+
+CCL_NAMESPACE_BEGIN
+
+TextureCache::TextureCache() : texture_system(NULL), max_memory_mb(4096)
+{
+}
+
+TextureCache::~TextureCache()
+{
+  if (texture_system) {
+    TextureSystem *ts = (TextureSystem *)texture_system;
+    VLOG(1) << "Texture cache statistics:\n" << ts->getstats();
+    ts->invalidate_all(true);
+    TextureSystem::destroy(ts);
+  }
+}
+
+void TextureCache::set_max_memory(const int max_memory_mb_)
+{
+  thread_scoped_lock lock(mutex);
+  max_memory_mb = max_memory_mb_;
+  if (texture_system) {
+    ((TextureSystem *)texture_system)->attribute("max_memory_MB", (float)max_memory_mb);
+  }
+}
+
+void *TextureCache::file_handle(const string &filepath)
+{
+  thread_scoped_lock lock(mutex);
+
+  if (texture_system == NULL) {
+    /* Not shared with OSL, so the memory budget only applies to images used by SVM. */
+    TextureSystem *ts = TextureSystem::create(false);
+    ts->attribute("automip", 1);
+    ts->attribute("autotile", 64);
+    ts->attribute("gray_to_rgb", 1);
+    ts->attribute("max_memory_MB", (float)max_memory_mb);
+    texture_system = ts;
+  }
+
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  const ustring filename(filepath);
+
+  int exists = 0;
+  if (!ts->get_texture_info(filename, 0, ustring("exists"), TypeDesc::TypeInt, &exists) ||
+      !exists) {
+    ts->geterror();
+    return NULL;
+  }
+
+  return ts->get_texture_handle(filename);
+}
+
+void TextureCache::invalidate(const string &filepath)
+{
+  thread_scoped_lock lock(mutex);
+  if (texture_system) {
+    ((TextureSystem *)texture_system)->invalidate(ustring(filepath));
+  }
+}
+
+void *TextureCache::thread_info()
+{
+  thread_scoped_lock lock(mutex);
+  if (texture_system == NULL) {
+    return NULL;
+  }
+  return ((TextureSystem *)texture_system)->get_perthread_info();
+}
+
+float4 TextureCache::lookup(void *thread_info,
+                            const TextureInfo &info,
+                            float x,
+                            float y,
+                            float2 dx,
+                            float2 dy) const
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  TextureOpt options;
+
+  switch (info.interpolation) {
+    case INTERPOLATION_CLOSEST:
+      options.interpmode = TextureOpt::InterpClosest;
+      options.mipmode = TextureOpt::MipModeNoMIP;
+      break;
+    case INTERPOLATION_CUBIC:
+      options.interpmode = TextureOpt::InterpBicubic;
+      break;
+    case INTERPOLATION_SMART:
+      options.interpmode = TextureOpt::InterpSmartBicubic;
+      break;
+    default:
+      options.interpmode = TextureOpt::InterpBilinear;
+      break;
+  }
+
+  switch (info.extension) {
+    case EXTENSION_REPEAT:
+      options.swrap = options.twrap = TextureOpt::WrapPeriodic;
+      break;
+    case EXTENSION_EXTEND:
+      options.swrap = options.twrap = TextureOpt::WrapClamp;
+      break;
+    default:
+      options.swrap = options.twrap = TextureOpt::WrapBlack;
+      break;
+  }
+
+  /* Alpha of images without alpha channel. */
+  options.fill = 1.0f;
+
+  /* OpenImageIO has the first row at the top of the image. */
+  float result[4];
+  if (!ts->texture((TextureSystem::TextureHandle *)info.cache_handle,
+                   (TextureSystem::Perthread *)thread_info,
+                   options,
+                   x,
+                   1.0f - y,
+                   dx.x,
+                   -dx.y,
+                   dy.x,
+                   -dy.y,
+                   4,
+                   result)) {
+    ts->geterror();
+    return make_float4(
+        TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
+  }
+
+  return make_float4(result[0], result[1], result[2], result[3]);
+}
+
+CCL_NAMESPACE_END
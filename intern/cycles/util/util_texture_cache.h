@@ -0,0 +1,71 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_TEXTURE_CACHE_H__
+#define __UTIL_TEXTURE_CACHE_H__
+
+#include "util/util_string.h"
+#include "util/util_texture.h"
+#include "util/util_thread.h"
+#include "util/util_types.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Texture Cache
+ *
+ * Image textures for CPU rendering that are read from files on demand, instead of loading
+ * them completely before rendering. Files are accessed tile by tile and mipmapped, only the
+ * tiles that are actually sampled are kept in memory, up to a memory budget after which the
+ * least recently used tiles are evicted.
+ *
+ * Built on the OpenImageIO texture system, the same that is used for OSL. Tiled and mipmapped
+ * files (.tx) work best, other files get tiles and mip levels generated when they are read. */
+class TextureCache {
+ public:
+  TextureCache();
+  ~TextureCache();
+
+  /* Memory budget in megabytes. */
+  void set_max_memory(const int max_memory_mb);
+
+  /* Opaque handle for an image file to store in TextureInfo, or NULL if it can't be read. */
+  void *file_handle(const string &filepath);
+  /* Drop cached tiles of the file, so it's read again when the file was modified. */
+  void invalidate(const string &filepath);
+
+  /* Per-thread data for lookups from the calling thread. */
+  void *thread_info();
+
+  /* Filtered lookup, with the derivatives of the texture coordinates with respect to screen
+   * space x and y to pick the mip level. Coordinates follow the Cycles convention of the first
+   * row being the bottom of the image. */
+  float4 lookup(void *thread_info,
+                const TextureInfo &info,
+                float x,
+                float y,
+                float2 dx,
+                float2 dy) const;
+
+ protected:
+  /* OIIO::TextureSystem, created on first use. */
+  void *texture_system;
+  int max_memory_mb;
+  thread_mutex mutex;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_TEXTURE_CACHE_H__ */
@@ -32,6 +32,7 @@ extern "C" {
 #endif
 
 struct Mesh;
+struct MeshRemeshVoxelCache;
 
 /* OpenVDB Voxel Remesher */
 #ifdef WITH_OPENVDB
@@ -43,11 +44,18 @@ struct Mesh *BKE_mesh_remesh_voxel_ovdb_volume_to_mesh_nomain(struct OpenVDBLeve
                                                               bool relax_disoriented_triangles);
 #endif
 
+void BKE_mesh_remesh_voxel_cache_free(struct MeshRemeshVoxelCache *cache);
+
 struct Mesh *BKE_mesh_remesh_voxel_fix_poles(struct Mesh *mesh);
 struct Mesh *BKE_mesh_remesh_voxel_to_mesh_nomain(struct Mesh *mesh,
                                                   float voxel_size,
                                                   float adaptivity,
                                                   float isovalue);
+struct Mesh *BKE_mesh_remesh_voxel_to_mesh_nomain_ex(struct Mesh *mesh,
+                                                     float voxel_size,
+                                                     float adaptivity,
+                                                     float isovalue,
+                                                     struct MeshRemeshVoxelCache **cache_p);
 struct Mesh *BKE_mesh_remesh_quadriflow_to_mesh_nomain(struct Mesh *mesh,
                                                        int target_faces,
                                                        int seed,
@@ -213,6 +213,16 @@ typedef struct MeshCalcNormalsData {
   float (*pnors)[3];
   float (*lnors_weighted)[3];
   float (*vnors)[3];
+
+  /**
+   * Vertex to loop map, loops of vertex `v` are stored in
+   * `vert_loops[vert_loop_offsets[v]]` to `vert_loops[vert_loop_offsets[v + 1] - 1]`.
+   * Filled from multiple threads, only the counts/offsets use (integer) atomics.
+   */
+  int *vert_loop_offsets;
+  int *vert_loops;
+  /** Next free slot of each vertex in #vert_loops, while filling it. */
+  int *vert_loop_fill;
 } MeshCalcNormalsData;
 
 static void mesh_calc_normals_poly_cb(void *__restrict userdata,
@@ -225,6 +235,10 @@ static void mesh_calc_normals_poly_cb(void *__restrict userdata,
   BKE_mesh_calc_poly_normal(mp, data->mloop + mp->loopstart, data->mverts, data->pnors[pidx]);
 }
 
+/* Triangles and quads are by far the most common case,
+ * use a fixed size buffer for them instead of stack allocation. */
+#define MESH_CALC_NORMALS_EDGEVEC_STACK 4
+
 static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
                                               const int pidx,
                                               const TaskParallelTLS *__restrict UNUSED(tls))
@@ -239,7 +253,10 @@ static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
   float(*lnors_weighted)[3] = data->lnors_weighted;
 
   const int nverts = mp->totloop;
-  float(*edgevecbuf)[3] = BLI_array_alloca(edgevecbuf, (size_t)nverts);
+  float edgevecbuf_stack[MESH_CALC_NORMALS_EDGEVEC_STACK][3];
+  float(*edgevecbuf)[3] = (nverts <= MESH_CALC_NORMALS_EDGEVEC_STACK) ?
+                              edgevecbuf_stack :
+                              BLI_array_alloca(edgevecbuf, (size_t)nverts);
 
   /* Polygon Normal and edge-vector */
   /* inline version of #BKE_mesh_calc_poly_normal, also does edge-vectors */
@@ -268,9 +285,10 @@ static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
 
   /* accumulate angle weighted face normal */
   /* inline version of #accumulate_vertex_normals_poly_v3,
-   * split between this threaded callback and #mesh_calc_normals_poly_accum_cb. */
+   * split between this threaded callback and #mesh_calc_normals_poly_finalize_cb. */
   {
     const float *prev_edge = edgevecbuf[nverts - 1];
+    int *vert_loop_fill = data->vert_loop_fill;
 
     for (int i = 0; i < nverts; i++) {
       const int lidx = mp->loopstart + i;
@@ -283,11 +301,34 @@ static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
       /* Store for later accumulation */
       mul_v3_v3fl(lnors_weighted[lidx], pnor, fac);
 
+      /* Count loops of each vertex, to build the vertex to loop map. */
+      if (vert_loop_fill) {
+        atomic_add_and_fetch_int32(&vert_loop_fill[ml[i].v], 1);
+      }
+
       prev_edge = cur_edge;
     }
   }
 }
 
+#undef MESH_CALC_NORMALS_EDGEVEC_STACK
+
+static void mesh_calc_normals_poly_vert_loops_cb(void *__restrict userdata,
+                                                 const int pidx,
+                                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshCalcNormalsData *data = userdata;
+  const MPoly *mp = &data->mpolys[pidx];
+  const MLoop *ml = &data->mloop[mp->loopstart];
+  int *vert_loop_fill = data->vert_loop_fill;
+  int *vert_loops = data->vert_loops;
+
+  for (int i = 0; i < mp->totloop; i++) {
+    const int slot = atomic_fetch_and_add_int32(&vert_loop_fill[ml[i].v], 1);
+    vert_loops[slot] = mp->loopstart + i;
+  }
+}
+
 static void mesh_calc_normals_poly_finalize_cb(void *__restrict userdata,
                                                const int vidx,
                                                const TaskParallelTLS *__restrict UNUSED(tls))
@@ -297,6 +338,30 @@ static void mesh_calc_normals_poly_finalize_cb(void *__restrict userdata,
   MVert *mv = &data->mverts[vidx];
   float *no = data->vnors[vidx];
 
+  /* Accumulate weighted loop normals into the vertex one.
+   * Loops are sorted first, so the result doesn't depend on the order the map was filled in
+   * (and matches a plain loop over all loops). */
+  if (data->vert_loops) {
+    const float(*lnors_weighted)[3] = (const float(*)[3])data->lnors_weighted;
+    int *vloops = &data->vert_loops[data->vert_loop_offsets[vidx]];
+    const int vloops_len = data->vert_loop_offsets[vidx + 1] - data->vert_loop_offsets[vidx];
+
+    /* Insertion sort, vertices rarely use more than a handful of loops. */
+    for (int i = 1; i < vloops_len; i++) {
+      const int lidx = vloops[i];
+      int j = i;
+      for (; (j > 0) && (vloops[j - 1] > lidx); j--) {
+        vloops[j] = vloops[j - 1];
+      }
+      vloops[j] = lidx;
+    }
+
+    zero_v3(no);
+    for (int i = 0; i < vloops_len; i++) {
+      add_v3_v3(no, lnors_weighted[vloops[i]]);
+    }
+  }
+
   if (UNLIKELY(normalize_v3(no) == 0.0f)) {
     /* following Mesh convention; we use vertex coordinate itself for normal in this case */
     normalize_v3_v3(no, mv->co);
@@ -341,15 +406,32 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
       (size_t)numLoops, sizeof(*lnors_weighted), __func__);
   bool free_vnors = false;
 
+  /* Accumulating into vertices from multiple threads would need atomics on floats
+   * (and would not be deterministic), so build a vertex to loop map instead,
+   * each vertex then sums its own loops.
+   * Building the map costs more than a plain single threaded accumulation though,
+   * only worth it when there are enough threads and polygons to share the work. */
+  const bool use_vert_loop_map = (BLI_task_scheduler_num_threads() > 1) &&
+                                 (numPolys > settings.min_iter_per_thread * 4);
+  int *vert_loop_offsets = NULL;
+  int *vert_loop_fill = NULL;
+  int *vert_loops = NULL;
+
   /* first go through and calculate normals for all the polys */
   if (vnors == NULL) {
     vnors = MEM_calloc_arrayN((size_t)numVerts, sizeof(*vnors), __func__);
     free_vnors = true;
   }
-  else {
+  else if (!use_vert_loop_map) {
     memset(vnors, 0, sizeof(*vnors) * (size_t)numVerts);
   }
 
+  if (use_vert_loop_map) {
+    vert_loop_offsets = MEM_malloc_arrayN((size_t)numVerts + 1, sizeof(int), __func__);
+    vert_loop_fill = MEM_calloc_arrayN((size_t)numVerts, sizeof(int), __func__);
+    vert_loops = MEM_malloc_arrayN((size_t)numLoops, sizeof(int), __func__);
+  }
+
   MeshCalcNormalsData data = {
       .mpolys = mpolys,
       .mloop = mloop,
@@ -357,26 +439,47 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
       .pnors = pnors,
       .lnors_weighted = lnors_weighted,
       .vnors = vnors,
+      .vert_loop_offsets = vert_loop_offsets,
+      .vert_loops = vert_loops,
+      .vert_loop_fill = vert_loop_fill,
   };
 
-  /* Compute poly normals, and prepare weighted loop normals. */
+  /* Compute poly normals, and prepare weighted loop normals (also counts loops per vertex). */
   BLI_task_parallel_range(0, numPolys, &data, mesh_calc_normals_poly_prepare_cb, &settings);
 
-  /* Actually accumulate weighted loop normals into vertex ones. */
-  /* Unfortunately, not possible to thread that
-   * (not in a reasonable, totally lock- and barrier-free fashion),
-   * since several loops will point to the same vertex... */
-  for (int lidx = 0; lidx < numLoops; lidx++) {
-    add_v3_v3(vnors[mloop[lidx].v], data.lnors_weighted[lidx]);
+  if (use_vert_loop_map) {
+    int offset = 0;
+    for (int vidx = 0; vidx < numVerts; vidx++) {
+      const int count = vert_loop_fill[vidx];
+      vert_loop_offsets[vidx] = offset;
+      vert_loop_fill[vidx] = offset;
+      offset += count;
+    }
+    vert_loop_offsets[numVerts] = offset;
+    BLI_assert(offset <= numLoops);
+
+    BLI_task_parallel_range(0, numPolys, &data, mesh_calc_normals_poly_vert_loops_cb, &settings);
+  }
+  else {
+    /* Actually accumulate weighted loop normals into vertex ones. */
+    for (int lidx = 0; lidx < numLoops; lidx++) {
+      add_v3_v3(vnors[mloop[lidx].v], data.lnors_weighted[lidx]);
+    }
   }
 
-  /* Normalize and validate computed vertex normals. */
+  /* Normalize and validate computed vertex normals
+   * (also accumulates them when using the vertex to loop map). */
   BLI_task_parallel_range(0, numVerts, &data, mesh_calc_normals_poly_finalize_cb, &settings);
 
   if (free_vnors) {
     MEM_freeN(vnors);
   }
   MEM_freeN(lnors_weighted);
+  if (use_vert_loop_map) {
+    MEM_freeN(vert_loop_offsets);
+    MEM_freeN(vert_loop_fill);
+    MEM_freeN(vert_loops);
+  }
 }
 
 void BKE_mesh_ensure_normals(Mesh *mesh)
@@ -820,12 +923,35 @@ typedef struct LoopSplitTaskDataCommon {
 /* See comment about edge_to_loops below. */
 #define IS_EDGE_SHARP(_e2l) (ELEM((_e2l)[1], INDEX_UNSET, INDEX_INVALID))
 
+static void mesh_loops_prepare_cb(void *__restrict userdata,
+                                  const int mp_index,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *data = userdata;
+  const MVert *mverts = data->mverts;
+  const MLoop *mloops = data->mloops;
+  const MPoly *mp = &data->mpolys[mp_index];
+  float(*loopnors)[3] = data->loopnors; /* Note: loopnors may be NULL here. */
+  int *loop_to_poly = data->loop_to_poly;
+
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  for (int ml_index = mp->loopstart; ml_index <= ml_last_index; ml_index++) {
+    loop_to_poly[ml_index] = mp_index;
+
+    /* Pre-populate all loop normals as if their verts were all-smooth,
+     * this way we don't have to compute those later!
+     */
+    if (loopnors) {
+      normal_short_to_float_v3(loopnors[ml_index], mverts[mloops[ml_index].v].no);
+    }
+  }
+}
+
 static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
                                  const bool check_angle,
                                  const float split_angle,
                                  const bool do_sharp_edges_tag)
 {
-  const MVert *mverts = data->mverts;
   const MEdge *medges = data->medges;
   const MLoop *mloops = data->mloops;
 
@@ -834,7 +960,6 @@ static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
   const int numEdges = data->numEdges;
   const int numPolys = data->numPolys;
 
-  float(*loopnors)[3] = data->loopnors; /* Note: loopnors may be NULL here. */
   const float(*polynors)[3] = data->polynors;
 
   int(*edge_to_loops)[2] = data->edge_to_loops;
@@ -847,6 +972,15 @@ static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
 
   const float split_angle_cos = check_angle ? cosf(split_angle) : -1.0f;
 
+  /* Loop to poly mapping and default loop normals don't depend on other polys,
+   * fill them in parallel, only the edge to loops mapping has to be built sequentially. */
+  {
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1024;
+    BLI_task_parallel_range(0, numPolys, data, mesh_loops_prepare_cb, &settings);
+  }
+
   for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
     const MLoop *ml_curr;
     int *e2l;
@@ -858,15 +992,6 @@ static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
     for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++) {
       e2l = edge_to_loops[ml_curr->e];
 
-      loop_to_poly[ml_curr_index] = mp_index;
-
-      /* Pre-populate all loop normals as if their verts were all-smooth,
-       * this way we don't have to compute those later!
-       */
-      if (loopnors) {
-        normal_short_to_float_v3(loopnors[ml_curr_index], mverts[ml_curr->v].no);
-      }
-
       /* Check whether current edge might be smooth or sharp */
       if ((e2l[0] | e2l[1]) == 0) {
         /* 'Empty' edge until now, set e2l[0] (and e2l[1] to INDEX_UNSET to tag it as unset). */
@@ -1596,6 +1721,32 @@ static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common
 #endif
 }
 
+static void mesh_normals_loop_nosplit_cb(void *__restrict userdata,
+                                         const int mp_index,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *data = userdata;
+  const MPoly *mp = &data->mpolys[mp_index];
+  int *loop_to_poly = data->loop_to_poly; /* Note: loop_to_poly may be NULL here. */
+  float(*loopnors)[3] = data->loopnors;
+
+  int ml_index = mp->loopstart;
+  const int ml_index_end = ml_index + mp->totloop;
+  const bool is_poly_flat = ((mp->flag & ME_SMOOTH) == 0);
+
+  for (; ml_index < ml_index_end; ml_index++) {
+    if (loop_to_poly) {
+      loop_to_poly[ml_index] = mp_index;
+    }
+    if (is_poly_flat) {
+      copy_v3_v3(loopnors[ml_index], data->polynors[mp_index]);
+    }
+    else {
+      normal_short_to_float_v3(loopnors[ml_index], data->mverts[data->mloops[ml_index].v].no);
+    }
+  }
+}
+
 /**
  * Compute split normals, i.e. vertex normals associated with each poly (hence 'loop normals').
  * Useful to materialize sharp edges (or non-smooth faces) without actually modifying the geometry
@@ -1629,26 +1780,21 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
      * As usual, we could handle that on case-by-case basis,
      * but simpler to keep it well confined here.
      */
-    int mp_index;
-
-    for (mp_index = 0; mp_index < numPolys; mp_index++) {
-      MPoly *mp = &mpolys[mp_index];
-      int ml_index = mp->loopstart;
-      const int ml_index_end = ml_index + mp->totloop;
-      const bool is_poly_flat = ((mp->flag & ME_SMOOTH) == 0);
+    LoopSplitTaskDataCommon common_data = {
+        .loopnors = r_loopnors,
+        .mverts = mverts,
+        .mloops = mloops,
+        .mpolys = mpolys,
+        .loop_to_poly = r_loop_to_poly,
+        .polynors = polynors,
+        .numLoops = numLoops,
+        .numPolys = numPolys,
+    };
 
-      for (; ml_index < ml_index_end; ml_index++) {
-        if (r_loop_to_poly) {
-          r_loop_to_poly[ml_index] = mp_index;
-        }
-        if (is_poly_flat) {
-          copy_v3_v3(r_loopnors[ml_index], polynors[mp_index]);
-        }
-        else {
-          normal_short_to_float_v3(r_loopnors[ml_index], mverts[mloops[ml_index].v].no);
-        }
-      }
-    }
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1024;
+    BLI_task_parallel_range(0, numPolys, &common_data, mesh_normals_loop_nosplit_cb, &settings);
     return;
   }
 
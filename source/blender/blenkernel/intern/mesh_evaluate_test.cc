@@ -0,0 +1,147 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "BKE_mesh.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "mesh_evaluate_test_utils.hh"
+
+namespace blender::bke::tests {
+
+/** Straightforward single threaded angle weighted vertex normals, for reference. */
+static void test_mesh_normals_reference(const MeshNormalsTestContext *ctx, float (*r_vnors)[3])
+{
+  memset(r_vnors, 0, sizeof(float[3]) * ctx->verts_num);
+  for (int i = 0; i < ctx->polys_num; i++) {
+    const MPoly *mp = &ctx->mpolys[i];
+    const MLoop *ml = &ctx->mloops[mp->loopstart];
+    float pnor[3];
+    BKE_mesh_calc_poly_normal(mp, ml, ctx->mverts, pnor);
+    for (int j = 0; j < mp->totloop; j++) {
+      const float *co_prev = ctx->mverts[ml[(j + mp->totloop - 1) % mp->totloop].v].co;
+      const float *co_curr = ctx->mverts[ml[j].v].co;
+      const float *co_next = ctx->mverts[ml[(j + 1) % mp->totloop].v].co;
+      const float fac = angle_v3v3v3(co_prev, co_curr, co_next);
+      madd_v3_v3fl(r_vnors[ml[j].v], pnor, fac);
+    }
+  }
+  for (int i = 0; i < ctx->verts_num; i++) {
+    normalize_v3(r_vnors[i]);
+  }
+}
+
+TEST(mesh_normals, vertex_normals)
+{
+  MeshNormalsTestContext ctx;
+  test_mesh_normals_init(&ctx, 33);
+
+  float(*vnors)[3] = (float(*)[3])MEM_malloc_arrayN(ctx.verts_num, sizeof(float[3]), __func__);
+  float(*vnors_ref)[3] = (float(*)[3])MEM_malloc_arrayN(
+      ctx.verts_num, sizeof(float[3]), __func__);
+  float(*pnors)[3] = (float(*)[3])MEM_malloc_arrayN(ctx.polys_num, sizeof(float[3]), __func__);
+
+  BKE_mesh_calc_normals_poly(ctx.mverts,
+                             vnors,
+                             ctx.verts_num,
+                             ctx.mloops,
+                             ctx.mpolys,
+                             ctx.loops_num,
+                             ctx.polys_num,
+                             pnors,
+                             false);
+  test_mesh_normals_reference(&ctx, vnors_ref);
+
+  for (int i = 0; i < ctx.verts_num; i++) {
+    EXPECT_V3_NEAR(vnors[i], vnors_ref[i], 1e-5f);
+  }
+  for (int i = 0; i < ctx.polys_num; i++) {
+    float pnor_ref[3];
+    BKE_mesh_calc_poly_normal(
+        &ctx.mpolys[i], &ctx.mloops[ctx.mpolys[i].loopstart], ctx.mverts, pnor_ref);
+    EXPECT_V3_NEAR(pnors[i], pnor_ref, 1e-5f);
+  }
+
+  MEM_freeN(vnors);
+  MEM_freeN(vnors_ref);
+  MEM_freeN(pnors);
+  test_mesh_normals_free(&ctx);
+}
+
+/**
+ * Vertex normals of a mesh large enough for the threaded vertex to loop map, computed with a
+ * single thread and with all threads. The result must be bit-identical, and the same on every
+ * run.
+ */
+TEST(mesh_normals, vertex_normals_threaded)
+{
+  MeshNormalsTestContext ctx;
+  test_mesh_normals_init(&ctx, 128);
+  /* More than four times the minimum number of polygons per thread. */
+  ASSERT_GT(ctx.polys_num, 4 * 1024);
+
+  const size_t vnors_size = sizeof(float[3]) * ctx.verts_num;
+  float(*vnors)[3] = (float(*)[3])MEM_malloc_arrayN(ctx.verts_num, sizeof(float[3]), __func__);
+  float(*vnors_serial)[3] = (float(*)[3])MEM_malloc_arrayN(
+      ctx.verts_num, sizeof(float[3]), __func__);
+  MVert *mverts_serial = (MVert *)MEM_malloc_arrayN(ctx.verts_num, sizeof(MVert), __func__);
+
+  auto calc_normals = [&](float(*r_vnors)[3]) {
+    BKE_mesh_calc_normals_poly(ctx.mverts,
+                               r_vnors,
+                               ctx.verts_num,
+                               ctx.mloops,
+                               ctx.mpolys,
+                               ctx.loops_num,
+                               ctx.polys_num,
+                               nullptr,
+                               false);
+  };
+
+  /* Plain single threaded accumulation. */
+  BLI_system_num_threads_override_set(1);
+  BLI_task_scheduler_init();
+  ASSERT_EQ(BLI_task_scheduler_num_threads(), 1);
+  calc_normals(vnors_serial);
+  memcpy(mverts_serial, ctx.mverts, sizeof(MVert) * ctx.verts_num);
+  BLI_task_scheduler_exit();
+  BLI_system_num_threads_override_set(0);
+
+  BLI_task_scheduler_init();
+  for (int run = 0; run < 4; run++) {
+    memset(vnors, 0, vnors_size);
+    calc_normals(vnors);
+    EXPECT_EQ(memcmp(vnors, vnors_serial, vnors_size), 0);
+    EXPECT_EQ(memcmp(ctx.mverts, mverts_serial, sizeof(MVert) * ctx.verts_num), 0);
+  }
+  BLI_task_scheduler_exit();
+
+  MEM_freeN(vnors);
+  MEM_freeN(vnors_serial);
+  MEM_freeN(mverts_serial);
+  test_mesh_normals_free(&ctx);
+}
+
+}  // namespace blender::bke::tests
@@ -0,0 +1,156 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Synthetic meshes for the mesh normal tests and benchmarks.
+ */
+
+#include <math.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_meshdata_types.h"
+
+#include "BLI_utildefines.h"
+
+namespace blender::bke::tests {
+
+struct MeshNormalsTestContext {
+  MVert *mverts;
+  MEdge *medges;
+  MLoop *mloops;
+  MPoly *mpolys;
+  int verts_num;
+  int edges_num;
+  int loops_num;
+  int polys_num;
+};
+
+/**
+ * Create a wavy grid of `size` by `size` quads (with shared edges), so all vertices have
+ * different normals. Every other row of quads is split in two triangles and flat shaded.
+ */
+inline void test_mesh_normals_init(MeshNormalsTestContext *ctx, const int size)
+{
+  const int verts_side = size + 1;
+  ctx->verts_num = verts_side * verts_side;
+  ctx->edges_num = 2 * size * verts_side;
+  ctx->polys_num = 0;
+  ctx->loops_num = 0;
+  for (int y = 0; y < size; y++) {
+    ctx->polys_num += (y % 2) ? 2 * size : size;
+    ctx->loops_num += (y % 2) ? 6 * size : 4 * size;
+    ctx->edges_num += (y % 2) ? size : 0;
+  }
+
+  ctx->mverts = (MVert *)MEM_calloc_arrayN(ctx->verts_num, sizeof(MVert), __func__);
+  ctx->medges = (MEdge *)MEM_calloc_arrayN(ctx->edges_num, sizeof(MEdge), __func__);
+  ctx->mloops = (MLoop *)MEM_calloc_arrayN(ctx->loops_num, sizeof(MLoop), __func__);
+  ctx->mpolys = (MPoly *)MEM_calloc_arrayN(ctx->polys_num, sizeof(MPoly), __func__);
+
+  for (int y = 0; y < verts_side; y++) {
+    for (int x = 0; x < verts_side; x++) {
+      MVert *mv = &ctx->mverts[y * verts_side + x];
+      mv->co[0] = (float)x;
+      mv->co[1] = (float)y;
+      mv->co[2] = sinf((float)x * 0.3f) * cosf((float)y * 0.2f);
+    }
+  }
+
+  /* Horizontal edges, then vertical ones, then diagonals of triangulated rows. */
+  int edge_index = 0;
+  auto edge_add = [&](const int v1, const int v2) {
+    ctx->medges[edge_index].v1 = v1;
+    ctx->medges[edge_index].v2 = v2;
+    return edge_index++;
+  };
+  auto edge_horizontal = [&](const int x, const int y) { return y * size + x; };
+  auto edge_vertical = [&](const int x, const int y) {
+    return verts_side * size + x * size + y;
+  };
+  for (int y = 0; y < verts_side; y++) {
+    for (int x = 0; x < size; x++) {
+      edge_add(y * verts_side + x, y * verts_side + x + 1);
+    }
+  }
+  for (int x = 0; x < verts_side; x++) {
+    for (int y = 0; y < size; y++) {
+      edge_add(y * verts_side + x, (y + 1) * verts_side + x);
+    }
+  }
+
+  int loop_index = 0;
+  int poly_index = 0;
+  auto loop_add = [&](const int v, const int e) {
+    ctx->mloops[loop_index].v = v;
+    ctx->mloops[loop_index].e = e;
+    loop_index++;
+  };
+  auto poly_begin = [&](const char flag) {
+    MPoly *mp = &ctx->mpolys[poly_index++];
+    mp->loopstart = loop_index;
+    mp->flag = flag;
+    return mp;
+  };
+
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int v00 = y * verts_side + x;
+      const int v10 = v00 + 1;
+      const int v01 = v00 + verts_side;
+      const int v11 = v01 + 1;
+      if (y % 2) {
+        const int e_diag = edge_add(v00, v11);
+        MPoly *mp = poly_begin(0);
+        loop_add(v00, edge_horizontal(x, y));
+        loop_add(v10, edge_vertical(x + 1, y));
+        loop_add(v11, e_diag);
+        mp->totloop = 3;
+        mp = poly_begin(0);
+        loop_add(v00, e_diag);
+        loop_add(v11, edge_horizontal(x, y + 1));
+        loop_add(v01, edge_vertical(x, y));
+        mp->totloop = 3;
+      }
+      else {
+        MPoly *mp = poly_begin(ME_SMOOTH);
+        loop_add(v00, edge_horizontal(x, y));
+        loop_add(v10, edge_vertical(x + 1, y));
+        loop_add(v11, edge_horizontal(x, y + 1));
+        loop_add(v01, edge_vertical(x, y));
+        mp->totloop = 4;
+      }
+    }
+  }
+  BLI_assert(edge_index == ctx->edges_num);
+  BLI_assert(loop_index == ctx->loops_num);
+  BLI_assert(poly_index == ctx->polys_num);
+}
+
+inline void test_mesh_normals_free(MeshNormalsTestContext *ctx)
+{
+  MEM_freeN(ctx->mverts);
+  MEM_freeN(ctx->medges);
+  MEM_freeN(ctx->mloops);
+  MEM_freeN(ctx->mpolys);
+}
+
+}  // namespace blender::bke::tests
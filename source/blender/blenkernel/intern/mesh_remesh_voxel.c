@@ -32,6 +32,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_mesh_types.h"
@@ -57,6 +58,32 @@
 #endif
 
 #ifdef WITH_OPENVDB
+typedef struct RemeshVoxelInputData {
+  const MVert *mvert;
+  const MVertTri *verttri;
+  float *verts;
+  unsigned int *faces;
+} RemeshVoxelInputData;
+
+static void remesh_voxel_input_verts_cb(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const RemeshVoxelInputData *data = userdata;
+  copy_v3_v3(&data->verts[i * 3], data->mvert[i].co);
+}
+
+static void remesh_voxel_input_faces_cb(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const RemeshVoxelInputData *data = userdata;
+  const MVertTri *vt = &data->verttri[i];
+  data->faces[i * 3] = vt->tri[0];
+  data->faces[i * 3 + 1] = vt->tri[1];
+  data->faces[i * 3 + 2] = vt->tri[2];
+}
+
 struct OpenVDBLevelSet *BKE_mesh_remesh_voxel_ovdb_mesh_to_level_set_create(
     Mesh *mesh, struct OpenVDBTransform *transform)
 {
@@ -73,19 +100,17 @@ struct OpenVDBLevelSet *BKE_mesh_remesh_voxel_ovdb_mesh_to_level_set_create(
   unsigned int *faces = (unsigned int *)MEM_malloc_arrayN(
       totfaces * 3, sizeof(unsigned int), "remesh_intput_faces");
 
-  for (unsigned int i = 0; i < totverts; i++) {
-    MVert *mvert = &mesh->mvert[i];
-    verts[i * 3] = mvert->co[0];
-    verts[i * 3 + 1] = mvert->co[1];
-    verts[i * 3 + 2] = mvert->co[2];
-  }
-
-  for (unsigned int i = 0; i < totfaces; i++) {
-    MVertTri *vt = &verttri[i];
-    faces[i * 3] = vt->tri[0];
-    faces[i * 3 + 1] = vt->tri[1];
-    faces[i * 3 + 2] = vt->tri[2];
-  }
+  RemeshVoxelInputData data = {
+      .mvert = mesh->mvert,
+      .verttri = verttri,
+      .verts = verts,
+      .faces = faces,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 4096;
+  BLI_task_parallel_range(0, (int)totverts, &data, remesh_voxel_input_verts_cb, &settings);
+  BLI_task_parallel_range(0, (int)totfaces, &data, remesh_voxel_input_faces_cb, &settings);
 
   struct OpenVDBLevelSet *level_set = OpenVDBLevelSet_create(false, NULL);
   OpenVDBLevelSet_mesh_to_level_set(level_set, verts, faces, totverts, totfaces, transform);
@@ -97,6 +122,52 @@ struct OpenVDBLevelSet *BKE_mesh_remesh_voxel_ovdb_mesh_to_level_set_create(
   return level_set;
 }
 
+typedef struct RemeshVoxelOutputData {
+  const struct OpenVDBVolumeToMeshData *output_mesh;
+  MVert *mvert;
+  MLoop *mloop;
+  MPoly *mpoly;
+} RemeshVoxelOutputData;
+
+static void remesh_voxel_output_verts_cb(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const RemeshVoxelOutputData *data = userdata;
+  copy_v3_v3(data->mvert[i].co, &data->output_mesh->vertices[i * 3]);
+}
+
+/** Quads come first, followed by triangles. */
+static void remesh_voxel_output_polys_cb(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const RemeshVoxelOutputData *data = userdata;
+  const struct OpenVDBVolumeToMeshData *output_mesh = data->output_mesh;
+  MPoly *mp = &data->mpoly[i];
+
+  if (i < output_mesh->totquads) {
+    mp->loopstart = i * 4;
+    mp->totloop = 4;
+
+    MLoop *ml = &data->mloop[mp->loopstart];
+    ml[0].v = output_mesh->quads[i * 4 + 3];
+    ml[1].v = output_mesh->quads[i * 4 + 2];
+    ml[2].v = output_mesh->quads[i * 4 + 1];
+    ml[3].v = output_mesh->quads[i * 4];
+  }
+  else {
+    const int tri = i - output_mesh->totquads;
+    mp->loopstart = (output_mesh->totquads * 4) + (tri * 3);
+    mp->totloop = 3;
+
+    MLoop *ml = &data->mloop[mp->loopstart];
+    ml[0].v = output_mesh->triangles[tri * 3 + 2];
+    ml[1].v = output_mesh->triangles[tri * 3 + 1];
+    ml[2].v = output_mesh->triangles[tri * 3];
+  }
+}
+
 Mesh *BKE_mesh_remesh_voxel_ovdb_volume_to_mesh_nomain(struct OpenVDBLevelSet *level_set,
                                                        double isovalue,
                                                        double adaptivity,
@@ -112,30 +183,22 @@ Mesh *BKE_mesh_remesh_voxel_ovdb_volume_to_mesh_nomain(struct OpenVDBLevelSet *l
                                    (output_mesh.totquads * 4) + (output_mesh.tottriangles * 3),
                                    output_mesh.totquads + output_mesh.tottriangles);
 
-  for (int i = 0; i < output_mesh.totvertices; i++) {
-    copy_v3_v3(mesh->mvert[i].co, &output_mesh.vertices[i * 3]);
-  }
-
-  MPoly *mp = mesh->mpoly;
-  MLoop *ml = mesh->mloop;
-  for (int i = 0; i < output_mesh.totquads; i++, mp++, ml += 4) {
-    mp->loopstart = (int)(ml - mesh->mloop);
-    mp->totloop = 4;
-
-    ml[0].v = output_mesh.quads[i * 4 + 3];
-    ml[1].v = output_mesh.quads[i * 4 + 2];
-    ml[2].v = output_mesh.quads[i * 4 + 1];
-    ml[3].v = output_mesh.quads[i * 4];
-  }
-
-  for (int i = 0; i < output_mesh.tottriangles; i++, mp++, ml += 3) {
-    mp->loopstart = (int)(ml - mesh->mloop);
-    mp->totloop = 3;
-
-    ml[0].v = output_mesh.triangles[i * 3 + 2];
-    ml[1].v = output_mesh.triangles[i * 3 + 1];
-    ml[2].v = output_mesh.triangles[i * 3];
-  }
+  RemeshVoxelOutputData data = {
+      .output_mesh = &output_mesh,
+      .mvert = mesh->mvert,
+      .mloop = mesh->mloop,
+      .mpoly = mesh->mpoly,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 4096;
+  BLI_task_parallel_range(
+      0, output_mesh.totvertices, &data, remesh_voxel_output_verts_cb, &settings);
+  BLI_task_parallel_range(0,
+                          output_mesh.totquads + output_mesh.tottriangles,
+                          &data,
+                          remesh_voxel_output_polys_cb,
+                          &settings);
 
   BKE_mesh_calc_edges(mesh, false, false);
   BKE_mesh_calc_normals(mesh);
@@ -149,8 +212,39 @@ Mesh *BKE_mesh_remesh_voxel_ovdb_volume_to_mesh_nomain(struct OpenVDBLevelSet *l
 
   return mesh;
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Level Set Cache
+ *
+ * Converting the input mesh to a level set is the most expensive part of voxel remeshing.
+ * The grid only depends on the input geometry and the voxel size, so callers which know their
+ * input didn't change (the Remesh modifier) can keep it and remesh again with a different
+ * isovalue or adaptivity.
+ * \{ */
+
+typedef struct MeshRemeshVoxelCache {
+  struct OpenVDBLevelSet *level_set;
+  struct OpenVDBTransform *xform;
+  float voxel_size;
+} MeshRemeshVoxelCache;
+
+/** \} */
 #endif
 
+void BKE_mesh_remesh_voxel_cache_free(struct MeshRemeshVoxelCache *cache)
+{
+#ifdef WITH_OPENVDB
+  if (cache != NULL) {
+    OpenVDBLevelSet_free(cache->level_set);
+    OpenVDBTransform_free(cache->xform);
+    MEM_freeN(cache);
+  }
+#else
+  BLI_assert(cache == NULL);
+  UNUSED_VARS_NDEBUG(cache);
+#endif
+}
+
 #ifdef WITH_QUADRIFLOW
 static Mesh *BKE_mesh_remesh_quadriflow(Mesh *input_mesh,
                                         int target_faces,
@@ -297,23 +391,126 @@ Mesh *BKE_mesh_remesh_voxel_to_mesh_nomain(Mesh *mesh,
                                            float voxel_size,
                                            float adaptivity,
                                            float isovalue)
+{
+  return BKE_mesh_remesh_voxel_to_mesh_nomain_ex(mesh, voxel_size, adaptivity, isovalue, NULL);
+}
+
+/**
+ * \param cache_p: When not NULL, the level set is kept in `*cache_p` and reused by the next
+ * call with the same voxel size. The caller is responsible for freeing the cache when the input
+ * mesh changes, see #BKE_mesh_remesh_voxel_cache_free.
+ */
+Mesh *BKE_mesh_remesh_voxel_to_mesh_nomain_ex(Mesh *mesh,
+                                              float voxel_size,
+                                              float adaptivity,
+                                              float isovalue,
+                                              struct MeshRemeshVoxelCache **cache_p)
 {
   Mesh *new_mesh = NULL;
 #ifdef WITH_OPENVDB
-  struct OpenVDBLevelSet *level_set;
-  struct OpenVDBTransform *xform = OpenVDBTransform_create();
-  OpenVDBTransform_create_linear_transform(xform, (double)voxel_size);
-  level_set = BKE_mesh_remesh_voxel_ovdb_mesh_to_level_set_create(mesh, xform);
+  struct MeshRemeshVoxelCache *cache = (cache_p != NULL) ? *cache_p : NULL;
+  if (cache != NULL && cache->voxel_size != voxel_size) {
+    BKE_mesh_remesh_voxel_cache_free(cache);
+    cache = NULL;
+  }
+  if (cache == NULL) {
+    cache = MEM_callocN(sizeof(*cache), __func__);
+    cache->xform = OpenVDBTransform_create();
+    OpenVDBTransform_create_linear_transform(cache->xform, (double)voxel_size);
+    cache->level_set = BKE_mesh_remesh_voxel_ovdb_mesh_to_level_set_create(mesh, cache->xform);
+    cache->voxel_size = voxel_size;
+  }
+
   new_mesh = BKE_mesh_remesh_voxel_ovdb_volume_to_mesh_nomain(
-      level_set, (double)isovalue, (double)adaptivity, false);
-  OpenVDBLevelSet_free(level_set);
-  OpenVDBTransform_free(xform);
+      cache->level_set, (double)isovalue, (double)adaptivity, false);
+
+  if (cache_p != NULL) {
+    *cache_p = cache;
+  }
+  else {
+    BKE_mesh_remesh_voxel_cache_free(cache);
+  }
 #else
   UNUSED_VARS(mesh, voxel_size, adaptivity, isovalue);
+  if (cache_p != NULL) {
+    *cache_p = NULL;
+  }
 #endif
   return new_mesh;
 }
 
+typedef struct RemeshReprojectData {
+  const BVHTreeFromMesh *bvhtree;
+  const MVert *target_verts;
+  const MLoop *target_loops;
+  const MPoly *target_polys;
+  const MLoopTri *source_looptri;
+  const float *source_mask;
+  const int *source_face_sets;
+  float *target_mask;
+  int *target_face_sets;
+  int *nearest_index;
+} RemeshReprojectData;
+
+static void remesh_reproject_paint_mask_cb(void *__restrict userdata,
+                                           const int i,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const RemeshReprojectData *data = userdata;
+  const BVHTreeFromMesh *bvhtree = data->bvhtree;
+  BVHTreeNearest nearest;
+  nearest.index = -1;
+  nearest.dist_sq = FLT_MAX;
+  BLI_bvhtree_find_nearest(bvhtree->tree,
+                           data->target_verts[i].co,
+                           &nearest,
+                           bvhtree->nearest_callback,
+                           (void *)bvhtree);
+  if (nearest.index != -1) {
+    data->target_mask[i] = data->source_mask[nearest.index];
+  }
+}
+
+static void remesh_reproject_face_sets_cb(void *__restrict userdata,
+                                          const int i,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const RemeshReprojectData *data = userdata;
+  const BVHTreeFromMesh *bvhtree = data->bvhtree;
+  const MPoly *mpoly = &data->target_polys[i];
+  float from_co[3];
+  BVHTreeNearest nearest;
+  nearest.index = -1;
+  nearest.dist_sq = FLT_MAX;
+  BKE_mesh_calc_poly_center(
+      mpoly, &data->target_loops[mpoly->loopstart], data->target_verts, from_co);
+  BLI_bvhtree_find_nearest(
+      bvhtree->tree, from_co, &nearest, bvhtree->nearest_callback, (void *)bvhtree);
+  if (nearest.index != -1) {
+    data->target_face_sets[i] = data->source_face_sets[data->source_looptri[nearest.index].poly];
+  }
+  else {
+    data->target_face_sets[i] = 1;
+  }
+}
+
+static void remesh_reproject_nearest_vert_cb(void *__restrict userdata,
+                                             const int i,
+                                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const RemeshReprojectData *data = userdata;
+  const BVHTreeFromMesh *bvhtree = data->bvhtree;
+  BVHTreeNearest nearest;
+  nearest.index = -1;
+  nearest.dist_sq = FLT_MAX;
+  BLI_bvhtree_find_nearest(bvhtree->tree,
+                           data->target_verts[i].co,
+                           &nearest,
+                           bvhtree->nearest_callback,
+                           (void *)bvhtree);
+  data->nearest_index[i] = nearest.index;
+}
+
 void BKE_mesh_remesh_reproject_paint_mask(Mesh *target, Mesh *source)
 {
   BVHTreeFromMesh bvhtree = {
@@ -340,17 +537,17 @@ void BKE_mesh_remesh_reproject_paint_mask(Mesh *target, Mesh *source)
         &source->vdata, CD_PAINT_MASK, CD_CALLOC, NULL, source->totvert);
   }
 
-  for (int i = 0; i < target->totvert; i++) {
-    float from_co[3];
-    BVHTreeNearest nearest;
-    nearest.index = -1;
-    nearest.dist_sq = FLT_MAX;
-    copy_v3_v3(from_co, target_verts[i].co);
-    BLI_bvhtree_find_nearest(bvhtree.tree, from_co, &nearest, bvhtree.nearest_callback, &bvhtree);
-    if (nearest.index != -1) {
-      target_mask[i] = source_mask[nearest.index];
-    }
-  }
+  RemeshReprojectData data = {
+      .bvhtree = &bvhtree,
+      .target_verts = target_verts,
+      .source_mask = source_mask,
+      .target_mask = target_mask,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, target->totvert, &data, remesh_reproject_paint_mask_cb, &settings);
+
   free_bvhtree_from_mesh(&bvhtree);
 }
 
@@ -385,32 +582,47 @@ void BKE_remesh_reproject_sculpt_face_sets(Mesh *target, Mesh *source)
   const MLoopTri *looptri = BKE_mesh_runtime_looptri_ensure(source);
   BKE_bvhtree_from_mesh_get(&bvhtree, source, BVHTREE_FROM_LOOPTRI, 2);
 
-  for (int i = 0; i < target->totpoly; i++) {
-    float from_co[3];
-    BVHTreeNearest nearest;
-    nearest.index = -1;
-    nearest.dist_sq = FLT_MAX;
-    const MPoly *mpoly = &target_polys[i];
-    BKE_mesh_calc_poly_center(mpoly, &target_loops[mpoly->loopstart], target_verts, from_co);
-    BLI_bvhtree_find_nearest(bvhtree.tree, from_co, &nearest, bvhtree.nearest_callback, &bvhtree);
-    if (nearest.index != -1) {
-      target_face_sets[i] = source_face_sets[looptri[nearest.index].poly];
-    }
-    else {
-      target_face_sets[i] = 1;
-    }
-  }
+  RemeshReprojectData data = {
+      .bvhtree = &bvhtree,
+      .target_verts = target_verts,
+      .target_loops = target_loops,
+      .target_polys = target_polys,
+      .source_looptri = looptri,
+      .source_face_sets = source_face_sets,
+      .target_face_sets = target_face_sets,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, target->totpoly, &data, remesh_reproject_face_sets_cb, &settings);
+
   free_bvhtree_from_mesh(&bvhtree);
 }
 
 void BKE_remesh_reproject_vertex_paint(Mesh *target, Mesh *source)
 {
+  int tot_color_layer = CustomData_number_of_layers(&source->vdata, CD_PROP_COLOR);
+  if (tot_color_layer == 0) {
+    return;
+  }
+
   BVHTreeFromMesh bvhtree = {
       .nearest_callback = NULL,
   };
   BKE_bvhtree_from_mesh_get(&bvhtree, source, BVHTREE_FROM_VERTS, 2);
 
-  int tot_color_layer = CustomData_number_of_layers(&source->vdata, CD_PROP_COLOR);
+  /* The nearest source vertex is the same for all layers, look it up only once. */
+  int *nearest_index = MEM_malloc_arrayN(target->totvert, sizeof(int), __func__);
+  RemeshReprojectData data = {
+      .bvhtree = &bvhtree,
+      .target_verts = CustomData_get_layer(&target->vdata, CD_MVERT),
+      .nearest_index = nearest_index,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, target->totvert, &data, remesh_reproject_nearest_vert_cb, &settings);
+  free_bvhtree_from_mesh(&bvhtree);
 
   for (int layer_n = 0; layer_n < tot_color_layer; layer_n++) {
     const char *layer_name = CustomData_get_layer_name(&source->vdata, CD_PROP_COLOR, layer_n);
@@ -418,20 +630,14 @@ void BKE_remesh_reproject_vertex_paint(Mesh *target, Mesh *source)
         &target->vdata, CD_PROP_COLOR, CD_CALLOC, NULL, target->totvert, layer_name);
 
     MPropCol *target_color = CustomData_get_layer_n(&target->vdata, CD_PROP_COLOR, layer_n);
-    MVert *target_verts = CustomData_get_layer(&target->vdata, CD_MVERT);
     MPropCol *source_color = CustomData_get_layer_n(&source->vdata, CD_PROP_COLOR, layer_n);
     for (int i = 0; i < target->totvert; i++) {
-      BVHTreeNearest nearest;
-      nearest.index = -1;
-      nearest.dist_sq = FLT_MAX;
-      BLI_bvhtree_find_nearest(
-          bvhtree.tree, target_verts[i].co, &nearest, bvhtree.nearest_callback, &bvhtree);
-      if (nearest.index != -1) {
-        copy_v4_v4(target_color[i].color, source_color[nearest.index].color);
+      if (nearest_index[i] != -1) {
+        copy_v4_v4(target_color[i].color, source_color[nearest_index[i]].color);
       }
     }
   }
-  free_bvhtree_from_mesh(&bvhtree);
+  MEM_freeN(nearest_index);
 }
 
 struct Mesh *BKE_mesh_remesh_voxel_fix_poles(struct Mesh *mesh)
@@ -0,0 +1,87 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math.h"
+#include "BLI_task.h"
+
+#include "BKE_mesh.h"
+
+#include "PIL_time.h"
+
+#include "mesh_evaluate_test_utils.hh"
+
+namespace blender::bke::tests {
+
+static void mesh_normals_performance(const int size, const int runs_num)
+{
+  BLI_task_scheduler_init();
+  MeshNormalsTestContext ctx;
+  test_mesh_normals_init(&ctx, size);
+
+  float(*pnors)[3] = (float(*)[3])MEM_malloc_arrayN(ctx.polys_num, sizeof(float[3]), __func__);
+  float(*lnors)[3] = (float(*)[3])MEM_malloc_arrayN(ctx.loops_num, sizeof(float[3]), __func__);
+
+  double time_poly = 0.0;
+  double time_loop = 0.0;
+  for (int run = 0; run < runs_num; run++) {
+    const double time_start = PIL_check_seconds_timer();
+    BKE_mesh_calc_normals_poly(ctx.mverts,
+                               nullptr,
+                               ctx.verts_num,
+                               ctx.mloops,
+                               ctx.mpolys,
+                               ctx.loops_num,
+                               ctx.polys_num,
+                               pnors,
+                               false);
+    const double time_mid = PIL_check_seconds_timer();
+    BKE_mesh_normals_loop_split(ctx.mverts,
+                                ctx.verts_num,
+                                ctx.medges,
+                                ctx.edges_num,
+                                ctx.mloops,
+                                lnors,
+                                ctx.loops_num,
+                                ctx.mpolys,
+                                pnors,
+                                ctx.polys_num,
+                                true,
+                                DEG2RADF(30.0f),
+                                nullptr,
+                                nullptr,
+                                nullptr);
+    const double time_end = PIL_check_seconds_timer();
+    time_poly += time_mid - time_start;
+    time_loop += time_end - time_mid;
+  }
+
+  printf("\n========== Mesh normals of %d faces ==========\n", ctx.polys_num);
+  printf("\tvertex & face normals: done in %fs on average over %d runs\n",
+         time_poly / runs_num,
+         runs_num);
+  printf("\tsplit loop normals: done in %fs on average over %d runs\n",
+         time_loop / runs_num,
+         runs_num);
+
+  MEM_freeN(pnors);
+  MEM_freeN(lnors);
+  test_mesh_normals_free(&ctx);
+  BLI_task_scheduler_exit();
+}
+
+TEST(mesh_normals, performance_10000)
+{
+  mesh_normals_performance(100, 100);
+}
+
+TEST(mesh_normals, performance_1000000)
+{
+  mesh_normals_performance(1000, 10);
+}
+
+}  // namespace blender::bke::tests
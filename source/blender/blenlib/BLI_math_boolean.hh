@@ -49,6 +49,11 @@ int incircle_fast(const double2 &a, const double2 &b, const double2 &c, const do
 int orient3d(const double3 &a, const double3 &b, const double3 &c, const double3 &d);
 int orient3d_fast(const double3 &a, const double3 &b, const double3 &c, const double3 &d);
 
+/* #orient3d_filter gives the sign of #orient3d for the exact coordinates that the arguments
+ * approximate, if double arithmetic is enough to be certain of it, and 0 otherwise.
+ * Callers fall back to an exact predicate when it returns 0. */
+int orient3d_filter(const double3 &a, const double3 &b, const double3 &c, const double3 &d);
+
 int insphere(
     const double3 &a, const double3 &b, const double3 &c, const double3 &d, const double3 &e);
 int insphere_fast(
@@ -2518,6 +2518,38 @@ int orient3d_fast(const double3 &a, const double3 &b, const double3 &c, const do
   return sgn(robust_pred::orient3dfast(a, b, c, d));
 }
 
+/**
+ * Filtered orient3d, see EXACT GEOMETRIC COMPUTATION USING CASCADING, by Burnikel, Funke, and
+ * Seel. The input coordinates are the double approximations of exact coordinates, so they have
+ * index 1. The differences have index 2, the 2x2 minors have index 6, and the final sum of
+ * products has index 11. The error bound is the determinant evaluated on the magnitudes of the
+ * inputs, so the bound of a difference `a - d` is `|a| + |d|`, not `|a - d|`.
+ */
+int orient3d_filter(const double3 &a, const double3 &b, const double3 &c, const double3 &d)
+{
+  double3 ad = a - d;
+  double3 bd = b - d;
+  double3 cd = c - d;
+  double det = ad[2] * (bd[0] * cd[1] - cd[0] * bd[1]) + bd[2] * (cd[0] * ad[1] - ad[0] * cd[1]) +
+               cd[2] * (ad[0] * bd[1] - bd[0] * ad[1]);
+  if (det == 0.0) {
+    return 0;
+  }
+  double3 abs_d = double3::abs(d);
+  double3 sup_ad = double3::abs(a) + abs_d;
+  double3 sup_bd = double3::abs(b) + abs_d;
+  double3 sup_cd = double3::abs(c) + abs_d;
+  double supremum = sup_ad[2] * (sup_bd[0] * sup_cd[1] + sup_cd[0] * sup_bd[1]) +
+                    sup_bd[2] * (sup_cd[0] * sup_ad[1] + sup_ad[0] * sup_cd[1]) +
+                    sup_cd[2] * (sup_ad[0] * sup_bd[1] + sup_bd[0] * sup_ad[1]);
+  constexpr double index_orient3d = 11;
+  double err_bound = supremum * index_orient3d * DBL_EPSILON;
+  if (fabs(det) > err_bound) {
+    return det > 0 ? 1 : -1;
+  }
+  return 0;
+}
+
 int insphere(
     const double3 &a, const double3 &b, const double3 &c, const double3 &d, const double3 &e)
 {
@@ -37,6 +37,7 @@
 #  include "BLI_set.hh"
 #  include "BLI_span.hh"
 #  include "BLI_stack.hh"
+#  include "BLI_task.h"
 #  include "BLI_vector.hh"
 #  include "BLI_vector_set.hh"
 
@@ -878,9 +879,9 @@ static int sort_tris_class(const Face &tri, const Face &tri0, const Edge e)
   if (dbg_level > 0) {
     std::cout << "classify  e = " << e << "\n";
   }
-  mpq3 a0 = tri0[0]->co_exact;
-  mpq3 a1 = tri0[1]->co_exact;
-  mpq3 a2 = tri0[2]->co_exact;
+  const mpq3 &a0 = tri0[0]->co_exact;
+  const mpq3 &a1 = tri0[1]->co_exact;
+  const mpq3 &a2 = tri0[2]->co_exact;
   bool rev;
   bool rev0;
   const Vert *flapv0 = find_flap_vert(tri0, e, &rev0);
@@ -892,9 +893,13 @@ static int sort_tris_class(const Face &tri, const Face &tri0, const Edge e)
     std::cout << " rev = " << rev << " flapv = " << flapv << "\n";
   }
   BLI_assert(flapv != nullptr && flapv0 != nullptr);
-  const mpq3 flap = flapv->co_exact;
-  /* orient will be positive if flap is below oriented plane of a0,a1,a2. */
-  int orient = orient3d(a0, a1, a2, flap);
+  /* orient will be positive if flap is below oriented plane of a0,a1,a2.
+   * Try the double filter first; only near-degenerate configurations need exact arithmetic. */
+  int orient = orient3d_filter(tri0[0]->co, tri0[1]->co, tri0[2]->co, flapv->co);
+  if (orient == 0) {
+    const mpq3 &flap = flapv->co_exact;
+    orient = orient3d(a0, a1, a2, flap);
+  }
   int ans;
   if (orient > 0) {
     ans = rev0 ? 4 : 3;
@@ -2432,10 +2437,119 @@ static bool point_is_inside_shape(const IMesh &tm,
   return (gwn > 0.01);
 }
 
+/** What #gwn_boolean decided to do with a patch. */
+enum class GwnPatchAction : int8_t {
+  Remove = 0,
+  Keep = 1,
+  Flip = 2,
+};
+
+/**
+ * Data needed for parallelization of the patch classification in #gwn_boolean.
+ */
+struct GwnClassifyData {
+  const IMesh &tm;
+  BoolOpType op;
+  int nshapes;
+  std::function<int(int)> shape_fn;
+  const PatchesInfo &pinfo;
+  Array<GwnPatchAction> &r_patch_action;
+
+  GwnClassifyData(const IMesh &tm,
+                  BoolOpType op,
+                  int nshapes,
+                  std::function<int(int)> shape_fn,
+                  const PatchesInfo &pinfo,
+                  Array<GwnPatchAction> &r_patch_action)
+      : tm(tm),
+        op(op),
+        nshapes(nshapes),
+        shape_fn(shape_fn),
+        pinfo(pinfo),
+        r_patch_action(r_patch_action)
+  {
+  }
+};
+
+static void gwn_classify_patch_range_func(void *__restrict userdata,
+                                          const int iter,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  constexpr int dbg_level = 0;
+  GwnClassifyData *data = static_cast<GwnClassifyData *>(userdata);
+  const int p = iter;
+  const BoolOpType op = data->op;
+  const Patch &patch = data->pinfo.patch(p);
+  /* For test triangle, choose one in the middle of patch list
+   * as the ones near the beginning may be very near other patches. */
+  int test_t_index = patch.tri(patch.tot_tri() / 2);
+  Face &tri_test = *data->tm.face(test_t_index);
+  /* Assume all triangles in a patch are in the same shape. */
+  int shape = data->shape_fn(tri_test.orig);
+  if (dbg_level > 0) {
+    std::cout << "process patch " << p << " = " << patch << "\n";
+    std::cout << "test tri = " << test_t_index << " = " << &tri_test << "\n";
+    std::cout << "shape = " << shape << "\n";
+  }
+  if (shape == -1) {
+    data->r_patch_action[p] = GwnPatchAction::Remove;
+    return;
+  }
+  mpq3 test_point = calc_point_inside_tri(tri_test);
+  double3 test_point_db(test_point[0].get_d(), test_point[1].get_d(), test_point[2].get_d());
+  if (dbg_level > 0) {
+    std::cout << "test point = " << test_point_db << "\n";
+  }
+  Array<int> winding(data->nshapes, 0);
+  for (int other_shape = 0; other_shape < data->nshapes; ++other_shape) {
+    if (other_shape == shape) {
+      continue;
+    }
+    /* The point_is_inside_shape function has to approximate if the other
+     * shape is not PWN. For most operations, even a hint of being inside
+     * gives good results, but when shape is a cutter in a Difference
+     * operation, we want to be pretty sure that the point is inside other_shape.
+     * E.g., T75827.
+     */
+    bool need_high_confidence = (op == BoolOpType::Difference) && (shape != 0);
+    bool inside = point_is_inside_shape(
+        data->tm, data->shape_fn, test_point_db, other_shape, need_high_confidence);
+    if (dbg_level > 0) {
+      std::cout << "test point is " << (inside ? "inside" : "outside") << " other_shape "
+                << other_shape << "\n";
+    }
+    winding[other_shape] = inside;
+  }
+  /* Find out the "in the output volume" flag for each of the cases of winding[shape] == 0
+   * and winding[shape] == 1. If the flags are different, this patch should be in the output.
+   * Also, if this is a Difference and the shape isn't the first one, need to flip the normals.
+   */
+  winding[shape] = 0;
+  bool in_output_volume_0 = apply_bool_op(op, winding);
+  winding[shape] = 1;
+  bool in_output_volume_1 = apply_bool_op(op, winding);
+  bool do_remove = in_output_volume_0 == in_output_volume_1;
+  bool do_flip = !do_remove && op == BoolOpType::Difference && shape != 0;
+  if (dbg_level > 0) {
+    std::cout << "winding = ";
+    for (int i = 0; i < data->nshapes; ++i) {
+      std::cout << winding[i] << " ";
+    }
+    std::cout << "\niv0=" << in_output_volume_0 << ", iv1=" << in_output_volume_1 << "\n";
+    std::cout << "result for patch " << p << ": remove=" << do_remove << ", flip=" << do_flip
+              << "\n";
+  }
+  data->r_patch_action[p] = do_remove ? GwnPatchAction::Remove :
+                                        (do_flip ? GwnPatchAction::Flip : GwnPatchAction::Keep);
+}
+
 /**
  * Use the Generalized Winding Number method for deciding if a patch of the
  * mesh is supposed to be included or excluded in the boolean result,
  * and return the mesh that is the boolean result.
+ * The patches are classified in parallel, since every classification needs
+ * a winding number calculation over the whole mesh. The output is then
+ * assembled in patch order, so it does not depend on the thread scheduling.
  */
 static IMesh gwn_boolean(const IMesh &tm,
                          BoolOpType op,
@@ -2448,86 +2562,37 @@ static IMesh gwn_boolean(const IMesh &tm,
   if (dbg_level > 0) {
     std::cout << "GWN_BOOLEAN\n";
   }
+  Array<GwnPatchAction> patch_action(pinfo.tot_patch());
+  GwnClassifyData data(tm, op, nshapes, shape_fn, pinfo, patch_action);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  settings.use_threading = dbg_level == 0;
+  BLI_task_parallel_range(0, pinfo.tot_patch(), &data, gwn_classify_patch_range_func, &settings);
+
   IMesh ans;
   Vector<Face *> out_faces;
   out_faces.reserve(tm.face_size());
-  Array<int> winding(nshapes, 0);
   for (int p : pinfo.index_range()) {
-    const Patch &patch = pinfo.patch(p);
-    /* For test triangle, choose one in the middle of patch list
-     * as the ones near the beginning may be very near other patches. */
-    int test_t_index = patch.tri(patch.tot_tri() / 2);
-    Face &tri_test = *tm.face(test_t_index);
-    /* Assume all triangles in a patch are in the same shape. */
-    int shape = shape_fn(tri_test.orig);
-    if (dbg_level > 0) {
-      std::cout << "process patch " << p << " = " << patch << "\n";
-      std::cout << "test tri = " << test_t_index << " = " << &tri_test << "\n";
-      std::cout << "shape = " << shape << "\n";
-    }
-    if (shape == -1) {
+    if (patch_action[p] == GwnPatchAction::Remove) {
       continue;
     }
-    mpq3 test_point = calc_point_inside_tri(tri_test);
-    double3 test_point_db(test_point[0].get_d(), test_point[1].get_d(), test_point[2].get_d());
-    if (dbg_level > 0) {
-      std::cout << "test point = " << test_point_db << "\n";
-    }
-    for (int other_shape = 0; other_shape < nshapes; ++other_shape) {
-      if (other_shape == shape) {
-        continue;
-      }
-      /* The point_is_inside_shape function has to approximate if the other
-       * shape is not PWN. For most operations, even a hint of being inside
-       * gives good results, but when shape is a cutter in a Difference
-       * operation, we want to be pretty sure that the point is inside other_shape.
-       * E.g., T75827.
-       */
-      bool need_high_confidence = (op == BoolOpType::Difference) && (shape != 0);
-      bool inside = point_is_inside_shape(
-          tm, shape_fn, test_point_db, other_shape, need_high_confidence);
-      if (dbg_level > 0) {
-        std::cout << "test point is " << (inside ? "inside" : "outside") << " other_shape "
-                  << other_shape << "\n";
-      }
-      winding[other_shape] = inside;
-    }
-    /* Find out the "in the output volume" flag for each of the cases of winding[shape] == 0
-     * and winding[shape] == 1. If the flags are different, this patch should be in the output.
-     * Also, if this is a Difference and the shape isn't the first one, need to flip the normals.
-     */
-    winding[shape] = 0;
-    bool in_output_volume_0 = apply_bool_op(op, winding);
-    winding[shape] = 1;
-    bool in_output_volume_1 = apply_bool_op(op, winding);
-    bool do_remove = in_output_volume_0 == in_output_volume_1;
-    bool do_flip = !do_remove && op == BoolOpType::Difference && shape != 0;
-    if (dbg_level > 0) {
-      std::cout << "winding = ";
-      for (int i = 0; i < nshapes; ++i) {
-        std::cout << winding[i] << " ";
+    const bool do_flip = patch_action[p] == GwnPatchAction::Flip;
+    for (int t : pinfo.patch(p).tris()) {
+      Face *f = tm.face(t);
+      if (!do_flip) {
+        out_faces.append(f);
       }
-      std::cout << "\niv0=" << in_output_volume_0 << ", iv1=" << in_output_volume_1 << "\n";
-      std::cout << "result for patch " << p << ": remove=" << do_remove << ", flip=" << do_flip
-                << "\n";
-    }
-    if (!do_remove) {
-      for (int t : patch.tris()) {
-        Face *f = tm.face(t);
-        if (!do_flip) {
-          out_faces.append(f);
-        }
-        else {
-          Face &tri = *f;
-          /* We need flipped version of f. */
-          Array<const Vert *> flipped_vs = {tri[0], tri[2], tri[1]};
-          Array<int> flipped_e_origs = {tri.edge_orig[2], tri.edge_orig[1], tri.edge_orig[0]};
-          Array<bool> flipped_is_intersect = {
-              tri.is_intersect[2], tri.is_intersect[1], tri.is_intersect[0]};
-          Face *flipped_f = arena->add_face(
-              flipped_vs, f->orig, flipped_e_origs, flipped_is_intersect);
-          out_faces.append(flipped_f);
-        }
+      else {
+        Face &tri = *f;
+        /* We need flipped version of f. */
+        Array<const Vert *> flipped_vs = {tri[0], tri[2], tri[1]};
+        Array<int> flipped_e_origs = {tri.edge_orig[2], tri.edge_orig[1], tri.edge_orig[0]};
+        Array<bool> flipped_is_intersect = {
+            tri.is_intersect[2], tri.is_intersect[1], tri.is_intersect[0]};
+        Face *flipped_f = arena->add_face(
+            flipped_vs, f->orig, flipped_e_origs, flipped_is_intersect);
+        out_faces.append(flipped_f);
       }
     }
   }
@@ -3114,6 +3179,83 @@ static Vector<Face *> merge_tris_for_face(Vector<int> tris,
   return ans;
 }
 
+/**
+ * Data needed for parallelization of #merge_all_tris_for_faces.
+ */
+struct MergeTrisData {
+  Array<Vector<Face *>> &r_face_output_face;
+  const Array<Vector<int>> &face_output_tris;
+  const IMesh &tm;
+  const IMesh &imesh_in;
+  IMeshArena *arena;
+
+  MergeTrisData(Array<Vector<Face *>> &r_face_output_face,
+                const Array<Vector<int>> &face_output_tris,
+                const IMesh &tm,
+                const IMesh &imesh_in,
+                IMeshArena *arena)
+      : r_face_output_face(r_face_output_face),
+        face_output_tris(face_output_tris),
+        tm(tm),
+        imesh_in(imesh_in),
+        arena(arena)
+  {
+  }
+};
+
+static void merge_tris_for_face_range_func(void *__restrict userdata,
+                                           const int iter,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MergeTrisData *data = static_cast<MergeTrisData *>(userdata);
+  const Vector<int> &tris = data->face_output_tris[iter];
+  if (tris.is_empty()) {
+    return;
+  }
+  data->r_face_output_face[iter] = merge_tris_for_face(
+      tris, data->tm, data->imesh_in, data->arena);
+}
+
+/**
+ * Fill in r_face_output_face[f] with the result of merging the output triangles
+ * that came from input face f. Every input face is independent of the others,
+ * and the arena is safe to use from several threads.
+ */
+static void merge_all_tris_for_faces(Array<Vector<Face *>> &r_face_output_face,
+                                     const Array<Vector<int>> &face_output_tris,
+                                     const IMesh &tm,
+                                     const IMesh &imesh_in,
+                                     IMeshArena *arena)
+{
+  MergeTrisData data(r_face_output_face, face_output_tris, tm, imesh_in, arena);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1000;
+  BLI_task_parallel_range(
+      0, face_output_tris.size(), &data, merge_tris_for_face_range_func, &settings);
+}
+
+static void populate_plane_approx_range_func(void *__restrict userdata,
+                                             const int iter,
+                                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const IMesh *tm = static_cast<const IMesh *>(userdata);
+  tm->face(iter)->populate_plane(false);
+}
+
+/** Populate the double-precision plane of every face of \a tm, in parallel. */
+static void populate_planes_approx(const IMesh &tm)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1000;
+  BLI_task_parallel_range(0,
+                          tm.face_size(),
+                          const_cast<IMesh *>(&tm),
+                          populate_plane_approx_range_func,
+                          &settings);
+}
+
 /**
  * Return an array, paralleling imesh_out.vert, saying which vertices can be dissolved.
  * A vertex v can be dissolved if (a) it is not an input vertex; (b) it has valence 2;
@@ -3232,9 +3374,7 @@ static IMesh polymesh_from_trimesh_with_dissolve(const IMesh &tm_out,
     std::cout << "\nPOLYMESH_FROM_TRIMESH_WITH_DISSOLVE\n";
   }
   /* For now: need plane normals for all triangles. */
-  for (Face *tri : tm_out.faces()) {
-    tri->populate_plane(false);
-  }
+  populate_planes_approx(tm_out);
   /* Gather all output triangles that are part of each input face.
    * face_output_tris[f] will be indices of triangles in tm_out
    * that have f as their original face. */
@@ -3256,16 +3396,9 @@ static IMesh polymesh_from_trimesh_with_dissolve(const IMesh &tm_out,
    * face_output_face[f] will be new original const Face *'s that
    * make up whatever part of the boolean output remains of input face f. */
   Array<Vector<Face *>> face_output_face(tot_in_face);
+  merge_all_tris_for_faces(face_output_face, face_output_tris, tm_out, imesh_in, arena);
   int tot_out_face = 0;
   for (int in_f : imesh_in.face_index_range()) {
-    if (dbg_level > 1) {
-      std::cout << "merge tris for face " << in_f << "\n";
-    }
-    int num_out_tris_for_face = face_output_tris.size();
-    if (num_out_tris_for_face == 0) {
-      continue;
-    }
-    face_output_face[in_f] = merge_tris_for_face(face_output_tris[in_f], tm_out, imesh_in, arena);
     tot_out_face += face_output_face[in_f].size();
   }
   Array<Face *> face(tot_out_face);
@@ -407,7 +407,7 @@ class IMeshArena::IMeshArenaImpl : NonCopyable, NonMovable {
 
   Face *add_face(Span<const Vert *> verts, int orig, Span<int> edge_origs, Span<bool> is_intersect)
   {
-    Face *f = new Face(verts, next_face_id_++, orig, edge_origs, is_intersect);
+    Face *f = new Face(verts, NO_INDEX, orig, edge_origs, is_intersect);
     if (intersect_use_threading) {
 #  ifdef USE_SPINLOCK
       BLI_spin_lock(&lock_);
@@ -415,6 +415,8 @@ class IMeshArena::IMeshArenaImpl : NonCopyable, NonMovable {
       BLI_mutex_lock(mutex_);
 #  endif
     }
+    /* The id must be assigned under the lock: faces are added from several threads. */
+    f->id = next_face_id_++;
     allocated_faces_.append(std::unique_ptr<Face>(f));
     if (intersect_use_threading) {
 #  ifdef USE_SPINLOCK
@@ -2384,19 +2386,164 @@ static CDT_data calc_cluster_subdivided(const CoplanarClusterInfo &clinfo,
   return cd_data;
 }
 
+/**
+ * Data needed for parallelization of #calc_cluster_subdivides.
+ */
+struct ClusterSubdivideData {
+  Array<CDT_data> &r_cluster_subdivided;
+  const CoplanarClusterInfo &clinfo;
+  const IMesh &tm;
+  const TriOverlaps &ov;
+  const Map<std::pair<int, int>, ITT_value> &itt_map;
+  IMeshArena *arena;
+
+  ClusterSubdivideData(Array<CDT_data> &r_cluster_subdivided,
+                       const CoplanarClusterInfo &clinfo,
+                       const IMesh &tm,
+                       const TriOverlaps &ov,
+                       const Map<std::pair<int, int>, ITT_value> &itt_map,
+                       IMeshArena *arena)
+      : r_cluster_subdivided(r_cluster_subdivided),
+        clinfo(clinfo),
+        tm(tm),
+        ov(ov),
+        itt_map(itt_map),
+        arena(arena)
+  {
+  }
+};
+
+static void calc_cluster_subdivided_range_func(void *__restrict userdata,
+                                               const int iter,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ClusterSubdivideData *data = static_cast<ClusterSubdivideData *>(userdata);
+  data->r_cluster_subdivided[iter] = calc_cluster_subdivided(
+      data->clinfo, iter, data->tm, data->ov, data->itt_map, data->arena);
+}
+
+/**
+ * Fill in r_cluster_subdivided with the CDT of each coplanar cluster.
+ * The clusters are independent of each other, so each one is triangulated in its own task.
+ */
+static void calc_cluster_subdivides(Array<CDT_data> &r_cluster_subdivided,
+                                    const CoplanarClusterInfo &clinfo,
+                                    const IMesh &tm,
+                                    const TriOverlaps &ov,
+                                    const Map<std::pair<int, int>, ITT_value> &itt_map,
+                                    IMeshArena *arena)
+{
+  ClusterSubdivideData data(r_cluster_subdivided, clinfo, tm, ov, itt_map, arena);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  /* A cluster CDT can be expensive, so let every task take just one. */
+  settings.min_iter_per_thread = 1;
+  settings.use_threading = intersect_use_threading;
+  BLI_task_parallel_range(
+      0, clinfo.tot_cluster(), &data, calc_cluster_subdivided_range_func, &settings);
+}
+
+/**
+ * Data needed for parallelization of #extract_all_subdivided_tris.
+ */
+struct ExtractTrisData {
+  Array<IMesh> &r_tri_subdivided;
+  const Array<CDT_data> &cluster_subdivided;
+  const CoplanarClusterInfo &clinfo;
+  const IMesh &tm;
+  IMeshArena *arena;
+
+  ExtractTrisData(Array<IMesh> &r_tri_subdivided,
+                  const Array<CDT_data> &cluster_subdivided,
+                  const CoplanarClusterInfo &clinfo,
+                  const IMesh &tm,
+                  IMeshArena *arena)
+      : r_tri_subdivided(r_tri_subdivided),
+        cluster_subdivided(cluster_subdivided),
+        clinfo(clinfo),
+        tm(tm),
+        arena(arena)
+  {
+  }
+};
+
+static void extract_subdivided_tri_range_func(void *__restrict userdata,
+                                              const int iter,
+                                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ExtractTrisData *data = static_cast<ExtractTrisData *>(userdata);
+  int t = iter;
+  int c = data->clinfo.tri_cluster(t);
+  if (c != NO_INDEX) {
+    BLI_assert(data->r_tri_subdivided[t].face_size() == 0);
+    data->r_tri_subdivided[t] = extract_subdivided_tri(
+        data->cluster_subdivided[c], data->tm, t, data->arena);
+  }
+  else if (data->r_tri_subdivided[t].face_size() == 0) {
+    data->r_tri_subdivided[t] = extract_single_tri(data->tm, t);
+  }
+}
+
+/**
+ * Fill in the remaining slots of r_tri_subdivided: triangles in clusters get their part of
+ * the cluster's CDT output, and triangles that intersect nothing are copied as is.
+ */
+static void extract_all_subdivided_tris(Array<IMesh> &r_tri_subdivided,
+                                        const Array<CDT_data> &cluster_subdivided,
+                                        const CoplanarClusterInfo &clinfo,
+                                        const IMesh &tm,
+                                        IMeshArena *arena)
+{
+  ExtractTrisData data(r_tri_subdivided, cluster_subdivided, clinfo, tm, arena);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1000;
+  settings.use_threading = intersect_use_threading;
+  BLI_task_parallel_range(0, tm.face_size(), &data, extract_subdivided_tri_range_func, &settings);
+}
+
+/**
+ * Data needed for parallelization of #union_tri_subdivides.
+ */
+struct UnionTrisData {
+  const Array<IMesh> &tri_subdivided;
+  /* Where the output faces of each `tri_subdivided` entry start in faces. */
+  Array<int> face_start;
+  Array<Face *> &faces;
+
+  UnionTrisData(const Array<IMesh> &tri_subdivided, Array<Face *> &faces)
+      : tri_subdivided(tri_subdivided), face_start(tri_subdivided.size()), faces(faces)
+  {
+  }
+};
+
+static void union_tri_subdivides_range_func(void *__restrict userdata,
+                                            const int iter,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  UnionTrisData *data = static_cast<UnionTrisData *>(userdata);
+  Span<Face *> m_faces = data->tri_subdivided[iter].faces();
+  if (!m_faces.is_empty()) {
+    std::copy(m_faces.begin(), m_faces.end(), &data->faces[data->face_start[iter]]);
+  }
+}
+
 static IMesh union_tri_subdivides(const blender::Array<IMesh> &tri_subdivided)
 {
+  Array<Face *> faces;
+  UnionTrisData data(tri_subdivided, faces);
   int tot_tri = 0;
-  for (const IMesh &m : tri_subdivided) {
-    tot_tri += m.face_size();
-  }
-  Array<Face *> faces(tot_tri);
-  int face_index = 0;
-  for (const IMesh &m : tri_subdivided) {
-    for (Face *f : m.faces()) {
-      faces[face_index++] = f;
-    }
+  for (int t : tri_subdivided.index_range()) {
+    data.face_start[t] = tot_tri;
+    tot_tri += tri_subdivided[t].face_size();
   }
+  faces.reinitialize(tot_tri);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 10000;
+  settings.use_threading = intersect_use_threading;
+  BLI_task_parallel_range(
+      0, tri_subdivided.size(), &data, union_tri_subdivides_range_func, &settings);
   return IMesh(faces);
 }
 
@@ -2524,6 +2671,40 @@ static CoplanarClusterInfo find_clusters(const IMesh &tm,
   return ans;
 }
 
+/* Data and functions to populate the exact planes of the overlapping triangles in parallel. */
+struct PopulatePlaneData {
+  const IMesh &tm;
+  const TriOverlaps &ov;
+
+  PopulatePlaneData(const IMesh &tm, const TriOverlaps &ov) : tm(tm), ov(ov)
+  {
+  }
+};
+
+static void populate_plane_range_func(void *__restrict userdata,
+                                      const int iter,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PopulatePlaneData *data = static_cast<PopulatePlaneData *>(userdata);
+  if (data->ov.first_overlap_index(iter) != -1) {
+    data->tm.face(iter)->populate_plane(true);
+  }
+}
+
+/**
+ * Only triangles that overlap some other triangle need an exact plane.
+ * Each task only writes to its own #Face, so no locking is needed.
+ */
+static void populate_overlap_planes(const IMesh &tm, const TriOverlaps &ov)
+{
+  PopulatePlaneData data(tm, ov);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1000;
+  settings.use_threading = intersect_use_threading;
+  BLI_task_parallel_range(0, tm.face_size(), &data, populate_plane_range_func, &settings);
+}
+
 static bool face_is_degenerate(const Face *f)
 {
   const Face &face = *f;
@@ -2672,11 +2853,7 @@ IMesh trimesh_nary_intersect(const IMesh &tm_in,
   double overlap_time = PIL_check_seconds_timer();
   std::cout << "intersect overlaps calculated, time = " << overlap_time - bb_calc_time << "\n";
 #  endif
-  for (int t : tm_clean->face_index_range()) {
-    if (tri_ov.first_overlap_index(t) != -1) {
-      tm_clean->face(t)->populate_plane(true);
-    }
-  }
+  populate_overlap_planes(*tm_clean, tri_ov);
 #  ifdef PERFDEBUG
   double plane_populate = PIL_check_seconds_timer();
   std::cout << "planes populated, time = " << plane_populate - overlap_time << "\n";
@@ -2708,24 +2885,13 @@ IMesh trimesh_nary_intersect(const IMesh &tm_in,
   std::cout << "subdivided tris found, time = " << subdivided_tris_time - itt_time << "\n";
 #  endif
   Array<CDT_data> cluster_subdivided(clinfo.tot_cluster());
-  for (int c : clinfo.index_range()) {
-    cluster_subdivided[c] = calc_cluster_subdivided(clinfo, c, *tm_clean, tri_ov, itt_map, arena);
-  }
+  calc_cluster_subdivides(cluster_subdivided, clinfo, *tm_clean, tri_ov, itt_map, arena);
 #  ifdef PERFDEBUG
   double cluster_subdivide_time = PIL_check_seconds_timer();
   std::cout << "subdivided clusters found, time = "
             << cluster_subdivide_time - subdivided_tris_time << "\n";
 #  endif
-  for (int t : tm_clean->face_index_range()) {
-    int c = clinfo.tri_cluster(t);
-    if (c != NO_INDEX) {
-      BLI_assert(tri_subdivided[t].face_size() == 0);
-      tri_subdivided[t] = extract_subdivided_tri(cluster_subdivided[c], *tm_clean, t, arena);
-    }
-    else if (tri_subdivided[t].face_size() == 0) {
-      tri_subdivided[t] = extract_single_tri(*tm_clean, t);
-    }
-  }
+  extract_all_subdivided_tris(tri_subdivided, cluster_subdivided, clinfo, *tm_clean, arena);
 #  ifdef PERFDEBUG
   double extract_time = PIL_check_seconds_timer();
   std::cout << "triangles extracted, time = " << extract_time - cluster_subdivide_time << "\n";
@@ -0,0 +1,81 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_double3.hh"
+#include "BLI_hash.h"
+#include "BLI_math_boolean.hh"
+
+namespace blender::tests {
+
+TEST(math_boolean, Orient3dFilterSimple)
+{
+  double3 a(0.0, 0.0, 0.0);
+  double3 b(1.0, 0.0, 0.0);
+  double3 c(0.0, 1.0, 0.0);
+  double3 above(0.0, 0.0, 1.0);
+  double3 below(0.0, 0.0, -1.0);
+  double3 on(0.5, 0.5, 0.0);
+  EXPECT_EQ(orient3d_filter(a, b, c, above), orient3d(a, b, c, above));
+  EXPECT_EQ(orient3d_filter(a, b, c, below), orient3d(a, b, c, below));
+  EXPECT_EQ(orient3d_filter(a, b, c, on), 0);
+}
+
+#ifdef WITH_GMP
+static double3 mpq3_approx(const mpq3 &co)
+{
+  return double3(co[0].get_d(), co[1].get_d(), co[2].get_d());
+}
+
+/* Exactly coplanar points far from the origin, whose coordinates are not representable as
+ * doubles. The rounding error of the approximations is relative to the magnitude of the
+ * coordinates, not to their differences, so the filter must not claim a sign. */
+TEST(math_boolean, Orient3dFilterNearDegenerate)
+{
+  const mpq_class base(1000000);
+  const mpq3 a(base + mpq_class(1, 3), base + mpq_class(1, 7), base);
+  const mpq3 b(base + mpq_class(2, 3), base, base + mpq_class(1, 11));
+  const mpq3 c(base, base + mpq_class(3, 7), base + mpq_class(1, 5));
+
+  for (int i = 1; i < 20; i++) {
+    const mpq_class s(i, 3);
+    const mpq_class t(1, i + 8);
+    const mpq3 d = a + (b - a) * s + (c - a) * t;
+    ASSERT_EQ(orient3d(a, b, c, d), 0);
+
+    const int orient = orient3d_filter(
+        mpq3_approx(a), mpq3_approx(b), mpq3_approx(c), mpq3_approx(d));
+    EXPECT_EQ(orient, 0);
+  }
+}
+
+/* Points slightly off the plane, the filter either agrees with the exact sign or gives up. */
+TEST(math_boolean, Orient3dFilterAgreesWithExact)
+{
+  const mpq_class base(1000000);
+  const mpq3 a(base + mpq_class(1, 3), base + mpq_class(1, 7), base);
+  const mpq3 b(base + mpq_class(3002, 3), base, base + mpq_class(1, 11));
+  const mpq3 c(base, base + mpq_class(7003, 7), base + mpq_class(1, 5));
+
+  int num_decided = 0;
+  for (int i = 0; i < 1000; i++) {
+    const mpq_class s(int(BLI_hash_int_2d(i, 0) % 1000), 997);
+    const mpq_class t(int(BLI_hash_int_2d(i, 1) % 1000), 991);
+    /* Offsets from the plane between 1e-12 and 1e7, of either sign. */
+    const double offset = ((i % 2) ? 1.0 : -1.0) * pow(10.0, -12.0 + (i % 20));
+    const mpq3 d = a + (b - a) * s + (c - a) * t + mpq3(0, 0, mpq_class(offset));
+
+    const int exact = orient3d(a, b, c, d);
+    const int orient = orient3d_filter(
+        mpq3_approx(a), mpq3_approx(b), mpq3_approx(c), mpq3_approx(d));
+    if (orient != 0) {
+      EXPECT_EQ(orient, exact);
+      num_decided++;
+    }
+  }
+  /* Points far enough from the plane are decided without exact arithmetic. */
+  EXPECT_GT(num_decided, 0);
+}
+#endif
+
+}  // namespace blender::tests
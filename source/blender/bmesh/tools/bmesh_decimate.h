@@ -28,6 +28,26 @@ void BM_mesh_decimate_collapse(BMesh *bm,
                                const int symmetry_axis,
                                const float symmetry_eps);
 
+typedef struct BMDecimateCollapse BMDecimateCollapse;
+
+BMDecimateCollapse *BM_mesh_decimate_collapse_begin(BMesh *bm,
+                                                    float *vweights,
+                                                    float vweight_factor,
+                                                    const int symmetry_axis,
+                                                    const float symmetry_eps);
+void BM_mesh_decimate_collapse_step(BMDecimateCollapse *dc, const float factor);
+void BM_mesh_decimate_collapse_end(BMDecimateCollapse *dc, const bool do_triangulate);
+
+typedef struct BMDecimateCollapseRecord BMDecimateCollapseRecord;
+
+BMDecimateCollapseRecord *BM_mesh_decimate_collapse_record_new(void);
+void BM_mesh_decimate_collapse_record_free(BMDecimateCollapseRecord *record);
+void BM_mesh_decimate_collapse_record(BMDecimateCollapse *dc, BMDecimateCollapseRecord *record);
+bool BM_mesh_decimate_collapse_replay(BMesh *bm,
+                                      const BMDecimateCollapseRecord *record,
+                                      const float factor,
+                                      const bool do_triangulate);
+
 void BM_mesh_decimate_unsubdivide_ex(BMesh *bm, const int iterations, const bool tag_only);
 void BM_mesh_decimate_unsubdivide(BMesh *bm, const int iterations);
 
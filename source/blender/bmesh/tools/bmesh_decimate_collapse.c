@@ -32,6 +32,7 @@
 #include "BLI_polyfill_2d.h"
 #include "BLI_polyfill_2d_beautify.h"
 #include "BLI_quadric.h"
+#include "BLI_task.h"
 #include "BLI_utildefines_stack.h"
 
 #include "BKE_customdata.h"
@@ -76,62 +77,175 @@ typedef enum CD_UseFlag {
 /* BMesh Helper Functions
  * ********************** */
 
+static void bm_decim_face_quadric(BMFace *f, Quadric *r_q)
+{
+  float center[3];
+  double plane_db[4];
+
+  BM_face_calc_center_median(f, center);
+  copy_v3db_v3fl(plane_db, f->no);
+  plane_db[3] = -dot_v3db_v3fl(plane_db, center);
+
+  BLI_quadric_from_plane(r_q, plane_db);
+}
+
 /**
- * \param vquadrics: must be calloc'd
+ * \return false when the boundary edge doesn't define a plane (it adds nothing to the quadrics).
  */
-static void bm_decim_build_quadrics(BMesh *bm, Quadric *vquadrics)
+static bool bm_decim_boundary_edge_quadric(BMEdge *e, Quadric *r_q)
 {
-  BMIter iter;
-  BMFace *f;
-  BMEdge *e;
+  float edge_vector[3];
+  float edge_plane[3];
+  double edge_plane_db[4];
+  sub_v3_v3v3(edge_vector, e->v2->co, e->v1->co);
 
-  BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-    BMLoop *l_first;
-    BMLoop *l_iter;
+  cross_v3_v3v3(edge_plane, edge_vector, e->l->f->no);
+  copy_v3db_v3fl(edge_plane_db, edge_plane);
 
+  if (normalize_v3_db(edge_plane_db) > (double)FLT_EPSILON) {
     float center[3];
-    double plane_db[4];
-    Quadric q;
 
-    BM_face_calc_center_median(f, center);
-    copy_v3db_v3fl(plane_db, f->no);
-    plane_db[3] = -dot_v3db_v3fl(plane_db, center);
+    mid_v3_v3v3(center, e->v1->co, e->v2->co);
 
-    BLI_quadric_from_plane(&q, plane_db);
+    edge_plane_db[3] = -dot_v3db_v3fl(edge_plane_db, center);
+    BLI_quadric_from_plane(r_q, edge_plane_db);
+    BLI_quadric_mul(r_q, BOUNDARY_PRESERVE_WEIGHT);
+    return true;
+  }
+  return false;
+}
 
-    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-    do {
-      BLI_quadric_add_qu_qu(&vquadrics[BM_elem_index_get(l_iter->v)], &q);
-    } while ((l_iter = l_iter->next) != l_first);
+typedef struct DecimQuadricsData {
+  Quadric *vquadrics;
+  /** Face index aligned quadrics, calculated before the vertex quadrics. */
+  Quadric *fquadrics;
+} DecimQuadricsData;
+
+static void bm_decim_build_quadrics_face_cb(void *userdata, MempoolIterData *mp_f)
+{
+  DecimQuadricsData *data = userdata;
+  BMFace *f = (BMFace *)mp_f;
+  bm_decim_face_quadric(f, &data->fquadrics[BM_elem_index_get(f)]);
+}
+
+static int bm_decim_elem_index_cmp(const void *a_v, const void *b_v)
+{
+  const int a = BM_elem_index_get(*(BMElem *const *)a_v);
+  const int b = BM_elem_index_get(*(BMElem *const *)b_v);
+  return (a > b) - (a < b);
+}
+
+/**
+ * Elements around a vertex, sorted by index,
+ * small enough for most vertices to use the stack.
+ */
+typedef struct DecimElemBuf {
+  BMElem **data;
+  int len;
+  int len_alloc;
+  BMElem *data_stack[64];
+} DecimElemBuf;
+
+static void bm_decim_elem_buf_init(DecimElemBuf *buf)
+{
+  buf->data = buf->data_stack;
+  buf->len = 0;
+  buf->len_alloc = ARRAY_SIZE(buf->data_stack);
+}
+
+static void bm_decim_elem_buf_append(DecimElemBuf *buf, void *ele)
+{
+  if (UNLIKELY(buf->len == buf->len_alloc)) {
+    buf->len_alloc *= 2;
+    if (buf->data == buf->data_stack) {
+      buf->data = MEM_mallocN(sizeof(*buf->data) * buf->len_alloc, __func__);
+      memcpy(buf->data, buf->data_stack, sizeof(buf->data_stack));
+    }
+    else {
+      buf->data = MEM_reallocN(buf->data, sizeof(*buf->data) * buf->len_alloc);
+    }
   }
+  buf->data[buf->len++] = ele;
+}
 
-  /* boundary edges */
-  BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
-    if (UNLIKELY(BM_edge_is_boundary(e))) {
-      float edge_vector[3];
-      float edge_plane[3];
-      double edge_plane_db[4];
-      sub_v3_v3v3(edge_vector, e->v2->co, e->v1->co);
-      f = e->l->f;
+static void bm_decim_elem_buf_sort(DecimElemBuf *buf)
+{
+  qsort(buf->data, buf->len, sizeof(*buf->data), bm_decim_elem_index_cmp);
+}
 
-      cross_v3_v3v3(edge_plane, edge_vector, f->no);
-      copy_v3db_v3fl(edge_plane_db, edge_plane);
+static void bm_decim_elem_buf_free(DecimElemBuf *buf)
+{
+  if (buf->data != buf->data_stack) {
+    MEM_freeN(buf->data);
+  }
+}
 
-      if (normalize_v3_db(edge_plane_db) > (double)FLT_EPSILON) {
-        Quadric q;
-        float center[3];
+static void bm_decim_build_quadrics_vert_cb(void *userdata, MempoolIterData *mp_v)
+{
+  DecimQuadricsData *data = userdata;
+  BMVert *v = (BMVert *)mp_v;
+  Quadric *q_v = &data->vquadrics[BM_elem_index_get(v)];
 
-        mid_v3_v3v3(center, e->v1->co, e->v2->co);
+  if (v->e == NULL) {
+    return;
+  }
 
-        edge_plane_db[3] = -dot_v3db_v3fl(edge_plane_db, center);
-        BLI_quadric_from_plane(&q, edge_plane_db);
-        BLI_quadric_mul(&q, BOUNDARY_PRESERVE_WEIGHT);
+  /* Sum the quadrics in face, then edge index order,
+   * so the result is the same as looping over all faces & edges of the mesh. */
+  DecimElemBuf buf;
+  bm_decim_elem_buf_init(&buf);
 
-        BLI_quadric_add_qu_qu(&vquadrics[BM_elem_index_get(e->v1)], &q);
-        BLI_quadric_add_qu_qu(&vquadrics[BM_elem_index_get(e->v2)], &q);
-      }
+  BMIter iter;
+  BMLoop *l;
+  BM_ITER_ELEM (l, &iter, v, BM_LOOPS_OF_VERT) {
+    bm_decim_elem_buf_append(&buf, l->f);
+  }
+  bm_decim_elem_buf_sort(&buf);
+  for (int i = 0; i < buf.len; i++) {
+    BLI_quadric_add_qu_qu(q_v, &data->fquadrics[BM_elem_index_get(buf.data[i])]);
+  }
+
+  /* boundary edges */
+  buf.len = 0;
+  BMEdge *e_iter, *e_first;
+  e_iter = e_first = v->e;
+  do {
+    if (UNLIKELY(BM_edge_is_boundary(e_iter))) {
+      bm_decim_elem_buf_append(&buf, e_iter);
+    }
+  } while ((e_iter = bmesh_disk_edge_next(e_iter, v)) != e_first);
+
+  bm_decim_elem_buf_sort(&buf);
+  for (int i = 0; i < buf.len; i++) {
+    Quadric q;
+    if (bm_decim_boundary_edge_quadric((BMEdge *)buf.data[i], &q)) {
+      BLI_quadric_add_qu_qu(q_v, &q);
     }
   }
+
+  bm_decim_elem_buf_free(&buf);
+}
+
+/**
+ * Each vertex quadric is the sum of the quadrics of its faces and boundary edges.
+ * Face quadrics are calculated first, then each vertex gathers its own,
+ * so both passes can run in parallel without any locking.
+ *
+ * \param vquadrics: must be calloc'd
+ */
+static void bm_decim_build_quadrics(BMesh *bm, Quadric *vquadrics)
+{
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+
+  DecimQuadricsData data = {
+      .vquadrics = vquadrics,
+      .fquadrics = MEM_mallocN(sizeof(Quadric) * bm->totface, __func__),
+  };
+
+  BM_iter_parallel(bm, BM_FACES_OF_MESH, bm_decim_build_quadrics_face_cb, &data, true);
+  BM_iter_parallel(bm, BM_VERTS_OF_MESH, bm_decim_build_quadrics_vert_cb, &data, true);
+
+  MEM_freeN(data.fquadrics);
 }
 
 static void bm_decim_calc_target_co_db(BMEdge *e, double optimize_co[3], const Quadric *vquadrics)
@@ -236,18 +350,20 @@ static float bm_decim_build_edge_cost_single__topology(BMEdge *e)
 
 #endif /* USE_TOPOLOGY_FALLBACK */
 
-static void bm_decim_build_edge_cost_single(BMEdge *e,
-                                            const Quadric *vquadrics,
-                                            const float *vweights,
-                                            const float vweight_factor,
-                                            Heap *eheap,
-                                            HeapNode **eheap_table)
+/**
+ * \return false when the edge must not be collapsed (and so must not be in the heap).
+ */
+static bool bm_decim_calc_edge_cost_single(BMEdge *e,
+                                           const Quadric *vquadrics,
+                                           const float *vweights,
+                                           const float vweight_factor,
+                                           float *r_cost)
 {
   float cost;
 
   if (UNLIKELY(vweights && ((vweights[BM_elem_index_get(e->v1)] == 0.0f) ||
                             (vweights[BM_elem_index_get(e->v2)] == 0.0f)))) {
-    goto clear;
+    return false;
   }
 
   /* check we can collapse, some edges we better not touch */
@@ -257,7 +373,7 @@ static void bm_decim_build_edge_cost_single(BMEdge *e,
     }
     else {
       /* only collapse tri's */
-      goto clear;
+      return false;
     }
   }
   else if (BM_edge_is_manifold(e)) {
@@ -266,11 +382,11 @@ static void bm_decim_build_edge_cost_single(BMEdge *e,
     }
     else {
       /* only collapse tri's */
-      goto clear;
+      return false;
     }
   }
   else {
-    goto clear;
+    return false;
   }
   /* end sanity check */
 
@@ -323,10 +439,24 @@ static void bm_decim_build_edge_cost_single(BMEdge *e,
     }
   }
 
-  BLI_heap_insert_or_update(eheap, &eheap_table[BM_elem_index_get(e)], cost, e);
-  return;
+  *r_cost = cost;
+  return true;
+}
+
+static void bm_decim_build_edge_cost_single(BMEdge *e,
+                                            const Quadric *vquadrics,
+                                            const float *vweights,
+                                            const float vweight_factor,
+                                            Heap *eheap,
+                                            HeapNode **eheap_table)
+{
+  float cost;
+
+  if (bm_decim_calc_edge_cost_single(e, vquadrics, vweights, vweight_factor, &cost)) {
+    BLI_heap_insert_or_update(eheap, &eheap_table[BM_elem_index_get(e)], cost, e);
+    return;
+  }
 
-clear:
   if (eheap_table[BM_elem_index_get(e)]) {
     BLI_heap_remove(eheap, eheap_table[BM_elem_index_get(e)]);
   }
@@ -341,6 +471,31 @@ static void bm_decim_invalid_edge_cost_single(BMEdge *e, Heap *eheap, HeapNode *
   eheap_table[BM_elem_index_get(e)] = BLI_heap_insert(eheap, COST_INVALID, e);
 }
 
+typedef struct DecimEdgeCostData {
+  const Quadric *vquadrics;
+  const float *vweights;
+  float vweight_factor;
+  /** Edge index aligned costs, only set where #ecosts_valid is true. */
+  float *ecosts;
+  /** Edge index aligned, false for edges which are not to be added to the heap.
+   * Kept apart from the costs since any float, including #COST_INVALID, is a valid cost. */
+  bool *ecosts_valid;
+} DecimEdgeCostData;
+
+static void bm_decim_build_edge_cost_cb(void *userdata, MempoolIterData *mp_e)
+{
+  DecimEdgeCostData *data = userdata;
+  BMEdge *e = (BMEdge *)mp_e;
+  const int index = BM_elem_index_get(e);
+
+  data->ecosts_valid[index] = bm_decim_calc_edge_cost_single(
+      e, data->vquadrics, data->vweights, data->vweight_factor, &data->ecosts[index]);
+}
+
+/**
+ * Costs are calculated in parallel, then added to the heap in edge order,
+ * so the heap is exactly the same as when building it on a single thread.
+ */
 static void bm_decim_build_edge_cost(BMesh *bm,
                                      const Quadric *vquadrics,
                                      const float *vweights,
@@ -352,11 +507,23 @@ static void bm_decim_build_edge_cost(BMesh *bm,
   BMEdge *e;
   uint i;
 
+  DecimEdgeCostData data = {
+      .vquadrics = vquadrics,
+      .vweights = vweights,
+      .vweight_factor = vweight_factor,
+      .ecosts = MEM_mallocN(sizeof(float) * bm->totedge, __func__),
+      .ecosts_valid = MEM_mallocN(sizeof(bool) * bm->totedge, __func__),
+  };
+
+  BM_iter_parallel(bm, BM_EDGES_OF_MESH, bm_decim_build_edge_cost_cb, &data, true);
+
   BM_ITER_MESH_INDEX (e, &iter, bm, BM_EDGES_OF_MESH, i) {
-    /* keep sanity check happy */
-    eheap_table[i] = NULL;
-    bm_decim_build_edge_cost_single(e, vquadrics, vweights, vweight_factor, eheap, eheap_table);
+    BLI_assert(BM_elem_index_get(e) == (int)i);
+    eheap_table[i] = data.ecosts_valid[i] ? BLI_heap_insert(eheap, data.ecosts[i], e) : NULL;
   }
+
+  MEM_freeN(data.ecosts);
+  MEM_freeN(data.ecosts_valid);
 }
 
 #ifdef USE_SYMMETRY
@@ -1279,70 +1446,91 @@ static bool bm_decim_edge_collapse(BMesh *bm,
  * ********************** */
 
 /**
- * \brief BM_mesh_decimate
- * \param bm: The mesh
- * \param factor: face count multiplier [0 - 1]
- * \param vweights: Optional array of vertex  aligned weights [0 - 1],
- *        a vertex group is the usual source for this.
- * \param symmetry_axis: Axis of symmetry, -1 to disable mirror decimate.
- * \param symmetry_eps: Threshold when matching mirror verts.
+ * Decimation state, kept between steps so decimating further
+ * doesn't need to rebuild the quadrics and the edge heap.
  */
-void BM_mesh_decimate_collapse(BMesh *bm,
-                               const float factor,
-                               float *vweights,
-                               float vweight_factor,
-                               const bool do_triangulate,
-                               const int symmetry_axis,
-                               const float symmetry_eps)
-{
+struct BMDecimateCollapse {
+  BMesh *bm;
+
   /* edge heap */
   Heap *eheap;
   /* edge index aligned table pointing to the eheap */
   HeapNode **eheap_table;
   /* vert index aligned quadrics */
   Quadric *vquadrics;
+
+  float *vweights;
+  float vweight_factor;
+
   int tot_edge_orig;
-  int face_tot_target;
+  /** Face count before any collapse (after triangulating), the target is relative to this. */
+  int face_tot_orig;
 
-  CD_UseFlag customdata_flag = 0;
+  CD_UseFlag customdata_flag;
 
 #ifdef USE_SYMMETRY
-  bool use_symmetry = (symmetry_axis != -1);
+  int symmetry_axis;
   int *edge_symmetry_map;
 #endif
 
 #ifdef USE_TRIANGULATE
-  int edges_tri_tot = 0;
-  /* temp convert quads to triangles */
-  bool use_triangulate = bm_decim_triangulate_begin(bm, &edges_tri_tot);
-#else
-  UNUSED_VARS(do_triangulate);
+  bool use_triangulate;
+  int edges_tri_tot;
 #endif
 
-  /* alloc vars */
-  vquadrics = MEM_callocN(sizeof(Quadric) * bm->totvert, __func__);
-  /* since some edges may be degenerate, we might be over allocing a little here */
-  eheap = BLI_heap_new_ex(bm->totedge);
-  eheap_table = MEM_mallocN(sizeof(HeapNode *) * bm->totedge, __func__);
-  tot_edge_orig = bm->totedge;
-
-  /* build initial edge collapse cost data */
-  bm_decim_build_quadrics(bm, vquadrics);
+  /** Optional, see #BM_mesh_decimate_collapse_record. */
+  BMDecimateCollapseRecord *record;
+};
 
-  bm_decim_build_edge_cost(bm, vquadrics, vweights, vweight_factor, eheap, eheap_table);
+/** A single edge collapse of a #BMDecimateCollapseRecord. */
+typedef struct DecimCollapse {
+  /** Index of the kept and the removed vertex, vertex indices don't change while collapsing. */
+  int v_index[2];
+  /** Location of the kept vertex. */
+  float co[3];
+  /** Collapsed in the same step as the collapse before it, for the mirror edge. */
+  bool is_mirror;
+} DecimCollapse;
 
-  face_tot_target = bm->totface * factor;
-  bm->elem_index_dirty |= BM_ALL;
+/**
+ * The edge collapses of a decimation in order. Their order only depends on the input,
+ * so decimating the same input to any factor collapses a prefix of the same edges.
+ */
+struct BMDecimateCollapseRecord {
+  DecimCollapse *collapses;
+  int collapses_len;
+  int collapses_alloc;
+  /** Lowest factor the collapses were recorded down to. */
+  float factor;
+  /** Nothing more could be collapsed, the collapses reach any factor. */
+  bool is_complete;
+};
 
-#ifdef USE_SYMMETRY
-  edge_symmetry_map = (use_symmetry) ? bm_edge_symmetry_map(bm, symmetry_axis, symmetry_eps) :
-                                       NULL;
-#else
-  UNUSED_VARS(symmetry_axis, symmetry_eps);
-#endif
+static void bm_decim_record_add(BMDecimateCollapseRecord *record,
+                                const int v_index[2],
+                                const float co[3],
+                                const bool is_mirror)
+{
+  if (record == NULL) {
+    return;
+  }
+  if (record->collapses_len == record->collapses_alloc) {
+    record->collapses_alloc = max_ii(record->collapses_alloc * 2, 1024);
+    record->collapses = MEM_reallocN(record->collapses,
+                                     sizeof(*record->collapses) * record->collapses_alloc);
+  }
+  DecimCollapse *collapse = &record->collapses[record->collapses_len++];
+  collapse->v_index[0] = v_index[0];
+  collapse->v_index[1] = v_index[1];
+  copy_v3_v3(collapse->co, co);
+  collapse->is_mirror = is_mirror;
+}
 
+static CD_UseFlag bm_decim_customdata_flag(BMesh *bm)
+{
+  CD_UseFlag customdata_flag = 0;
 #ifdef USE_CUSTOMDATA
-  /* initialize customdata flag, we only need math for loops */
+  /* we only need math for loops */
   if (CustomData_has_interp(&bm->vdata)) {
     customdata_flag |= CD_DO_VERT;
   }
@@ -1352,11 +1540,94 @@ void BM_mesh_decimate_collapse(BMesh *bm,
   if (CustomData_has_math(&bm->ldata)) {
     customdata_flag |= CD_DO_LOOP;
   }
+#else
+  UNUSED_VARS(bm);
+#endif
+  return customdata_flag;
+}
+
+/**
+ * \brief Begin an edge collapse decimation, the mesh isn't decimated until stepped.
+ *
+ * \param bm: The mesh, it must stay valid and unchanged until the decimation ends.
+ * \param vweights: Optional array of vertex  aligned weights [0 - 1],
+ *        a vertex group is the usual source for this.
+ *        Values are modified as vertices are collapsed.
+ * \param symmetry_axis: Axis of symmetry, -1 to disable mirror decimate.
+ * \param symmetry_eps: Threshold when matching mirror verts.
+ */
+BMDecimateCollapse *BM_mesh_decimate_collapse_begin(BMesh *bm,
+                                                    float *vweights,
+                                                    float vweight_factor,
+                                                    const int symmetry_axis,
+                                                    const float symmetry_eps)
+{
+  BMDecimateCollapse *dc = MEM_callocN(sizeof(*dc), __func__);
+
+  dc->bm = bm;
+  dc->vweights = vweights;
+  dc->vweight_factor = vweight_factor;
+
+#ifdef USE_TRIANGULATE
+  /* temp convert quads to triangles */
+  dc->use_triangulate = bm_decim_triangulate_begin(bm, &dc->edges_tri_tot);
 #endif
 
+  /* alloc vars */
+  dc->vquadrics = MEM_callocN(sizeof(Quadric) * bm->totvert, __func__);
+  /* since some edges may be degenerate, we might be over allocing a little here */
+  dc->eheap = BLI_heap_new_ex(bm->totedge);
+  dc->eheap_table = MEM_mallocN(sizeof(HeapNode *) * bm->totedge, __func__);
+  dc->tot_edge_orig = bm->totedge;
+
+  /* build initial edge collapse cost data */
+  bm_decim_build_quadrics(bm, dc->vquadrics);
+
+  bm_decim_build_edge_cost(
+      bm, dc->vquadrics, vweights, vweight_factor, dc->eheap, dc->eheap_table);
+
+  dc->face_tot_orig = bm->totface;
+  bm->elem_index_dirty |= BM_ALL;
+
+#ifdef USE_SYMMETRY
+  dc->symmetry_axis = symmetry_axis;
+  dc->edge_symmetry_map = (symmetry_axis != -1) ?
+                              bm_edge_symmetry_map(bm, symmetry_axis, symmetry_eps) :
+                              NULL;
+#else
+  UNUSED_VARS(symmetry_axis, symmetry_eps);
+#endif
+
+  dc->customdata_flag = bm_decim_customdata_flag(bm);
+
+  return dc;
+}
+
+/**
+ * \brief Collapse edges until the face count is at most \a factor times the original count.
+ *
+ * Steps continue from the previous one, so decimating to a lower factor
+ * gives exactly the same result as decimating to it in one step.
+ * Stepping to a higher factor than a previous step does nothing.
+ *
+ * \param factor: face count multiplier [0 - 1]
+ */
+void BM_mesh_decimate_collapse_step(BMDecimateCollapse *dc, const float factor)
+{
+  BMesh *bm = dc->bm;
+  Heap *eheap = dc->eheap;
+  HeapNode **eheap_table = dc->eheap_table;
+  Quadric *vquadrics = dc->vquadrics;
+  float *vweights = dc->vweights;
+  const float vweight_factor = dc->vweight_factor;
+  const CD_UseFlag customdata_flag = dc->customdata_flag;
+  const int face_tot_target = dc->face_tot_orig * factor;
+
   /* iterative edge collapse and maintain the eheap */
 #ifdef USE_SYMMETRY
-  if (use_symmetry == false)
+  int *edge_symmetry_map = dc->edge_symmetry_map;
+  const int symmetry_axis = dc->symmetry_axis;
+  if (edge_symmetry_map == NULL)
 #endif
   {
     /* simple non-mirror case */
@@ -1366,25 +1637,30 @@ void BM_mesh_decimate_collapse(BMesh *bm,
       BMEdge *e = BLI_heap_pop_min(eheap);
       float optimize_co[3];
       /* handy to detect corruptions elsewhere */
-      BLI_assert(BM_elem_index_get(e) < tot_edge_orig);
+      BLI_assert(BM_elem_index_get(e) < dc->tot_edge_orig);
 
       /* Under normal conditions wont be accessed again,
        * but NULL just in case so we don't use freed node. */
       eheap_table[BM_elem_index_get(e)] = NULL;
 
-      bm_decim_edge_collapse(bm,
-                             e,
-                             vquadrics,
-                             vweights,
-                             vweight_factor,
-                             eheap,
-                             eheap_table,
+      /* Read before collapsing, which removes 'e->v2'. */
+      const int v_index[2] = {BM_elem_index_get(e->v1), BM_elem_index_get(e->v2)};
+
+      if (bm_decim_edge_collapse(bm,
+                                 e,
+                                 vquadrics,
+                                 vweights,
+                                 vweight_factor,
+                                 eheap,
+                                 eheap_table,
 #ifdef USE_SYMMETRY
-                             edge_symmetry_map,
+                                 edge_symmetry_map,
 #endif
-                             customdata_flag,
-                             optimize_co,
-                             true);
+                                 customdata_flag,
+                                 optimize_co,
+                                 true)) {
+        bm_decim_record_add(dc->record, v_index, optimize_co, false);
+      }
     }
   }
 #ifdef USE_SYMMETRY
@@ -1405,7 +1681,7 @@ void BM_mesh_decimate_collapse(BMesh *bm,
       float optimize_co[3];
       char e_invalidate = 0;
 
-      BLI_assert(e_index < tot_edge_orig);
+      BLI_assert(e_index < dc->tot_edge_orig);
 
       eheap_table[e_index] = NULL;
 
@@ -1458,6 +1734,8 @@ void BM_mesh_decimate_collapse(BMesh *bm,
         }
       }
 
+      const int v_index[2] = {BM_elem_index_get(e->v1), BM_elem_index_get(e->v2)};
+
       if (bm_decim_edge_collapse(bm,
                                  e,
                                  vquadrics,
@@ -1469,22 +1747,30 @@ void BM_mesh_decimate_collapse(BMesh *bm,
                                  customdata_flag,
                                  optimize_co,
                                  false)) {
+        bm_decim_record_add(dc->record, v_index, optimize_co, false);
+
         if (e_mirr && (eheap_table[e_index_mirr])) {
           BLI_assert(e_index_mirr != e_index);
           BLI_heap_remove(eheap, eheap_table[e_index_mirr]);
           eheap_table[e_index_mirr] = NULL;
           optimize_co[symmetry_axis] *= -1.0f;
-          bm_decim_edge_collapse(bm,
-                                 e_mirr,
-                                 vquadrics,
-                                 vweights,
-                                 vweight_factor,
-                                 eheap,
-                                 eheap_table,
-                                 edge_symmetry_map,
-                                 customdata_flag,
-                                 optimize_co,
-                                 false);
+
+          const int v_index_mirr[2] = {BM_elem_index_get(e_mirr->v1),
+                                       BM_elem_index_get(e_mirr->v2)};
+
+          if (bm_decim_edge_collapse(bm,
+                                     e_mirr,
+                                     vquadrics,
+                                     vweights,
+                                     vweight_factor,
+                                     eheap,
+                                     eheap_table,
+                                     edge_symmetry_map,
+                                     customdata_flag,
+                                     optimize_co,
+                                     false)) {
+            bm_decim_record_add(dc->record, v_index_mirr, optimize_co, true);
+          }
         }
       }
       else {
@@ -1509,29 +1795,204 @@ void BM_mesh_decimate_collapse(BMesh *bm,
         bm_decim_invalid_edge_cost_single(e_mirr, eheap, eheap_table);
       }
     }
-
-    MEM_freeN((void *)edge_symmetry_map);
   }
 #endif /* USE_SYMMETRY */
 
+  if (dc->record) {
+    dc->record->factor = min_ff(dc->record->factor, factor);
+    /* Stopped before reaching the target, lower factors won't collapse more edges. */
+    if (bm->totface > face_tot_target) {
+      dc->record->is_complete = true;
+    }
+  }
+}
+
+/**
+ * End the decimation and free its state, the mesh remains.
+ *
+ * \param do_triangulate: Keep the faces triangulated,
+ * otherwise rejoin triangles from the faces which were triangulated on begin.
+ */
+void BM_mesh_decimate_collapse_end(BMDecimateCollapse *dc, const bool do_triangulate)
+{
 #ifdef USE_TRIANGULATE
   if (do_triangulate == false) {
     /* its possible we only had triangles, skip this step in that case */
-    if (LIKELY(use_triangulate)) {
+    if (LIKELY(dc->use_triangulate)) {
       /* temp convert quads to triangles */
-      bm_decim_triangulate_end(bm, edges_tri_tot);
+      bm_decim_triangulate_end(dc->bm, dc->edges_tri_tot);
     }
   }
+#else
+  UNUSED_VARS(do_triangulate);
 #endif
 
   /* free vars */
-  MEM_freeN(vquadrics);
-  MEM_freeN(eheap_table);
-  BLI_heap_free(eheap, NULL);
+#ifdef USE_SYMMETRY
+  MEM_SAFE_FREE(dc->edge_symmetry_map);
+#endif
+  MEM_freeN(dc->vquadrics);
+  MEM_freeN(dc->eheap_table);
+  BLI_heap_free(dc->eheap, NULL);
+  MEM_freeN(dc);
 
   /* testing only */
   // BM_mesh_validate(bm);
+}
+
+BMDecimateCollapseRecord *BM_mesh_decimate_collapse_record_new(void)
+{
+  BMDecimateCollapseRecord *record = MEM_callocN(sizeof(*record), __func__);
+  record->factor = 1.0f;
+  return record;
+}
+
+void BM_mesh_decimate_collapse_record_free(BMDecimateCollapseRecord *record)
+{
+  MEM_SAFE_FREE(record->collapses);
+  MEM_freeN(record);
+}
+
+/**
+ * Record the edge collapses of all following steps of the decimation,
+ * so decimating the same input to a factor recorded so far doesn't need the edge heap.
+ * Must be called before the first step, the record must outlive the decimation.
+ */
+void BM_mesh_decimate_collapse_record(BMDecimateCollapse *dc, BMDecimateCollapseRecord *record)
+{
+  BLI_assert(dc->record == NULL && record->collapses_len == 0);
+  dc->record = record;
+}
+
+/**
+ * Collapse an edge of a record, as #bm_decim_edge_collapse did without the quadrics and heap.
+ */
+static void bm_decim_edge_collapse_replay(BMesh *bm,
+                                          BMVert **vtable,
+                                          const DecimCollapse *collapse,
+                                          const CD_UseFlag customdata_flag)
+{
+  BMVert *v_other = vtable[collapse->v_index[0]];
+  BMVert *v_clear = vtable[collapse->v_index[1]];
+  BMEdge *e = BM_edge_exists(v_other, v_clear);
+  int e_clear_other[2];
+  float customdata_fac;
+
+  BLI_assert(e != NULL);
+
+#ifdef USE_VERT_NORMAL_INTERP
+  float v_clear_no[3];
+  copy_v3_v3(v_clear_no, v_clear->no);
+#endif
+
+  if (LIKELY(compare_v3v3(v_other->co, v_clear->co, FLT_EPSILON) == false)) {
+    customdata_fac = line_point_factor_v3(collapse->co, v_other->co, v_clear->co);
+  }
+  else {
+    customdata_fac = 0.5f;
+  }
+
+  if (!bm_edge_collapse(bm,
+                        e,
+                        v_clear,
+                        e_clear_other,
+#ifdef USE_SYMMETRY
+                        NULL,
+#endif
+                        customdata_flag,
+                        customdata_fac)) {
+    BLI_assert(!"recorded edge collapse failed");
+    return;
+  }
+
+  copy_v3_v3(v_other->co, collapse->co);
+
+#ifdef USE_VERT_NORMAL_INTERP
+  interp_v3_v3v3(v_other->no, v_other->no, v_clear_no, customdata_fac);
+  normalize_v3(v_other->no);
+#else
+  BM_vert_normal_update(v_other);
+#endif
+}
+
+/**
+ * \brief Decimate a mesh by replaying the start of a record,
+ * the result is the same as decimating it with #BM_mesh_decimate_collapse.
+ *
+ * \param bm: The mesh, it must match the one the record was made from,
+ * besides custom-data layers which are interpolated again.
+ * \param factor: face count multiplier [0 - 1]
+ * \return false when the record doesn't reach \a factor, the mesh is unchanged then.
+ */
+bool BM_mesh_decimate_collapse_replay(BMesh *bm,
+                                      const BMDecimateCollapseRecord *record,
+                                      const float factor,
+                                      const bool do_triangulate)
+{
+  if ((factor < record->factor) && !record->is_complete) {
+    return false;
+  }
+
+  /* Recorded collapses refer to vertices by index. */
+  BM_mesh_elem_index_ensure(bm, BM_VERT);
 
-  /* quiet release build warning */
-  (void)tot_edge_orig;
+#ifdef USE_TRIANGULATE
+  int edges_tri_tot = 0;
+  const bool use_triangulate = bm_decim_triangulate_begin(bm, &edges_tri_tot);
+#endif
+
+  const CD_UseFlag customdata_flag = bm_decim_customdata_flag(bm);
+  const int face_tot_target = bm->totface * factor;
+
+  BMVert **vtable = MEM_mallocN(sizeof(*vtable) * bm->totvert, __func__);
+  BMIter iter;
+  BMVert *v;
+  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+    vtable[BM_elem_index_get(v)] = v;
+  }
+
+  int i = 0;
+  while ((bm->totface > face_tot_target) && (i < record->collapses_len)) {
+    /* A mirror edge is collapsed in the same step as the edge before it. */
+    do {
+      bm_decim_edge_collapse_replay(bm, vtable, &record->collapses[i], customdata_flag);
+      i++;
+    } while ((i < record->collapses_len) && record->collapses[i].is_mirror);
+  }
+
+  MEM_freeN(vtable);
+  bm->elem_index_dirty |= BM_ALL;
+
+#ifdef USE_TRIANGULATE
+  if ((do_triangulate == false) && use_triangulate) {
+    bm_decim_triangulate_end(bm, edges_tri_tot);
+  }
+#else
+  UNUSED_VARS(do_triangulate);
+#endif
+
+  return true;
+}
+
+/**
+ * \brief BM_mesh_decimate
+ * \param bm: The mesh
+ * \param factor: face count multiplier [0 - 1]
+ * \param vweights: Optional array of vertex  aligned weights [0 - 1],
+ *        a vertex group is the usual source for this.
+ * \param symmetry_axis: Axis of symmetry, -1 to disable mirror decimate.
+ * \param symmetry_eps: Threshold when matching mirror verts.
+ */
+void BM_mesh_decimate_collapse(BMesh *bm,
+                               const float factor,
+                               float *vweights,
+                               float vweight_factor,
+                               const bool do_triangulate,
+                               const int symmetry_axis,
+                               const float symmetry_eps)
+{
+  BMDecimateCollapse *dc = BM_mesh_decimate_collapse_begin(
+      bm, vweights, vweight_factor, symmetry_axis, symmetry_eps);
+  BM_mesh_decimate_collapse_step(dc, factor);
+  BM_mesh_decimate_collapse_end(dc, do_triangulate);
 }
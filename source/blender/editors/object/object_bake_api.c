@@ -708,6 +708,290 @@ static Mesh *bake_mesh_new_from_object(Object *object)
   return me;
 }
 
+/* Allocate the images an object bakes into and count their pixels,
+ * returns false if the object can't be baked. */
+static bool bake_images_init(Main *bmain,
+                             Object *ob_low,
+                             BakeImages *bake_images,
+                             ReportList *reports,
+                             const bool is_save_internal,
+                             const bool is_split_materials,
+                             const int width,
+                             const int height,
+                             const char *uv_layer,
+                             size_t *r_num_pixels)
+{
+  int tot_materials = ob_low->totcol;
+
+  if (uv_layer && uv_layer[0] != '\0') {
+    Mesh *me = (Mesh *)ob_low->data;
+    if (CustomData_get_named_layer(&me->ldata, CD_MLOOPUV, uv_layer) == -1) {
+      BKE_reportf(reports,
+                  RPT_ERROR,
+                  "No UV layer named \"%s\" found in the object \"%s\"",
+                  uv_layer,
+                  ob_low->id.name + 2);
+      return false;
+    }
+  }
+
+  if (tot_materials == 0) {
+    if (is_save_internal) {
+      BKE_report(
+          reports, RPT_ERROR, "No active image found, add a material or bake to an external file");
+
+      return false;
+    }
+    else if (is_split_materials) {
+      BKE_report(
+          reports,
+          RPT_ERROR,
+          "No active image found, add a material or bake without the Split Materials option");
+
+      return false;
+    }
+    else {
+      /* baking externally without splitting materials */
+      tot_materials = 1;
+    }
+  }
+
+  /* we overallocate in case there is more materials than images */
+  bake_images->data = MEM_mallocN(sizeof(BakeImage) * tot_materials,
+                                  "bake images dimensions (width, height, offset)");
+  bake_images->lookup = MEM_mallocN(sizeof(int) * tot_materials,
+                                    "bake images lookup (from material to BakeImage)");
+
+  build_image_lookup(bmain, ob_low, bake_images);
+
+  if (is_save_internal) {
+    *r_num_pixels = init_internal_images(bake_images, reports);
+
+    if (*r_num_pixels == 0) {
+      return false;
+    }
+  }
+  else {
+    /* when saving externally always use the size specified in the UI */
+
+    const size_t num_pixels = (size_t)width * (size_t)height * bake_images->size;
+    *r_num_pixels = num_pixels;
+
+    for (int i = 0; i < bake_images->size; i++) {
+      bake_images->data[i].width = width;
+      bake_images->data[i].height = height;
+      bake_images->data[i].offset = (is_split_materials ? num_pixels : 0);
+      bake_images->data[i].image = NULL;
+    }
+
+    if (!is_split_materials) {
+      /* saving a single image */
+      for (int i = 0; i < tot_materials; i++) {
+        bake_images->lookup[i] = 0;
+      }
+    }
+  }
+
+  return true;
+}
+
+/* Convert baked world space normals to the requested space and swizzle. */
+static void bake_normal_space_convert(BakePixel *pixel_array_low,
+                                      const size_t num_pixels,
+                                      const int depth,
+                                      float *result,
+                                      Object *ob_low_eval,
+                                      Mesh *me_low,
+                                      BakeImages *bake_images,
+                                      const int normal_space,
+                                      const eBakeNormalSwizzle normal_swizzle[],
+                                      const bool is_selected_to_active,
+                                      const char *uv_layer)
+{
+  switch (normal_space) {
+    case R_BAKE_SPACE_WORLD: {
+      /* Cycles internal format */
+      if ((normal_swizzle[0] == R_BAKE_POSX) && (normal_swizzle[1] == R_BAKE_POSY) &&
+          (normal_swizzle[2] == R_BAKE_POSZ)) {
+        break;
+      }
+      RE_bake_normal_world_to_world(pixel_array_low, num_pixels, depth, result, normal_swizzle);
+      break;
+    }
+    case R_BAKE_SPACE_OBJECT: {
+      RE_bake_normal_world_to_object(
+          pixel_array_low, num_pixels, depth, result, ob_low_eval, normal_swizzle);
+      break;
+    }
+    case R_BAKE_SPACE_TANGENT: {
+      if (is_selected_to_active) {
+        RE_bake_normal_world_to_tangent(pixel_array_low,
+                                        num_pixels,
+                                        depth,
+                                        result,
+                                        me_low,
+                                        normal_swizzle,
+                                        ob_low_eval->obmat);
+      }
+      else {
+        /* from multiresolution */
+        Mesh *me_nores = NULL;
+        ModifierData *md = NULL;
+        int mode;
+
+        BKE_object_eval_reset(ob_low_eval);
+        md = BKE_modifiers_findby_type(ob_low_eval, eModifierType_Multires);
+
+        if (md) {
+          mode = md->mode;
+          md->mode &= ~eModifierMode_Render;
+        }
+
+        /* Evaluate modifiers again. */
+        me_nores = BKE_mesh_new_from_object(NULL, ob_low_eval, false);
+        RE_bake_pixels_populate(me_nores, pixel_array_low, num_pixels, bake_images, uv_layer);
+
+        RE_bake_normal_world_to_tangent(pixel_array_low,
+                                        num_pixels,
+                                        depth,
+                                        result,
+                                        me_nores,
+                                        normal_swizzle,
+                                        ob_low_eval->obmat);
+        BKE_id_free(NULL, &me_nores->id);
+
+        if (md) {
+          md->mode = mode;
+        }
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+/* Write the baked pixels of an object to its images, returns the operator result. */
+static int bake_write_images(Main *bmain,
+                             Scene *scene,
+                             ScrArea *area,
+                             ReportList *reports,
+                             Object *ob_low,
+                             Object *ob_low_eval,
+                             Mesh *me_low,
+                             BakeImages *bake_images,
+                             BakePixel *pixel_array_low,
+                             float *result,
+                             const int depth,
+                             const int margin,
+                             const bool is_save_internal,
+                             const bool is_clear,
+                             const bool is_split_materials,
+                             const bool is_automatic_name,
+                             const bool is_noncolor,
+                             const char *filepath,
+                             const char *identifier)
+{
+  int op_result = OPERATOR_CANCELLED;
+  bool ok;
+
+  for (int i = 0; i < bake_images->size; i++) {
+    BakeImage *bk_image = &bake_images->data[i];
+
+    if (is_save_internal) {
+      ok = write_internal_bake_pixels(bk_image->image,
+                                      pixel_array_low + bk_image->offset,
+                                      result + bk_image->offset * depth,
+                                      bk_image->width,
+                                      bk_image->height,
+                                      margin,
+                                      is_clear,
+                                      is_noncolor);
+
+      /* might be read by UI to set active image for display */
+      bake_update_image(area, bk_image->image);
+
+      if (!ok) {
+        BKE_reportf(reports,
+                    RPT_ERROR,
+                    "Problem saving the bake map internally for object \"%s\"",
+                    ob_low->id.name + 2);
+        op_result = OPERATOR_CANCELLED;
+      }
+      else {
+        BKE_report(reports,
+                   RPT_INFO,
+                   "Baking map saved to internal image, save it externally or pack it");
+        op_result = OPERATOR_FINISHED;
+      }
+    }
+    /* save externally */
+    else {
+      BakeData *bake = &scene->r.bake;
+      char name[FILE_MAX];
+
+      BKE_image_path_from_imtype(name,
+                                 filepath,
+                                 BKE_main_blendfile_path(bmain),
+                                 0,
+                                 bake->im_format.imtype,
+                                 true,
+                                 false,
+                                 NULL);
+
+      if (is_automatic_name) {
+        BLI_path_suffix(name, FILE_MAX, ob_low->id.name + 2, "_");
+        BLI_path_suffix(name, FILE_MAX, identifier, "_");
+      }
+
+      if (is_split_materials) {
+        if (bk_image->image) {
+          BLI_path_suffix(name, FILE_MAX, bk_image->image->id.name + 2, "_");
+        }
+        else {
+          if (ob_low_eval->mat[i]) {
+            BLI_path_suffix(name, FILE_MAX, ob_low_eval->mat[i]->id.name + 2, "_");
+          }
+          else if (me_low->mat[i]) {
+            BLI_path_suffix(name, FILE_MAX, me_low->mat[i]->id.name + 2, "_");
+          }
+          else {
+            /* if everything else fails, use the material index */
+            char tmp[5];
+            sprintf(tmp, "%d", i % 1000);
+            BLI_path_suffix(name, FILE_MAX, tmp, "_");
+          }
+        }
+      }
+
+      /* save it externally */
+      ok = write_external_bake_pixels(name,
+                                      pixel_array_low + bk_image->offset,
+                                      result + bk_image->offset * depth,
+                                      bk_image->width,
+                                      bk_image->height,
+                                      margin,
+                                      &bake->im_format,
+                                      is_noncolor);
+
+      if (!ok) {
+        BKE_reportf(reports, RPT_ERROR, "Problem saving baked map in \"%s\"", name);
+        op_result = OPERATOR_CANCELLED;
+      }
+      else {
+        BKE_reportf(reports, RPT_INFO, "Baking map written to \"%s\"", name);
+        op_result = OPERATOR_FINISHED;
+      }
+
+      if (!is_split_materials) {
+        break;
+      }
+    }
+  }
+
+  return op_result;
+}
+
 static int bake(Render *re,
                 Main *bmain,
                 Scene *scene,
@@ -769,7 +1053,6 @@ static int bake(Render *re,
   BakeImages bake_images = {NULL};
 
   size_t num_pixels;
-  int tot_materials;
 
   RE_bake_engine_set_engine_parameters(re, bmain, scene);
 
@@ -778,74 +1061,17 @@ static int bake(Render *re,
     goto cleanup;
   }
 
-  tot_materials = ob_low->totcol;
-
-  if (uv_layer && uv_layer[0] != '\0') {
-    Mesh *me = (Mesh *)ob_low->data;
-    if (CustomData_get_named_layer(&me->ldata, CD_MLOOPUV, uv_layer) == -1) {
-      BKE_reportf(reports,
-                  RPT_ERROR,
-                  "No UV layer named \"%s\" found in the object \"%s\"",
-                  uv_layer,
-                  ob_low->id.name + 2);
-      goto cleanup;
-    }
-  }
-
-  if (tot_materials == 0) {
-    if (is_save_internal) {
-      BKE_report(
-          reports, RPT_ERROR, "No active image found, add a material or bake to an external file");
-
-      goto cleanup;
-    }
-    else if (is_split_materials) {
-      BKE_report(
-          reports,
-          RPT_ERROR,
-          "No active image found, add a material or bake without the Split Materials option");
-
-      goto cleanup;
-    }
-    else {
-      /* baking externally without splitting materials */
-      tot_materials = 1;
-    }
-  }
-
-  /* we overallocate in case there is more materials than images */
-  bake_images.data = MEM_mallocN(sizeof(BakeImage) * tot_materials,
-                                 "bake images dimensions (width, height, offset)");
-  bake_images.lookup = MEM_mallocN(sizeof(int) * tot_materials,
-                                   "bake images lookup (from material to BakeImage)");
-
-  build_image_lookup(bmain, ob_low, &bake_images);
-
-  if (is_save_internal) {
-    num_pixels = init_internal_images(&bake_images, reports);
-
-    if (num_pixels == 0) {
-      goto cleanup;
-    }
-  }
-  else {
-    /* when saving externally always use the size specified in the UI */
-
-    num_pixels = (size_t)width * (size_t)height * bake_images.size;
-
-    for (int i = 0; i < bake_images.size; i++) {
-      bake_images.data[i].width = width;
-      bake_images.data[i].height = height;
-      bake_images.data[i].offset = (is_split_materials ? num_pixels : 0);
-      bake_images.data[i].image = NULL;
-    }
-
-    if (!is_split_materials) {
-      /* saving a single image */
-      for (int i = 0; i < tot_materials; i++) {
-        bake_images.lookup[i] = 0;
-      }
-    }
+  if (!bake_images_init(bmain,
+                        ob_low,
+                        &bake_images,
+                        reports,
+                        is_save_internal,
+                        is_split_materials,
+                        width,
+                        height,
+                        uv_layer,
+                        &num_pixels)) {
+    goto cleanup;
   }
 
   if (is_selected_to_active) {
@@ -1051,67 +1277,17 @@ static int bake(Render *re,
   /* normal space conversion
    * the normals are expected to be in world space, +X +Y +Z */
   if (ok && pass_type == SCE_PASS_NORMAL) {
-    switch (normal_space) {
-      case R_BAKE_SPACE_WORLD: {
-        /* Cycles internal format */
-        if ((normal_swizzle[0] == R_BAKE_POSX) && (normal_swizzle[1] == R_BAKE_POSY) &&
-            (normal_swizzle[2] == R_BAKE_POSZ)) {
-          break;
-        }
-        RE_bake_normal_world_to_world(pixel_array_low, num_pixels, depth, result, normal_swizzle);
-        break;
-      }
-      case R_BAKE_SPACE_OBJECT: {
-        RE_bake_normal_world_to_object(
-            pixel_array_low, num_pixels, depth, result, ob_low_eval, normal_swizzle);
-        break;
-      }
-      case R_BAKE_SPACE_TANGENT: {
-        if (is_selected_to_active) {
-          RE_bake_normal_world_to_tangent(pixel_array_low,
-                                          num_pixels,
-                                          depth,
-                                          result,
-                                          me_low,
-                                          normal_swizzle,
-                                          ob_low_eval->obmat);
-        }
-        else {
-          /* from multiresolution */
-          Mesh *me_nores = NULL;
-          ModifierData *md = NULL;
-          int mode;
-
-          BKE_object_eval_reset(ob_low_eval);
-          md = BKE_modifiers_findby_type(ob_low_eval, eModifierType_Multires);
-
-          if (md) {
-            mode = md->mode;
-            md->mode &= ~eModifierMode_Render;
-          }
-
-          /* Evaluate modifiers again. */
-          me_nores = BKE_mesh_new_from_object(NULL, ob_low_eval, false);
-          RE_bake_pixels_populate(me_nores, pixel_array_low, num_pixels, &bake_images, uv_layer);
-
-          RE_bake_normal_world_to_tangent(pixel_array_low,
-                                          num_pixels,
-                                          depth,
-                                          result,
-                                          me_nores,
-                                          normal_swizzle,
-                                          ob_low_eval->obmat);
-          BKE_id_free(NULL, &me_nores->id);
-
-          if (md) {
-            md->mode = mode;
-          }
-        }
-        break;
-      }
-      default:
-        break;
-    }
+    bake_normal_space_convert(pixel_array_low,
+                              num_pixels,
+                              depth,
+                              result,
+                              ob_low_eval,
+                              me_low,
+                              &bake_images,
+                              normal_space,
+                              normal_swizzle,
+                              is_selected_to_active,
+                              uv_layer);
   }
 
   if (!ok) {
@@ -1119,100 +1295,25 @@ static int bake(Render *re,
     op_result = OPERATOR_CANCELLED;
   }
   else {
-    /* save the results */
-    for (int i = 0; i < bake_images.size; i++) {
-      BakeImage *bk_image = &bake_images.data[i];
-
-      if (is_save_internal) {
-        ok = write_internal_bake_pixels(bk_image->image,
-                                        pixel_array_low + bk_image->offset,
-                                        result + bk_image->offset * depth,
-                                        bk_image->width,
-                                        bk_image->height,
-                                        margin,
-                                        is_clear,
-                                        is_noncolor);
-
-        /* might be read by UI to set active image for display */
-        bake_update_image(area, bk_image->image);
-
-        if (!ok) {
-          BKE_reportf(reports,
-                      RPT_ERROR,
-                      "Problem saving the bake map internally for object \"%s\"",
-                      ob_low->id.name + 2);
-          op_result = OPERATOR_CANCELLED;
-        }
-        else {
-          BKE_report(reports,
-                     RPT_INFO,
-                     "Baking map saved to internal image, save it externally or pack it");
-          op_result = OPERATOR_FINISHED;
-        }
-      }
-      /* save externally */
-      else {
-        BakeData *bake = &scene->r.bake;
-        char name[FILE_MAX];
-
-        BKE_image_path_from_imtype(name,
-                                   filepath,
-                                   BKE_main_blendfile_path(bmain),
-                                   0,
-                                   bake->im_format.imtype,
-                                   true,
-                                   false,
-                                   NULL);
-
-        if (is_automatic_name) {
-          BLI_path_suffix(name, FILE_MAX, ob_low->id.name + 2, "_");
-          BLI_path_suffix(name, FILE_MAX, identifier, "_");
-        }
-
-        if (is_split_materials) {
-          if (bk_image->image) {
-            BLI_path_suffix(name, FILE_MAX, bk_image->image->id.name + 2, "_");
-          }
-          else {
-            if (ob_low_eval->mat[i]) {
-              BLI_path_suffix(name, FILE_MAX, ob_low_eval->mat[i]->id.name + 2, "_");
-            }
-            else if (me_low->mat[i]) {
-              BLI_path_suffix(name, FILE_MAX, me_low->mat[i]->id.name + 2, "_");
-            }
-            else {
-              /* if everything else fails, use the material index */
-              char tmp[5];
-              sprintf(tmp, "%d", i % 1000);
-              BLI_path_suffix(name, FILE_MAX, tmp, "_");
-            }
-          }
-        }
-
-        /* save it externally */
-        ok = write_external_bake_pixels(name,
-                                        pixel_array_low + bk_image->offset,
-                                        result + bk_image->offset * depth,
-                                        bk_image->width,
-                                        bk_image->height,
-                                        margin,
-                                        &bake->im_format,
-                                        is_noncolor);
-
-        if (!ok) {
-          BKE_reportf(reports, RPT_ERROR, "Problem saving baked map in \"%s\"", name);
-          op_result = OPERATOR_CANCELLED;
-        }
-        else {
-          BKE_reportf(reports, RPT_INFO, "Baking map written to \"%s\"", name);
-          op_result = OPERATOR_FINISHED;
-        }
-
-        if (!is_split_materials) {
-          break;
-        }
-      }
-    }
+    op_result = bake_write_images(bmain,
+                                  scene,
+                                  area,
+                                  reports,
+                                  ob_low,
+                                  ob_low_eval,
+                                  me_low,
+                                  &bake_images,
+                                  pixel_array_low,
+                                  result,
+                                  depth,
+                                  margin,
+                                  is_save_internal,
+                                  is_clear,
+                                  is_split_materials,
+                                  is_automatic_name,
+                                  is_noncolor,
+                                  filepath,
+                                  identifier);
   }
 
   if (is_save_internal) {
@@ -1267,6 +1368,231 @@ cleanup:
   return op_result;
 }
 
+/* Object baked together with other objects by bake_multi_object(). */
+typedef struct BakeTarget {
+  Object *ob;
+  Object *ob_eval;
+  Mesh *me;
+
+  BakeImages bake_images;
+  size_t num_pixels;
+  /* Pixels and result of the object in the arrays of all objects. */
+  BakePixel *pixel_array;
+  float *result;
+
+  MultiresModifierData *mmd;
+  int mmd_flags;
+} BakeTarget;
+
+/* Bake all selected objects into their own images with a single pass of the render engine.
+ * The pixels of all objects are stored one after the other in rows of the widest image, which
+ * the engine bakes as a single image. This way the scene is synchronized once and the pixels of
+ * all objects are scheduled together, and each object reads its pixels and results in place.
+ * Images shared by objects are cleared before baking, not when writing the pixels of each
+ * object. */
+static int bake_multi_object(BakeAPIRender *bkr)
+{
+  Depsgraph *depsgraph = DEG_graph_new(bkr->main, bkr->scene, bkr->view_layer, DAG_EVAL_RENDER);
+  DEG_graph_build_from_view_layer(depsgraph);
+
+  int op_result = OPERATOR_CANCELLED;
+
+  const bool is_save_internal = (bkr->save_mode == R_BAKE_SAVE_INTERNAL);
+  const bool is_noncolor = is_noncolor_pass(bkr->pass_type);
+  const int depth = RE_pass_depth(bkr->pass_type);
+
+  const int num_targets = BLI_listbase_count(&bkr->selected_objects);
+  BakeTarget *targets = MEM_callocN(sizeof(BakeTarget) * num_targets, "bake targets");
+  Object **objects_eval = MEM_callocN(sizeof(Object *) * num_targets, "bake objects");
+
+  BakePixel *pixel_array = NULL;
+  float *result = NULL;
+  int width = 1, height;
+  size_t num_pixels = 0, offset;
+
+  RE_bake_engine_set_engine_parameters(bkr->render, bkr->main, bkr->scene);
+
+  CollectionPointerLink *link;
+  int i;
+
+  for (link = bkr->selected_objects.first, i = 0; link; link = link->next, i++) {
+    BakeTarget *target = &targets[i];
+    target->ob = link->ptr.data;
+
+    if (!bake_images_init(bkr->main,
+                          target->ob,
+                          &target->bake_images,
+                          bkr->reports,
+                          is_save_internal,
+                          bkr->is_split_materials,
+                          bkr->width,
+                          bkr->height,
+                          bkr->uv_layer,
+                          &target->num_pixels)) {
+      goto cleanup;
+    }
+
+    /* for multires bake, use linear UV subdivision to match low res UVs */
+    if (bkr->pass_type == SCE_PASS_NORMAL && bkr->normal_space == R_BAKE_SPACE_TANGENT) {
+      target->mmd = (MultiresModifierData *)BKE_modifiers_findby_type(target->ob,
+                                                                       eModifierType_Multires);
+      if (target->mmd) {
+        target->mmd_flags = target->mmd->flags;
+        target->mmd->uv_smooth = SUBSURF_UV_SMOOTH_NONE;
+      }
+    }
+  }
+
+  /* Make sure depsgraph is up to date. */
+  BKE_scene_graph_update_tagged(depsgraph, bkr->main);
+
+  for (i = 0; i < num_targets; i++) {
+    BakeTarget *target = &targets[i];
+
+    for (int j = 0; j < target->bake_images.size; j++) {
+      width = MAX2(width, target->bake_images.data[j].width);
+    }
+    num_pixels += target->num_pixels;
+  }
+
+  /* Pixels after the last object fill up the last row. */
+  height = (int)((num_pixels + width - 1) / width);
+  pixel_array = MEM_mallocN(sizeof(BakePixel) * width * height, "bake pixels multi object");
+  result = MEM_callocN(sizeof(float) * depth * width * height, "bake return pixels multi object");
+
+  for (size_t p = num_pixels; p < (size_t)width * height; p++) {
+    pixel_array[p].primitive_id = -1;
+    pixel_array[p].object_id = -1;
+  }
+
+  offset = 0;
+
+  for (i = 0; i < num_targets; i++) {
+    BakeTarget *target = &targets[i];
+
+    /* If an object is not renderable it should have failed long ago. */
+    target->ob_eval = DEG_get_evaluated_object(depsgraph, target->ob);
+    BLI_assert((target->ob_eval->restrictflag & OB_RESTRICT_RENDER) == 0);
+    objects_eval[i] = target->ob_eval;
+
+    /* get the mesh as it arrives in the renderer */
+    target->me = bake_mesh_new_from_object(target->ob_eval);
+
+    target->pixel_array = pixel_array + offset;
+    target->result = result + offset * depth;
+    offset += target->num_pixels;
+
+    RE_bake_pixels_populate(
+        target->me, target->pixel_array, target->num_pixels, &target->bake_images, bkr->uv_layer);
+
+    for (size_t p = 0; p < target->num_pixels; p++) {
+      BakePixel *pixel = &target->pixel_array[p];
+      pixel->object_id = (pixel->primitive_id == -1) ? -1 : i;
+    }
+  }
+
+  if (!RE_bake_engine_multi_object(bkr->render,
+                                   depsgraph,
+                                   objects_eval,
+                                   num_targets,
+                                   pixel_array,
+                                   width,
+                                   height,
+                                   depth,
+                                   bkr->pass_type,
+                                   bkr->pass_filter,
+                                   result)) {
+    BKE_report(bkr->reports, RPT_ERROR, "Problem baking selected objects");
+    goto cleanup;
+  }
+
+  op_result = OPERATOR_FINISHED;
+
+  for (i = 0; i < num_targets; i++) {
+    BakeTarget *target = &targets[i];
+
+    /* normal space conversion
+     * the normals are expected to be in world space, +X +Y +Z */
+    if (bkr->pass_type == SCE_PASS_NORMAL) {
+      bake_normal_space_convert(target->pixel_array,
+                                target->num_pixels,
+                                depth,
+                                target->result,
+                                target->ob_eval,
+                                target->me,
+                                &target->bake_images,
+                                bkr->normal_space,
+                                bkr->normal_swizzle,
+                                false,
+                                bkr->uv_layer);
+    }
+
+    if (bake_write_images(bkr->main,
+                          bkr->scene,
+                          bkr->area,
+                          bkr->reports,
+                          target->ob,
+                          target->ob_eval,
+                          target->me,
+                          &target->bake_images,
+                          target->pixel_array,
+                          target->result,
+                          depth,
+                          bkr->margin,
+                          is_save_internal,
+                          false,
+                          bkr->is_split_materials,
+                          bkr->is_automatic_name,
+                          is_noncolor,
+                          bkr->filepath,
+                          bkr->identifier) == OPERATOR_CANCELLED) {
+      op_result = OPERATOR_CANCELLED;
+    }
+
+    if (is_save_internal) {
+      refresh_images(&target->bake_images);
+    }
+  }
+
+cleanup:
+
+  for (i = 0; i < num_targets; i++) {
+    BakeTarget *target = &targets[i];
+
+    if (target->mmd) {
+      target->mmd->flags = target->mmd_flags;
+    }
+
+    MEM_SAFE_FREE(target->bake_images.data);
+    MEM_SAFE_FREE(target->bake_images.lookup);
+
+    if (target->me != NULL) {
+      BKE_id_free(NULL, &target->me->id);
+    }
+  }
+
+  MEM_freeN(targets);
+  MEM_freeN(objects_eval);
+  MEM_SAFE_FREE(pixel_array);
+  MEM_SAFE_FREE(result);
+
+  DEG_graph_free(depsgraph);
+
+  return op_result;
+}
+
+/* Whether the selected objects can be baked with a single pass of the render engine. */
+static bool bake_use_multi_object(BakeAPIRender *bkr)
+{
+  if (bkr->is_selected_to_active || BLI_listbase_is_single(&bkr->selected_objects) ||
+      bkr->save_mode != R_BAKE_SAVE_INTERNAL) {
+    return false;
+  }
+
+  RE_bake_engine_set_engine_parameters(bkr->render, bkr->main, bkr->scene);
+  return RE_bake_has_engine_multi_object(bkr->render);
+}
+
 static void bake_init_api_data(wmOperator *op, bContext *C, BakeAPIRender *bkr)
 {
   bool is_save_internal;
@@ -1392,6 +1718,9 @@ static int bake_exec(bContext *C, wmOperator *op)
                   bkr.area,
                   bkr.uv_layer);
   }
+  else if (bake_use_multi_object(&bkr)) {
+    result = bake_multi_object(&bkr);
+  }
   else {
     CollectionPointerLink *link;
     const bool is_clear = bkr.is_clear && BLI_listbase_is_single(&bkr.selected_objects);
@@ -1495,6 +1824,9 @@ static void bake_startjob(void *bkv, short *UNUSED(stop), short *do_update, floa
                        bkr->area,
                        bkr->uv_layer);
   }
+  else if (bake_use_multi_object(bkr)) {
+    bkr->result = bake_multi_object(bkr);
+  }
   else {
     CollectionPointerLink *link;
     const bool is_clear = bkr->is_clear && BLI_listbase_is_single(&bkr->selected_objects);
@@ -24,6 +24,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_string.h"
 
 #include "BLT_translation.h"
 
@@ -36,6 +37,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BKE_context.h"
+#include "BKE_customdata.h"
 #include "BKE_deform.h"
 #include "BKE_mesh.h"
 #include "BKE_screen.h"
@@ -60,6 +62,74 @@
 #include "MOD_ui_common.h"
 #include "MOD_util.h"
 
+/**
+ * Collapse decimation kept between evaluations. The edge collapses are recorded down to the
+ * lowest ratio used so far, any higher ratio is decimated by replaying the start of the record
+ * on the input mesh, without building the quadrics and the edge heap again.
+ */
+typedef struct DecimateRuntimeData {
+  /** Settings (besides the ratio and triangulation) the record was made with. */
+  short flag;
+  char symmetry_axis;
+  float defgrp_factor;
+  char defgrp_name[64];
+  int input_totvert, input_totedge, input_totpoly, input_totloop;
+  /**
+   * Copy of the input the collapse order depends on, only kept with modifiers before this one,
+   * otherwise the depsgraph tags of the object data tell if the input changed.
+   */
+  float (*input_co)[3];
+  int (*input_edges)[2];
+  int *input_loop_verts;
+  int (*input_polys)[2];
+  float *input_vweights;
+  /** Decimation the record is extended with, when the ratio is lowered. */
+  BMesh *bm;
+  BMDecimateCollapse *decimate;
+  BMDecimateCollapseRecord *record;
+  /** Owned by the decimation, modified as vertices collapse. */
+  float *vweights;
+} DecimateRuntimeData;
+
+static void decimate_runtime_clear(DecimateRuntimeData *runtime_data)
+{
+  if (runtime_data->decimate != NULL) {
+    /* Keep triangles, the mesh is freed anyway. */
+    BM_mesh_decimate_collapse_end(runtime_data->decimate, true);
+    runtime_data->decimate = NULL;
+  }
+  if (runtime_data->record != NULL) {
+    BM_mesh_decimate_collapse_record_free(runtime_data->record);
+    runtime_data->record = NULL;
+  }
+  if (runtime_data->bm != NULL) {
+    BM_mesh_free(runtime_data->bm);
+    runtime_data->bm = NULL;
+  }
+  MEM_SAFE_FREE(runtime_data->vweights);
+  MEM_SAFE_FREE(runtime_data->input_co);
+  MEM_SAFE_FREE(runtime_data->input_edges);
+  MEM_SAFE_FREE(runtime_data->input_loop_verts);
+  MEM_SAFE_FREE(runtime_data->input_polys);
+  MEM_SAFE_FREE(runtime_data->input_vweights);
+}
+
+static void freeRuntimeData(void *runtime_data_v)
+{
+  if (runtime_data_v == NULL) {
+    return;
+  }
+  DecimateRuntimeData *runtime_data = (DecimateRuntimeData *)runtime_data_v;
+  decimate_runtime_clear(runtime_data);
+  MEM_freeN(runtime_data);
+}
+
+static void freeData(ModifierData *md)
+{
+  freeRuntimeData(md->runtime);
+  md->runtime = NULL;
+}
+
 static void initData(ModifierData *md)
 {
   DecimateModifierData *dmd = (DecimateModifierData *)md;
@@ -101,6 +171,203 @@ static void updateFaceCount(const ModifierEvalContext *ctx,
   }
 }
 
+static bool decimate_has_modifiers_before(const DecimateModifierData *dmd)
+{
+  for (const ModifierData *md = dmd->modifier.prev; md != NULL; md = md->prev) {
+    if (md->mode & eModifierMode_Realtime) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Copy what the order of edge collapses depends on: vertex positions, topology and weights.
+ * Custom-data layers such as UV's are interpolated again when replaying.
+ */
+static void decimate_input_store(DecimateRuntimeData *runtime_data,
+                                 const Mesh *mesh,
+                                 const float *vweights)
+{
+  runtime_data->input_co = MEM_malloc_arrayN(mesh->totvert, sizeof(float[3]), __func__);
+  for (int i = 0; i < mesh->totvert; i++) {
+    copy_v3_v3(runtime_data->input_co[i], mesh->mvert[i].co);
+  }
+  runtime_data->input_edges = MEM_malloc_arrayN(mesh->totedge, sizeof(int[2]), __func__);
+  for (int i = 0; i < mesh->totedge; i++) {
+    runtime_data->input_edges[i][0] = mesh->medge[i].v1;
+    runtime_data->input_edges[i][1] = mesh->medge[i].v2;
+  }
+  runtime_data->input_loop_verts = MEM_malloc_arrayN(mesh->totloop, sizeof(int), __func__);
+  for (int i = 0; i < mesh->totloop; i++) {
+    runtime_data->input_loop_verts[i] = mesh->mloop[i].v;
+  }
+  runtime_data->input_polys = MEM_malloc_arrayN(mesh->totpoly, sizeof(int[2]), __func__);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    runtime_data->input_polys[i][0] = mesh->mpoly[i].loopstart;
+    runtime_data->input_polys[i][1] = mesh->mpoly[i].totloop;
+  }
+  if (vweights) {
+    runtime_data->input_vweights = MEM_dupallocN(vweights);
+  }
+}
+
+static bool decimate_input_matches_stored(const DecimateRuntimeData *runtime_data,
+                                          const Mesh *mesh,
+                                          const float *vweights)
+{
+  for (int i = 0; i < mesh->totvert; i++) {
+    if (!equals_v3v3(runtime_data->input_co[i], mesh->mvert[i].co)) {
+      return false;
+    }
+  }
+  for (int i = 0; i < mesh->totedge; i++) {
+    if ((runtime_data->input_edges[i][0] != mesh->medge[i].v1) ||
+        (runtime_data->input_edges[i][1] != mesh->medge[i].v2)) {
+      return false;
+    }
+  }
+  for (int i = 0; i < mesh->totloop; i++) {
+    if (runtime_data->input_loop_verts[i] != mesh->mloop[i].v) {
+      return false;
+    }
+  }
+  for (int i = 0; i < mesh->totpoly; i++) {
+    if ((runtime_data->input_polys[i][0] != mesh->mpoly[i].loopstart) ||
+        (runtime_data->input_polys[i][1] != mesh->mpoly[i].totloop)) {
+      return false;
+    }
+  }
+  if ((vweights == NULL) != (runtime_data->input_vweights == NULL)) {
+    return false;
+  }
+  return (vweights == NULL) ||
+         (memcmp(vweights, runtime_data->input_vweights, sizeof(float) * mesh->totvert) == 0);
+}
+
+/**
+ * Whether the input is the one the record was made from. When the input is the object data
+ * itself, the mesh data-block is tagged for update whenever it is edited, including shape key
+ * and vertex group changes, and the tags are cleared after each update. Modifiers before this
+ * one can depend on anything, so their result is compared with a copy instead.
+ */
+static bool decimate_input_unchanged(const DecimateRuntimeData *runtime_data,
+                                     const DecimateModifierData *dmd,
+                                     const ModifierEvalContext *ctx,
+                                     const Mesh *mesh,
+                                     const float *vweights)
+{
+  if ((runtime_data->input_totvert != mesh->totvert) ||
+      (runtime_data->input_totedge != mesh->totedge) ||
+      (runtime_data->input_totpoly != mesh->totpoly) ||
+      (runtime_data->input_totloop != mesh->totloop)) {
+    return false;
+  }
+  /* The record may have been made with or without the modifiers before this one. */
+  const bool has_modifiers_before = decimate_has_modifiers_before(dmd);
+  if (has_modifiers_before != (runtime_data->input_co != NULL)) {
+    return false;
+  }
+  if (has_modifiers_before) {
+    return decimate_input_matches_stored(runtime_data, mesh, vweights);
+  }
+  const ID *ob_data = ctx->object->data;
+  return (ob_data != NULL) && (ob_data->recalc & ID_RECALC_ALL) == 0;
+}
+
+static bool decimate_runtime_settings_match(const DecimateRuntimeData *runtime_data,
+                                            const DecimateModifierData *dmd)
+{
+  /* Triangulation is only applied after collapsing. */
+  return ((runtime_data->flag & ~MOD_DECIM_FLAG_TRIANGULATE) ==
+          (dmd->flag & ~MOD_DECIM_FLAG_TRIANGULATE)) &&
+         (runtime_data->symmetry_axis == dmd->symmetry_axis) &&
+         (runtime_data->defgrp_factor == dmd->defgrp_factor) &&
+         STREQ(runtime_data->defgrp_name, dmd->defgrp_name);
+}
+
+static BMesh *decimate_mesh_to_bmesh(Mesh *mesh, const bool calc_face_normal)
+{
+  return BKE_mesh_to_bmesh_ex(mesh,
+                              &(struct BMeshCreateParams){0},
+                              &(struct BMeshFromMeshParams){
+                                  .calc_face_normal = calc_face_normal,
+                                  .cd_mask_extra = {.vmask = CD_MASK_ORIGINDEX,
+                                                    .emask = CD_MASK_ORIGINDEX,
+                                                    .pmask = CD_MASK_ORIGINDEX},
+                              });
+}
+
+/**
+ * Collapse decimation which keeps a record of the edge collapses in the modifier run-time data.
+ * Lowering the ratio below what was recorded continues the decimation the record was made
+ * with, the result is always replayed on the input mesh.
+ *
+ * \param vweights: Ownership is taken.
+ */
+static Mesh *decimate_collapse_replay(DecimateModifierData *dmd,
+                                      const ModifierEvalContext *ctx,
+                                      Mesh *mesh,
+                                      float *vweights)
+{
+  DecimateRuntimeData *runtime_data = (DecimateRuntimeData *)dmd->modifier.runtime;
+  if (runtime_data == NULL) {
+    runtime_data = MEM_callocN(sizeof(*runtime_data), __func__);
+    dmd->modifier.runtime = runtime_data;
+  }
+
+  const bool use_record = (runtime_data->record != NULL) &&
+                          decimate_runtime_settings_match(runtime_data, dmd) &&
+                          decimate_input_unchanged(runtime_data, dmd, ctx, mesh, vweights);
+
+  if (use_record) {
+    if (vweights) {
+      MEM_freeN(vweights);
+    }
+  }
+  else {
+    decimate_runtime_clear(runtime_data);
+
+    const int symmetry_axis = (dmd->flag & MOD_DECIM_FLAG_SYMMETRY) ? dmd->symmetry_axis : -1;
+    const float symmetry_eps = 0.00002f;
+
+    runtime_data->flag = dmd->flag;
+    runtime_data->symmetry_axis = dmd->symmetry_axis;
+    runtime_data->defgrp_factor = dmd->defgrp_factor;
+    STRNCPY(runtime_data->defgrp_name, dmd->defgrp_name);
+    runtime_data->input_totvert = mesh->totvert;
+    runtime_data->input_totedge = mesh->totedge;
+    runtime_data->input_totpoly = mesh->totpoly;
+    runtime_data->input_totloop = mesh->totloop;
+    if (decimate_has_modifiers_before(dmd)) {
+      decimate_input_store(runtime_data, mesh, vweights);
+    }
+    runtime_data->vweights = vweights;
+    runtime_data->bm = decimate_mesh_to_bmesh(mesh, true);
+    runtime_data->decimate = BM_mesh_decimate_collapse_begin(
+        runtime_data->bm, vweights, dmd->defgrp_factor, symmetry_axis, symmetry_eps);
+    runtime_data->record = BM_mesh_decimate_collapse_record_new();
+    BM_mesh_decimate_collapse_record(runtime_data->decimate, runtime_data->record);
+  }
+
+  /* Does nothing when the ratio is already recorded. */
+  BM_mesh_decimate_collapse_step(runtime_data->decimate, dmd->percent);
+
+  const bool do_triangulate = (dmd->flag & MOD_DECIM_FLAG_TRIANGULATE) != 0;
+  BMesh *bm = decimate_mesh_to_bmesh(mesh, true);
+  const bool ok = BM_mesh_decimate_collapse_replay(
+      bm, runtime_data->record, dmd->percent, do_triangulate);
+  BLI_assert(ok);
+  UNUSED_VARS_NDEBUG(ok);
+
+  updateFaceCount(ctx, dmd, bm->totface);
+
+  Mesh *result = BKE_mesh_from_bmesh_for_eval_nomain(bm, NULL, mesh);
+  BM_mesh_free(bm);
+
+  return result;
+}
+
 static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *meshData)
 {
   DecimateModifierData *dmd = (DecimateModifierData *)md;
@@ -171,14 +438,22 @@ static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *
     }
   }
 
-  bm = BKE_mesh_to_bmesh_ex(mesh,
-                            &(struct BMeshCreateParams){0},
-                            &(struct BMeshFromMeshParams){
-                                .calc_face_normal = calc_face_normal,
-                                .cd_mask_extra = {.vmask = CD_MASK_ORIGINDEX,
-                                                  .emask = CD_MASK_ORIGINDEX,
-                                                  .pmask = CD_MASK_ORIGINDEX},
-                            });
+  if (dmd->mode == MOD_DECIM_MODE_COLLAPSE) {
+    /* Only keep the record for interactive changes of the ratio. */
+    if (ctx->flag & MOD_APPLY_USECACHE) {
+      result = decimate_collapse_replay(dmd, ctx, mesh, vweights);
+#ifdef USE_TIMEIT
+      TIMEIT_END(decim);
+#endif
+      result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+      return result;
+    }
+  }
+
+  /* Don't hold on to memory which isn't used. */
+  freeData(md);
+
+  bm = decimate_mesh_to_bmesh(mesh, calc_face_normal);
 
   switch (dmd->mode) {
     case MOD_DECIM_MODE_COLLAPSE: {
@@ -304,14 +579,14 @@ ModifierTypeInfo modifierType_Decimate = {
 
     /* initData */ initData,
     /* requiredDataMask */ requiredDataMask,
-    /* freeData */ NULL,
+    /* freeData */ freeData,
     /* isDisabled */ NULL,
     /* updateDepsgraph */ NULL,
     /* dependsOnTime */ NULL,
     /* dependsOnNormals */ NULL,
     /* foreachIDLink */ NULL,
     /* foreachTexLink */ NULL,
-    /* freeRuntimeData */ NULL,
+    /* freeRuntimeData */ freeRuntimeData,
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ NULL,
@@ -68,8 +68,76 @@ static void initData(ModifierData *md)
   MEMCPY_STRUCT_AFTER(rmd, DNA_struct_default_get(RemeshModifierData), modifier);
 }
 
+/**
+ * Voxel mode level set kept between evaluations,
+ * so tweaking the adaptivity doesn't convert the input mesh again.
+ */
+typedef struct RemeshRuntimeData {
+  int input_totvert, input_totpoly;
+  struct MeshRemeshVoxelCache *voxel_cache;
+} RemeshRuntimeData;
+
+static void freeRuntimeData(void *runtime_data_v)
+{
+  if (runtime_data_v == NULL) {
+    return;
+  }
+  RemeshRuntimeData *runtime_data = (RemeshRuntimeData *)runtime_data_v;
+  BKE_mesh_remesh_voxel_cache_free(runtime_data->voxel_cache);
+  MEM_freeN(runtime_data);
+}
+
+static void freeData(ModifierData *md)
+{
+  freeRuntimeData(md->runtime);
+  md->runtime = NULL;
+}
+
 #ifdef WITH_MOD_REMESH
 
+/**
+ * The depsgraph doesn't tell apart a direct update of the object from one flushed from its
+ * dependencies, so only a modifier evaluated on the unchanged original mesh data can tell its
+ * input is the same as in the previous evaluation.
+ */
+static bool remesh_input_maybe_changed(const RemeshModifierData *rmd,
+                                       const ModifierEvalContext *ctx)
+{
+  for (const ModifierData *md = rmd->modifier.prev; md != NULL; md = md->prev) {
+    if (md->mode & eModifierMode_Realtime) {
+      return true;
+    }
+  }
+  const ID *ob_data = ctx->object->data;
+  return (ob_data == NULL) || (ob_data->recalc & ID_RECALC_ALL) != 0;
+}
+
+static Mesh *remesh_voxel_cached(RemeshModifierData *rmd,
+                                 const ModifierEvalContext *ctx,
+                                 Mesh *mesh)
+{
+  RemeshRuntimeData *runtime_data = (RemeshRuntimeData *)rmd->modifier.runtime;
+  if (runtime_data == NULL) {
+    runtime_data = MEM_callocN(sizeof(*runtime_data), __func__);
+    rmd->modifier.runtime = runtime_data;
+  }
+
+  /* The cache itself checks the voxel size. */
+  const bool use_cached = (runtime_data->voxel_cache != NULL) &&
+                          (runtime_data->input_totvert == mesh->totvert) &&
+                          (runtime_data->input_totpoly == mesh->totpoly) &&
+                          !remesh_input_maybe_changed(rmd, ctx);
+  if (!use_cached) {
+    BKE_mesh_remesh_voxel_cache_free(runtime_data->voxel_cache);
+    runtime_data->voxel_cache = NULL;
+    runtime_data->input_totvert = mesh->totvert;
+    runtime_data->input_totpoly = mesh->totpoly;
+  }
+
+  return BKE_mesh_remesh_voxel_to_mesh_nomain_ex(
+      mesh, rmd->voxel_size, rmd->adaptivity, 0.0f, &runtime_data->voxel_cache);
+}
+
 static void init_dualcon_mesh(DualConInput *input, Mesh *mesh)
 {
   memset(input, 0, sizeof(DualConInput));
@@ -143,7 +211,7 @@ static void dualcon_add_quad(void *output_v, const int vert_indices[4])
   output->curface++;
 }
 
-static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *UNUSED(ctx), Mesh *mesh)
+static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *mesh)
 {
   RemeshModifierData *rmd;
   DualConOutput *output;
@@ -159,7 +227,13 @@ static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *UNUSED(ctx)
     if (rmd->voxel_size == 0.0f) {
       return NULL;
     }
-    result = BKE_mesh_remesh_voxel_to_mesh_nomain(mesh, rmd->voxel_size, rmd->adaptivity, 0.0f);
+    if (ctx->flag & MOD_APPLY_USECACHE) {
+      result = remesh_voxel_cached(rmd, ctx, mesh);
+    }
+    else {
+      result = BKE_mesh_remesh_voxel_to_mesh_nomain(
+          mesh, rmd->voxel_size, rmd->adaptivity, 0.0f);
+    }
     if (result == NULL) {
       return NULL;
     }
@@ -305,14 +379,14 @@ ModifierTypeInfo modifierType_Remesh = {
 
     /* initData */ initData,
     /* requiredDataMask */ NULL,
-    /* freeData */ NULL,
+    /* freeData */ freeData,
     /* isDisabled */ NULL,
     /* updateDepsgraph */ NULL,
     /* dependsOnTime */ NULL,
     /* dependsOnNormals */ NULL,
     /* foreachIDLink */ NULL,
     /* foreachTexLink */ NULL,
-    /* freeRuntimeData */ NULL,
+    /* freeRuntimeData */ freeRuntimeData,
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ NULL,
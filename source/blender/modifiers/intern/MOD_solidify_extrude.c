@@ -22,6 +22,7 @@
 
 #include "BLI_bitmap.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines_stack.h"
 
 #include "DNA_mesh_types.h"
@@ -75,6 +76,61 @@ BLI_INLINE bool edgeref_is_init(const EdgeFaceRef *edge_ref)
   return !((edge_ref->p1 == 0) && (edge_ref->p2 == 0));
 }
 
+typedef struct HQNormalEdgeData {
+  const EdgeFaceRef *edge_ref_array;
+  const float (*poly_nors)[3];
+  float (*edge_nors)[3];
+} HQNormalEdgeData;
+
+static void mesh_calc_hq_normal_edge_cb(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const HQNormalEdgeData *data = userdata;
+  const EdgeFaceRef *edge_ref = &data->edge_ref_array[i];
+  const float(*poly_nors)[3] = data->poly_nors;
+  float *edge_normal = data->edge_nors[i];
+
+  /* Get the edge vert indices, and edge value (the face indices that use it) */
+
+  if (edgeref_is_init(edge_ref) && (edge_ref->p1 != -1)) {
+    if (edge_ref->p2 != -1) {
+      /* We have 2 faces using this edge, calculate the edges normal
+       * using the angle between the 2 faces as a weighting */
+#if 0
+      add_v3_v3v3(edge_normal, face_nors[edge_ref->f1], face_nors[edge_ref->f2]);
+      normalize_v3_length(
+          edge_normal,
+          angle_normalized_v3v3(face_nors[edge_ref->f1], face_nors[edge_ref->f2]));
+#else
+      mid_v3_v3v3_angle_weighted(edge_normal, poly_nors[edge_ref->p1], poly_nors[edge_ref->p2]);
+#endif
+    }
+    else {
+      /* only one face attached to that edge */
+      /* an edge without another attached- the weight on this is undefined */
+      copy_v3_v3(edge_normal, poly_nors[edge_ref->p1]);
+    }
+  }
+}
+
+typedef struct HQNormalVertData {
+  const MVert *mvert;
+  float (*vert_nors)[3];
+} HQNormalVertData;
+
+static void mesh_calc_hq_normal_vert_cb(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const HQNormalVertData *data = userdata;
+  float *no = data->vert_nors[i];
+
+  if (normalize_v3(no) == 0.0f) {
+    normal_short_to_float_v3(no, data->mvert[i].no);
+  }
+}
+
 /**
  * \param mesh: Mesh to calculate normals for.
  * \param poly_nors: Precalculated face normals.
@@ -86,7 +142,7 @@ static void mesh_calc_hq_normal(Mesh *mesh, float (*poly_nors)[3], float (*r_ver
   MPoly *mpoly, *mp;
   MLoop *mloop, *ml;
   MEdge *medge, *ed;
-  MVert *mvert, *mv;
+  MVert *mvert;
 
   numVerts = mesh->totvert;
   numEdges = mesh->totedge;
@@ -104,14 +160,13 @@ static void mesh_calc_hq_normal(Mesh *mesh, float (*poly_nors)[3], float (*r_ver
   cddm->mvert = mv;
 #endif
 
-  mv = mvert;
   mp = mpoly;
 
   {
     EdgeFaceRef *edge_ref_array = MEM_calloc_arrayN(
         (size_t)numEdges, sizeof(EdgeFaceRef), "Edge Connectivity");
     EdgeFaceRef *edge_ref;
-    float edge_normal[3];
+    float(*edge_nors)[3];
 
     /* Add an edge reference if it's not there, pointing back to the face index. */
     for (i = 0; i < numPolys; i++, mp++) {
@@ -140,40 +195,278 @@ static void mesh_calc_hq_normal(Mesh *mesh, float (*poly_nors)[3], float (*r_ver
       }
     }
 
-    for (i = 0, ed = medge, edge_ref = edge_ref_array; i < numEdges; i++, ed++, edge_ref++) {
-      /* Get the edge vert indices, and edge value (the face indices that use it) */
+    /* Edge normals don't depend on each other, calculate them in parallel,
+     * then accumulate them into vertices in edge order, as before. */
+    edge_nors = MEM_malloc_arrayN((size_t)numEdges, sizeof(*edge_nors), __func__);
+    {
+      HQNormalEdgeData data = {
+          .edge_ref_array = edge_ref_array,
+          .poly_nors = (const float(*)[3])poly_nors,
+          .edge_nors = edge_nors,
+      };
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.min_iter_per_thread = 1024;
+      BLI_task_parallel_range(0, numEdges, &data, mesh_calc_hq_normal_edge_cb, &settings);
+    }
 
+    for (i = 0, ed = medge, edge_ref = edge_ref_array; i < numEdges; i++, ed++, edge_ref++) {
       if (edgeref_is_init(edge_ref) && (edge_ref->p1 != -1)) {
-        if (edge_ref->p2 != -1) {
-          /* We have 2 faces using this edge, calculate the edges normal
-           * using the angle between the 2 faces as a weighting */
+        add_v3_v3(r_vert_nors[ed->v1], edge_nors[i]);
+        add_v3_v3(r_vert_nors[ed->v2], edge_nors[i]);
+      }
+    }
+    MEM_freeN(edge_nors);
+    MEM_freeN(edge_ref_array);
+  }
+
+  /* normalize vertex normals and assign */
+  {
+    HQNormalVertData data = {
+        .mvert = mvert,
+        .vert_nors = r_vert_nors,
+    };
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1024;
+    BLI_task_parallel_range(0, numVerts, &data, mesh_calc_hq_normal_vert_cb, &settings);
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Threaded Passes
+ *
+ * Passes where every element only writes its own data,
+ * so the result doesn't depend on the number of threads.
+ * \{ */
+
+typedef struct SolidifyShellFlipData {
+  const Mesh *mesh;
+  Mesh *result;
+  /** Polygons of the shell (the copied polygons to flip). */
+  MPoly *mpoly;
+  MLoop *mloop;
+  uint numVerts;
+  uint numEdges;
+  short mat_ofs;
+  short mat_nr_max;
+} SolidifyShellFlipData;
+
+static void solidify_shell_flip_poly_cb(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const SolidifyShellFlipData *data = userdata;
+  const Mesh *mesh = data->mesh;
+  MPoly *mp = &data->mpoly[i];
+  const int loop_end = mp->totloop - 1;
+  MLoop *ml2;
+  uint e;
+  int j;
+
+  /* reverses the loop direction (MLoop.v as well as custom-data)
+   * MLoop.e also needs to be corrected too, done in a separate loop below. */
+  ml2 = data->mloop + mp->loopstart + mesh->totloop;
 #if 0
-          add_v3_v3v3(edge_normal, face_nors[edge_ref->f1], face_nors[edge_ref->f2]);
-          normalize_v3_length(
-              edge_normal,
-              angle_normalized_v3v3(face_nors[edge_ref->f1], face_nors[edge_ref->f2]));
+  for (j = 0; j < mp->totloop; j++) {
+    CustomData_copy_data(&mesh->ldata,
+                         &data->result->ldata,
+                         mp->loopstart + j,
+                         mp->loopstart + (loop_end - j) + mesh->totloop,
+                         1);
+  }
 #else
-          mid_v3_v3v3_angle_weighted(
-              edge_normal, poly_nors[edge_ref->p1], poly_nors[edge_ref->p2]);
+  /* slightly more involved, keep the first vertex the same for the copy,
+   * ensures the diagonals in the new face match the original. */
+  j = 0;
+  for (int j_prev = loop_end; j < mp->totloop; j_prev = j++) {
+    CustomData_copy_data(&mesh->ldata,
+                         &data->result->ldata,
+                         mp->loopstart + j,
+                         mp->loopstart + (loop_end - j_prev) + mesh->totloop,
+                         1);
+  }
 #endif
+
+  if (data->mat_ofs) {
+    mp->mat_nr += data->mat_ofs;
+    CLAMP(mp->mat_nr, 0, data->mat_nr_max);
+  }
+
+  e = ml2[0].e;
+  for (j = 0; j < loop_end; j++) {
+    ml2[j].e = ml2[j + 1].e;
+  }
+  ml2[loop_end].e = e;
+
+  mp->loopstart += mesh->totloop;
+
+  for (j = 0; j < mp->totloop; j++) {
+    ml2[j].e += data->numEdges;
+    ml2[j].v += data->numVerts;
+  }
+}
+
+typedef struct SolidifyOffsetData {
+  /** First vertex to offset, see #INIT_VERT_ARRAY_OFFSETS. */
+  MVert *mvert;
+  const uint *new_vert_arr;
+  bool do_shell_align;
+
+  /* Simple offset. */
+  const MDeformVert *dvert;
+  int defgrp_index;
+  bool defgrp_invert;
+  float offset_fac_vg;
+  float offset_fac_vg_inv;
+  float scalar_short;
+  bool do_clamp;
+  bool do_angle_clamp;
+  float offset;
+  float offset_sq;
+  const float *vert_lens;
+  const float *vert_angs;
+  /** Offsetting the original side (the angle clamp uses the opposite angle). */
+  bool is_orig;
+
+  /* Even thickness. */
+  const float (*vert_nors)[3];
+  const float *vert_angles;
+  const float *vert_accum;
+  float ofs;
+} SolidifyOffsetData;
+
+static void solidify_offset_simple_cb(void *__restrict userdata,
+                                      const int index,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const SolidifyOffsetData *data = userdata;
+  const uint i_orig = (uint)index;
+  const uint i = data->do_shell_align ? i_orig : data->new_vert_arr[i_orig];
+  MVert *mv = &data->mvert[i_orig];
+  const float offset = data->offset;
+  float scalar_short_vgroup = data->scalar_short;
+
+  if (data->dvert) {
+    const MDeformVert *dv = &data->dvert[i];
+    if (data->defgrp_invert) {
+      scalar_short_vgroup = 1.0f - BKE_defvert_find_weight(dv, data->defgrp_index);
+    }
+    else {
+      scalar_short_vgroup = BKE_defvert_find_weight(dv, data->defgrp_index);
+    }
+    scalar_short_vgroup = (data->offset_fac_vg +
+                           (scalar_short_vgroup * data->offset_fac_vg_inv)) *
+                          data->scalar_short;
+  }
+  if (data->do_clamp && offset > FLT_EPSILON) {
+    if (data->do_angle_clamp) {
+      float cos_ang = data->is_orig ? cosf(data->vert_angs[i_orig] * 0.5f) :
+                                      cosf(((2 * M_PI) - data->vert_angs[i]) * 0.5f);
+      if (cos_ang > 0) {
+        float max_off = sqrtf(data->vert_lens[i]) * 0.5f / cos_ang;
+        if (max_off < offset * 0.5f) {
+          scalar_short_vgroup *= max_off / offset * 2;
         }
-        else {
-          /* only one face attached to that edge */
-          /* an edge without another attached- the weight on this is undefined */
-          copy_v3_v3(edge_normal, poly_nors[edge_ref->p1]);
-        }
-        add_v3_v3(r_vert_nors[ed->v1], edge_normal);
-        add_v3_v3(r_vert_nors[ed->v2], edge_normal);
       }
     }
-    MEM_freeN(edge_ref_array);
+    else {
+      if (data->vert_lens[i] < data->offset_sq) {
+        float scalar = sqrtf(data->vert_lens[i]) / offset;
+        scalar_short_vgroup *= scalar;
+      }
+    }
   }
+  madd_v3v3short_fl(mv->co, mv->no, scalar_short_vgroup);
+}
 
-  /* normalize vertex normals and assign */
-  for (i = 0; i < numVerts; i++, mv++) {
-    if (normalize_v3(r_vert_nors[i]) == 0.0f) {
-      normal_short_to_float_v3(r_vert_nors[i], mv->no);
+static void solidify_offset_even_cb(void *__restrict userdata,
+                                    const int index,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const SolidifyOffsetData *data = userdata;
+  const uint i_orig = (uint)index;
+  const uint i_other = data->do_shell_align ? i_orig : data->new_vert_arr[i_orig];
+  MVert *mv = &data->mvert[i_orig];
+
+  if (data->vert_accum[i_other]) { /* zero if unselected */
+    madd_v3_v3fl(mv->co,
+                 data->vert_nors[i_other],
+                 data->ofs * (data->vert_angles[i_other] / data->vert_accum[i_other]));
+  }
+}
+
+typedef struct SolidifyEvenAnglesData {
+  const MVert *mvert;
+  const MLoop *mloop;
+  const MPoly *mpoly;
+  const MEdge *orig_medge;
+  const float (*vert_nors)[3];
+  const float (*poly_nors)[3];
+  bool check_non_manifold;
+  /** Per loop: corner angle and the same angle weighted by the shell distance. */
+  float (*loop_angles)[2];
+} SolidifyEvenAnglesData;
+
+static void solidify_even_angles_poly_cb(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const SolidifyEvenAnglesData *data = userdata;
+  const MVert *mvert = data->mvert;
+  const MPoly *mp = &data->mpoly[i];
+  const MLoop *ml = &data->mloop[mp->loopstart];
+  float(*loop_angles)[2] = &data->loop_angles[mp->loopstart];
+
+  /* #BKE_mesh_calc_poly_angles logic is inlined here */
+  float nor_prev[3];
+  float nor_next[3];
+
+  int i_curr = mp->totloop - 1;
+  int i_next = 0;
+
+  sub_v3_v3v3(nor_prev, mvert[ml[i_curr - 1].v].co, mvert[ml[i_curr].v].co);
+  normalize_v3(nor_prev);
+
+  while (i_next < mp->totloop) {
+    float angle;
+    sub_v3_v3v3(nor_next, mvert[ml[i_curr].v].co, mvert[ml[i_next].v].co);
+    normalize_v3(nor_next);
+    angle = angle_normalized_v3v3(nor_prev, nor_next);
+
+    /* --- not related to angle calc --- */
+    if (angle < FLT_EPSILON) {
+      angle = FLT_EPSILON;
+    }
+
+    const uint vidx = ml[i_curr].v;
+    loop_angles[i_curr][0] = angle;
+
+#ifdef USE_NONMANIFOLD_WORKAROUND
+    /* skip 3+ face user edges */
+    if ((data->check_non_manifold == false) ||
+        LIKELY(((data->orig_medge[ml[i_curr].e].flag & ME_EDGE_TMP_TAG) == 0) &&
+               ((data->orig_medge[ml[i_next].e].flag & ME_EDGE_TMP_TAG) == 0))) {
+      loop_angles[i_curr][1] = shell_v3v3_normalized_to_dist(data->vert_nors[vidx],
+                                                             data->poly_nors[i]) *
+                               angle;
+    }
+    else {
+      loop_angles[i_curr][1] = angle;
     }
+#else
+    loop_angles[i_curr][1] = shell_v3v3_normalized_to_dist(data->vert_nors[vidx],
+                                                           data->poly_nors[i]) *
+                             angle;
+#endif
+    /* --- end non-angle-calc section --- */
+
+    /* step */
+    copy_v3_v3(nor_prev, nor_next);
+    i_curr = i_next;
+    i_next++;
   }
 }
 
@@ -448,55 +741,20 @@ Mesh *MOD_solidify_extrude_modifyMesh(ModifierData *md, const ModifierEvalContex
   if (do_shell) {
     uint i;
 
-    mp = mpoly + numPolys;
-    for (i = 0; i < mesh->totpoly; i++, mp++) {
-      const int loop_end = mp->totloop - 1;
-      MLoop *ml2;
-      uint e;
-      int j;
-
-      /* reverses the loop direction (MLoop.v as well as custom-data)
-       * MLoop.e also needs to be corrected too, done in a separate loop below. */
-      ml2 = mloop + mp->loopstart + mesh->totloop;
-#if 0
-      for (j = 0; j < mp->totloop; j++) {
-        CustomData_copy_data(&mesh->ldata,
-                             &result->ldata,
-                             mp->loopstart + j,
-                             mp->loopstart + (loop_end - j) + mesh->totloop,
-                             1);
-      }
-#else
-      /* slightly more involved, keep the first vertex the same for the copy,
-       * ensures the diagonals in the new face match the original. */
-      j = 0;
-      for (int j_prev = loop_end; j < mp->totloop; j_prev = j++) {
-        CustomData_copy_data(&mesh->ldata,
-                             &result->ldata,
-                             mp->loopstart + j,
-                             mp->loopstart + (loop_end - j_prev) + mesh->totloop,
-                             1);
-      }
-#endif
-
-      if (mat_ofs) {
-        mp->mat_nr += mat_ofs;
-        CLAMP(mp->mat_nr, 0, mat_nr_max);
-      }
-
-      e = ml2[0].e;
-      for (j = 0; j < loop_end; j++) {
-        ml2[j].e = ml2[j + 1].e;
-      }
-      ml2[loop_end].e = e;
-
-      mp->loopstart += mesh->totloop;
-
-      for (j = 0; j < mp->totloop; j++) {
-        ml2[j].e += numEdges;
-        ml2[j].v += numVerts;
-      }
-    }
+    SolidifyShellFlipData data = {
+        .mesh = mesh,
+        .result = result,
+        .mpoly = mpoly + numPolys,
+        .mloop = mloop,
+        .numVerts = numVerts,
+        .numEdges = numEdges,
+        .mat_ofs = mat_ofs,
+        .mat_nr_max = mat_nr_max,
+    };
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1024;
+    BLI_task_parallel_range(0, mesh->totpoly, &data, solidify_shell_flip_poly_cb, &settings);
 
     for (i = 0, ed = medge + numEdges; i < numEdges; i++, ed++) {
       ed->v1 += numVerts;
@@ -508,7 +766,6 @@ Mesh *MOD_solidify_extrude_modifyMesh(ModifierData *md, const ModifierEvalContex
   if ((smd->flag & MOD_SOLIDIFY_EVEN) == 0) {
     /* no even thickness, very simple */
     float scalar_short;
-    float scalar_short_vgroup;
 
     /* for clamping */
     float *vert_lens = NULL;
@@ -594,96 +851,68 @@ Mesh *MOD_solidify_extrude_modifyMesh(ModifierData *md, const ModifierEvalContex
     }
 
     if (ofs_new != 0.0f) {
-      uint i_orig, i_end;
+      uint i_end;
       bool do_shell_align;
 
-      scalar_short = scalar_short_vgroup = ofs_new / 32767.0f;
+      scalar_short = ofs_new / 32767.0f;
 
       INIT_VERT_ARRAY_OFFSETS(false);
 
-      for (i_orig = 0; i_orig < i_end; i_orig++, mv++) {
-        const uint i = do_shell_align ? i_orig : new_vert_arr[i_orig];
-        if (dvert) {
-          MDeformVert *dv = &dvert[i];
-          if (defgrp_invert) {
-            scalar_short_vgroup = 1.0f - BKE_defvert_find_weight(dv, defgrp_index);
-          }
-          else {
-            scalar_short_vgroup = BKE_defvert_find_weight(dv, defgrp_index);
-          }
-          scalar_short_vgroup = (offset_fac_vg + (scalar_short_vgroup * offset_fac_vg_inv)) *
-                                scalar_short;
-        }
-        if (do_clamp && offset > FLT_EPSILON) {
-          /* always reset because we may have set before */
-          if (dvert == NULL) {
-            scalar_short_vgroup = scalar_short;
-          }
-          if (do_angle_clamp) {
-            float cos_ang = cosf(((2 * M_PI) - vert_angs[i]) * 0.5f);
-            if (cos_ang > 0) {
-              float max_off = sqrtf(vert_lens[i]) * 0.5f / cos_ang;
-              if (max_off < offset * 0.5f) {
-                scalar_short_vgroup *= max_off / offset * 2;
-              }
-            }
-          }
-          else {
-            if (vert_lens[i] < offset_sq) {
-              float scalar = sqrtf(vert_lens[i]) / offset;
-              scalar_short_vgroup *= scalar;
-            }
-          }
-        }
-        madd_v3v3short_fl(mv->co, mv->no, scalar_short_vgroup);
-      }
+      SolidifyOffsetData data = {
+          .mvert = mv,
+          .new_vert_arr = new_vert_arr,
+          .do_shell_align = do_shell_align,
+          .dvert = dvert,
+          .defgrp_index = defgrp_index,
+          .defgrp_invert = defgrp_invert,
+          .offset_fac_vg = offset_fac_vg,
+          .offset_fac_vg_inv = offset_fac_vg_inv,
+          .scalar_short = scalar_short,
+          .do_clamp = do_clamp,
+          .do_angle_clamp = do_angle_clamp,
+          .offset = offset,
+          .offset_sq = offset_sq,
+          .vert_lens = vert_lens,
+          .vert_angs = vert_angs,
+          .is_orig = false,
+      };
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.min_iter_per_thread = 1024;
+      BLI_task_parallel_range(0, (int)i_end, &data, solidify_offset_simple_cb, &settings);
     }
 
     if (ofs_orig != 0.0f) {
-      uint i_orig, i_end;
+      uint i_end;
       bool do_shell_align;
 
-      scalar_short = scalar_short_vgroup = ofs_orig / 32767.0f;
+      scalar_short = ofs_orig / 32767.0f;
 
       /* as above but swapped */
       INIT_VERT_ARRAY_OFFSETS(true);
 
-      for (i_orig = 0; i_orig < i_end; i_orig++, mv++) {
-        const uint i = do_shell_align ? i_orig : new_vert_arr[i_orig];
-        if (dvert) {
-          MDeformVert *dv = &dvert[i];
-          if (defgrp_invert) {
-            scalar_short_vgroup = 1.0f - BKE_defvert_find_weight(dv, defgrp_index);
-          }
-          else {
-            scalar_short_vgroup = BKE_defvert_find_weight(dv, defgrp_index);
-          }
-          scalar_short_vgroup = (offset_fac_vg + (scalar_short_vgroup * offset_fac_vg_inv)) *
-                                scalar_short;
-        }
-        if (do_clamp && offset > FLT_EPSILON) {
-          /* always reset because we may have set before */
-          if (dvert == NULL) {
-            scalar_short_vgroup = scalar_short;
-          }
-          if (do_angle_clamp) {
-            float cos_ang = cosf(vert_angs[i_orig] * 0.5f);
-            if (cos_ang > 0) {
-              float max_off = sqrtf(vert_lens[i]) * 0.5f / cos_ang;
-              if (max_off < offset * 0.5f) {
-                scalar_short_vgroup *= max_off / offset * 2;
-              }
-            }
-          }
-          else {
-            if (vert_lens[i] < offset_sq) {
-              float scalar = sqrtf(vert_lens[i]) / offset;
-              scalar_short_vgroup *= scalar;
-            }
-          }
-        }
-        madd_v3v3short_fl(mv->co, mv->no, scalar_short_vgroup);
-      }
+      SolidifyOffsetData data = {
+          .mvert = mv,
+          .new_vert_arr = new_vert_arr,
+          .do_shell_align = do_shell_align,
+          .dvert = dvert,
+          .defgrp_index = defgrp_index,
+          .defgrp_invert = defgrp_invert,
+          .offset_fac_vg = offset_fac_vg,
+          .offset_fac_vg_inv = offset_fac_vg_inv,
+          .scalar_short = scalar_short,
+          .do_clamp = do_clamp,
+          .do_angle_clamp = do_angle_clamp,
+          .offset = offset,
+          .offset_sq = offset_sq,
+          .vert_lens = vert_lens,
+          .vert_angs = vert_angs,
+          .is_orig = true,
+      };
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.min_iter_per_thread = 1024;
+      BLI_task_parallel_range(0, (int)i_end, &data, solidify_offset_simple_cb, &settings);
     }
 
     if (do_bevel_convex) {
@@ -738,54 +967,37 @@ Mesh *MOD_solidify_extrude_modifyMesh(ModifierData *md, const ModifierEvalContex
       }
     }
 
-    for (i = 0, mp = mpoly; i < numPolys; i++, mp++) {
-      /* #BKE_mesh_calc_poly_angles logic is inlined here */
-      float nor_prev[3];
-      float nor_next[3];
-
-      int i_curr = mp->totloop - 1;
-      int i_next = 0;
-
-      ml = &mloop[mp->loopstart];
-
-      sub_v3_v3v3(nor_prev, mvert[ml[i_curr - 1].v].co, mvert[ml[i_curr].v].co);
-      normalize_v3(nor_prev);
-
-      while (i_next < mp->totloop) {
-        float angle;
-        sub_v3_v3v3(nor_next, mvert[ml[i_curr].v].co, mvert[ml[i_next].v].co);
-        normalize_v3(nor_next);
-        angle = angle_normalized_v3v3(nor_prev, nor_next);
-
-        /* --- not related to angle calc --- */
-        if (angle < FLT_EPSILON) {
-          angle = FLT_EPSILON;
-        }
-
-        vidx = ml[i_curr].v;
-        vert_accum[vidx] += angle;
-
+    {
+      /* Calculate the corner angles in parallel, then accumulate them into vertices
+       * in the same order as a single loop over all polygons would. */
+      float(*loop_angles)[2] = MEM_malloc_arrayN(numLoops, sizeof(*loop_angles), __func__);
+      SolidifyEvenAnglesData data = {
+          .mvert = mvert,
+          .mloop = mloop,
+          .mpoly = mpoly,
+          .orig_medge = orig_medge,
+          .vert_nors = (const float(*)[3])vert_nors,
+          .poly_nors = (const float(*)[3])poly_nors,
 #ifdef USE_NONMANIFOLD_WORKAROUND
-        /* skip 3+ face user edges */
-        if ((check_non_manifold == false) ||
-            LIKELY(((orig_medge[ml[i_curr].e].flag & ME_EDGE_TMP_TAG) == 0) &&
-                   ((orig_medge[ml[i_next].e].flag & ME_EDGE_TMP_TAG) == 0))) {
-          vert_angles[vidx] += shell_v3v3_normalized_to_dist(vert_nors[vidx], poly_nors[i]) *
-                               angle;
-        }
-        else {
-          vert_angles[vidx] += angle;
-        }
-#else
-        vert_angles[vidx] += shell_v3v3_normalized_to_dist(vert_nors[vidx], poly_nors[i]) * angle;
+          .check_non_manifold = check_non_manifold,
 #endif
-        /* --- end non-angle-calc section --- */
-
-        /* step */
-        copy_v3_v3(nor_prev, nor_next);
-        i_curr = i_next;
-        i_next++;
+          .loop_angles = loop_angles,
+      };
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.min_iter_per_thread = 1024;
+      BLI_task_parallel_range(0, (int)numPolys, &data, solidify_even_angles_poly_cb, &settings);
+
+      for (i = 0, mp = mpoly; i < numPolys; i++, mp++) {
+        ml = &mloop[mp->loopstart];
+        int i_curr = mp->totloop - 1;
+        for (int i_next = 0; i_next < mp->totloop; i_curr = i_next++) {
+          vidx = ml[i_curr].v;
+          vert_accum[vidx] += loop_angles[mp->loopstart + i_curr][0];
+          vert_angles[vidx] += loop_angles[mp->loopstart + i_curr][1];
+        }
       }
+      MEM_freeN(loop_angles);
     }
 
     /* vertex group support */
@@ -944,34 +1156,46 @@ Mesh *MOD_solidify_extrude_modifyMesh(ModifierData *md, const ModifierEvalContex
 #undef INVALID_PAIR
 
     if (ofs_new != 0.0f) {
-      uint i_orig, i_end;
+      uint i_end;
       bool do_shell_align;
 
       INIT_VERT_ARRAY_OFFSETS(false);
 
-      for (i_orig = 0; i_orig < i_end; i_orig++, mv++) {
-        const uint i_other = do_shell_align ? i_orig : new_vert_arr[i_orig];
-        if (vert_accum[i_other]) { /* zero if unselected */
-          madd_v3_v3fl(
-              mv->co, vert_nors[i_other], ofs_new * (vert_angles[i_other] / vert_accum[i_other]));
-        }
-      }
+      SolidifyOffsetData data = {
+          .mvert = mv,
+          .new_vert_arr = new_vert_arr,
+          .do_shell_align = do_shell_align,
+          .vert_nors = (const float(*)[3])vert_nors,
+          .vert_angles = vert_angles,
+          .vert_accum = vert_accum,
+          .ofs = ofs_new,
+      };
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.min_iter_per_thread = 1024;
+      BLI_task_parallel_range(0, (int)i_end, &data, solidify_offset_even_cb, &settings);
     }
 
     if (ofs_orig != 0.0f) {
-      uint i_orig, i_end;
+      uint i_end;
       bool do_shell_align;
 
       /* same as above but swapped, intentional use of 'ofs_new' */
       INIT_VERT_ARRAY_OFFSETS(true);
 
-      for (i_orig = 0; i_orig < i_end; i_orig++, mv++) {
-        const uint i_other = do_shell_align ? i_orig : new_vert_arr[i_orig];
-        if (vert_accum[i_other]) { /* zero if unselected */
-          madd_v3_v3fl(
-              mv->co, vert_nors[i_other], ofs_orig * (vert_angles[i_other] / vert_accum[i_other]));
-        }
-      }
+      SolidifyOffsetData data = {
+          .mvert = mv,
+          .new_vert_arr = new_vert_arr,
+          .do_shell_align = do_shell_align,
+          .vert_nors = (const float(*)[3])vert_nors,
+          .vert_angles = vert_angles,
+          .vert_accum = vert_accum,
+          .ofs = ofs_orig,
+      };
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.min_iter_per_thread = 1024;
+      BLI_task_parallel_range(0, (int)i_end, &data, solidify_offset_even_cb, &settings);
     }
 
     MEM_freeN(vert_angles);
@@ -64,6 +64,7 @@ typedef struct BakeHighPolyData {
 
 /* external_engine.c */
 bool RE_bake_has_engine(struct Render *re);
+bool RE_bake_has_engine_multi_object(struct Render *re);
 
 bool RE_bake_engine(struct Render *re,
                     struct Depsgraph *depsgraph,
@@ -76,6 +77,18 @@ bool RE_bake_engine(struct Render *re,
                     const int pass_filter,
                     float result[]);
 
+bool RE_bake_engine_multi_object(struct Render *re,
+                                 struct Depsgraph *depsgraph,
+                                 struct Object **objects,
+                                 const int num_objects,
+                                 const BakePixel pixel_array[],
+                                 const int width,
+                                 const int height,
+                                 const int depth,
+                                 const eScenePassType pass_type,
+                                 const int pass_filter,
+                                 float result[]);
+
 /* bake.c */
 int RE_pass_depth(const eScenePassType pass_type);
 
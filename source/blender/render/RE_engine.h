@@ -64,6 +64,7 @@ extern "C" {
 #define RE_USE_SPHERICAL_STEREO 128
 #define RE_USE_STEREO_VIEWPORT 256
 #define RE_USE_GPU_CONTEXT 512
+#define RE_USE_BAKE_MULTI_OBJECT 1024
 
 /* RenderEngine.flag */
 #define RE_ENGINE_ANIMATION 1
@@ -145,6 +146,9 @@ typedef struct RenderEngine {
     float *result;
     int width, height, depth;
     int object_id;
+    /* Objects baked together, indexed by the object_id of pixels, when object_id is -1. */
+    struct Object **objects;
+    int num_objects;
   } bake;
 
   /* Depsgraph */
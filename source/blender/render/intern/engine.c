@@ -47,6 +47,7 @@
 #include "BKE_scene.h"
 
 #include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
 #include "DEG_depsgraph_debug.h"
 #include "DEG_depsgraph_query.h"
 
@@ -148,6 +149,11 @@ void RE_engine_free(RenderEngine *engine)
   }
 #endif
 
+  if (engine->depsgraph) {
+    /* Kept between renders with persistent data. */
+    DEG_graph_free(engine->depsgraph);
+  }
+
   BLI_mutex_end(&engine->update_render_passes_mutex);
 
   MEM_freeN(engine);
@@ -181,15 +187,17 @@ static RenderResult *render_result_from_bake(RenderEngine *engine, int x, int y,
 
   /* Fill render passes from bake pixel array, to be read by the render engine. */
   for (int ty = 0; ty < h; ty++) {
-    size_t offset = ty * w * 4;
+    size_t offset = (size_t)ty * w * 4;
     float *primitive = primitive_pass->rect + offset;
     float *differential = differential_pass->rect + offset;
 
-    size_t bake_offset = (y + ty) * engine->bake.width + x;
+    size_t bake_offset = (size_t)(y + ty) * engine->bake.width + x;
     const BakePixel *bake_pixel = engine->bake.pixels + bake_offset;
 
     for (int tx = 0; tx < w; tx++) {
-      if (bake_pixel->object_id != engine->bake.object_id) {
+      /* When baking multiple objects at once, object_id is -1 and pixels of all objects are
+       * passed to the engine. */
+      if (engine->bake.object_id != -1 && bake_pixel->object_id != engine->bake.object_id) {
         primitive[0] = int_as_float(-1);
         primitive[1] = int_as_float(-1);
       }
@@ -213,9 +221,9 @@ static RenderResult *render_result_from_bake(RenderEngine *engine, int x, int y,
 
   /* Initialize tile render result from full image bake result. */
   for (int ty = 0; ty < h; ty++) {
-    size_t offset = ty * w * engine->bake.depth;
-    size_t bake_offset = ((y + ty) * engine->bake.width + x) * engine->bake.depth;
-    size_t size = w * engine->bake.depth * sizeof(float);
+    size_t offset = (size_t)ty * w * engine->bake.depth;
+    size_t bake_offset = ((size_t)(y + ty) * engine->bake.width + x) * engine->bake.depth;
+    size_t size = (size_t)w * engine->bake.depth * sizeof(float);
 
     memcpy(result_pass->rect + offset, engine->bake.result + bake_offset, size);
   }
@@ -238,9 +246,9 @@ static void render_result_to_bake(RenderEngine *engine, RenderResult *rr)
   int h = rr->tilerect.ymax - rr->tilerect.ymin;
 
   for (int ty = 0; ty < h; ty++) {
-    size_t offset = ty * w * engine->bake.depth;
-    size_t bake_offset = ((y + ty) * engine->bake.width + x) * engine->bake.depth;
-    size_t size = w * engine->bake.depth * sizeof(float);
+    size_t offset = (size_t)ty * w * engine->bake.depth;
+    size_t bake_offset = ((size_t)(y + ty) * engine->bake.width + x) * engine->bake.depth;
+    size_t size = (size_t)w * engine->bake.depth * sizeof(float);
 
     memcpy(engine->bake.result + bake_offset, rpass->rect + offset, size);
   }
@@ -599,13 +607,46 @@ RenderData *RE_engine_get_render_data(Render *re)
 }
 
 /* Depsgraph */
+
+/* With persistent data the depsgraph is kept along with the engine, so that animation frames and
+ * re-renders only evaluate what changed. The recalc flags of IDs are then left for the engine to
+ * read, so it can update only the changed parts of its own copy of the scene. */
+static bool engine_keep_depsgraph(RenderEngine *engine)
+{
+  return (engine->re->r.mode & R_PERSISTENT_DATA) != 0;
+}
+
+static void engine_depsgraph_free(RenderEngine *engine)
+{
+  DEG_graph_free(engine->depsgraph);
+
+  engine->depsgraph = NULL;
+}
+
 static void engine_depsgraph_init(RenderEngine *engine, ViewLayer *view_layer)
 {
   Main *bmain = engine->re->main;
   Scene *scene = engine->re->scene;
 
-  engine->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(engine->depsgraph, "RENDER");
+  /* Reuse depsgraph from persistent data if possible. */
+  if (engine->depsgraph) {
+    if (DEG_get_bmain(engine->depsgraph) != bmain ||
+        DEG_get_input_scene(engine->depsgraph) != scene) {
+      /* If bmain or scene changes, we need a completely new graph. */
+      engine_depsgraph_free(engine);
+    }
+    else if (DEG_get_input_view_layer(engine->depsgraph) != view_layer) {
+      /* If only the view layer changed, reuse the depsgraph in the hope of reusing objects
+       * shared between view layers. */
+      DEG_graph_replace_owners(engine->depsgraph, bmain, scene, view_layer);
+      DEG_graph_tag_relations_update(engine->depsgraph);
+    }
+  }
+
+  if (!engine->depsgraph) {
+    engine->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+    DEG_debug_name_set(engine->depsgraph, "RENDER");
+  }
 
   if (engine->re->r.scemode & R_BUTS_PREVIEW) {
     Depsgraph *depsgraph = engine->depsgraph;
@@ -615,17 +656,26 @@ static void engine_depsgraph_init(RenderEngine *engine, ViewLayer *view_layer)
     DEG_ids_clear_recalc(bmain, depsgraph);
   }
   else {
-    BKE_scene_graph_update_for_newframe(engine->depsgraph);
+    /* Recalc flags are cleared after rendering, when the depsgraph is kept. */
+    BKE_scene_graph_update_for_newframe_ex(engine->depsgraph, !engine_keep_depsgraph(engine));
   }
 
   engine->has_grease_pencil = DRW_render_check_grease_pencil(engine->depsgraph);
 }
 
-static void engine_depsgraph_free(RenderEngine *engine)
+static void engine_depsgraph_exit(RenderEngine *engine)
 {
-  DEG_graph_free(engine->depsgraph);
+  if (engine->depsgraph == NULL) {
+    return;
+  }
 
-  engine->depsgraph = NULL;
+  if (engine_keep_depsgraph(engine)) {
+    /* The engine has handled the updates of this frame by now. */
+    DEG_ids_clear_recalc(engine->re->main, engine->depsgraph);
+  }
+  else {
+    engine_depsgraph_free(engine);
+  }
 }
 
 void RE_engine_frame_set(RenderEngine *engine, int frame, float subframe)
@@ -639,7 +689,7 @@ void RE_engine_frame_set(RenderEngine *engine, int frame, float subframe)
 
   CLAMP(cfra, MINAFRAME, MAXFRAME);
   BKE_scene_frame_set(re->scene, cfra);
-  BKE_scene_graph_update_for_newframe(engine->depsgraph);
+  BKE_scene_graph_update_for_newframe_ex(engine->depsgraph, !engine_keep_depsgraph(engine));
 
   BKE_scene_camera_switch_update(re->scene);
 }
@@ -658,16 +708,24 @@ bool RE_bake_has_engine(Render *re)
   return (type->bake != NULL);
 }
 
-bool RE_bake_engine(Render *re,
-                    Depsgraph *depsgraph,
-                    Object *object,
-                    const int object_id,
-                    const BakePixel pixel_array[],
-                    const BakeImages *bake_images,
-                    const int depth,
-                    const eScenePassType pass_type,
-                    const int pass_filter,
-                    float result[])
+bool RE_bake_has_engine_multi_object(Render *re)
+{
+  RenderEngineType *type = RE_engines_find(re->r.engine);
+  return (type->bake != NULL) && (type->flag & RE_USE_BAKE_MULTI_OBJECT);
+}
+
+static bool engine_bake(Render *re,
+                        Depsgraph *depsgraph,
+                        Object *object,
+                        const int object_id,
+                        Object **objects,
+                        const int num_objects,
+                        const BakePixel pixel_array[],
+                        const BakeImages *bake_images,
+                        const int depth,
+                        const eScenePassType pass_type,
+                        const int pass_filter,
+                        float result[])
 {
   RenderEngineType *type = RE_engines_find(re->r.engine);
   RenderEngine *engine;
@@ -700,6 +758,10 @@ bool RE_bake_engine(Render *re,
   BLI_rw_mutex_unlock(&re->partsmutex);
 
   if (type->bake) {
+    /* Baking uses the depsgraph of the caller, not one kept from a render. */
+    if (engine->depsgraph) {
+      engine_depsgraph_free(engine);
+    }
     engine->depsgraph = depsgraph;
 
     /* update is only called so we create the engine.session */
@@ -716,6 +778,8 @@ bool RE_bake_engine(Render *re,
       engine->bake.height = image->height;
       engine->bake.depth = depth;
       engine->bake.object_id = object_id;
+      engine->bake.objects = objects;
+      engine->bake.num_objects = num_objects;
 
       type->bake(
           engine, engine->depsgraph, object, pass_type, pass_filter, image->width, image->height);
@@ -748,6 +812,69 @@ bool RE_bake_engine(Render *re,
   return true;
 }
 
+bool RE_bake_engine(Render *re,
+                    Depsgraph *depsgraph,
+                    Object *object,
+                    const int object_id,
+                    const BakePixel pixel_array[],
+                    const BakeImages *bake_images,
+                    const int depth,
+                    const eScenePassType pass_type,
+                    const int pass_filter,
+                    float result[])
+{
+  return engine_bake(re,
+                     depsgraph,
+                     object,
+                     object_id,
+                     NULL,
+                     0,
+                     pixel_array,
+                     bake_images,
+                     depth,
+                     pass_type,
+                     pass_filter,
+                     result);
+}
+
+/* Bake multiple objects in a single pass of the engine, so the scene is synchronized once and
+ * pixels of all objects are scheduled together. The object_id of every pixel is an index into
+ * objects, and the pixel array is a single width by height image. */
+bool RE_bake_engine_multi_object(Render *re,
+                                 Depsgraph *depsgraph,
+                                 Object **objects,
+                                 const int num_objects,
+                                 const BakePixel pixel_array[],
+                                 const int width,
+                                 const int height,
+                                 const int depth,
+                                 const eScenePassType pass_type,
+                                 const int pass_filter,
+                                 float result[])
+{
+  BakeImage image = {NULL};
+  image.width = width;
+  image.height = height;
+  image.offset = 0;
+
+  BakeImages bake_images = {NULL};
+  bake_images.data = &image;
+  bake_images.size = 1;
+
+  return engine_bake(re,
+                     depsgraph,
+                     objects[0],
+                     -1,
+                     objects,
+                     num_objects,
+                     pixel_array,
+                     &bake_images,
+                     depth,
+                     pass_type,
+                     pass_filter,
+                     result);
+}
+
 /* Render */
 
 static void engine_render_view_layer(Render *re,
@@ -801,7 +928,7 @@ static void engine_render_view_layer(Render *re,
   }
 
   /* Free dependency graph, if engine has not done it already. */
-  engine_depsgraph_free(engine);
+  engine_depsgraph_exit(engine);
 }
 
 int RE_engine_render(Render *re, int do_all)
@@ -1024,7 +1151,7 @@ void RE_engine_free_blender_memory(RenderEngine *engine)
    *
    * TODO(sergey): Find better solution for this.
    */
-  if (engine->has_grease_pencil) {
+  if (engine->has_grease_pencil || engine_keep_depsgraph(engine)) {
     return;
   }
   DEG_graph_free(engine->depsgraph);